@@ -0,0 +1,208 @@
+// End-to-end extraction and download replayed from a recorded session
+// (fixtures/http, see record_fixtures.py), so no request leaves the machine.
+// Latency and bandwidth are synthetic and set per benchmark; the arguments
+// are milliseconds per request and KiB/s per connection.
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <optional>
+#include <ytdlpp/extractor.hpp>
+#include <ytdlpp/http_client.hpp>
+
+#include "fixtures.hpp"
+#include "net/http_replay.hpp"
+#include "youtube/player_script.hpp"
+
+namespace {
+
+namespace asio = boost::asio;
+using ytdlpp::bench::fixture_dir;
+using ytdlpp::bench::load_fixture;
+
+ytdlpp::net::HttpReplayOptions replay_options(std::chrono::milliseconds latency,
+											  uint64_t bandwidth) {
+	ytdlpp::net::HttpReplayOptions options;
+	options.mode = ytdlpp::net::HttpReplayOptions::Mode::replay;
+	options.directory = (fixture_dir() / "http").string();
+	options.latency = latency;
+	options.bandwidth = bandwidth;
+	return options;
+}
+
+// Recorded URL (fixtures/http/url.txt) without its trailing newline
+std::optional<std::string> recorded_url() {
+	auto url = load_fixture("http/url.txt");
+	if (!url) return std::nullopt;
+	while (!url->empty() && (url->back() == '\n' || url->back() == '\r')) {
+		url->pop_back();
+	}
+	return url;
+}
+
+struct Replay {
+	asio::io_context ioc;
+	ytdlpp::net::HttpReplayOptions options;
+	std::shared_ptr<ytdlpp::net::HttpClient> http;
+
+	explicit Replay(const benchmark::State &state)
+		: options(replay_options(std::chrono::milliseconds(state.range(0)),
+								 static_cast<uint64_t>(state.range(1)) * 1024)),
+		  http(std::make_shared<ytdlpp::net::HttpClient>(ioc.get_executor())) {
+		http->set_replay(options);
+	}
+
+	// Runs the loop until `start`'s operation calls the completion handler
+	// it was given; the guard covers waits on the V8 worker thread.
+	template <typename Start>
+	void run(Start &&start) {
+		ioc.restart();
+		auto work = asio::make_work_guard(ioc);
+		start([&work] { work.reset(); });
+		ioc.run();
+	}
+
+	ytdlpp::Result<ytdlpp::VideoInfo> extract(
+		ytdlpp::youtube::Extractor &extractor, const std::string &url) {
+		std::optional<ytdlpp::Result<ytdlpp::VideoInfo>> result;
+		run([&](auto done) {
+			extractor.async_process(
+				url, [&result, done](ytdlpp::Result<ytdlpp::VideoInfo> r) {
+					result = std::move(r);
+					done();
+				});
+		});
+		return std::move(*result);
+	}
+};
+
+// Drops the bytes; only the transfer is measured
+class DiscardSink : public ytdlpp::net::FileSink {
+   public:
+	ytdlpp::Result<void> preallocate(long long) override {
+		return ytdlpp::outcome::success();
+	}
+	ytdlpp::Result<void> write_at(long long, const char *, size_t) override {
+		return ytdlpp::outcome::success();
+	}
+	ytdlpp::Result<void> close() override {
+		return ytdlpp::outcome::success();
+	}
+};
+
+// Nothing cached: every iteration fetches and loads the player again
+void BM_ExtractCold(benchmark::State &state) {
+	auto url = recorded_url();
+	if (!url) {
+		state.SkipWithError("fixture http/ not recorded");
+		return;
+	}
+	Replay replay(state);
+	for (auto _ : state) {
+		state.PauseTiming();
+		ytdlpp::youtube::PlayerScript::clear_cache();
+		ytdlpp::youtube::Extractor extractor(
+			replay.http, replay.ioc.get_executor());
+		state.ResumeTiming();
+		auto info = replay.extract(extractor, *url);
+		if (info.has_error()) {
+			state.SkipWithError("replayed extraction failed");
+			break;
+		}
+		state.PauseTiming();
+		extractor.shutdown();
+		state.ResumeTiming();
+	}
+}
+BENCHMARK(BM_ExtractCold)
+	->Args({0, 0})
+	->Args({50, 0})
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// One extractor, player already loaded; the result cache stays off
+void BM_ExtractWarm(benchmark::State &state) {
+	auto url = recorded_url();
+	if (!url) {
+		state.SkipWithError("fixture http/ not recorded");
+		return;
+	}
+	Replay replay(state);
+	ytdlpp::youtube::Extractor extractor(
+		replay.http, replay.ioc.get_executor());
+	if (replay.extract(extractor, *url).has_error()) {
+		state.SkipWithError("replayed extraction failed");
+		return;
+	}
+	for (auto _ : state) {
+		auto info = replay.extract(extractor, *url);
+		benchmark::DoNotOptimize(info);
+	}
+	extractor.shutdown();
+}
+BENCHMARK(BM_ExtractWarm)
+	->Args({0, 0})
+	->Args({50, 0})
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Download of the first recorded format over range(2) connections
+void BM_DownloadReplay(benchmark::State &state) {
+	auto url = recorded_url();
+	if (!url) {
+		state.SkipWithError("fixture http/ not recorded");
+		return;
+	}
+	Replay replay(state);
+	ytdlpp::net::HttpReplayStore store(replay.options);
+	ytdlpp::youtube::Extractor extractor(
+		replay.http, replay.ioc.get_executor());
+	auto info = replay.extract(extractor, *url);
+	extractor.shutdown();
+	if (info.has_error()) {
+		state.SkipWithError("replayed extraction failed");
+		return;
+	}
+
+	std::string media_url;
+	long long size = 0;
+	for (const auto &format : info.value().formats) {
+		if (auto media = store.find_media(format.url)) {
+			media_url = format.url;
+			size = media->size;
+			break;
+		}
+	}
+	if (media_url.empty()) {
+		state.SkipWithError("no download recorded");
+		return;
+	}
+
+	auto connections = static_cast<int>(state.range(2));
+	for (auto _ : state) {
+		bool ok = false;
+		replay.run([&](auto done) {
+			replay.http->async_download_file(
+				media_url, std::make_shared<DiscardSink>(), nullptr,
+				[&ok, done](ytdlpp::Result<void> r) {
+					ok = r.has_value();
+					done();
+				},
+				connections);
+		});
+		if (!ok) {
+			state.SkipWithError("replayed download failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_DownloadReplay)
+	->Args({0, 0, 1})
+	->Args({20, 4096, 1})
+	->Args({20, 4096, 4})
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+}  // namespace
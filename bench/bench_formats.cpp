@@ -0,0 +1,97 @@
+// Format selection and rendering of an extracted VideoInfo: the per-video
+// work between extraction and the first download request.
+
+#include <benchmark/benchmark.h>
+
+#include <nlohmann/json.hpp>
+#include <ytdlpp/downloader.hpp>
+#include <ytdlpp/extractor.hpp>
+#include <ytdlpp/output_template.hpp>
+
+#include "fixtures.hpp"
+
+namespace {
+
+using ytdlpp::Downloader;
+using ytdlpp::bench::sample_video_info;
+
+void BM_SelectStreams(benchmark::State &state, const char *selector) {
+	const auto &info = sample_video_info();
+	for (auto _ : state) {
+		auto streams = Downloader::select_streams(info, selector);
+		benchmark::DoNotOptimize(streams);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_SelectStreams, best, "best");
+BENCHMARK_CAPTURE(BM_SelectStreams, bestaudio, "bestaudio");
+BENCHMARK_CAPTURE(BM_SelectStreams, bestvideo_bestaudio,
+				  "bestvideo+bestaudio");
+
+void BM_SelectStreamsPreferredLanguage(benchmark::State &state) {
+	const auto &info = sample_video_info();
+	for (auto _ : state) {
+		auto streams = Downloader::select_streams(info, "bestaudio", "ja");
+		benchmark::DoNotOptimize(streams);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SelectStreamsPreferredLanguage);
+
+void BM_VideoInfoToJson(benchmark::State &state) {
+	const auto &info = sample_video_info();
+	for (auto _ : state) {
+		nlohmann::json j;
+		ytdlpp::youtube::to_json(j, info);
+		benchmark::DoNotOptimize(j);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VideoInfoToJson);
+
+// --dump-json: conversion plus serialization
+void BM_VideoInfoDumpJson(benchmark::State &state) {
+	const auto &info = sample_video_info();
+	size_t bytes = 0;
+	for (auto _ : state) {
+		nlohmann::json j;
+		ytdlpp::youtube::to_json(j, info);
+		auto text = j.dump();
+		bytes += text.size();
+		benchmark::DoNotOptimize(text);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_VideoInfoDumpJson);
+
+constexpr const char *kShortTemplate = "%(title)s [%(id)s].%(ext)s";
+constexpr const char *kLongTemplate =
+	"%(uploader)s/%(upload_date)s - %(title).50s [%(id)s] "
+	"(%(duration_string)s, %(view_count)d views).%(ext)s";
+
+// Parse and render, as a one-off expand_output_template() call does
+void BM_ExpandOutputTemplate(benchmark::State &state, const char *tpl) {
+	const auto &info = sample_video_info();
+	for (auto _ : state) {
+		auto name = ytdlpp::expand_output_template(tpl, info, "mp4");
+		benchmark::DoNotOptimize(name);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_ExpandOutputTemplate, short, kShortTemplate);
+BENCHMARK_CAPTURE(BM_ExpandOutputTemplate, long, kLongTemplate);
+
+// Render only, as downloads and --print do with a compiled template
+void BM_RenderOutputTemplate(benchmark::State &state, const char *tpl) {
+	const auto &info = sample_video_info();
+	const ytdlpp::OutputTemplate compiled(tpl);
+	for (auto _ : state) {
+		auto name = compiled.render(info, "mp4");
+		benchmark::DoNotOptimize(name);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_RenderOutputTemplate, short, kShortTemplate);
+BENCHMARK_CAPTURE(BM_RenderOutputTemplate, long, kLongTemplate);
+
+}  // namespace
@@ -0,0 +1,61 @@
+// ytdlpp_bench entry point. Logging is silenced so benchmarks measure the
+// code rather than the console, and the player cache goes to a scratch
+// directory emptied on every run. --require_fixtures fails the run when a
+// recording is missing instead of skipping the benchmarks that need it.
+
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "fixtures.hpp"
+#include "youtube/player_script.hpp"
+
+int main(int argc, char **argv) {
+	spdlog::set_level(spdlog::level::off);
+
+	auto cache_dir =
+		std::filesystem::temp_directory_path() / "ytdlpp_bench_cache";
+	ytdlpp::youtube::PlayerScript::set_cache_directory(cache_dir);
+	ytdlpp::youtube::PlayerScript::clear_cache();
+
+	bool require_fixtures = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--require_fixtures") != 0) continue;
+		require_fixtures = true;
+		for (int j = i; j + 1 < argc; ++j) argv[j] = argv[j + 1];
+		--argc;
+		break;
+	}
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+	if (require_fixtures) {
+		auto missing = ytdlpp::bench::missing_fixtures();
+		for (const auto &name : missing) {
+			std::fprintf(stderr, "ytdlpp_bench: fixture %s not recorded in %s\n",
+						 name.c_str(),
+						 ytdlpp::bench::fixture_dir().string().c_str());
+		}
+		if (!missing.empty()) {
+			std::fprintf(stderr,
+						 "ytdlpp_bench: record them with "
+						 "bench/record_fixtures.py or point "
+						 "YTDLPP_BENCH_FIXTURES at a recording\n");
+			return 1;
+		}
+	}
+
+	// Recorded with the results, so runs on different fixtures are told apart
+	benchmark::AddCustomContext(
+		"fixtures", ytdlpp::bench::fixture_dir().string());
+	benchmark::AddCustomContext(
+		"player_id", ytdlpp::bench::fixture_player_id());
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,128 @@
+// Parsing of fetched responses: search results, the player URL on a watch
+// page, and gzip/deflate bodies.
+
+#include <benchmark/benchmark.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <ytdlpp/extractor.hpp>
+
+#include "fixtures.hpp"
+#include "net/decompress.hpp"
+#include "youtube/player_script.hpp"
+#include "youtube/search_results.hpp"
+
+namespace {
+
+using ytdlpp::bench::load_fixture;
+
+// search.json: a recorded /youtubei/v1/search response
+void BM_ExtractSearchResults(benchmark::State &state) {
+	auto body = load_fixture("search.json");
+	if (!body) {
+		state.SkipWithError("fixture search.json not recorded");
+		return;
+	}
+	auto response = nlohmann::json::parse(*body);
+	for (auto _ : state) {
+		auto results = ytdlpp::youtube::extract_search_results(response, 20);
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExtractSearchResults);
+
+// Parse included, as the search handler sees the raw body
+void BM_ParseSearchResponse(benchmark::State &state) {
+	auto body = load_fixture("search.json");
+	if (!body) {
+		state.SkipWithError("fixture search.json not recorded");
+		return;
+	}
+	for (auto _ : state) {
+		auto results = ytdlpp::youtube::extract_search_results(
+			nlohmann::json::parse(*body), 20);
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetBytesProcessed(
+		static_cast<int64_t>(state.iterations() * body->size()));
+}
+BENCHMARK(BM_ParseSearchResponse);
+
+// watch.html: a recorded watch page
+void BM_ExtractPlayerUrl(benchmark::State &state) {
+	auto page = load_fixture("watch.html");
+	if (!page) {
+		state.SkipWithError("fixture watch.html not recorded");
+		return;
+	}
+	for (auto _ : state) {
+		auto url =
+			ytdlpp::youtube::PlayerScript::extract_player_url_from_webpage(
+				*page);
+		benchmark::DoNotOptimize(url);
+	}
+	state.SetBytesProcessed(
+		static_cast<int64_t>(state.iterations() * page->size()));
+}
+BENCHMARK(BM_ExtractPlayerUrl);
+
+std::string gzip(const std::string &data) {
+	z_stream zs{};
+	deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+				 Z_DEFAULT_STRATEGY);
+	std::string out(deflateBound(&zs, data.size()), '\0');
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	zs.avail_in = static_cast<uInt>(data.size());
+	zs.next_out = reinterpret_cast<Bytef *>(out.data());
+	zs.avail_out = static_cast<uInt>(out.size());
+	deflate(&zs, Z_FINISH);
+	out.resize(zs.total_out);
+	deflateEnd(&zs);
+	return out;
+}
+
+// A --dump-json document stands in for a gzipped JSON API response
+const std::string &gzip_body() {
+	static const std::string body = [] {
+		nlohmann::json j;
+		ytdlpp::youtube::to_json(j, ytdlpp::bench::sample_video_info());
+		return gzip(j.dump());
+	}();
+	return body;
+}
+
+void BM_DecompressBody(benchmark::State &state) {
+	const auto &body = gzip_body();
+	size_t bytes = 0;
+	for (auto _ : state) {
+		auto text = ytdlpp::net::decompress_body(body, "gzip");
+		bytes += text.size();
+		benchmark::DoNotOptimize(text);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_DecompressBody);
+
+// Chunked as a response arrives from the socket; arg = chunk size
+void BM_InflaterFeed(benchmark::State &state) {
+	const auto &body = gzip_body();
+	auto chunk = static_cast<size_t>(state.range(0));
+	size_t bytes = 0;
+	for (auto _ : state) {
+		ytdlpp::net::Inflater inflater(ytdlpp::net::Inflater::Encoding::gzip);
+		std::string text;
+		for (size_t pos = 0; pos < body.size(); pos += chunk) {
+			inflater.feed(
+				body.data() + pos, std::min(chunk, body.size() - pos), text);
+		}
+		bytes += text.size();
+		benchmark::DoNotOptimize(text);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_InflaterFeed)->Arg(1024)->Arg(16 * 1024);
+
+}  // namespace
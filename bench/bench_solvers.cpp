@@ -0,0 +1,95 @@
+// Challenge solving on a recorded player (fixtures/player.js): native
+// function discovery and EJS batch throughput. Each benchmark gets its own
+// isolate so globals installed by one solver never leak into another.
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+#include <ytdlpp/ejs_solver.hpp>
+
+#include "fixtures.hpp"
+#include "scripting/js_engine.hpp"
+#include "scripting/native_js_solver.hpp"
+
+namespace {
+
+using ytdlpp::bench::fixture_player_id;
+using ytdlpp::bench::load_fixture;
+using ytdlpp::bench::sample_challenges;
+
+struct Engine {
+	boost::asio::io_context ioc;
+	ytdlpp::scripting::JsEngine js{ioc.get_executor()};
+
+	~Engine() { js.shutdown(); }
+};
+
+// Discovery from scratch: no player id, so nothing is cached
+void BM_NativeLoadPlayer(benchmark::State &state) {
+	auto player = load_fixture("player.js");
+	if (!player) {
+		state.SkipWithError("fixture player.js not recorded");
+		return;
+	}
+	Engine engine;
+	ytdlpp::NativeJsSolver solver(&engine.js);
+	if (!solver.init()) {
+		state.SkipWithError("solver scripts failed to load");
+		return;
+	}
+	for (auto _ : state) {
+		bool ok = solver.load_player(*player);
+		benchmark::DoNotOptimize(ok);
+	}
+	state.SetBytesProcessed(
+		static_cast<int64_t>(state.iterations() * player->size()));
+}
+BENCHMARK(BM_NativeLoadPlayer)->Unit(benchmark::kMillisecond);
+
+// A known player replaying its cached discovery results
+void BM_NativeLoadPlayerCached(benchmark::State &state) {
+	auto player = load_fixture("player.js");
+	if (!player) {
+		state.SkipWithError("fixture player.js not recorded");
+		return;
+	}
+	Engine engine;
+	ytdlpp::NativeJsSolver solver(&engine.js);
+	auto player_id = fixture_player_id();
+	if (!solver.init() || !solver.load_player(*player, player_id)) {
+		state.SkipWithError("player failed to load");
+		return;
+	}
+	for (auto _ : state) {
+		bool ok = solver.load_player(*player, player_id);
+		benchmark::DoNotOptimize(ok);
+	}
+}
+BENCHMARK(BM_NativeLoadPlayerCached)->Unit(benchmark::kMillisecond);
+
+// One jsc() call solving arg sig and arg n challenges
+void BM_EjsSolveBatch(benchmark::State &state) {
+	auto player = load_fixture("player.js");
+	if (!player) {
+		state.SkipWithError("fixture player.js not recorded");
+		return;
+	}
+	Engine engine;
+	ytdlpp::EjsSolver solver(engine.js);
+	if (!solver.load_player(*player)) {
+		state.SkipWithError("player failed to load");
+		return;
+	}
+	auto count = static_cast<size_t>(state.range(0));
+	auto sigs = sample_challenges(count, 108, 1);
+	auto ns = sample_challenges(count, 16, 2);
+	for (auto _ : state) {
+		auto results = solver.solve_batch(sigs, ns);
+		benchmark::DoNotOptimize(results);
+	}
+	state.SetItemsProcessed(
+		static_cast<int64_t>(state.iterations() * count * 2));
+}
+BENCHMARK(BM_EjsSolveBatch)->Arg(1)->Arg(16)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
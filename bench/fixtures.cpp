@@ -0,0 +1,237 @@
+#include "fixtures.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#ifndef YTDLPP_BENCH_FIXTURES_DIR
+#define YTDLPP_BENCH_FIXTURES_DIR "fixtures"
+#endif
+
+namespace ytdlpp::bench {
+
+namespace {
+
+// About the length of a real googlevideo URL (~1 KB of query parameters)
+std::string stream_url(int itag, std::string_view mime) {
+	return "https://rr3---sn-4g5lzned.googlevideo.com/videoplayback"
+		"?expire=1767225600&ei=Xk9yZ6mOKpyJ8gO2o6TQDg&ip=203.0.113.7"
+		"&id=o-AJk2bVbTzHq8wX1mF3s7pQyR4uN0cD5eL6vW9aZ&itag=" +
+		std::to_string(itag) +
+		"&aitags=133%2C134%2C135%2C136%2C137%2C160%2C242%2C243%2C244%2C247"
+		"%2C248%2C278%2C394%2C395%2C396%2C397%2C398%2C399&source=youtube"
+		"&requiressl=yes&xpc=EgVo2aDSNQ%3D%3D&met=1767204000%2C&mh=Xy"
+		"&mm=31%2C29&mn=sn-4g5lzned%2Csn-4g5e6nzz&ms=au%2Crdu&mv=m&mvi=3"
+		"&pl=24&rms=au%2Cau&initcwndbps=1873750&bui=AY2Et-N0rA5hQ"
+		"&vprv=1&svpuc=1&mime=" +
+		std::string(mime) +
+		"&ns=q3pN4hB0zC9G&rqh=1&gir=yes&clen=48213577&dur=212.091&lmt="
+		"1735689600000000&mt=1767203700&fvip=4&keepalive=yes&fexp=51326932"
+		"&c=WEB&sefc=1&txp=4532434&n=Qw3rTy8uIoP1aSd&sparams=expire%2Cei%2C"
+		"ip%2Cid%2Caitags%2Csource%2Crequiressl%2Cxpc%2Cbui%2Cvprv%2Csvpuc"
+		"%2Cmime%2Cns%2Crqh%2Cgir%2Cclen%2Cdur%2Clmt&sig=AJfQdSswRQIhAKp3"
+		"Vc0Gd7Wq2y9vX1bZ8nM4kL6jH5gF3dS2aQ1wE0rTAiB7uY6iO5pL4kJ3hG2fD1sA"
+		"0zXcVbNmQwErTyUiOpAs&lsparams=met%2Cmh%2Cmm%2Cmn%2Cms%2Cmv%2Cmvi"
+		"%2Cpl%2Crms%2Cinitcwndbps&lsig=AGluJ3MwRgIhAOq8Zx1Vb2Nm3Kl4Jh5Gf6"
+		"Ds7Aq8Wz9Xe0Rc1Tv2By3AiEA4Nu5Mi6Ko7Lp8Qw9Er0Ty1Ui2Op3As4Df5Gh6Jk7L";
+}
+
+VideoFormat video_format(int itag, int height, std::string_view codec,
+						 std::string_view ext, double tbr) {
+	VideoFormat f;
+	f.itag = itag;
+	f.format_id = std::to_string(itag);
+	f.ext = ext;
+	f.container = ext;
+	f.mime_type = std::string(ext == "webm" ? "video/webm" : "video/mp4") +
+				  "; codecs=\"" + std::string(codec) + "\"";
+	f.url = stream_url(itag, ext == "webm" ? "video%2Fwebm" : "video%2Fmp4");
+	f.vcodec = codec;
+	f.acodec = "none";
+	f.height = height;
+	f.width = height * 16 / 9;
+	f.fps = height >= 720 ? 60 : 30;
+	f.tbr = tbr;
+	f.vbr = tbr;
+	f.content_length = static_cast<long long>(tbr * 1000 / 8 * 212);
+	f.format_note = std::to_string(height) + "p";
+	f.aspect_ratio = 1.78;
+	return f;
+}
+
+VideoFormat audio_format(std::string format_id, int itag,
+						 std::string_view codec, std::string_view ext,
+						 double abr, std::string_view language,
+						 int language_preference) {
+	VideoFormat f;
+	f.itag = itag;
+	f.format_id = std::move(format_id);
+	f.ext = ext == "webm" ? std::string_view("webm") : std::string_view("m4a");
+	f.container = ext;
+	f.mime_type = std::string(ext == "webm" ? "audio/webm" : "audio/mp4") +
+				  "; codecs=\"" + std::string(codec) + "\"";
+	f.url = stream_url(itag, ext == "webm" ? "audio%2Fwebm" : "audio%2Fmp4");
+	f.vcodec = "none";
+	f.acodec = codec;
+	f.audio_sample_rate = 48000;
+	f.audio_channels = 2;
+	f.tbr = abr;
+	f.abr = abr;
+	f.content_length = static_cast<long long>(abr * 1000 / 8 * 212);
+	f.language = language;
+	f.language_preference = language_preference;
+	f.format_note = std::string(language) + (language_preference > 0
+												 ? ", original (default)"
+												 : ", dubbed");
+	return f;
+}
+
+VideoInfo make_sample_video_info() {
+	VideoInfo info;
+	info.id = "dQw4w9WgXcQ";
+	info.title =
+		"Rick Astley - Never Gonna Give You Up (Official Video) (4K Remaster)";
+	info.fulltitle = info.title;
+	info.description = std::string(4000, 'x');
+	info.uploader = "Rick Astley";
+	info.uploader_id = "@RickAstleyYT";
+	info.uploader_url = "https://www.youtube.com/@RickAstleyYT";
+	info.upload_date = "20091025";
+	info.duration = 212;
+	info.duration_string = "3:32";
+	info.view_count = 1700000000;
+	info.like_count = 18000000;
+	info.webpage_url = "https://www.youtube.com/watch?v=dQw4w9WgXcQ";
+	info.thumbnail = "https://i.ytimg.com/vi/dQw4w9WgXcQ/maxresdefault.jpg";
+	info.channel = "Rick Astley";
+	info.channel_id = "UCuAXFkgsw1L7xaCfnd5JJOw";
+	info.channel_url =
+		"https://www.youtube.com/channel/UCuAXFkgsw1L7xaCfnd5JJOw";
+	info.categories = {"Music"};
+	info.tags = {"rick astley", "never gonna give you up", "80s", "pop"};
+	for (int i = 0; i < 40; ++i) {
+		Thumbnail t;
+		t.url = "https://i.ytimg.com/vi/dQw4w9WgXcQ/" + std::to_string(i) +
+				".jpg";
+		t.id = std::to_string(i);
+		t.width = 120 + i * 32;
+		t.height = 90 + i * 18;
+		info.thumbnails.push_back(std::move(t));
+	}
+	for (int i = 0; i < 8; ++i) {
+		Chapter c;
+		c.start_time = i * 26.5;
+		c.end_time = (i + 1) * 26.5;
+		c.title = "Chapter " + std::to_string(i + 1);
+		info.chapters.push_back(std::move(c));
+	}
+
+	struct Rung {
+		int height;
+		int avc, vp9, av1;
+		double tbr;
+	};
+	static constexpr Rung kLadder[] = {
+		{144, 160, 278, 394, 80},	  {240, 133, 242, 395, 160},
+		{360, 134, 243, 396, 350},	  {480, 135, 244, 397, 650},
+		{720, 136, 247, 398, 1300},	  {1080, 137, 248, 399, 2600},
+		{1440, 264, 271, 400, 6500},  {2160, 266, 313, 401, 13000},
+	};
+	for (const auto &r : kLadder) {
+		info.formats.push_back(
+			video_format(r.avc, r.height, "avc1.4d401f", "mp4", r.tbr));
+		info.formats.push_back(
+			video_format(r.vp9, r.height, "vp9", "webm", r.tbr * 0.8));
+		info.formats.push_back(video_format(
+			r.av1, r.height, "av01.0.08M.08", "mp4", r.tbr * 0.7));
+	}
+
+	static constexpr std::string_view kLanguages[] = {"en", "de", "es",
+													  "fr", "ja", "pt"};
+	for (auto lang : kLanguages) {
+		int pref = lang == "en" ? 10 : -1;
+		auto suffix = "-" + std::string(lang);
+		info.formats.push_back(
+			audio_format("139" + suffix, 139, "mp4a.40.5", "m4a", 48, lang,
+						 pref));
+		info.formats.push_back(
+			audio_format("140" + suffix, 140, "mp4a.40.2", "m4a", 129, lang,
+						 pref));
+		info.formats.push_back(audio_format("249" + suffix, 249, "opus",
+											"webm", 50, lang, pref));
+		info.formats.push_back(audio_format("251" + suffix, 251, "opus",
+											"webm", 135, lang, pref));
+	}
+
+	// Muxed 360p
+	auto muxed = video_format(18, 360, "avc1.42001E", "mp4", 500);
+	muxed.acodec = "mp4a.40.2";
+	muxed.audio_channels = 2;
+	muxed.audio_sample_rate = 44100;
+	info.formats.push_back(std::move(muxed));
+	return info;
+}
+
+}  // namespace
+
+std::filesystem::path fixture_dir() {
+	if (const char *dir = std::getenv("YTDLPP_BENCH_FIXTURES")) {
+		return dir;
+	}
+	return YTDLPP_BENCH_FIXTURES_DIR;
+}
+
+std::optional<std::string> load_fixture(std::string_view name) {
+	std::ifstream file(fixture_dir() / std::string(name), std::ios::binary);
+	if (!file) return std::nullopt;
+	return std::string((std::istreambuf_iterator<char>(file)),
+					   std::istreambuf_iterator<char>());
+}
+
+std::vector<std::string> missing_fixtures() {
+	static constexpr std::string_view kRecorded[] = {
+		"watch.html", "player.js", "player_id.txt", "search.json",
+		"http/url.txt",
+	};
+	std::vector<std::string> missing;
+	for (auto name : kRecorded) {
+		std::error_code ec;
+		if (!std::filesystem::is_regular_file(fixture_dir() / name, ec)) {
+			missing.emplace_back(name);
+		}
+	}
+	return missing;
+}
+
+std::string fixture_player_id() {
+	auto id = load_fixture("player_id.txt").value_or("bench");
+	while (!id.empty() && std::isspace(static_cast<unsigned char>(id.back()))) {
+		id.pop_back();
+	}
+	return id;
+}
+
+const VideoInfo &sample_video_info() {
+	static const VideoInfo info = make_sample_video_info();
+	return info;
+}
+
+std::vector<std::string> sample_challenges(size_t count, size_t length,
+										   unsigned seed) {
+	static constexpr std::string_view kAlphabet =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	// mt19937's sequence is fixed by the standard, distributions' are not
+	std::mt19937 rng(seed);
+	std::vector<std::string> out;
+	out.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		std::string s(length, ' ');
+		for (auto &c : s) c = kAlphabet[rng() % kAlphabet.size()];
+		out.push_back(std::move(s));
+	}
+	return out;
+}
+
+}  // namespace ytdlpp::bench
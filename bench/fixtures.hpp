@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ytdlpp/types.hpp>
+
+namespace ytdlpp::bench {
+
+// =============================================================================
+// BENCHMARK FIXTURES
+// =============================================================================
+// Recorded inputs live in bench/fixtures (see record_fixtures.py), or in
+// $YTDLPP_BENCH_FIXTURES when set. Benchmarks that need a recording skip
+// themselves when it is missing, unless --require_fixtures makes the run fail
+// up front instead (ytdlpp_bench_json does, so no report is ever partial).
+// Everything else runs on generated data that is the same on every run, so
+// numbers stay comparable across commits.
+// =============================================================================
+
+std::filesystem::path fixture_dir();
+
+/// Contents of the recorded fixture `name`, or nullopt if not recorded.
+std::optional<std::string> load_fixture(std::string_view name);
+
+/// Recorded fixtures the benchmarks use that are missing from fixture_dir().
+std::vector<std::string> missing_fixtures();
+
+/// Player id recorded next to player.js (fixtures/player_id.txt).
+std::string fixture_player_id();
+
+/// A web client extraction: muxed, adaptive video in three codecs up to
+/// 2160p, and audio in several languages, with full-length stream URLs.
+const VideoInfo &sample_video_info();
+
+/// `count` distinct challenge-like strings of `length` characters.
+std::vector<std::string> sample_challenges(size_t count, size_t length,
+										   unsigned seed);
+
+}  // namespace ytdlpp::bench
@@ -0,0 +1,95 @@
+"""Record the inputs ytdlpp_bench replays into bench/fixtures.
+
+    python bench/record_fixtures.py [VIDEO_ID] [SEARCH_QUERY] [YT_DLPP]
+
+Writes watch.html, player.js, player_id.txt and search.json. Given the path
+of a yt-dlpp binary, also records its HTTP traffic for the video (extraction
+and a bestaudio download) into http/, for the replayed end-to-end
+benchmarks. Re-record only
+deliberately (e.g. when YouTube ships a player the solvers must handle):
+results are comparable only between runs on the same fixtures, and the
+player id is stored with every JSON result.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import urllib.request
+
+FIXTURES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures")
+USER_AGENT = (
+    "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+    "(KHTML, like Gecko) Chrome/131.0.0.0 Safari/537.36"
+)
+
+
+def fetch(url, data=None, headers=None):
+    request = urllib.request.Request(url, data=data, headers=headers or {})
+    request.add_header("User-Agent", USER_AGENT)
+    request.add_header("Accept-Language", "en-US,en;q=0.9")
+    with urllib.request.urlopen(request, timeout=30) as response:
+        return response.read()
+
+
+def save(name, content):
+    path = os.path.join(FIXTURES, name)
+    with open(path, "wb") as f:
+        f.write(content)
+    print(f"{name}: {len(content)} bytes")
+
+
+def main():
+    video_id = sys.argv[1] if len(sys.argv) > 1 else "dQw4w9WgXcQ"
+    query = sys.argv[2] if len(sys.argv) > 2 else "never gonna give you up"
+    os.makedirs(FIXTURES, exist_ok=True)
+
+    page = fetch(f"https://www.youtube.com/watch?v={video_id}&hl=en")
+    save("watch.html", page)
+
+    match = re.search(rb"/s/player/([a-zA-Z0-9_-]+)/[^\"']*?base\.js", page)
+    if not match:
+        sys.exit("No player URL on the watch page")
+    player_url = "https://www.youtube.com" + match.group(0).decode()
+    save("player.js", fetch(player_url))
+    save("player_id.txt", match.group(1) + b"\n")
+
+    payload = {
+        "context": {
+            "client": {
+                "clientName": "WEB",
+                "clientVersion": "2.20250101.00.00",
+                "hl": "en",
+            }
+        },
+        "query": query,
+        "params": "EgIQAfABAQ==",
+    }
+    search = fetch(
+        "https://www.youtube.com/youtubei/v1/search",
+        data=json.dumps(payload).encode(),
+        headers={"Content-Type": "application/json"},
+    )
+    save("search.json", search)
+
+    if len(sys.argv) > 3:
+        record_http(sys.argv[3], f"https://www.youtube.com/watch?v={video_id}")
+
+
+def record_http(binary, url):
+    http_dir = os.path.join(FIXTURES, "http")
+    shutil.rmtree(http_dir, ignore_errors=True)
+    with tempfile.TemporaryDirectory() as out:
+        subprocess.run(
+            [binary, "--record-http", http_dir, "-f", "bestaudio",
+             "-P", out, url],
+            check=True,
+        )
+    save("http/url.txt", url.encode() + b"\n")
+
+
+if __name__ == "__main__":
+    main()
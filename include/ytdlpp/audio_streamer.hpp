@@ -8,6 +8,7 @@
 #include <boost/asio/associated_cancellation_slot.hpp>
 #include <boost/asio/async_result.hpp>
 #include <boost/asio/buffer.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -16,6 +17,10 @@
 
 #include "result.hpp"
 
+namespace ytdlpp::net {
+class HttpClient;
+}
+
 namespace ytdlpp::media {
 
 namespace asio = boost::asio;
@@ -39,25 +44,88 @@ enum class SampleFormat : std::uint8_t {
 	S64P = 11,	// signed 64 bits, planar
 };
 
+/// What an AudioStream delivers
+enum class AudioOutput : std::uint8_t {
+	PCM = 0,   // Decoded and resampled per sample_rate/channels/sample_fmt
+	Opus = 1,  // Opus packets as demuxed if the source is Opus, else PCM
+	AAC = 2,   // AAC packets as demuxed if the source is AAC, else PCM
+};
+
+/// Framing of compressed packets in passthrough mode. The byte stream is a
+/// sequence of headers, each followed by `size` payload bytes, in host byte
+/// order. The ring only ever holds whole packets.
+struct YTDLPP_EXPORT AudioPacketHeader {
+	std::int64_t pts_us = -1;		 // Presentation time, -1 if unknown
+	std::int64_t duration_us = 0;	 // 0 if unknown
+	std::uint32_t size = 0;			 // Payload bytes after the header
+	std::uint32_t reserved = 0;
+};
+
+/// Source codec of a passthrough stream: what a decoder or muxer needs before
+/// the first packet (see AudioStream::codec_parameters()).
+struct YTDLPP_EXPORT AudioCodecParameters {
+	AudioOutput codec = AudioOutput::PCM;  // Opus or AAC when passing through
+	int codec_id = 0;					   // FFmpeg's AVCodecID value
+	int sample_rate = 0;
+	int channels = 0;
+	// AV_CH_* bits of the channel layout, 0 if it has no native order
+	std::uint64_t channel_mask = 0;
+	// Samples to drop at the start (Opus pre-skip, AAC priming), 0 if unknown
+	int initial_padding = 0;
+	// Decoder setup: AudioSpecificConfig for AAC, the OpusHead for Opus
+	std::vector<std::uint8_t> extradata;
+};
+
+/// One compressed packet, as returned by AudioStream::async_read_packet()
+struct YTDLPP_EXPORT AudioPacket {
+	std::int64_t pts_us = -1;
+	std::int64_t duration_us = 0;
+	std::vector<std::uint8_t> data;	 // Empty at EOF
+};
+
 /// Audio stream configuration
 struct YTDLPP_EXPORT AudioStreamOptions {
 	int sample_rate = 48000;  // Common rates: 44100, 48000, 96000
 	int channels = 2;		  // 1 = mono, 2 = stereo
 	SampleFormat sample_fmt = SampleFormat::S16;
+	// Decoded PCM buffered ahead of the reader; decoding pauses when full.
+	// Rounded up to a power of two (default ~2.7 s of 48 kHz stereo S16).
+	size_t buffer_bytes = 512 * 1024;
+	// Compressed bytes the HttpClient reads ahead of the decoder, and its
+	// Range connections. Only used by streamers built with an HttpClient.
+	size_t prefetch_bytes = 4 * 1024 * 1024;
+	int http_connections = 1;
+	// Passthrough skips decoding and resampling when the source codec is
+	// the one requested (e.g. itag 251 is Opus in WebM); the fields above
+	// then only apply to the PCM fallback.
+	AudioOutput output = AudioOutput::PCM;
 };
 
 /// AudioStream - an async-readable audio stream backed by FFmpeg decoding.
 ///
 /// This class provides an asio-compatible async read interface for decoded
 /// audio data. The decoding runs in a background thread and data is buffered
-/// for async consumption.
+/// in a fixed-size ring (AudioStreamOptions::buffer_bytes) for async
+/// consumption.
+///
+/// In passthrough mode (see AudioOutput) the stream carries compressed
+/// packets framed by AudioPacketHeader instead of PCM. async_read_packet()
+/// returns them one at a time; the allocating async_read() returns one framed
+/// packet per call. Don't mix packet reads with buffer reads on one stream.
+///
+/// If the input breaks off (the download or the demuxer fails), the stream
+/// still ends, but the read that would report the end fails with
+/// errc::request_failed and error() is set, so truncated audio is not taken
+/// for the whole track.
 ///
 /// Example usage with yield_context:
 ///   AudioStream stream = streamer.async_open(url, opts, yield).value();
 ///   while (!stream.is_eof()) {
 ///       auto result = stream.async_read(yield);
+///       if (result.has_error()) break;
 ///       // process result.value() bytes
 ///   }
+///   if (stream.error()) { /* the track was cut short */ }
 class YTDLPP_EXPORT AudioStream {
    public:
 	AudioStream(AudioStream &&) noexcept;
@@ -71,9 +139,19 @@ class YTDLPP_EXPORT AudioStream {
 	/// Check if stream has reached end of file
 	[[nodiscard]] bool is_eof() const;
 
+	/// Why the stream ended before its input did; empty on a clean end.
+	[[nodiscard]] std::error_code error() const;
+
 	/// Check if stream was cancelled
 	[[nodiscard]] bool is_cancelled() const;
 
+	/// True if the stream carries compressed packets instead of PCM
+	[[nodiscard]] bool is_passthrough() const;
+
+	/// Codec of the packets in passthrough mode, set before async_open()
+	/// completes; default (PCM) otherwise.
+	[[nodiscard]] const AudioCodecParameters &codec_parameters() const;
+
 	/// Cancel the stream (thread-safe)
 	void cancel();
 
@@ -131,8 +209,33 @@ class YTDLPP_EXPORT AudioStream {
 			token);
 	}
 
+	/// Async read of one passthrough packet with its timestamps.
+	/// Returns a packet with empty data on EOF.
+	/// Signature: void(Result<AudioPacket>)
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<AudioPacket>))
+				  CompletionToken>
+	auto async_read_packet(CompletionToken &&token) {
+		auto ex = get_executor();
+		return asio::async_initiate<CompletionToken, void(Result<AudioPacket>)>(
+			[this, ex](auto &&handler) mutable {
+				CompletionExecutor handler_ex =
+					asio::get_associated_executor(handler, ex);
+
+				auto slot = asio::get_associated_cancellation_slot(handler);
+
+				auto any_handler =
+					asio::any_completion_handler<void(Result<AudioPacket>)>{
+						std::forward<decltype(handler)>(handler)};
+
+				async_read_packet_impl(
+					std::move(any_handler), std::move(handler_ex), slot);
+			},
+			token);
+	}
+
    private:
 	friend class AudioStreamer;
+	friend class DecodeJob;	 // Shared decode scheduler (audio_streamer.cpp)
 
 	struct Impl;
 	explicit AudioStream(std::shared_ptr<Impl> impl);
@@ -147,12 +250,35 @@ class YTDLPP_EXPORT AudioStream {
 			handler,
 		CompletionExecutor handler_ex, asio::cancellation_slot slot);
 
+	void async_read_packet_impl(
+		asio::any_completion_handler<void(Result<AudioPacket>)> handler,
+		CompletionExecutor handler_ex, asio::cancellation_slot slot);
+
 	std::shared_ptr<Impl> m_impl;
 };
 
+/// Snapshot of AudioStreamer::stats(): how full the streams still open are.
+struct YTDLPP_EXPORT AudioStreamerStats {
+	uint64_t opened = 0;  // Streams opened so far
+	size_t open = 0;	  // Streams not yet destroyed
+	// Output rings: bytes waiting for the reader, out of their capacity
+	size_t buffered_bytes = 0;
+	size_t buffer_capacity = 0;
+	size_t full = 0;  // Streams whose decoder waits on a full ring
+	// Compressed bytes read ahead by the HttpClient, not yet decoded
+	size_t prefetched_bytes = 0;
+};
+
 /// AudioStreamer - factory for creating AudioStream instances.
 ///
-/// Opens audio streams from URLs using FFmpeg for decoding.
+/// Opens audio streams from URLs using FFmpeg for decoding. Given an
+/// HttpClient, the bytes are fetched by it (connection pool, DNS cache, Range
+/// chunking) into a read-ahead buffer that FFmpeg reads through a custom
+/// AVIOContext; otherwise FFmpeg fetches the URL itself.
+///
+/// Decoding for every open stream runs on one process-wide pool sized to the
+/// cores, in short round-robin steps. Streams that are full or waiting on the
+/// network don't hold a thread, so hundreds can be open at once.
 class YTDLPP_EXPORT AudioStreamer {
    public:
 	AudioStreamer(const AudioStreamer &) = delete;
@@ -162,13 +288,21 @@ class YTDLPP_EXPORT AudioStreamer {
 	~AudioStreamer();
 
 	explicit AudioStreamer(asio::any_io_executor ex);
+	AudioStreamer(asio::any_io_executor ex,
+				  std::shared_ptr<net::HttpClient> http);
 
 	[[nodiscard]] asio::any_io_executor get_executor() const;
 
+	/// Occupancy of the streams opened by this streamer (thread-safe).
+	[[nodiscard]] AudioStreamerStats stats() const;
+
 	using CompletionExecutor = asio::any_completion_executor;
 
 	/// Open an audio stream asynchronously.
-	/// Returns an AudioStream that can be read from.
+	/// Returns an AudioStream that can be read from. For PCM output it
+	/// completes at once and decoding starts in the background; with a
+	/// passthrough output it completes once the source has been probed, so
+	/// is_passthrough() is already known.
 	/// Signature: void(Result<AudioStream>)
 	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<AudioStream>))
 				  CompletionToken>
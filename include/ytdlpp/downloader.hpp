@@ -22,6 +22,16 @@ namespace ytdlpp {
 
 namespace asio = boost::asio;
 
+struct DownloaderOptions {
+	// Merge video+audio while they download: both streams feed bounded
+	// in-memory queues read by the muxer, so no intermediate files are
+	// written. Needs containers that demux without seeking (YouTube's DASH
+	// WebM and fragmented MP4 do).
+	bool stream_merge = false;
+	// Buffer per stream before the download connections are paused.
+	size_t stream_buffer_bytes = 16 * 1024 * 1024;
+};
+
 class YTDLPP_EXPORT Downloader {
    public:
 	Downloader(const Downloader &) = delete;
@@ -30,7 +40,8 @@ class YTDLPP_EXPORT Downloader {
 	Downloader &operator=(Downloader &&) noexcept;
 	~Downloader();
 
-	explicit Downloader(std::shared_ptr<net::HttpClient> http);
+	explicit Downloader(std::shared_ptr<net::HttpClient> http,
+						DownloaderOptions options = {});
 
 	[[nodiscard]] asio::any_io_executor get_executor() const;
 
@@ -41,21 +52,32 @@ class YTDLPP_EXPORT Downloader {
 		const VideoFormat *audio{};
 	};
 
-	// Static helper - doesn't need async
+	// Static helper - doesn't need async. `log_selection` = false keeps it
+	// quiet, for callers that only probe what would be picked.
 	[[nodiscard]] static StreamInfo select_streams(
 		const VideoInfo &info, std::string_view selector,
-		std::optional<std::string> preferred_lang = std::nullopt);
-
+		std::optional<std::string> preferred_lang = std::nullopt,
+		bool log_selection = true);
+
+	/// Download the selected streams. `connections` is the number of
+	/// parallel Range connections used per stream (see
+	/// DownloadOptions::concurrent_fragments). The session holds a
+	/// reference to `info` until it completes; pass a shared_ptr to avoid
+	/// copying the format table.
 	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<std::string>))
 				  CompletionToken>
-	auto async_download(const VideoInfo &info, std::string_view format_selector,
+	auto async_download(std::shared_ptr<const VideoInfo> info,
+						std::string_view format_selector,
 						std::optional<std::string> merge_format,
-						ProgressCallback progress_cb, CompletionToken &&token) {
+						ProgressCallback progress_cb, CompletionToken &&token,
+						int connections = 1) {
 		auto ex = get_executor();
 		return asio::async_initiate<CompletionToken, void(Result<std::string>)>(
-			[this, ex, info, format_selector_s = std::string(format_selector),
+			[this, ex, info = std::move(info),
+			 format_selector_s = std::string(format_selector),
 			 merge_format = std::move(merge_format),
-			 progress_cb = std::move(progress_cb)](auto &&handler) mutable {
+			 progress_cb = std::move(progress_cb),
+			 connections](auto &&handler) mutable {
 				CompletionExecutor handler_ex =
 					asio::get_associated_executor(handler, ex);
 
@@ -64,19 +86,33 @@ class YTDLPP_EXPORT Downloader {
 						std::forward<decltype(handler)>(handler)};
 
 				async_download_impl(
-					info, std::move(format_selector_s), std::move(merge_format),
-					std::move(progress_cb), std::move(any_handler),
-					std::move(handler_ex));
+					std::move(info), std::move(format_selector_s),
+					std::move(merge_format), std::move(progress_cb),
+					connections, std::move(any_handler), std::move(handler_ex));
 			},
 			token);
 	}
 
+	/// As above; copies `info` once (moves it if it is an rvalue).
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<std::string>))
+				  CompletionToken>
+	auto async_download(VideoInfo info, std::string_view format_selector,
+						std::optional<std::string> merge_format,
+						ProgressCallback progress_cb, CompletionToken &&token,
+						int connections = 1) {
+		return async_download(
+			std::make_shared<const VideoInfo>(std::move(info)),
+			format_selector, std::move(merge_format), std::move(progress_cb),
+			std::forward<CompletionToken>(token), connections);
+	}
+
    private:
 	struct Impl;
 
 	void async_download_impl(
-		const VideoInfo &info, std::string format_selector,
+		std::shared_ptr<const VideoInfo> info, std::string format_selector,
 		std::optional<std::string> merge_format, ProgressCallback progress_cb,
+		int connections,
 		asio::any_completion_handler<void(Result<std::string>)> handler,
 		CompletionExecutor handler_ex);
 
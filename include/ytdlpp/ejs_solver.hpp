@@ -3,6 +3,8 @@
 #include <boost/asio.hpp>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // Forward declaration
 namespace ytdlpp::scripting {
@@ -11,6 +13,15 @@ class JsEngine;
 
 namespace ytdlpp {
 
+/**
+ * Results of a batched solve, keyed by the original challenge.
+ * Challenges the solver could not handle map to themselves.
+ */
+struct ChallengeResults {
+	std::unordered_map<std::string, std::string> sig;
+	std::unordered_map<std::string, std::string> n;
+};
+
 /**
  * EJS Solver - JavaScript Challenge Solver using yt-dlp's EJS approach.
  *
@@ -56,6 +67,21 @@ class EjsSolver {
 			token, std::move(n));
 	}
 
+	// Solve every sig and n challenge in a single jsc() call.
+	template <typename CompletionToken>
+	auto async_solve_batch(std::vector<std::string> sigs,
+						   std::vector<std::string> ns,
+						   CompletionToken &&token) {
+		return boost::asio::async_initiate<CompletionToken,
+										   void(ChallengeResults)>(
+			[this](auto handler, std::vector<std::string> sigs,
+				   std::vector<std::string> ns) {
+				async_solve_batch_impl(
+					std::move(sigs), std::move(ns), std::move(handler));
+			},
+			token, std::move(sigs), std::move(ns));
+	}
+
 	// Load and preprocess the player script.
 	bool load_player(const std::string &player_code,
 					 const std::string &player_id = "");
@@ -66,6 +92,10 @@ class EjsSolver {
 	// Solve an n-parameter challenge.
 	std::string solve_n(const std::string &n_param) const;
 
+	// Solve a batch of challenges (inputs are expected to be unique).
+	ChallengeResults solve_batch(const std::vector<std::string> &sigs,
+								 const std::vector<std::string> &ns) const;
+
 	[[nodiscard]] bool is_ready() const { return ready_; }
 
    private:
@@ -84,6 +114,12 @@ class EjsSolver {
 		boost::asio::any_completion_handler<void(bool)> handler,
 		std::string player_id);
 
+	// Run the preprocessed player once, installing the solver functions;
+	// compiled with the player's V8 code cache when one is stored.
+	void async_install_solvers_impl(
+		std::string preprocessed, std::string player_id,
+		boost::asio::any_completion_handler<void(bool)> handler);
+
 	void async_solve_sig_impl(
 		std::string sig,
 		boost::asio::any_completion_handler<void(std::string)> handler);
@@ -92,6 +128,10 @@ class EjsSolver {
 		std::string n,
 		boost::asio::any_completion_handler<void(std::string)> handler);
 
+	void async_solve_batch_impl(
+		std::vector<std::string> sigs, std::vector<std::string> ns,
+		boost::asio::any_completion_handler<void(ChallengeResults)> handler);
+
 	// Helper for checking/loading bundle async
 	template <typename Handler>
 	void ensure_solver_loaded_async(Handler &&handler) {
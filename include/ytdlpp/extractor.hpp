@@ -6,6 +6,8 @@
 #include <boost/asio/any_completion_handler.hpp>
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/async_result.hpp>
+#include <chrono>
+#include <filesystem>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <optional>
@@ -23,6 +25,56 @@ namespace ytdlpp::youtube {
 
 namespace asio = boost::asio;
 
+struct ExtractorOptions {
+	// Number of V8 isolates (one worker thread each) used for player loading
+	// and challenge solving; concurrent extractions spread across them.
+	size_t js_isolates = 1;
+
+	// Player API requests go to several clients in parallel. By default
+	// extraction waits for all of them. With a selector set here (the
+	// caller's format selector, see Downloader::select_streams), it finishes
+	// as soon as the responses so far can satisfy it, e.g. "bestaudio" from
+	// android_sdkless alone, and later responses are ignored.
+	std::string complete_when_selectable;
+	// Hedge against slow clients: once this long has passed since the
+	// requests went out, extraction finishes with whatever usable
+	// responses it has (or with the first one to arrive). 0 waits.
+	std::chrono::milliseconds client_timeout{0};
+
+	// Reuse results for repeated requests of one video id: up to this many
+	// videos are kept in memory (0 disables), each until its earliest
+	// stream URL expiry minus info_cache_margin. Concurrent requests for
+	// the same id always share one extraction.
+	size_t info_cache_entries = 0;
+	std::chrono::seconds info_cache_margin{300};
+	// Also keep results on disk here, shared with other processes
+	std::filesystem::path info_cache_dir;
+};
+
+/// Snapshot of Extractor::stats(). Counters are relaxed and read one by one.
+struct YTDLPP_EXPORT ExtractorStats {
+	uint64_t extractions = 0;  // Extraction sessions started
+	uint64_t failures = 0;	   // ...that completed with an error
+	uint64_t active = 0;	   // ...still running
+	// Result cache (ExtractorOptions::info_cache_entries/info_cache_dir),
+	// and requests that joined an extraction already in flight
+	uint64_t info_cache_hits = 0;
+	uint64_t info_cache_misses = 0;
+	uint64_t coalesced = 0;
+	// Player cache (scripts, bytecode, solver state); process-wide
+	uint64_t player_cache_memory_hits = 0;
+	uint64_t player_cache_disk_hits = 0;
+	uint64_t player_cache_misses = 0;
+	// V8 isolates (ExtractorOptions::js_isolates): started, leased to an
+	// extraction, and their worker tasks
+	size_t js_isolates = 0;
+	size_t js_isolates_busy = 0;
+	uint64_t js_tasks = 0;
+	uint64_t js_queue_depth = 0;
+	std::chrono::nanoseconds js_wait_time{0};
+	std::chrono::nanoseconds js_run_time{0};
+};
+
 class YTDLPP_EXPORT Extractor {
    public:
 	Extractor(const Extractor &) = delete;
@@ -32,7 +84,8 @@ class YTDLPP_EXPORT Extractor {
 	~Extractor();
 
 	explicit Extractor(std::shared_ptr<ytdlpp::net::HttpClient> http,
-					   asio::any_io_executor ex);
+					   asio::any_io_executor ex,
+					   ExtractorOptions options = {});
 
 	[[nodiscard]] asio::any_io_executor get_executor() const;
 
@@ -44,6 +97,8 @@ class YTDLPP_EXPORT Extractor {
 	/// engine.
 	void shutdown();
 
+	[[nodiscard]] ExtractorStats stats() const;
+
 	using CompletionExecutor = asio::any_completion_executor;
 
 	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<VideoInfo>))
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ytdlpp/ytdlpp_export.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "result.hpp"
+
+namespace ytdlpp::net {
+
+/// Destination of a download. Segments fetched over parallel connections
+/// arrive out of order, so every write carries its absolute file offset.
+/// All calls for one download are made from the same strand.
+class YTDLPP_EXPORT FileSink {
+   public:
+	virtual ~FileSink() = default;
+
+	/// Final size, once Content-Length/Content-Range has told us. Not called
+	/// when the server doesn't report a total.
+	virtual Result<void> preallocate(long long size) = 0;
+
+	/// Write `size` bytes of `data` at `offset`, straight from the caller's
+	/// buffer.
+	virtual Result<void> write_at(
+		long long offset, const char *data, size_t size) = 0;
+
+	/// Backpressure hook, asked after every write by the connection that
+	/// continues at `next_offset`. Returning false parks that connection
+	/// until the sink invokes `resume` (from any thread). Files never park.
+	virtual bool wants_more(long long /*next_offset*/,
+							std::function<void()> /*resume*/) {
+		return true;
+	}
+
+	/// Download failed. Called once, just before close(), so sinks that
+	/// treat a closed file as complete can tell the two apart.
+	virtual void abort() {}
+
+	/// Download finished (successfully or not); flush and release the file.
+	virtual Result<void> close() = 0;
+};
+
+/// Sink writing to `path` with positional writes (pwrite / overlapped
+/// WriteFile) and up-front allocation of the final size (posix_fallocate /
+/// SetFileInformationByHandle). The file is created or truncated.
+YTDLPP_EXPORT Result<std::shared_ptr<FileSink>> open_file_sink(
+	const std::string &path);
+
+}  // namespace ytdlpp::net
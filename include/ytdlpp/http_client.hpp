@@ -6,12 +6,15 @@
 #include <boost/asio/any_completion_handler.hpp>
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/async_result.hpp>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <string_view>
 
+#include "file_sink.hpp"
 #include "result.hpp"
 
 namespace ytdlpp::net {
@@ -24,6 +27,75 @@ struct YTDLPP_EXPORT HttpResponse {
 	std::map<std::string, std::string> headers;
 };
 
+/// TLS handshakes that resumed a cached session vs. full handshakes.
+struct YTDLPP_EXPORT TlsResumptionStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
+/// Traffic to one host, or to all of them (see HttpClientStats).
+struct YTDLPP_EXPORT HttpTransferStats {
+	uint64_t requests = 0;	// Requests and downloads completed
+	uint64_t failures = 0;	// ...of which failed
+	uint64_t bytes = 0;		// Body bytes received, after inflating
+	// Summed from request start to completion; parallel Range connections
+	// of one download count once
+	std::chrono::nanoseconds time{0};
+
+	/// Mean receive rate in bytes per second, 0 before any transfer.
+	[[nodiscard]] double throughput() const {
+		if (time.count() <= 0) return 0.0;
+		return static_cast<double>(bytes) * 1e9 /
+			   static_cast<double>(time.count());
+	}
+};
+
+/// Snapshot of HttpClient::stats(). The counters are read one by one, so
+/// fields may be a few requests apart; replayed traffic is not counted.
+struct YTDLPP_EXPORT HttpClientStats {
+	// Requests sent on a pooled keep-alive connection, or on a new one
+	uint64_t pool_hits = 0;
+	uint64_t pool_misses = 0;
+	// DNS cache lookups; the cache, and so these, are process-wide
+	uint64_t dns_hits = 0;
+	uint64_t dns_misses = 0;
+	TlsResumptionStats tls;
+	uint64_t active_requests = 0;
+	uint64_t active_downloads = 0;
+	HttpTransferStats total;
+	// By host; hosts past the first kMaxHosts share the "other" entry
+	static constexpr size_t kMaxHosts = 64;
+	std::map<std::string, HttpTransferStats> hosts;
+};
+
+/// Offline record/replay of traffic, for reproducible end-to-end timings.
+/// `record` saves every response (and every download's size) to
+/// `directory` while talking to the network as usual; `replay` serves them
+/// from there and never opens a connection. Requests are matched on method,
+/// URL and body.
+struct YTDLPP_EXPORT HttpReplayOptions {
+	enum class Mode { off, record, replay };
+	Mode mode = Mode::off;
+	std::string directory;
+
+	// Record: also save download bodies. Without them, replayed downloads
+	// are zero-filled at the recorded size (transfer timing only).
+	bool record_media = false;
+
+	// Replay: wait before each response or download segment starts
+	std::chrono::milliseconds latency{0};
+	// Replay: bytes per second and connection, 0 = unlimited
+	uint64_t bandwidth = 0;
+};
+
+/// Download rate limits in bytes per second, 0 = unlimited.
+struct YTDLPP_EXPORT BandwidthLimits {
+	// Shared by all downloads of the client, in equal shares
+	uint64_t total = 0;
+	// Each download (one async_download_* call) on its own
+	uint64_t per_download = 0;
+};
+
 class YTDLPP_EXPORT HttpClient {
    public:
 	HttpClient(const HttpClient &) = delete;
@@ -39,6 +111,21 @@ class YTDLPP_EXPORT HttpClient {
 
 	[[nodiscard]] asio::any_io_executor get_executor() const;
 
+	/// Resumption counters of the per-host TLS session cache.
+	[[nodiscard]] TlsResumptionStats tls_resumption_stats() const;
+
+	/// Connection, DNS and per-host transfer counters. Cheap enough to poll
+	/// (a metrics scrape); the hot paths only bump relaxed atomics.
+	[[nodiscard]] HttpClientStats stats() const;
+
+	/// Switch recording/replay (see HttpReplayOptions) before the first
+	/// request.
+	void set_replay(HttpReplayOptions options);
+
+	/// Throttle downloads (see BandwidthLimits); running ones included.
+	/// Requests are never throttled.
+	void set_bandwidth_limits(BandwidthLimits limits);
+
 	using CompletionExecutor = asio::any_io_executor;
 	using ProgressCallback =
 		std::function<void(long long dl_now, long long dl_total)>;
@@ -92,16 +179,19 @@ class YTDLPP_EXPORT HttpClient {
 	}
 
 	// Async Download File
+	// `connections` > 1 fetches Range segments over that many parallel
+	// connections (googlevideo throttles per connection).
 	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<void>))
 				  CompletionToken>
 	auto async_download_file(std::string_view url, std::string_view output_path,
 							 ProgressCallback progress_cb,
-							 CompletionToken &&token) {
+							 CompletionToken &&token, int connections = 1) {
 		auto ex = get_executor();
 		return asio::async_initiate<CompletionToken, void(Result<void>)>(
 			[this, ex, url_s = std::string(url),
 			 output_path_s = std::string(output_path),
-			 progress_cb = std::move(progress_cb)](auto &&handler) mutable {
+			 progress_cb = std::move(progress_cb),
+			 connections](auto &&handler) mutable {
 				CompletionExecutor handler_ex =
 					asio::get_associated_executor(handler, ex);
 
@@ -111,7 +201,35 @@ class YTDLPP_EXPORT HttpClient {
 
 				async_download_file_impl(
 					std::move(url_s), std::move(output_path_s),
-					std::move(progress_cb), std::move(any_handler),
+					std::move(progress_cb), connections,
+					std::move(any_handler), std::move(handler_ex));
+			},
+			token);
+	}
+
+	// Async Download into a caller-provided sink (e.g. one that feeds a
+	// consumer while the file is still arriving).
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<void>))
+				  CompletionToken>
+	auto async_download_file(std::string_view url,
+							 std::shared_ptr<FileSink> sink,
+							 ProgressCallback progress_cb,
+							 CompletionToken &&token, int connections = 1) {
+		auto ex = get_executor();
+		return asio::async_initiate<CompletionToken, void(Result<void>)>(
+			[this, ex, url_s = std::string(url), sink = std::move(sink),
+			 progress_cb = std::move(progress_cb),
+			 connections](auto &&handler) mutable {
+				CompletionExecutor handler_ex =
+					asio::get_associated_executor(handler, ex);
+
+				auto any_handler =
+					asio::any_completion_handler<void(Result<void>)>{
+						std::forward<decltype(handler)>(handler)};
+
+				async_download_sink_impl(
+					std::move(url_s), std::move(sink), std::move(progress_cb),
+					connections, std::move(any_handler),
 					std::move(handler_ex));
 			},
 			token);
@@ -135,10 +253,18 @@ class YTDLPP_EXPORT HttpClient {
 
 	void async_download_file_impl(
 		std::string url, std::string output_path, ProgressCallback progress_cb,
+		int connections,
+		asio::any_completion_handler<void(Result<void>)> handler,
+		CompletionExecutor handler_ex);
+
+	void async_download_sink_impl(
+		std::string url, std::shared_ptr<FileSink> sink,
+		ProgressCallback progress_cb, int connections,
 		asio::any_completion_handler<void(Result<void>)> handler,
 		CompletionExecutor handler_ex);
 
-	std::unique_ptr<Impl> m_impl;
+	// Shared so in-flight requests can tell when the client is gone
+	std::shared_ptr<Impl> m_impl;
 };
 
 }  // namespace ytdlpp::net
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ytdlpp/ytdlpp_export.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ytdlpp {
+
+// =============================================================================
+// INTERNED STRING
+// =============================================================================
+// Handle to an immutable string in a process-wide pool. Format tables repeat
+// the same handful of values (ext, codecs, mime types, languages) across
+// thousands of entries; each distinct value is stored once and every format
+// holds a pointer to it. Interning takes a lock, reading does not. Pool
+// entries are never freed, so only use this for low-cardinality values.
+// =============================================================================
+
+class YTDLPP_EXPORT InternedString {
+   public:
+	InternedString();
+	explicit InternedString(std::string_view s);
+
+	InternedString &operator=(std::string_view s) {
+		return *this = InternedString(s);
+	}
+
+	[[nodiscard]] const std::string &str() const noexcept { return *str_; }
+	operator const std::string &() const noexcept { return *str_; }
+	operator std::string_view() const noexcept { return *str_; }
+
+	[[nodiscard]] bool empty() const noexcept { return str_->empty(); }
+	[[nodiscard]] size_t size() const noexcept { return str_->size(); }
+	[[nodiscard]] const char *c_str() const noexcept { return str_->c_str(); }
+
+	// One pool entry per value, so handles compare by address
+	friend bool operator==(InternedString a, InternedString b) noexcept {
+		return a.str_ == b.str_;
+	}
+	friend bool operator!=(InternedString a, InternedString b) noexcept {
+		return a.str_ != b.str_;
+	}
+	friend bool operator==(InternedString a, std::string_view b) noexcept {
+		return *a.str_ == b;
+	}
+	friend bool operator!=(InternedString a, std::string_view b) noexcept {
+		return *a.str_ != b;
+	}
+	friend bool operator==(std::string_view a, InternedString b) noexcept {
+		return a == *b.str_;
+	}
+	friend bool operator!=(std::string_view a, InternedString b) noexcept {
+		return a != *b.str_;
+	}
+
+   private:
+	const std::string *str_;
+};
+
+}  // namespace ytdlpp
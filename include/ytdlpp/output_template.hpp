@@ -1,8 +1,12 @@
 #pragma once
 
-#include <boost/regex.hpp>
+#include <cctype>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 #include <ytdlpp/types.hpp>
 
 namespace ytdlpp {
@@ -15,67 +19,248 @@ constexpr int PADDING_THRESHOLD = 10;
 constexpr unsigned char MAX_ASCII = 127;
 }  // namespace detail
 
-/// Expand output template using yt-dlp style %(field)s syntax.
-/// Supported fields: id, title, ext, uploader, channel, channel_id,
-/// upload_date, duration, duration_string, view_count, description,
-/// resolution, format, format_id, extractor, extractor_key
-inline std::string expand_output_template(
-	std::string_view tpl, const VideoInfo &info, std::string_view ext = "") {
-	std::string result(tpl);
-	std::string extension = ext.empty() ? info.ext : std::string(ext);
-
-	// Helper to replace field using boost::regex
-	auto replace_field =
-		[&result](const std::string &field, const std::string &value) {
-			// Match %(field)s or %(field).Ns patterns
-			boost::regex pattern("%\\(" + field + "\\)(?:\\.\\d+)?s");
-			result = boost::regex_replace(result, pattern, value);
+// =============================================================================
+// OUTPUT TEMPLATE
+// =============================================================================
+// yt-dlp style filename template, parsed once into literal and field tokens
+// and rendered against a VideoInfo in a single pass.
+//
+//   %(field)s    field value
+//   %(field).Ns  field value truncated to N characters
+//   %(field)d    same as %(field)s (numeric fields)
+//   %%           a literal '%'
+//
+// Supported fields: id, title, fulltitle, ext, uploader, uploader_id,
+// channel, channel_id, upload_date, duration, duration_string, view_count,
+// like_count, description, resolution, format, format_id, extractor,
+// extractor_key. Unknown fields and malformed specs are kept as written.
+// =============================================================================
+
+class OutputTemplate {
+   public:
+	OutputTemplate() = default;
+	explicit OutputTemplate(std::string_view tpl) : source_(tpl) {
+		compile();
+	}
+
+	[[nodiscard]] const std::string &source() const { return source_; }
+	[[nodiscard]] bool empty() const { return source_.empty(); }
+
+	/// Render for `info`; `ext` overrides info.ext when non-empty.
+	[[nodiscard]] std::string render(
+		const VideoInfo &info, std::string_view ext = "") const {
+		std::string result;
+		result.reserve(source_.size() + info.title.size());
+		for (const auto &token : tokens_) {
+			if (token.field == Field::literal) {
+				result += token.literal;
+				continue;
+			}
+			std::string scratch;
+			std::string_view value =
+				field_value(token.field, info, ext, scratch);
+			if (token.max_chars != std::string::npos) {
+				value = truncate_utf8(value, token.max_chars);
+			}
+			result += value;
+		}
+		return result;
+	}
+
+   private:
+	enum class Field : uint8_t {
+		literal,
+		id,
+		title,
+		fulltitle,
+		ext,
+		uploader,
+		uploader_id,
+		channel,
+		channel_id,
+		upload_date,
+		duration,
+		duration_string,
+		view_count,
+		like_count,
+		description,
+		resolution,
+		format,
+		format_id,
+		extractor,
+		extractor_key,
+	};
+
+	struct Token {
+		Field field = Field::literal;
+		std::string literal;
+		size_t max_chars = std::string::npos;
+	};
+
+	static std::optional<Field> lookup(std::string_view name) {
+		static constexpr std::pair<std::string_view, Field> kFields[] = {
+			{"id", Field::id},
+			{"title", Field::title},
+			{"fulltitle", Field::fulltitle},
+			{"ext", Field::ext},
+			{"uploader", Field::uploader},
+			{"uploader_id", Field::uploader_id},
+			{"channel", Field::channel},
+			{"channel_id", Field::channel_id},
+			{"upload_date", Field::upload_date},
+			{"duration", Field::duration},
+			{"duration_string", Field::duration_string},
+			{"view_count", Field::view_count},
+			{"like_count", Field::like_count},
+			{"description", Field::description},
+			{"resolution", Field::resolution},
+			{"format", Field::format},
+			{"format_id", Field::format_id},
+			{"extractor", Field::extractor},
+			{"extractor_key", Field::extractor_key},
 		};
+		for (const auto &[key, field] : kFields) {
+			if (key == name) return field;
+		}
+		return std::nullopt;
+	}
 
-	// Basic fields
-	replace_field("id", info.id);
-	replace_field("title", info.title);
-	replace_field("ext", extension);
-	replace_field("uploader", info.uploader);
-	replace_field("channel", info.channel);
-	replace_field("channel_id", info.channel_id);
-	replace_field("upload_date", info.upload_date);
-	replace_field("description", info.description);
-	replace_field("resolution", info.resolution);
-	replace_field("format", info.format);
-	replace_field("format_id", info.format_id);
-
-	// Numeric fields
-	replace_field("duration", std::to_string(info.duration));
-	replace_field("view_count", std::to_string(info.view_count));
-	replace_field("like_count", std::to_string(info.like_count));
-
-	// Duration string formatted
-	auto dur = info.duration;
-	int hours = static_cast<int>(dur / detail::SECONDS_PER_HOUR);
-	int minutes = static_cast<int>(
-		(dur % detail::SECONDS_PER_HOUR) / detail::SECONDS_PER_MINUTE);
-	int seconds = static_cast<int>(dur % detail::SECONDS_PER_MINUTE);
-	std::string duration_str;
-	if (hours > 0) {
-		duration_str =
-			std::to_string(hours) + ":" +
-			(minutes < detail::PADDING_THRESHOLD ? "0" : "") +
-			std::to_string(minutes) + ":" +
-			(seconds < detail::PADDING_THRESHOLD ? "0" : "") +
-			std::to_string(seconds);
-	} else {
-		duration_str = std::to_string(minutes) + ":" +
-					   (seconds < detail::PADDING_THRESHOLD ? "0" : "") +
-					   std::to_string(seconds);
+	void append_literal(std::string_view text) {
+		if (tokens_.empty() || tokens_.back().field != Field::literal) {
+			tokens_.emplace_back();
+		}
+		tokens_.back().literal += text;
 	}
-	replace_field("duration_string", duration_str);
 
-	// Extractor fields
-	replace_field("extractor", info.extractor);
-	replace_field("extractor_key", info.extractor_key);
+	void compile() {
+		std::string_view tpl = source_;
+		size_t pos = 0;
+		while (pos < tpl.size()) {
+			size_t pct = tpl.find('%', pos);
+			if (pct == std::string_view::npos) {
+				append_literal(tpl.substr(pos));
+				break;
+			}
+			append_literal(tpl.substr(pos, pct - pos));
+			pos = pct + 1;
 
-	return result;
+			if (pos < tpl.size() && tpl[pos] == '%') {
+				append_literal("%");
+				++pos;
+				continue;
+			}
+			if (auto end = parse_field(tpl, pct)) {
+				pos = *end;
+			} else {
+				append_literal("%");
+			}
+		}
+	}
+
+	// Parse the spec starting at tpl[pct] == '%'. On success adds a token and
+	// returns the position after the conversion character.
+	std::optional<size_t> parse_field(std::string_view tpl, size_t pct) {
+		size_t pos = pct + 1;
+		if (pos >= tpl.size() || tpl[pos] != '(') return std::nullopt;
+		size_t close = tpl.find(')', pos);
+		if (close == std::string_view::npos) return std::nullopt;
+		auto field = lookup(tpl.substr(pos + 1, close - pos - 1));
+		if (!field) return std::nullopt;
+		pos = close + 1;
+
+		Token token;
+		token.field = *field;
+		if (pos < tpl.size() && tpl[pos] == '.') {
+			size_t digits = pos + 1;
+			size_t n = 0;
+			while (digits < tpl.size() &&
+				   std::isdigit(static_cast<unsigned char>(tpl[digits]))) {
+				n = n * 10 + static_cast<size_t>(tpl[digits] - '0');
+				++digits;
+			}
+			if (digits == pos + 1) return std::nullopt;
+			token.max_chars = n;
+			pos = digits;
+		}
+		if (pos >= tpl.size() || (tpl[pos] != 's' && tpl[pos] != 'd')) {
+			return std::nullopt;
+		}
+		tokens_.push_back(std::move(token));
+		return pos + 1;
+	}
+
+	static std::string_view field_value(Field field, const VideoInfo &info,
+										std::string_view ext,
+										std::string &scratch) {
+		switch (field) {
+			case Field::id: return info.id;
+			case Field::title: return info.title;
+			case Field::fulltitle: return info.fulltitle;
+			case Field::ext: return ext.empty() ? info.ext : ext;
+			case Field::uploader: return info.uploader;
+			case Field::uploader_id: return info.uploader_id;
+			case Field::channel: return info.channel;
+			case Field::channel_id: return info.channel_id;
+			case Field::upload_date: return info.upload_date;
+			case Field::description: return info.description;
+			case Field::resolution: return info.resolution;
+			case Field::format: return info.format;
+			case Field::format_id: return info.format_id;
+			case Field::extractor: return info.extractor;
+			case Field::extractor_key: return info.extractor_key;
+			case Field::duration:
+				return scratch = std::to_string(info.duration);
+			case Field::view_count:
+				return scratch = std::to_string(info.view_count);
+			case Field::like_count:
+				return scratch = std::to_string(info.like_count);
+			case Field::duration_string:
+				return scratch = format_duration(info.duration);
+			case Field::literal: break;
+		}
+		return {};
+	}
+
+	static std::string format_duration(long long dur) {
+		int hours = static_cast<int>(dur / detail::SECONDS_PER_HOUR);
+		int minutes = static_cast<int>(
+			(dur % detail::SECONDS_PER_HOUR) / detail::SECONDS_PER_MINUTE);
+		int seconds = static_cast<int>(dur % detail::SECONDS_PER_MINUTE);
+		auto pad = [](int v) {
+			return (v < detail::PADDING_THRESHOLD ? "0" : "") +
+				   std::to_string(v);
+		};
+		if (hours > 0) {
+			return std::to_string(hours) + ":" + pad(minutes) + ":" +
+				   pad(seconds);
+		}
+		return std::to_string(minutes) + ":" + pad(seconds);
+	}
+
+	// First `max_chars` code points of a UTF-8 string
+	static std::string_view truncate_utf8(std::string_view s,
+										  size_t max_chars) {
+		size_t chars = 0;
+		for (size_t i = 0; i < s.size(); ++i) {
+			// Count lead bytes, skip continuation bytes (10xxxxxx)
+			if ((static_cast<unsigned char>(s[i]) & 0xC0) != 0x80) {
+				if (chars == max_chars) return s.substr(0, i);
+				++chars;
+			}
+		}
+		return s;
+	}
+
+	std::string source_;
+	std::vector<Token> tokens_;
+};
+
+/// Expand output template using yt-dlp style %(field)s syntax (see
+/// OutputTemplate). Compiles `tpl` on every call; keep an OutputTemplate
+/// around when rendering the same template repeatedly.
+inline std::string expand_output_template(
+	std::string_view tpl, const VideoInfo &info, std::string_view ext = "") {
+	return OutputTemplate(tpl).render(info, ext);
 }
 
 /// Sanitize filename - remove/replace problematic characters
@@ -32,6 +32,7 @@ enum class errc {
 
 	// Media
 	muxer_error = 60,
+	stream_open_failed,
 
 	unknown = 100
 };
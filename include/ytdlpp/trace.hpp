@@ -0,0 +1,161 @@
+#pragma once
+
+#include <ytdlpp/ytdlpp_export.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "result.hpp"
+
+namespace ytdlpp::trace {
+
+// =============================================================================
+// LATENCY TRACING
+// =============================================================================
+// Spans time the phases of extraction and download (DNS, connect, TLS, time
+// to first byte, player download, V8 compile, solving, muxing, disk). They
+// cost one relaxed atomic load while no sink is installed, and nothing at
+// all when the library is built with YTDLPP_ENABLE_TRACING=OFF (which
+// defines YTDLPP_NO_TRACING).
+//
+// A scoped span covers a stretch of code on one thread. An async span covers
+// an operation that hops between callbacks (a request from resolve to last
+// byte); those overlap freely on an io_context thread, so exporters must not
+// nest them under the thread's scoped spans.
+// =============================================================================
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+	const char *category = "";	// Static strings, e.g. "net", "js"
+	const char *name = "";
+	std::string detail;	 // Host, video id, byte range...
+	Clock::time_point begin;
+	Clock::time_point end;
+	std::thread::id thread;	 // Where the span began
+	uint64_t id = 0;		 // Async spans only: unique per span
+	bool async = false;
+};
+
+/// Receives every finished span, on the thread that ended it; must be
+/// thread-safe. An empty sink disables tracing.
+using Sink = std::function<void(const Event &)>;
+
+YTDLPP_EXPORT void set_sink(Sink sink);
+
+namespace detail {
+YTDLPP_EXPORT extern std::atomic<bool> g_enabled;
+YTDLPP_EXPORT void emit(Event &&event);
+YTDLPP_EXPORT uint64_t next_async_id();
+}  // namespace detail
+
+inline bool enabled() noexcept {
+#ifdef YTDLPP_NO_TRACING
+	return false;
+#else
+	return detail::g_enabled.load(std::memory_order_relaxed);
+#endif
+}
+
+/// Open span, reported to the sink when it ends (explicitly or on
+/// destruction). Inactive, and free, while tracing is disabled.
+class Span {
+   public:
+	Span() = default;
+	Span(const char *category, const char *name) {
+		if (enabled()) open(category, name, false);
+	}
+	Span(const char *category, const char *name, std::string_view detail)
+		: Span(category, name) {
+		if (event_) event_->detail = detail;
+	}
+
+	/// Span whose begin and end run in different callbacks.
+	static Span async(const char *category, const char *name,
+					  std::string_view detail = {}) {
+		Span span;
+		if (enabled()) {
+			span.open(category, name, true);
+			span.event_->detail = detail;
+		}
+		return span;
+	}
+
+	Span(Span &&) noexcept = default;
+	Span &operator=(Span &&other) noexcept {
+		if (this != &other) {
+			end();
+			event_ = std::move(other.event_);
+		}
+		return *this;
+	}
+	Span(const Span &) = delete;
+	Span &operator=(const Span &) = delete;
+
+	~Span() { end(); }
+
+	[[nodiscard]] bool active() const noexcept { return event_ != nullptr; }
+
+	/// Replace the detail; for what is only known later (sizes, status).
+	/// Check active() first when building it costs anything.
+	void set_detail(std::string detail) {
+		if (event_) event_->detail = std::move(detail);
+	}
+
+	void end() {
+		if (!event_) return;
+		event_->end = Clock::now();
+		detail::emit(std::move(*event_));
+		event_.reset();
+	}
+
+   private:
+	void open(const char *category, const char *name, bool async) {
+		event_ = std::make_unique<Event>();
+		event_->category = category;
+		event_->name = name;
+		event_->thread = std::this_thread::get_id();
+		event_->async = async;
+		if (async) event_->id = detail::next_async_id();
+		event_->begin = Clock::now();
+	}
+
+	std::unique_ptr<Event> event_;
+};
+
+// =============================================================================
+// CHROME TRACE RECORDER
+// =============================================================================
+// Collects spans while installed and writes them in the Chrome trace event
+// format (chrome://tracing, ui.perfetto.dev). Ids of threads are renumbered
+// in order of appearance.
+// =============================================================================
+
+class YTDLPP_EXPORT ChromeTraceRecorder {
+   public:
+	ChromeTraceRecorder();
+	~ChromeTraceRecorder();
+	ChromeTraceRecorder(const ChromeTraceRecorder &) = delete;
+	ChromeTraceRecorder &operator=(const ChromeTraceRecorder &) = delete;
+
+	/// Become the trace sink; uninstalled on destruction.
+	void install();
+
+	[[nodiscard]] std::vector<Event> events() const;
+
+	Result<void> write(const std::string &path) const;
+
+   private:
+	struct State;
+	std::shared_ptr<State> state_;	// Shared with the installed sink
+};
+
+}  // namespace ytdlpp::trace
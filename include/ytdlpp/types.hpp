@@ -7,6 +7,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include <ytdlpp/interned_string.hpp>
 
 namespace ytdlpp {
 
@@ -22,14 +23,31 @@ using ProgressCallback = std::function<void(
 	const std::string &status, const DownloadProgress &progress)>;
 using StreamDataCallback = std::function<void(const std::vector<uint8_t> &)>;
 
+enum class Protocol : uint8_t { https, m3u8_native, http_dash_segments };
+enum class DynamicRange : uint8_t { SDR, HDR };
+
+inline const char *to_string(Protocol p) {
+	switch (p) {
+		case Protocol::m3u8_native: return "m3u8_native";
+		case Protocol::http_dash_segments: return "http_dash_segments";
+		default: return "https";
+	}
+}
+
+inline const char *to_string(DynamicRange r) {
+	return r == DynamicRange::HDR ? "HDR" : "SDR";
+}
+
+// Repeated, low-cardinality values are interned (see InternedString) or
+// enums; only the per-format fields (format_id, url) own their strings.
 struct YTDLPP_EXPORT VideoFormat {
 	int itag = 0;
 	std::string format_id;	// Unique ID (e.g., "251", "251-drc", "139-en-GB")
 	std::string url;
-	std::string mime_type;
-	std::string ext;
-	std::string vcodec;
-	std::string acodec;
+	InternedString mime_type;
+	InternedString ext;
+	InternedString vcodec;
+	InternedString acodec;
 	int width = 0;
 	int height = 0;
 	int fps = 0;
@@ -39,16 +57,16 @@ struct YTDLPP_EXPORT VideoFormat {
 	double abr = 0.0;
 	double vbr = 0.0;
 	long long content_length = 0;
-	std::string language;		   // Language code
+	InternedString language;	   // Language code
 	int language_preference = -1;  // Default -1
 
 	// Additional yt-dlp compatible fields
-	std::string format_note;	// e.g., "144p", "720p", "Premium"
-	std::string container;		// e.g., "webm", "mp4"
-	std::string protocol;		// e.g., "https", "m3u8_native"
-	std::string dynamic_range;	// e.g., "SDR", "HDR"
-	double aspect_ratio = 0.0;
+	InternedString format_note;	 // e.g., "144p", "720p", "Premium"
+	InternedString container;	 // e.g., "webm", "mp4"
+	Protocol protocol = Protocol::https;
+	DynamicRange dynamic_range = DynamicRange::SDR;
 	bool has_drm = false;
+	double aspect_ratio = 0.0;
 	long long filesize_approx = 0;
 };
 
@@ -166,6 +184,7 @@ struct YTDLPP_EXPORT DownloadOptions {
 	bool verbose = false;	// -v, --verbose
 
 	// Network
+	int concurrent_fragments = 1;	  // -N, --concurrent-fragments
 	bool restrict_filenames = false;  // --restrict-filenames
 	bool no_mtime = false;			  // --no-mtime
 };
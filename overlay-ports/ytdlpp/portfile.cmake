@@ -8,6 +8,9 @@ set(SOURCE_PATH "${CMAKE_CURRENT_LIST_DIR}/../..")
 vcpkg_check_features(
     OUT_FEATURE_OPTIONS
     FEATURE_OPTIONS
+    FEATURES
+    http2
+    YTDLPP_ENABLE_HTTP2
     INVERTED_FEATURES
     boost
     YTDLPP_USE_SYSTEM_BOOST
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+namespace ytdlpp {
+
+namespace asio = boost::asio;
+
+// =============================================================================
+// ASYNC SEMAPHORE
+// =============================================================================
+// Counting semaphore for async operations: async_acquire() completes once a
+// slot is free, and release() hands the slot to the oldest waiter. Waiters are
+// resumed through `ex`, never inline. Not thread-safe: use it from a single
+// thread or strand.
+// =============================================================================
+
+class AsyncSemaphore {
+   public:
+	AsyncSemaphore(asio::any_io_executor ex, size_t count)
+		: ex_(std::move(ex)), count_(count) {}
+
+	AsyncSemaphore(const AsyncSemaphore &) = delete;
+	AsyncSemaphore &operator=(const AsyncSemaphore &) = delete;
+
+	/// Wait for a slot. Signature: void()
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void()) CompletionToken>
+	auto async_acquire(CompletionToken &&token) {
+		return asio::async_initiate<CompletionToken, void()>(
+			[this](auto &&handler) {
+				waiters_.emplace_back(std::forward<decltype(handler)>(handler));
+				dispatch_waiters();
+			},
+			token);
+	}
+
+	/// Return a slot taken by async_acquire().
+	void release() {
+		++count_;
+		dispatch_waiters();
+	}
+
+	[[nodiscard]] size_t available() const { return count_; }
+	[[nodiscard]] size_t waiting() const { return waiters_.size(); }
+
+   private:
+	void dispatch_waiters() {
+		while (count_ > 0 && !waiters_.empty()) {
+			--count_;
+			asio::post(ex_, [handler = std::move(waiters_.front())]() mutable {
+				handler();
+			});
+			waiters_.pop_front();
+		}
+	}
+
+	asio::any_io_executor ex_;
+	size_t count_;
+	std::deque<asio::any_completion_handler<void()>> waiters_;
+};
+
+}  // namespace ytdlpp
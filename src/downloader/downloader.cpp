@@ -4,13 +4,16 @@
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/post.hpp>
 #include <filesystem>
+#include <mutex>
 #include <utility>
+#include <vector>
 #include <ytdlpp/downloader.hpp>
 #include <ytdlpp/http_client.hpp>
 
 namespace fs = std::filesystem;
 
 #include "media/muxer.hpp"
+#include "media/stream_queue.hpp"
 
 namespace ytdlpp {
 
@@ -28,20 +31,42 @@ std::string sanitize_filename_local(const std::string &name) {
 // Struct Impl definition
 struct Downloader::Impl {
 	std::shared_ptr<ytdlpp::net::HttpClient> http;
+	DownloaderOptions options;
 
-	explicit Impl(std::shared_ptr<ytdlpp::net::HttpClient> h)
-		: http(std::move(h)) {}
+	// Queues of in-flight streaming merges
+	std::mutex queues_mutex;
+	std::vector<std::weak_ptr<media::StreamQueue>> live_queues;
+
+	Impl(std::shared_ptr<ytdlpp::net::HttpClient> h, DownloaderOptions opts)
+		: http(std::move(h)), options(opts) {}
+
+	~Impl() {
+		// A merge still waiting for bytes would hold a muxing thread forever
+		std::lock_guard lock(queues_mutex);
+		for (auto &weak : live_queues) {
+			if (auto q = weak.lock()) q->cancel();
+		}
+	}
+
+	void track_queue(const std::shared_ptr<media::StreamQueue> &queue) {
+		std::lock_guard lock(queues_mutex);
+		live_queues.erase(
+			std::remove_if(live_queues.begin(), live_queues.end(),
+						   [](const auto &w) { return w.expired(); }),
+			live_queues.end());
+		live_queues.push_back(queue);
+	}
 
 	// Logic for stream selection
 	static Downloader::StreamInfo select_streams(
 		const VideoInfo &info, std::string_view selector,
-		std::optional<std::string> preferred_lang = std::nullopt);
+		std::optional<std::string> preferred_lang, bool log_selection);
 
 	// Async download logic delegate
 	void async_download(
-		const ytdlpp::VideoInfo &info, std::string format_selector,
+		std::shared_ptr<const VideoInfo> info, std::string format_selector,
 		std::optional<std::string> merge_format,
-		ytdlpp::ProgressCallback progress_cb,
+		ytdlpp::ProgressCallback progress_cb, int connections,
 		asio::any_completion_handler<void(Result<std::string>)> handler,
 		Downloader::CompletionExecutor handler_ex);
 
@@ -62,24 +87,28 @@ class AsyncDownloaderSession
 	AsyncDownloaderSession(
 		std::shared_ptr<ytdlpp::net::HttpClient> http,
 		asio::any_completion_handler<void(Result<std::string>)> cb,
-		CompletionExecutor handler_ex, ProgressCallback progress_cb)
+		CompletionExecutor handler_ex, ProgressCallback progress_cb,
+		int connections, DownloaderOptions options)
 		: http_(std::move(http)),
 		  cb_(std::move(cb)),
 		  handler_ex_(std::move(handler_ex)),
-		  progress_cb_(std::move(progress_cb)) {}
+		  progress_cb_(std::move(progress_cb)),
+		  connections_(connections),
+		  options_(options) {}
 
-	void start(const VideoInfo &info, std::string_view selector,
+	void start(std::shared_ptr<const VideoInfo> info, std::string_view selector,
 			   std::optional<std::string> merge_fmt) {
-		info_ = info;
+		// Shared, not copied: streams_ points into its format table
+		info_ = std::move(info);
 		merge_fmt_ = std::move(merge_fmt);
 
-		streams_ = Downloader::select_streams(info_, selector);
+		streams_ = Downloader::select_streams(*info_, selector);
 
 		if (!streams_.video && !streams_.audio) {
 			return complete(outcome::failure(errc::video_not_found));
 		}
 
-		base_filename_ = sanitize_filename_local(info.title);
+		base_filename_ = sanitize_filename_local(info_->title);
 		if (base_filename_.empty()) base_filename_ = "video";
 
 		// Calculate total operations
@@ -87,16 +116,30 @@ class AsyncDownloaderSession
 		if (streams_.video) active_downloads_++;
 		if (streams_.audio) active_downloads_++;
 
+		if (streams_.video && streams_.audio && merge_fmt_ &&
+			options_.stream_merge) {
+			return start_streaming_merge();
+		}
+
 		if (streams_.video) download_video();
 		if (streams_.audio) download_audio();
 	}
 
+	// Queues of a streaming merge (empty otherwise), valid after start().
+	[[nodiscard]] std::vector<std::shared_ptr<media::StreamQueue>>
+	stream_queues() const {
+		if (!video_queue_) return {};
+		return {video_queue_, audio_queue_};
+	}
+
    private:
 	std::shared_ptr<ytdlpp::net::HttpClient> http_;
 	asio::any_completion_handler<void(Result<std::string>)> cb_;
 	CompletionExecutor handler_ex_;
 	ProgressCallback progress_cb_;
-	VideoInfo info_;
+	int connections_ = 1;
+	DownloaderOptions options_;
+	std::shared_ptr<const VideoInfo> info_;
 	std::optional<std::string> merge_fmt_;
 	Downloader::StreamInfo streams_;
 	std::string base_filename_;
@@ -105,6 +148,13 @@ class AsyncDownloaderSession
 	int active_downloads_ = 0;
 	bool error_occurred_ = false;
 
+	// Streaming merge
+	std::shared_ptr<media::StreamQueue> video_queue_;
+	std::shared_ptr<media::StreamQueue> audio_queue_;
+	std::string output_path_;
+	bool merge_ok_ = false;
+	std::chrono::steady_clock::time_point merge_start_;
+
 	// Progress Tracking
 	long long total_video_bytes_ = 0;
 	long long total_audio_bytes_ = 0;
@@ -113,7 +163,7 @@ class AsyncDownloaderSession
 	std::chrono::steady_clock::time_point start_time_;
 
 	void download_video() {
-		video_path_ = base_filename_ + "." + streams_.video->ext;
+		video_path_ = base_filename_ + "." + streams_.video->ext.str();
 
 		spdlog::info("Downloading video: {}", video_path_);
 		http_->async_download_file(
@@ -130,11 +180,12 @@ class AsyncDownloaderSession
 					self->error_occurred_ = true;
 				}
 				self->on_download_complete();
-			});
+			},
+			connections_);
 	}
 
 	void download_audio() {
-		audio_path_ = base_filename_ + "_audio." + streams_.audio->ext;
+		audio_path_ = base_filename_ + "_audio." + streams_.audio->ext.str();
 		spdlog::info("Downloading audio: {}", audio_path_);
 		http_->async_download_file(
 			streams_.audio->url, audio_path_,
@@ -150,9 +201,63 @@ class AsyncDownloaderSession
 					self->error_occurred_ = true;
 				}
 				self->on_download_complete();
+			},
+			connections_);
+	}
+
+	// Both downloads write into bounded queues that the muxer drains on
+	// the muxing pool while the bytes arrive; the session completes once the two
+	// downloads and the merge have all finished.
+	void start_streaming_merge() {
+		output_path_ = base_filename_ + "." + *merge_fmt_;
+		video_queue_ =
+			std::make_shared<media::StreamQueue>(options_.stream_buffer_bytes);
+		audio_queue_ =
+			std::make_shared<media::StreamQueue>(options_.stream_buffer_bytes);
+		active_downloads_ = 3;
+
+		spdlog::info("Downloading and merging into: {}", output_path_);
+		stream_download(*streams_.video, video_queue_, true);
+		stream_download(*streams_.audio, audio_queue_, false);
+
+		media::Muxer::async_merge(
+			http_->get_executor(), video_queue_, audio_queue_, output_path_,
+			nullptr, [self = shared_from_this()](Result<void> res) {
+				// Unblocks downloads still parked if the merge stopped early
+				self->video_queue_->cancel();
+				self->audio_queue_->cancel();
+				self->merge_ok_ = !res.has_error();
+				self->on_download_complete();
 			});
 	}
 
+	void stream_download(const VideoFormat &format,
+						 std::shared_ptr<media::StreamQueue> queue,
+						 bool video) {
+		http_->async_download_file(
+			format.url, queue,
+			[this, video](long long now, long long total) {
+				(video ? current_video_bytes_ : current_audio_bytes_) = now;
+				if (total > 0)
+					(video ? total_video_bytes_ : total_audio_bytes_) = total;
+				report_progress("downloading and merging");
+			},
+			[self = shared_from_this(), queue, video](Result<void> res) {
+				if (res.has_error()) {
+					spdlog::error("{} download failed: {}",
+								  video ? "Video" : "Audio",
+								  res.error().message());
+					self->error_occurred_ = true;
+					// A download that failed mid-transfer already aborted the
+					// queue before closing it; this covers failures before
+					// the first byte, which never touch the sink
+					queue->cancel();
+				}
+				self->on_download_complete();
+			},
+			connections_);
+	}
+
 	void report_progress(const std::string &status) {
 		if (!progress_cb_) return;
 
@@ -194,9 +299,37 @@ class AsyncDownloaderSession
 		progress_cb_(status, prog);
 	}
 
+	void report_merge_progress(const media::MuxProgress &p) {
+		if (!progress_cb_) return;
+
+		DownloadProgress prog{};
+		prog.total_downloaded_bytes = p.bytes;
+		prog.total_size_bytes = p.total_bytes;
+		if (p.total_bytes > 0) {
+			prog.percentage = (double)p.bytes / p.total_bytes * 100.0;
+		}
+
+		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+							std::chrono::steady_clock::now() - merge_start_)
+							.count();
+		if (duration > 0) {
+			prog.speed_bytes_per_sec = (double)p.bytes * 1000.0 / duration;
+			if (prog.speed_bytes_per_sec > 0 && p.total_bytes > 0) {
+				prog.eta_seconds = (double)(p.total_bytes - p.bytes) /
+								   prog.speed_bytes_per_sec;
+			}
+		}
+
+		progress_cb_("merging", prog);
+	}
+
 	void on_download_complete() {
 		if (--active_downloads_ == 0) {
 			if (error_occurred_) {
+				if (video_queue_) {
+					std::error_code ec;
+					fs::remove(output_path_, ec);
+				}
 				return complete(outcome::failure(errc::request_failed));
 			}
 			finalize();
@@ -204,20 +337,37 @@ class AsyncDownloaderSession
 	}
 
 	void finalize() {
+		if (video_queue_) {
+			if (merge_ok_) return complete(outcome::success(output_path_));
+			spdlog::error("Merge failed");
+			std::error_code ec;
+			fs::remove(output_path_, ec);
+			return complete(outcome::failure(errc::muxer_error));
+		}
 		if (streams_.video && streams_.audio && merge_fmt_) {
 			spdlog::info("Merging video and audio...");
 			report_progress("merging");
 
-			std::string output_filename = base_filename_ + "." + *merge_fmt_;
-
-			if (media::Muxer::merge(
-					video_path_, audio_path_, output_filename)) {
-				std::filesystem::remove(video_path_);
-				std::filesystem::remove(audio_path_);
-				return complete(outcome::success(output_filename));
-			}
-			spdlog::error("Merge failed");
-			return complete(outcome::failure(errc::muxer_error));
+			// Remuxing runs on the muxing pool so the io_context keeps
+			// serving other extractions and downloads meanwhile.
+			output_path_ = base_filename_ + "." + *merge_fmt_;
+			merge_start_ = std::chrono::steady_clock::now();
+			return media::Muxer::async_merge(
+				http_->get_executor(), video_path_, audio_path_, output_path_,
+				[self = shared_from_this()](const media::MuxProgress &p) {
+					self->report_merge_progress(p);
+				},
+				[self = shared_from_this()](Result<void> res) {
+					if (res.has_error()) {
+						spdlog::error("Merge failed");
+						return self->complete(
+							outcome::failure(errc::muxer_error));
+					}
+					std::error_code ec;
+					fs::remove(self->video_path_, ec);
+					fs::remove(self->audio_path_, ec);
+					self->complete(outcome::success(self->output_path_));
+				});
 		}
 		// If not merging, just return video path for now or maybe both?
 		// The user interface assumes single file return usually.
@@ -234,19 +384,21 @@ class AsyncDownloaderSession
 };
 
 void Downloader::Impl::async_download(
-	const ytdlpp::VideoInfo &info, std::string format_selector,
+	std::shared_ptr<const VideoInfo> info, std::string format_selector,
 	std::optional<std::string> merge_format,
-	ytdlpp::ProgressCallback progress_cb,
+	ytdlpp::ProgressCallback progress_cb, int connections,
 	asio::any_completion_handler<void(Result<std::string>)> handler,
 	Downloader::CompletionExecutor handler_ex) {
-	std::make_shared<AsyncDownloaderSession>(
-		http, std::move(handler), std::move(handler_ex), std::move(progress_cb))
-		->start(info, format_selector, std::move(merge_format));
+	auto session = std::make_shared<AsyncDownloaderSession>(
+		http, std::move(handler), std::move(handler_ex), std::move(progress_cb),
+		connections, options);
+	session->start(std::move(info), format_selector, std::move(merge_format));
+	for (const auto &queue : session->stream_queues()) track_queue(queue);
 }
 
 Downloader::StreamInfo Downloader::Impl::select_streams(
 	const VideoInfo &info, std::string_view selector,
-	std::optional<std::string> preferred_lang) {
+	std::optional<std::string> preferred_lang, bool log_selection) {
 	StreamInfo result;
 
 	auto get_vcodec_score = [](const std::string &codec) -> int {
@@ -308,12 +460,13 @@ Downloader::StreamInfo Downloader::Impl::select_streams(
 		}
 		// Prefer exact language match, fallback to best overall
 		const VideoFormat *selected = preferred ? preferred : best;
-		if (selected)
+		if (selected && log_selection)
 			spdlog::info(
 				"Selected best audio: itag={}, ext={}, tbr={:.2f}, acodec={}, "
 				"channels={}, lang={}, lang_pref={}",
-				selected->itag, selected->ext, selected->tbr, selected->acodec,
-				selected->audio_channels, selected->language,
+				selected->itag, selected->ext.str(), selected->tbr,
+				selected->acodec.str(), selected->audio_channels,
+				selected->language.str(),
 				selected->language_preference);
 		result.audio = selected;
 		return result;
@@ -404,8 +557,9 @@ std::string Downloader::Impl::sanitize_filename(const std::string &name) {
 }
 
 // Downloader main methods delegation
-Downloader::Downloader(std::shared_ptr<net::HttpClient> http)
-	: m_impl(std::make_unique<Impl>(std::move(http))) {}
+Downloader::Downloader(std::shared_ptr<net::HttpClient> http,
+					   DownloaderOptions options)
+	: m_impl(std::make_unique<Impl>(std::move(http), options)) {}
 
 Downloader::~Downloader() = default;
 Downloader::Downloader(Downloader &&) noexcept = default;
@@ -416,19 +570,22 @@ asio::any_io_executor Downloader::get_executor() const {
 }
 
 void Downloader::async_download_impl(
-	const VideoInfo &info, std::string format_selector,
+	std::shared_ptr<const VideoInfo> info, std::string format_selector,
 	std::optional<std::string> merge_format, ProgressCallback progress_cb,
+	int connections,
 	asio::any_completion_handler<void(Result<std::string>)> handler,
 	CompletionExecutor handler_ex) {
-	m_impl->async_download(
-		info, std::move(format_selector), std::move(merge_format),
-		std::move(progress_cb), std::move(handler), std::move(handler_ex));
+	m_impl->async_download(std::move(info), std::move(format_selector),
+						   std::move(merge_format), std::move(progress_cb),
+						   connections, std::move(handler),
+						   std::move(handler_ex));
 }
 
 Downloader::StreamInfo Downloader::select_streams(
 	const VideoInfo &info, std::string_view selector,
-	std::optional<std::string> preferred_lang) {
-	return Impl::select_streams(info, selector, std::move(preferred_lang));
+	std::optional<std::string> preferred_lang, bool log_selection) {
+	return Impl::select_streams(
+		info, selector, std::move(preferred_lang), log_selection);
 }
 
 }  // namespace ytdlpp
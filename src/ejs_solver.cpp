@@ -2,12 +2,159 @@
 
 #include <ytdlpp/ejs_bundle.hpp>
 #include <ytdlpp/ejs_solver.hpp>
+#include <ytdlpp/trace.hpp>
 
 #include "scripting/js_engine.hpp"
+#include "youtube/player_script.hpp"
 
 namespace ytdlpp {
 
-EjsSolver::EjsSolver(scripting::JsEngine &js) : js_(&js) {}
+using youtube::PlayerScript;
+
+namespace {
+
+std::string js_string(const std::string &s) {
+	return nlohmann::json(s).dump(
+		-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// Runs the preprocessed player once and keeps the extracted solver functions
+// in globalThis._ytdlpp_solvers. This is what jsc() does on every call with a
+// "preprocessed" input (via Function('_result', code)); doing it once means
+// solves no longer recompile the player, and the compiled script can be code
+// cached per player id.
+std::string build_install_script(const std::string &preprocessed,
+								 const std::string &player_id) {
+	std::string script;
+	script.reserve(preprocessed.size() + 1024);
+	script +=
+		"(function() {\n"
+		"  var solvers = { n: null, sig: null };\n"
+		"  (function(_result) {\n";
+	script += preprocessed;
+	script +=
+		"\n  })(solvers);\n"
+		"  globalThis._ytdlpp_solvers = solvers;\n"
+		"  globalThis._loaded_player_id = " +
+		js_string(player_id) +
+		";\n"
+		"  globalThis._ytdlpp_solve = function(requests) {\n"
+		"    var responses = requests.map(function(req) {\n"
+		"      var solver = globalThis._ytdlpp_solvers[req.type];\n"
+		"      if (!solver) return { type: 'error',\n"
+		"        error: 'Failed to extract ' + req.type + ' function' };\n"
+		"      try {\n"
+		"        var data = {};\n"
+		"        req.challenges.forEach(function(c) { data[c] = solver(c); });\n"
+		"        return { type: 'result', data: data };\n"
+		"      } catch (e) { return { type: 'error', error: '' + e }; }\n"
+		"    });\n"
+		"    return JSON.stringify({ type: 'result', responses: responses });\n"
+		"  };\n"
+		"})();";
+	return script;
+}
+
+// Input for the one-time jsc() preprocessing pass
+std::string build_preprocess_call(const std::string &player_code) {
+	nlohmann::json input;
+	input["type"] = "player";
+	input["player"] = player_code;
+	input["requests"] = nlohmann::json::array();  // Empty for preprocessing
+	input["output_preprocessed"] = true;
+
+	return "JSON.stringify(jsc(" +
+		   input.dump(-1, ' ', false,
+					  nlohmann::json::error_handler_t::replace) +
+		   "))";
+}
+
+// Returns the preprocessed player from a jsc() result, empty on error
+std::string parse_preprocess_output(const std::string &raw) {
+	try {
+		auto output = nlohmann::json::parse(raw);
+		if (output["type"] == "error") {
+			spdlog::debug(
+				"EJS solver error: {}", output.value("error", "unknown"));
+			return "";
+		}
+		if (output.contains("preprocessed_player")) {
+			return output["preprocessed_player"].get<std::string>();
+		}
+		spdlog::debug("EJS solver returned no preprocessed player");
+	} catch (const std::exception &e) {
+		spdlog::debug("EJS solver JSON parse error: {}", e.what());
+	}
+	return "";
+}
+
+// Build one solve call carrying a "sig" and an "n" request. `kinds` receives
+// the request type of each entry, in the order the responses come back.
+std::string build_batch_call(const std::vector<std::string> &sigs,
+							 const std::vector<std::string> &ns,
+							 std::vector<std::string> &kinds) {
+	nlohmann::json requests = nlohmann::json::array();
+	if (!sigs.empty()) {
+		requests.push_back({{"type", "sig"}, {"challenges", sigs}});
+		kinds.emplace_back("sig");
+	}
+	if (!ns.empty()) {
+		requests.push_back({{"type", "n"}, {"challenges", ns}});
+		kinds.emplace_back("n");
+	}
+
+	return "globalThis._ytdlpp_solve(" +
+		   requests.dump(-1, ' ', false,
+						 nlohmann::json::error_handler_t::replace) +
+		   ")";
+}
+
+ChallengeResults identity_results(const std::vector<std::string> &sigs,
+								  const std::vector<std::string> &ns) {
+	ChallengeResults results;
+	results.sig.reserve(sigs.size());
+	results.n.reserve(ns.size());
+	for (const auto &s : sigs) results.sig.emplace(s, s);
+	for (const auto &n : ns) results.n.emplace(n, n);
+	return results;
+}
+
+// Overwrite the identity entries with whatever the solver returned.
+void apply_batch_output(const std::string &raw,
+						const std::vector<std::string> &kinds,
+						ChallengeResults &results) {
+	try {
+		auto output = nlohmann::json::parse(raw);
+		if (output["type"] != "result") {
+			spdlog::debug(
+				"EJS batch solve error: {}", output.value("error", "unknown"));
+			return;
+		}
+		const auto &responses = output["responses"];
+		for (size_t i = 0; i < kinds.size() && i < responses.size(); ++i) {
+			const auto &resp = responses[i];
+			if (resp.value("type", "") != "result" || !resp.contains("data")) {
+				spdlog::debug("EJS {} solve error: {}", kinds[i],
+							  resp.value("error", "unknown"));
+				continue;
+			}
+			auto &target = kinds[i] == "sig" ? results.sig : results.n;
+			for (const auto &[challenge, solved] : resp["data"].items()) {
+				if (!solved.is_string()) continue;
+				auto it = target.find(challenge);
+				if (it != target.end()) it->second = solved.get<std::string>();
+			}
+		}
+	} catch (const std::exception &e) {
+		spdlog::debug("EJS batch solve JSON error: {}", e.what());
+	}
+}
+
+}  // namespace
+
+// A snapshot-booted isolate already has the bundle evaluated
+EjsSolver::EjsSolver(scripting::JsEngine &js)
+	: js_(&js), solver_loaded_(js.booted_from_snapshot()) {}
 
 bool EjsSolver::ensure_solver_loaded() {
 	if (solver_loaded_) return true;
@@ -19,6 +166,7 @@ bool EjsSolver::ensure_solver_loaded() {
 	}
 
 	spdlog::debug("Loading EJS solver bundle ({} bytes)...", bundle.size());
+	trace::Span span("js", "ejs_bundle");
 	std::string script =
 		"if (!globalThis._ytdlpp_ejs_loaded) { " + std::string(bundle) +
 		"; globalThis._ytdlpp_ejs_loaded = true; }";
@@ -38,12 +186,10 @@ bool EjsSolver::load_player(const std::string &player_code,
 							const std::string &player_id) {
 	ready_ = false;
 
-	if (!ensure_solver_loaded()) { return false; }
-
 	// Optimized cache check
 	if (!player_id.empty()) {
 		auto check = js_->evaluate_and_get(
-			"globalThis._loaded_player_id === '" + player_id + "'");
+			"globalThis._loaded_player_id === " + js_string(player_id));
 		if (!check.has_error() && check.value() == "true") {
 			ready_ = true;
 			spdlog::debug("EJS solver used cached player {}", player_id);
@@ -51,132 +197,67 @@ bool EjsSolver::load_player(const std::string &player_code,
 		}
 	}
 
-	// Construct the input JSON for the solver
-	nlohmann::json input;
-	input["type"] = "player";
-	input["player"] = player_code;
-	input["requests"] = nlohmann::json::array();  // Empty for preprocessing
-	input["output_preprocessed"] = true;
-
-	// Call the jsc function with the input
-	std::string call_code =
-		"JSON.stringify(jsc(" +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		"))";
-	auto result = js_->evaluate_and_get(call_code);
-	if (result.has_error()) {
-		spdlog::debug(
-			"EJS solver preprocessing failed: {}", result.error().message());
-		return false;
+	std::string preprocessed;
+	if (!player_id.empty()) {
+		preprocessed =
+			PlayerScript::get_cached_preprocessed(player_id).value_or("");
 	}
 
-	try {
-		auto output = nlohmann::json::parse(result.value());
-		if (output["type"] == "error") {
-			spdlog::debug(
-				"EJS solver error: {}", output.value("error", "unknown"));
+	if (preprocessed.empty()) {
+		if (player_code.empty() || !ensure_solver_loaded()) { return false; }
+
+		trace::Span span("js", "ejs_preprocess", player_id);
+		auto result = js_->evaluate_and_get(build_preprocess_call(player_code));
+		if (result.has_error()) {
+			spdlog::debug("EJS solver preprocessing failed: {}",
+						  result.error().message());
 			return false;
 		}
-
-		// Store preprocessed player for future use
-		if (output.contains("preprocessed_player")) {
-			// Re-evaluate with the preprocessed player stored
-			std::string prep_code =
-				"globalThis._preprocessed_player = " +
-				nlohmann::json(output["preprocessed_player"]).dump() + ";";
-			if (!player_id.empty()) {
-				prep_code +=
-					"globalThis._loaded_player_id = '" + player_id + "';";
-			}
-			(void)js_->evaluate(prep_code);
+		preprocessed = parse_preprocess_output(result.value());
+		if (preprocessed.empty()) return false;
+		if (!player_id.empty()) {
+			PlayerScript::cache_preprocessed(player_id, preprocessed);
 		}
+	}
 
-		ready_ = true;
-		spdlog::debug("EJS solver ready");
-		return true;
-
-	} catch (const std::exception &e) {
-		spdlog::debug("EJS solver JSON parse error: {}", e.what());
+	trace::Span compile_span("js", "ejs_compile", player_id);
+	auto installed =
+		js_->evaluate(build_install_script(preprocessed, player_id));
+	compile_span.end();
+	if (installed.has_error()) {
+		spdlog::debug("EJS solver install failed: {}",
+					  installed.error().message());
 		return false;
 	}
+
+	ready_ = true;
+	spdlog::debug("EJS solver ready");
+	return true;
 }
 
 std::string EjsSolver::solve_sig(const std::string &encrypted_sig) const {
-	if (!ready_) return encrypted_sig;
-
-	nlohmann::json input;
-	input["type"] = "preprocessed";
-	input["preprocessed_player"] = "_preprocessed_player";	// Will be resolved
-	input["requests"] = {{{"type", "sig"}, {"challenges", {encrypted_sig}}}};
-
-	// Build the actual call using the stored preprocessed player
-	std::string call_code =
-		"(function() {"
-		"  var input = " +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		";"
-		"  input.preprocessed_player = globalThis._preprocessed_player;"
-		"  return JSON.stringify(jsc(input));"
-		"})()";
-
-	auto result = js_->evaluate_and_get(call_code);
-	if (result.has_error()) {
-		spdlog::debug("EJS sig solve failed: {}", result.error().message());
-		return encrypted_sig;
-	}
-
-	try {
-		auto output = nlohmann::json::parse(result.value());
-		if (output["type"] == "result" && !output["responses"].empty()) {
-			auto &resp = output["responses"][0];
-			if (resp["type"] == "result" &&
-				resp["data"].contains(encrypted_sig)) {
-				return resp["data"][encrypted_sig].get<std::string>();
-			}
-		}
-	} catch (const std::exception &e) {
-		spdlog::debug("EJS sig solve JSON error: {}", e.what());
-	}
-
-	return encrypted_sig;
+	return solve_batch({encrypted_sig}, {}).sig[encrypted_sig];
 }
 
 std::string EjsSolver::solve_n(const std::string &n_param) const {
-	if (!ready_) return n_param;
+	return solve_batch({}, {n_param}).n[n_param];
+}
 
-	nlohmann::json input;
-	input["type"] = "preprocessed";
-	input["preprocessed_player"] = "_preprocessed_player";	// Will be resolved
-	input["requests"] = {{{"type", "n"}, {"challenges", {n_param}}}};
-
-	std::string call_code =
-		"(function() {"
-		"  var input = " +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		";"
-		"  input.preprocessed_player = globalThis._preprocessed_player;"
-		"  return JSON.stringify(jsc(input));"
-		"})()";
-
-	auto result = js_->evaluate_and_get(call_code);
-	if (result.has_error()) {
-		spdlog::debug("EJS n solve failed: {}", result.error().message());
-		return n_param;
-	}
+ChallengeResults EjsSolver::solve_batch(
+	const std::vector<std::string> &sigs,
+	const std::vector<std::string> &ns) const {
+	ChallengeResults results = identity_results(sigs, ns);
+	if (!ready_ || (sigs.empty() && ns.empty())) return results;
 
-	try {
-		auto output = nlohmann::json::parse(result.value());
-		if (output["type"] == "result" && !output["responses"].empty()) {
-			auto &resp = output["responses"][0];
-			if (resp["type"] == "result" && resp["data"].contains(n_param)) {
-				return resp["data"][n_param].get<std::string>();
-			}
-		}
-	} catch (const std::exception &e) {
-		spdlog::debug("EJS n solve JSON error: {}", e.what());
+	trace::Span span("js", "ejs_solve");
+	std::vector<std::string> kinds;
+	auto result = js_->evaluate_and_get(build_batch_call(sigs, ns, kinds));
+	if (result.has_error()) {
+		spdlog::debug("EJS batch solve failed: {}", result.error().message());
+		return results;
 	}
-
-	return n_param;
+	apply_batch_output(result.value(), kinds, results);
+	return results;
 }
 
 void EjsSolver::ensure_solver_loaded_async_impl(
@@ -197,7 +278,10 @@ void EjsSolver::ensure_solver_loaded_async_impl(
 	js_->async_evaluate(
 		"if (!globalThis._ytdlpp_ejs_loaded) { " + std::string(bundle) +
 			"; globalThis._ytdlpp_ejs_loaded = true; }",
-		[this, handler = std::move(handler)](Result<void> res) mutable {
+		[this, handler = std::move(handler),
+		 span = trace::Span::async("js", "ejs_bundle")](
+			Result<void> res) mutable {
+			span.end();
 			if (res.has_error()) {
 				spdlog::debug(
 					"Failed to load EJS solver: {}", res.error().message());
@@ -214,40 +298,52 @@ void EjsSolver::async_load_player_impl(
 	std::string player_code,
 	boost::asio::any_completion_handler<void(bool)> handler,
 	std::string player_id) {
-	ensure_solver_loaded_async_impl(
-		[this, player_code = std::move(player_code),
-		 handler = std::move(handler), player_id](bool success) mutable {
-			if (!success) {
-				handler(false);
+	ready_ = false;
+
+	if (player_id.empty()) {
+		async_load_player_impl_continue(
+			std::move(player_code), std::move(handler), "");
+		return;
+	}
+
+	// Optimized cache check logic (Async)
+	js_->async_evaluate_and_get(
+		"globalThis._loaded_player_id === " + js_string(player_id),
+		[this, player_id, player_code = std::move(player_code),
+		 handler = std::move(handler)](Result<std::string> res) mutable {
+			if (!res.has_error() && res.value() == "true") {
+				ready_ = true;
+				spdlog::debug("EJS solver used cached player {}", player_id);
+				handler(true);
 				return;
 			}
 
-			ready_ = false;
-
-			// Optimized cache check logic (Async)
-			if (!player_id.empty()) {
-				js_->async_evaluate_and_get(
-					"globalThis._loaded_player_id === '" + player_id + "'",
-					[this, player_id, player_code = std::move(player_code),
-					 handler =
-						 std::move(handler)](Result<std::string> res) mutable {
-						if (!res.has_error() && res.value() == "true") {
-							ready_ = true;
-							spdlog::debug(
-								"EJS solver used cached player {}", player_id);
-							handler(true);
-							return;
-						}
-						// Cache miss - proceed to load
-						async_load_player_impl_continue(
-							std::move(player_code), std::move(handler),
-							std::move(player_id));
-					});
+			// Known player: install the stored preprocessed code with its
+			// code cache and skip jsc() preprocessing entirely
+			auto preprocessed =
+				PlayerScript::get_cached_preprocessed(player_id);
+			if (!preprocessed) {
+				async_load_player_impl_continue(std::move(player_code),
+												std::move(handler),
+												std::move(player_id));
 				return;
 			}
 
-			async_load_player_impl_continue(
-				std::move(player_code), std::move(handler), "");
+			spdlog::debug("EJS solver using preprocessed player {}",
+						  player_id);
+			async_install_solvers_impl(
+				std::move(*preprocessed), player_id,
+				[this, player_id, player_code = std::move(player_code),
+				 handler = std::move(handler)](bool ok) mutable {
+					if (ok) {
+						handler(true);
+						return;
+					}
+					// Stale or broken cache entry; preprocess from source
+					async_load_player_impl_continue(std::move(player_code),
+													std::move(handler),
+													std::move(player_id));
+				});
 		});
 }
 
@@ -255,156 +351,148 @@ void EjsSolver::async_load_player_impl_continue(
 	std::string player_code,
 	boost::asio::any_completion_handler<void(bool)> handler,
 	std::string player_id) {
-	nlohmann::json input;
-	input["type"] = "player";
-	input["player"] = player_code;
-	input["requests"] = nlohmann::json::array();
-	input["output_preprocessed"] = true;
-
-	std::string call_code =
-		"JSON.stringify(jsc(" +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		"))";
+	if (player_code.empty()) {
+		spdlog::debug("EJS solver has no player code to preprocess");
+		handler(false);
+		return;
+	}
 
-	js_->async_evaluate_and_get(
-		call_code, [this, handler = std::move(handler),
-					player_id](Result<std::string> res) mutable {
-			if (res.has_error()) {
-				spdlog::debug("EJS solver preprocessing failed: {}",
-							  res.error().message());
+	ensure_solver_loaded_async_impl(
+		[this, player_code = std::move(player_code),
+		 handler = std::move(handler),
+		 player_id = std::move(player_id)](bool success) mutable {
+			if (!success) {
 				handler(false);
 				return;
 			}
 
-			try {
-				auto output = nlohmann::json::parse(res.value());
-				if (output["type"] == "error") {
-					spdlog::debug("EJS solver error: {}",
-								  output.value("error", "unknown"));
-					handler(false);
-					return;
-				}
-
-				if (output.contains("preprocessed_player")) {
-					std::string prep_code =
-						"globalThis._preprocessed_player = " +
-						nlohmann::json(output["preprocessed_player"]).dump() +
-						";";
+			js_->async_evaluate_and_get(
+				build_preprocess_call(player_code),
+				[this, handler = std::move(handler), player_id,
+				 span = trace::Span::async("js", "ejs_preprocess", player_id)](
+					Result<std::string> res) mutable {
+					span.end();
+					if (res.has_error()) {
+						spdlog::debug("EJS solver preprocessing failed: {}",
+									  res.error().message());
+						handler(false);
+						return;
+					}
+
+					std::string preprocessed =
+						parse_preprocess_output(res.value());
+					if (preprocessed.empty()) {
+						handler(false);
+						return;
+					}
 					if (!player_id.empty()) {
-						prep_code += "globalThis._loaded_player_id = '" +
-									 player_id + "';";
+						PlayerScript::cache_preprocessed(
+							player_id, preprocessed);
 					}
-					js_->async_evaluate(
-						prep_code, [this, handler = std::move(handler)](
-									   Result<void> res2) mutable {
-							if (res2.has_error()) {
-								handler(false);
-							} else {
-								ready_ = true;
-								spdlog::debug("EJS solver ready");
-								handler(true);
-							}
-						});
-				} else {
-					ready_ = true;
-					handler(true);
-				}
-			} catch (...) {
-				spdlog::debug("EJS solver JSON parse error during async");
-				handler(false);
-			}
+					async_install_solvers_impl(std::move(preprocessed),
+											   player_id, std::move(handler));
+				});
 		});
 }
 
-void EjsSolver::async_solve_sig_impl(
-	std::string sig,
-	boost::asio::any_completion_handler<void(std::string)> handler) {
-	if (!ready_) {
-		handler(sig);
-		return;
+void EjsSolver::async_install_solvers_impl(
+	std::string preprocessed, std::string player_id,
+	boost::asio::any_completion_handler<void(bool)> handler) {
+	SharedBytes code_cache;
+	if (!player_id.empty()) {
+		code_cache =
+			PlayerScript::get_cached_bytecode(player_id).value_or(SharedBytes{});
 	}
 
-	nlohmann::json input;
-	input["type"] = "preprocessed";
-	input["preprocessed_player"] = "_preprocessed_player";
-	input["requests"] = {{{"type", "sig"}, {"challenges", {sig}}}};
-
-	std::string call_code =
-		"(function() {"
-		"  var input = " +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		";"
-		"  input.preprocessed_player = globalThis._preprocessed_player;"
-		"  return JSON.stringify(jsc(input));"
-		"})()";
-
-	js_->async_evaluate_and_get(
-		call_code, [this, sig, handler = std::move(handler)](
-					   Result<std::string> res) mutable {
+	js_->async_evaluate_cached(
+		build_install_script(preprocessed, player_id), std::move(code_cache),
+		[this, player_id, handler = std::move(handler),
+		 span = trace::Span::async("js", "ejs_compile", player_id)](
+			Result<scripting::CodeCacheResult> res) mutable {
+			if (span.active() && res.has_value()) {
+				span.set_detail(player_id + (res.value().consumed
+												 ? " (code cache)"
+												 : " (from source)"));
+			}
+			span.end();
 			if (res.has_error()) {
 				spdlog::debug(
-					"EJS sig solve failed: {}", res.error().message());
-				handler(sig);
+					"EJS solver install failed: {}", res.error().message());
+				handler(false);
 				return;
 			}
-			try {
-				auto output = nlohmann::json::parse(res.value());
-				if (output["type"] == "result" &&
-					!output["responses"].empty()) {
-					auto &resp = output["responses"][0];
-					if (resp["type"] == "result" &&
-						resp["data"].contains(sig)) {
-						handler(resp["data"][sig].get<std::string>());
-						return;
-					}
-				}
-			} catch (...) {}
-			handler(sig);
+
+			auto &cache = res.value();
+			if (cache.consumed) {
+				spdlog::debug("EJS solver used code cache for {}", player_id);
+			} else if (cache.rejected) {
+				spdlog::debug(
+					"Code cache for {} rejected, recompiled from source",
+					player_id);
+			}
+			if (!player_id.empty() && !cache.produced.empty()) {
+				PlayerScript::cache_bytecode(player_id, cache.produced);
+			}
+
+			ready_ = true;
+			spdlog::debug("EJS solver ready");
+			handler(true);
+		});
+}
+
+void EjsSolver::async_solve_sig_impl(
+	std::string sig,
+	boost::asio::any_completion_handler<void(std::string)> handler) {
+	async_solve_batch_impl(
+		{sig}, {},
+		[sig, handler = std::move(handler)](ChallengeResults res) mutable {
+			handler(std::move(res.sig[sig]));
 		});
 }
 
 void EjsSolver::async_solve_n_impl(
 	std::string n,
 	boost::asio::any_completion_handler<void(std::string)> handler) {
-	if (!ready_) {
-		handler(n);
+	async_solve_batch_impl(
+		{}, {n},
+		[n, handler = std::move(handler)](ChallengeResults res) mutable {
+			handler(std::move(res.n[n]));
+		});
+}
+
+void EjsSolver::async_solve_batch_impl(
+	std::vector<std::string> sigs, std::vector<std::string> ns,
+	boost::asio::any_completion_handler<void(ChallengeResults)> handler) {
+	ChallengeResults results = identity_results(sigs, ns);
+	if (!ready_ || (sigs.empty() && ns.empty())) {
+		handler(std::move(results));
 		return;
 	}
 
-	nlohmann::json input;
-	input["type"] = "preprocessed";
-	input["preprocessed_player"] = "_preprocessed_player";
-	input["requests"] = {{{"type", "n"}, {"challenges", {n}}}};
-
-	std::string call_code =
-		"(function() {"
-		"  var input = " +
-		input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) +
-		";"
-		"  input.preprocessed_player = globalThis._preprocessed_player;"
-		"  return JSON.stringify(jsc(input));"
-		"})()";
+	std::vector<std::string> kinds;
+	std::string call_code = build_batch_call(sigs, ns, kinds);
+	spdlog::debug(
+		"EJS batch solve: {} sig, {} n challenges", sigs.size(), ns.size());
 
+	trace::Span span;
+	if (trace::enabled()) {
+		span = trace::Span::async(
+			"js", "ejs_solve",
+			fmt::format("{} sig, {} n", sigs.size(), ns.size()));
+	}
 	js_->async_evaluate_and_get(
-		call_code, [this, n, handler = std::move(handler)](
-					   Result<std::string> res) mutable {
+		call_code,
+		[kinds = std::move(kinds), results = std::move(results),
+		 handler = std::move(handler),
+		 span = std::move(span)](Result<std::string> res) mutable {
+			span.end();
 			if (res.has_error()) {
-				spdlog::debug("EJS n solve failed: {}", res.error().message());
-				handler(n);
-				return;
+				spdlog::debug(
+					"EJS batch solve failed: {}", res.error().message());
+			} else {
+				apply_batch_output(res.value(), kinds, results);
 			}
-			try {
-				auto output = nlohmann::json::parse(res.value());
-				if (output["type"] == "result" &&
-					!output["responses"].empty()) {
-					auto &resp = output["responses"][0];
-					if (resp["type"] == "result" && resp["data"].contains(n)) {
-						handler(resp["data"][n].get<std::string>());
-						return;
-					}
-				}
-			} catch (...) {}
-			handler(n);
+			handler(std::move(results));
 		});
 }
 
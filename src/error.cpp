@@ -21,6 +21,7 @@ struct ytdlpp_error_category : std::error_category {
 			case errc::file_open_failed: return "File open failed";
 			case errc::file_write_failed: return "File write failed";
 			case errc::invalid_number_format: return "Invalid number format";
+			case errc::stream_open_failed: return "Audio stream open failed";
 			default: return "Unknown error";
 		}
 	}
@@ -0,0 +1,46 @@
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <ytdlpp/interned_string.hpp>
+
+namespace ytdlpp {
+
+namespace {
+
+class StringPool {
+   public:
+	const std::string *empty() const { return &empty_; }
+
+	const std::string *intern(std::string_view s) {
+		if (s.empty()) return &empty_;
+
+		std::lock_guard lock(mutex_);
+		if (auto it = index_.find(s); it != index_.end()) return it->second;
+		// deque::push_back keeps existing elements (and the views into
+		// them used as keys) in place
+		const auto &stored = storage_.emplace_back(s);
+		index_.emplace(stored, &stored);
+		return &stored;
+	}
+
+   private:
+	const std::string empty_;
+	std::mutex mutex_;
+	std::deque<std::string> storage_;
+	std::unordered_map<std::string_view, const std::string *> index_;
+};
+
+StringPool &pool() {
+	// Leaked so handles stay valid during static destruction
+	static auto *p = new StringPool();
+	return *p;
+}
+
+}  // namespace
+
+InternedString::InternedString() : str_(pool().empty()) {}
+
+InternedString::InternedString(std::string_view s)
+	: str_(pool().intern(s)) {}
+
+}  // namespace ytdlpp
@@ -9,9 +9,17 @@
 #include <boost/asio/spawn.hpp>
 #include <boost/coroutine/attributes.hpp>
 #include <boost/program_options.hpp>
+#include <boost/scope_exit.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 // Windows headers for console
 #ifdef _WIN32
@@ -27,9 +35,13 @@
 #include <ytdlpp/extractor.hpp>
 #include <ytdlpp/http_client.hpp>
 #include <ytdlpp/output_template.hpp>
+#include <ytdlpp/trace.hpp>
 #include <ytdlpp/types.hpp>
 
+#include "async_semaphore.hpp"
 #include "media/muxer.hpp"
+#include "server/extract_server.hpp"
+#include "server/metrics.hpp"
 
 namespace po = boost::program_options;
 namespace asio = boost::asio;
@@ -72,7 +84,7 @@ void print_formats_table(std::vector<ytdlpp::VideoFormat> formats) {
 	for (const auto &f : formats) {
 		Row r;
 		r.id = std::to_string(f.itag);
-		r.ext = f.ext.empty() ? "unk" : f.ext;
+		r.ext = f.ext.empty() ? "unk" : f.ext.str();
 		r.res = (f.vcodec != "none" && f.width > 0)
 					? fmt::format("{}x{}", f.width, f.height)
 					: "audio only";
@@ -87,20 +99,20 @@ void print_formats_table(std::vector<ytdlpp::VideoFormat> formats) {
 		}
 
 		r.tbr = (f.tbr > 0) ? fmt::format("{:.0f}k", f.tbr / KBPS_SCALE) : "";
-		r.proto = f.protocol.empty() ? "https" : f.protocol;
+		r.proto = ytdlpp::to_string(f.protocol);
 		r.vcodec = f.vcodec.empty()		? "none"
 				   : f.vcodec == "none" ? "video only"
-										: f.vcodec.substr(0, 12);
+										: f.vcodec.str().substr(0, 12);
 		r.acodec = f.acodec.empty()		? "none"
 				   : f.acodec == "none" ? "audio only"
-										: f.acodec.substr(0, 8);
+										: f.acodec.str().substr(0, 8);
 		r.abr = (f.acodec != "none" && f.tbr > 0)
 					? fmt::format("{:.0f}k", f.tbr / KBPS_SCALE)
 					: "";
 		r.asr = (f.audio_sample_rate > 0)
 					? fmt::format("{}Hz", f.audio_sample_rate)
 					: "";
-		r.info = f.format_note.empty() ? "" : f.format_note;
+		r.info = f.format_note.str();
 		r.is_grey = (f.vcodec == "none" || f.acodec == "none");
 		rows.push_back(r);
 	}
@@ -149,6 +161,34 @@ void log_youtube(std::string_view msg) {
 
 void log_info(std::string_view msg) { fmt::println(stderr, "[info] {}", msg); }
 
+// Rate like yt-dlp's --limit-rate: bytes per second with an optional K, M
+// or G suffix (powers of 1024), e.g. "50K" or "4.2M"
+std::optional<uint64_t> parse_rate(const std::string &text) {
+	char *end = nullptr;
+	double value = std::strtod(text.c_str(), &end);
+	if (end == text.c_str() || !std::isfinite(value) || value < 0) {
+		return std::nullopt;
+	}
+	std::string_view unit(end);
+	if (!unit.empty() && (unit.back() == 'B' || unit.back() == 'b')) {
+		unit.remove_suffix(1);
+	}
+	if (unit.size() > 1) return std::nullopt;
+	if (!unit.empty()) {
+		switch (unit[0]) {
+			case 'g': case 'G': value *= 1024; [[fallthrough]];
+			case 'm': case 'M': value *= 1024; [[fallthrough]];
+			case 'k': case 'K': value *= 1024; break;
+			default: return std::nullopt;
+		}
+	}
+	// The cast is undefined past the range; max() rounds up to 2^64
+	if (value >= static_cast<double>(std::numeric_limits<uint64_t>::max())) {
+		return std::nullopt;
+	}
+	return static_cast<uint64_t>(value);
+}
+
 // =============================================================================
 // CLI Application using Coroutines
 // =============================================================================
@@ -172,7 +212,8 @@ struct CliOptions {
 	// New: display options
 	bool quiet = false;
 	bool simulate = false;
-	std::string print_template;	 // -O print template
+	std::string print_template;		 // -O print template
+	ytdlpp::OutputTemplate print;	 // print_template, compiled once
 
 	// Existing options
 	bool list_formats = false;
@@ -181,13 +222,61 @@ struct CliOptions {
 	bool stream_audio = false;
 	bool verbose = false;
 	bool flat_playlist = false;
+
+	// Network
+	int concurrent_fragments = 1;  // -N, parallel connections per stream
+	int js_isolates = 1;		   // V8 isolates for challenge solving
+	bool stream_merge = false;	   // Mux while downloading, no temp files
+	bool early_completion = false;	// Stop waiting once -f is satisfiable
+	int client_timeout_ms = 0;		// Player API hedge deadline, 0 = off
+	int info_cache_entries = 0;		// Extraction results kept, 0 = off
+	std::string info_cache_dir;		// Also keep them on disk here
+	ytdlpp::net::BandwidthLimits bandwidth;	 // -r, --limit-total-rate
+
+	// Offline timing: record HTTP traffic, or replay it instead of the network
+	ytdlpp::net::HttpReplayOptions replay;
+
+	// Batch mode: one URL per line from a file ("-" for stdin)
+	std::string batch_file;
+	int concurrent_extractions = 4;
+	int concurrent_downloads = 2;
+
+	// Daemon mode: serve extraction on localhost instead of one job
+	std::optional<int> serve_port;
 };
 
+ytdlpp::youtube::ExtractorOptions extractor_options(const CliOptions &opts) {
+	ytdlpp::youtube::ExtractorOptions options;
+	options.js_isolates = static_cast<size_t>(opts.js_isolates);
+	if (opts.early_completion) options.complete_when_selectable = opts.format;
+	options.client_timeout = std::chrono::milliseconds(opts.client_timeout_ms);
+	options.info_cache_entries = static_cast<size_t>(opts.info_cache_entries);
+	options.info_cache_dir = opts.info_cache_dir;
+	return options;
+}
+
+ytdlpp::DownloaderOptions downloader_options(const CliOptions &opts) {
+	ytdlpp::DownloaderOptions options;
+	options.stream_merge = opts.stream_merge;
+	return options;
+}
+
+std::shared_ptr<ytdlpp::net::HttpClient> make_http_client(
+	asio::io_context &ioc, const CliOptions &opts) {
+	auto http = std::make_shared<ytdlpp::net::HttpClient>(ioc.get_executor());
+	if (opts.replay.mode != ytdlpp::net::HttpReplayOptions::Mode::off) {
+		http->set_replay(opts.replay);
+	}
+	http->set_bandwidth_limits(opts.bandwidth);
+	return http;
+}
+
 // Main application logic using yield_context for clean async
 void run_app(asio::io_context &ioc,
 			 const std::shared_ptr<ytdlpp::net::HttpClient> &http,
 			 const CliOptions &opts, asio::yield_context yield) {
-	ytdlpp::youtube::Extractor extractor(http, ioc.get_executor());
+	ytdlpp::youtube::Extractor extractor(
+		http, ioc.get_executor(), extractor_options(opts));
 
 	// Check if this is a search URL
 	auto search_opts = ytdlpp::youtube::parse_search_url(opts.url);
@@ -297,7 +386,7 @@ void run_app(asio::io_context &ioc,
 			if (opts.simulate) { continue; }
 
 			// Otherwise download
-			ytdlpp::Downloader downloader(http);
+			ytdlpp::Downloader downloader(http, downloader_options(opts));
 			auto download_result = downloader.async_download(
 				info, opts.format, opts.merge_format,
 				[&opts](const std::string &status,
@@ -307,7 +396,7 @@ void run_app(asio::io_context &ioc,
 								  << "%   " << std::flush;
 					}
 				},
-				yield);
+				yield, opts.concurrent_fragments);
 
 			if (download_result.has_error()) {
 				fmt::println(stderr, "\nERROR: Download failed: {}",
@@ -359,8 +448,9 @@ void run_app(asio::io_context &ioc,
 		audio_opts.sample_rate = 48000;
 		audio_opts.channels = 2;
 		audio_opts.sample_fmt = ytdlpp::media::SampleFormat::S16;
+		audio_opts.http_connections = opts.concurrent_fragments;
 
-		ytdlpp::media::AudioStreamer streamer(ioc.get_executor());
+		ytdlpp::media::AudioStreamer streamer(ioc.get_executor(), http);
 		auto stream = streamer.async_open(best->url, audio_opts, yield);
 		if (stream.has_error()) {
 			spdlog::error(
@@ -375,6 +465,9 @@ void run_app(asio::io_context &ioc,
 			const auto &audio_data = read_result.value();
 			std::fwrite(audio_data.data(), 1, audio_data.size(), stdout);
 		}
+		if (auto ec = audio_stream.error()) {
+			spdlog::error("Audio stream ended early: {}", ec.message());
+		}
 		return;
 	}
 
@@ -394,8 +487,7 @@ void run_app(asio::io_context &ioc,
 
 	// Handle -O, --print (template printing)
 	if (!opts.print_template.empty()) {
-		auto output = ytdlpp::expand_output_template(opts.print_template, info);
-		std::cout << output << "\n";
+		std::cout << opts.print.render(info) << "\n";
 		return;
 	}
 
@@ -443,7 +535,7 @@ void run_app(asio::io_context &ioc,
 	if (opts.simulate) { return; }
 
 	// Download mode
-	ytdlpp::Downloader downloader(http);
+	ytdlpp::Downloader downloader(http, downloader_options(opts));
 	auto download_result = downloader.async_download(
 		info, opts.format, opts.merge_format,
 		[&opts](
@@ -453,7 +545,7 @@ void run_app(asio::io_context &ioc,
 						  << std::flush;
 			}
 		},
-		yield);
+		yield, opts.concurrent_fragments);
 
 	if (download_result.has_error()) {
 		fmt::println(stderr, "\nERROR: Download failed: {}",
@@ -465,6 +557,255 @@ void run_app(asio::io_context &ioc,
 	}
 }
 
+// =============================================================================
+// Batch Mode
+// =============================================================================
+// Every URL runs through one Extractor and one Downloader, so V8 isolates, the
+// solver bundle, cached players and pooled TLS connections are paid for once.
+// Items run concurrently, bounded separately for extraction and download.
+
+std::vector<std::string> read_batch_urls(const std::string &path) {
+	std::ifstream file;
+	if (path != "-") {
+		file.open(path);
+		if (!file) {
+			fmt::println(stderr, "ERROR: Cannot open batch file: {}", path);
+			return {};
+		}
+	}
+	std::istream &in = path == "-" ? std::cin : file;
+
+	// Like yt-dlp's --batch-file: blank lines and #, ; or ] comments skipped
+	std::vector<std::string> urls;
+	std::string line;
+	while (std::getline(in, line)) {
+		auto first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos) continue;
+		auto last = line.find_last_not_of(" \t\r");
+		line = line.substr(first, last - first + 1);
+		if (line[0] == '#' || line[0] == ';' || line[0] == ']') continue;
+		urls.push_back(std::move(line));
+	}
+	return urls;
+}
+
+struct BatchItemStats {
+	bool ok = false;
+	long long extract_ms = 0;
+	long long download_ms = 0;
+	long long total_ms = 0;	 // Including time queued for a slot
+};
+
+long long elapsed_ms(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			   std::chrono::steady_clock::now() - since)
+		.count();
+}
+
+BatchItemStats run_batch_item(ytdlpp::youtube::Extractor &extractor,
+							  ytdlpp::Downloader &downloader,
+							  ytdlpp::AsyncSemaphore &extract_slots,
+							  ytdlpp::AsyncSemaphore &download_slots,
+							  const CliOptions &opts, const std::string &url,
+							  const std::string &label,
+							  asio::yield_context yield) {
+	using Clock = std::chrono::steady_clock;
+	BatchItemStats stats;
+	auto start = Clock::now();
+
+	if (ytdlpp::youtube::parse_search_url(url)) {
+		fmt::println(stderr, "ERROR: {} Search URLs aren't supported in batch "
+					 "mode: {}", label, url);
+		return stats;
+	}
+
+	ytdlpp::Result<ytdlpp::VideoInfo> info_result =
+		ytdlpp::outcome::failure(ytdlpp::errc::unknown);
+	{
+		extract_slots.async_acquire(yield);
+		BOOST_SCOPE_EXIT_ALL(&) { extract_slots.release(); };
+		if (g_cancelled.load()) return stats;
+
+		auto extract_start = Clock::now();
+		if (!opts.quiet) log_youtube(fmt::format("Extracting URL: {}", url));
+		info_result = extractor.async_process(url, yield);
+		stats.extract_ms = elapsed_ms(extract_start);
+	}
+
+	if (info_result.has_error()) {
+		fmt::println(stderr, "ERROR: {} Failed to extract {}: {}", label, url,
+					 info_result.error().message());
+		stats.total_ms = elapsed_ms(start);
+		return stats;
+	}
+	const auto &info = info_result.value();
+
+	if (opts.dump_json) {
+		// One object per line so the output stays parseable when items
+		// finish out of order
+		nlohmann::json j;
+		ytdlpp::youtube::to_json(j, info);
+		std::cout << j.dump() << "\n";
+	} else if (!opts.print_template.empty()) {
+		std::cout << opts.print.render(info) << "\n";
+	} else if (opts.get_url) {
+		auto streams = ytdlpp::Downloader::select_streams(
+			info, opts.format, opts.audio_lang);
+		if (streams.video) { std::cout << streams.video->url << "\n"; }
+		if (streams.audio && streams.audio != streams.video) {
+			std::cout << streams.audio->url << "\n";
+		}
+	} else if (!opts.simulate) {
+		download_slots.async_acquire(yield);
+		BOOST_SCOPE_EXIT_ALL(&) { download_slots.release(); };
+		if (g_cancelled.load()) return stats;
+
+		auto download_start = Clock::now();
+		// Interleaved \r progress from several items is unreadable, so
+		// batch mode only reports completions
+		auto download_result = downloader.async_download(
+			info, opts.format, opts.merge_format, nullptr, yield,
+			opts.concurrent_fragments);
+		stats.download_ms = elapsed_ms(download_start);
+
+		if (download_result.has_error()) {
+			fmt::println(stderr, "ERROR: {} Download failed for {}: {}", label,
+						 info.id, download_result.error().message());
+			stats.total_ms = elapsed_ms(start);
+			return stats;
+		}
+		if (!opts.quiet) {
+			log_download(fmt::format(
+				"{} Destination: {}", label, download_result.value()));
+		}
+	}
+
+	stats.ok = true;
+	stats.total_ms = elapsed_ms(start);
+	if (!opts.quiet) {
+		fmt::println(stderr,
+					 "[batch] {} {}: extract {} ms, download {} ms, total {} ms",
+					 label, info.id, stats.extract_ms, stats.download_ms,
+					 stats.total_ms);
+	}
+	return stats;
+}
+
+void run_batch(asio::io_context &ioc,
+			   const std::shared_ptr<ytdlpp::net::HttpClient> &http,
+			   const CliOptions &opts, asio::yield_context yield) {
+	auto urls = read_batch_urls(opts.batch_file);
+	if (urls.empty()) {
+		fmt::println(stderr, "ERROR: No URLs in batch file: {}",
+					 opts.batch_file);
+		return;
+	}
+
+	ytdlpp::youtube::Extractor extractor(
+		http, ioc.get_executor(), extractor_options(opts));
+	ytdlpp::Downloader downloader(http, downloader_options(opts));
+
+	ytdlpp::AsyncSemaphore extract_slots(
+		ioc.get_executor(), static_cast<size_t>(opts.concurrent_extractions));
+	ytdlpp::AsyncSemaphore download_slots(
+		ioc.get_executor(), static_cast<size_t>(opts.concurrent_downloads));
+
+	if (!opts.quiet) {
+		log_info(fmt::format(
+			"Batch of {} URLs ({} extractions, {} downloads at a time)",
+			urls.size(), opts.concurrent_extractions,
+			opts.concurrent_downloads));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<BatchItemStats> stats(urls.size());
+	size_t remaining = urls.size();
+	asio::steady_timer all_done(ioc, asio::steady_timer::time_point::max());
+
+	// Items queue on the semaphores in file order
+	for (size_t i = 0; i < urls.size(); ++i) {
+		boost::asio::spawn(
+			ioc,
+			[&, i](asio::yield_context item_yield) {
+				auto label = fmt::format("[{}/{}]", i + 1, urls.size());
+				stats[i] = run_batch_item(extractor, downloader, extract_slots,
+										  download_slots, opts, urls[i], label,
+										  std::move(item_yield));
+				if (--remaining == 0) all_done.cancel();
+			},
+			boost::coroutines::attributes());
+	}
+
+	// spawn() may run an item inline up to its first wait
+	if (remaining > 0) {
+		boost::system::error_code ec;
+		all_done.async_wait(yield[ec]);
+	}
+
+	std::vector<long long> totals;
+	for (const auto &s : stats) {
+		if (s.ok) totals.push_back(s.total_ms);
+	}
+	std::sort(totals.begin(), totals.end());
+	auto wall_ms = elapsed_ms(start);
+	if (totals.empty()) {
+		fmt::println(stderr, "[batch] 0 of {} succeeded in {} ms", urls.size(),
+					 wall_ms);
+		return;
+	}
+	fmt::println(stderr,
+				 "[batch] {} of {} succeeded in {} ms; per item: median {} ms, "
+				 "max {} ms",
+				 totals.size(), urls.size(), wall_ms,
+				 totals[totals.size() / 2], totals.back());
+}
+
+// =============================================================================
+// Server Mode
+// =============================================================================
+// Keeps one warm Extractor (V8 isolates, player caches, pooled connections)
+// behind a localhost HTTP endpoint; SIGINT/SIGTERM drain it.
+
+int run_server(const CliOptions &opts) {
+	asio::io_context ioc;
+	auto http = make_http_client(ioc, opts);
+
+	ytdlpp::youtube::Extractor extractor(
+		http, ioc.get_executor(), extractor_options(opts));
+	auto player_id = extractor.warmup();
+	if (!player_id.empty()) {
+		spdlog::debug("Warmed up with cached player {}", player_id);
+	}
+
+	ytdlpp::server::ServerOptions server_opts;
+	server_opts.port = static_cast<unsigned short>(*opts.serve_port);
+	server_opts.extra_metrics = [http](ytdlpp::server::MetricsWriter &out) {
+		ytdlpp::server::write_metrics(out, http->stats());
+	};
+	ytdlpp::server::ExtractServer server(
+		ioc.get_executor(), extractor, server_opts);
+	if (server.start().has_error()) return 1;
+	log_info(fmt::format("Serving on http://{}:{} (POST /extract)",
+						 server_opts.address, server.port()));
+
+	asio::signal_set signals(ioc, SIGINT, SIGTERM);
+	signals.async_wait([&](const boost::system::error_code &ec, int sig) {
+		if (ec) return;
+		log_info(fmt::format("Received signal {}, finishing requests", sig));
+		server.drain([&] {
+			extractor.shutdown();
+			ioc.stop();
+		});
+		// A second signal skips the drain
+		signals.async_wait([&](const boost::system::error_code &ec2, int) {
+			if (!ec2) ioc.stop();
+		});
+	});
+
+	ioc.run();
+	return 0;
+}
+
 // =============================================================================
 // Main Entry Point
 // =============================================================================
@@ -503,6 +844,50 @@ int main(int argc, char *argv[]) {
 			 "Output path for downloads")
 			("merge-output-format", po::value<std::string>(),
 			 "Container format for merging (mkv, mp4, webm)")
+			// Download options
+			("concurrent-fragments,N", po::value<int>()->default_value(1),
+			 "Number of parallel connections per stream")
+			("limit-rate,r", po::value<std::string>(),
+			 "Maximum download rate in bytes per second per download "
+			 "(e.g. 50K or 4.2M)")
+			("limit-total-rate", po::value<std::string>(),
+			 "Maximum combined download rate, shared equally by concurrent "
+			 "downloads")
+			("js-isolates", po::value<int>()->default_value(1),
+			 "Number of JavaScript isolates for signature solving")
+			("early-completion",
+			 "Stop waiting for player API clients once -f can be satisfied")
+			("client-timeout", po::value<int>()->default_value(0),
+			 "Milliseconds to wait for slower player API clients (0 = all)")
+			("info-cache", po::value<int>()->default_value(0),
+			 "Reuse extraction results for up to N videos until URLs expire")
+			("info-cache-dir", po::value<std::string>(),
+			 "Also keep extraction results in this directory")
+			("record-http", po::value<std::string>(),
+			 "Save every HTTP response to this directory")
+			("record-media",
+			 "With --record-http, also save downloaded media bytes")
+			("replay-http", po::value<std::string>(),
+			 "Answer HTTP requests from a --record-http directory")
+			("replay-latency", po::value<int>()->default_value(0),
+			 "Delay each replayed request by this many milliseconds")
+			("replay-bandwidth", po::value<long long>()->default_value(0),
+			 "Pace replayed bodies at BYTES/s per connection (0 = unlimited)")
+			("trace-json", po::value<std::string>(),
+			 "Write per-phase timings in Chrome trace format to this file "
+			 "(not with --serve)")
+			("stream-merge",
+			 "Merge video and audio while downloading (no temporary files)")
+			// Batch options
+			("batch-file,a", po::value<std::string>(),
+			 "File with URLs to download, one per line (\"-\" for stdin)")
+			("concurrent-extractions", po::value<int>()->default_value(4),
+			 "Batch mode: URLs extracted at the same time")
+			("concurrent-downloads", po::value<int>()->default_value(2),
+			 "Batch mode: videos downloaded at the same time")
+			// Server options
+			("serve", po::value<int>()->implicit_value(8765),
+			 "Serve extraction over HTTP on 127.0.0.1 (default port 8765)")
 			// Display options
 			("dump-json,j", "Output video info as JSON")
 			("get-url,g", "Print download URL(s)")
@@ -561,14 +946,18 @@ int main(int argc, char *argv[]) {
 			return 1;
 		}
 
-		if (!vm.count("url")) {
+		if (!vm.count("url") && !vm.count("batch-file") &&
+			!vm.count("serve")) {
 			std::cout << "Usage: yt-dlpp [options] <url>\n" << desc << "\n";
 			return 1;
 		}
 
 		// Build CLI options
 		CliOptions opts;
-		opts.url = vm["url"].as<std::string>();
+		if (vm.count("url")) opts.url = vm["url"].as<std::string>();
+		if (vm.count("batch-file")) {
+			opts.batch_file = vm["batch-file"].as<std::string>();
+		}
 		opts.format = vm["format"].as<std::string>();
 		if (vm.count("merge-output-format")) {
 			opts.merge_format = vm["merge-output-format"].as<std::string>();
@@ -581,6 +970,7 @@ int main(int argc, char *argv[]) {
 		}
 		if (vm.count("print")) {
 			opts.print_template = vm["print"].as<std::string>();
+			opts.print = ytdlpp::OutputTemplate(opts.print_template);
 		}
 		if (vm.count("audio-format")) {
 			opts.audio_format = vm["audio-format"].as<std::string>();
@@ -598,16 +988,90 @@ int main(int argc, char *argv[]) {
 		opts.stream_audio = vm.count("stream-audio") > 0;
 		opts.verbose = vm.count("verbose") > 0;
 		opts.flat_playlist = vm.count("flat-playlist") > 0;
+		opts.concurrent_fragments =
+			std::max(1, vm["concurrent-fragments"].as<int>());
+		opts.js_isolates = std::max(1, vm["js-isolates"].as<int>());
+		opts.stream_merge = vm.count("stream-merge") > 0;
+		opts.early_completion = vm.count("early-completion") > 0;
+		opts.client_timeout_ms = std::max(0, vm["client-timeout"].as<int>());
+		opts.info_cache_entries = std::max(0, vm["info-cache"].as<int>());
+		if (vm.count("info-cache-dir")) {
+			opts.info_cache_dir = vm["info-cache-dir"].as<std::string>();
+		}
+		for (auto [name, limit] :
+			 {std::pair{"limit-rate", &opts.bandwidth.per_download},
+			  std::pair{"limit-total-rate", &opts.bandwidth.total}}) {
+			if (!vm.count(name)) continue;
+			auto rate = parse_rate(vm[name].as<std::string>());
+			if (!rate) {
+				spdlog::error("Invalid rate for --{}: {}", name,
+							  vm[name].as<std::string>());
+				return 1;
+			}
+			*limit = *rate;
+		}
+		using ReplayMode = ytdlpp::net::HttpReplayOptions::Mode;
+		if (vm.count("record-http") && vm.count("replay-http")) {
+			spdlog::error("--record-http and --replay-http are exclusive");
+			return 1;
+		}
+		if (vm.count("record-http")) {
+			opts.replay.mode = ReplayMode::record;
+			opts.replay.directory = vm["record-http"].as<std::string>();
+			opts.replay.record_media = vm.count("record-media") > 0;
+		} else if (vm.count("replay-http")) {
+			opts.replay.mode = ReplayMode::replay;
+			opts.replay.directory = vm["replay-http"].as<std::string>();
+		}
+		opts.replay.latency = std::chrono::milliseconds(
+			std::max(0, vm["replay-latency"].as<int>()));
+		opts.replay.bandwidth = static_cast<uint64_t>(
+			std::max(0LL, vm["replay-bandwidth"].as<long long>()));
+		opts.concurrent_extractions =
+			std::max(1, vm["concurrent-extractions"].as<int>());
+		opts.concurrent_downloads =
+			std::max(1, vm["concurrent-downloads"].as<int>());
+		if (vm.count("serve")) {
+			int port = vm["serve"].as<int>();
+			if (port < 1 || port > 65535) {
+				spdlog::error("Invalid port for --serve: {}", port);
+				return 1;
+			}
+			opts.serve_port = port;
+			// Spans are buffered until exit, which a server never reaches
+			if (vm.count("trace-json")) {
+				spdlog::error("--trace-json cannot be used with --serve");
+				return 1;
+			}
+		}
 
 		// Auto-select bestaudio format when extracting audio
 		if (opts.extract_audio && opts.format == "best") {
 			opts.format = "bestaudio";
 		}
 
+		// Spans are written when main returns: after errors and signals too
+		std::optional<ytdlpp::trace::ChromeTraceRecorder> tracer;
+		std::string trace_path;
+		if (vm.count("trace-json")) {
+			trace_path = vm["trace-json"].as<std::string>();
+			tracer.emplace();
+			tracer->install();
+		}
+		BOOST_SCOPE_EXIT_ALL(&tracer, &trace_path) {
+			if (!tracer) return;
+			if (tracer->write(trace_path).has_error()) {
+				spdlog::error("Could not write trace to {}", trace_path);
+			} else {
+				spdlog::info("Trace written to {}", trace_path);
+			}
+		};
+
+		if (opts.serve_port) return run_server(opts);
+
 		// Setup async context
 		asio::io_context ioc;
-		auto http =
-			std::make_shared<ytdlpp::net::HttpClient>(ioc.get_executor());
+		auto http = make_http_client(ioc, opts);
 
 		// Setup signal handling using asio::signal_set
 		asio::signal_set signals(ioc, SIGINT, SIGTERM);
@@ -624,7 +1088,14 @@ int main(int argc, char *argv[]) {
 		boost::asio::spawn(
 			ioc,
 			[&](asio::yield_context yield) {
-				run_app(ioc, http, opts, std::move(yield));
+				if (!opts.batch_file.empty()) {
+					run_batch(ioc, http, opts, std::move(yield));
+				} else {
+					run_app(ioc, http, opts, std::move(yield));
+				}
+				auto tls = http->tls_resumption_stats();
+				spdlog::debug("TLS session resumption: {} resumed, {} full",
+							  tls.hits, tls.misses);
 				// Cancel signal wait so io_context can exit normally
 				signals.cancel();
 			},
@@ -1,5 +1,7 @@
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/cancellation_signal.hpp>
@@ -9,11 +11,17 @@
 #include <boost/asio/strand.hpp>
 #include <boost/asio/thread_pool.hpp>
 #include <boost/scope_exit.hpp>
-#include <condition_variable>
-#include <deque>
+#include <cstring>
 #include <mutex>
 #include <optional>
+#include <thread>
+#include <utility>
 #include <ytdlpp/audio_streamer.hpp>
+#include <ytdlpp/http_client.hpp>
+
+#include "queue_io.hpp"
+#include "spsc_ring.hpp"
+#include "stream_queue.hpp"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -24,21 +32,46 @@ extern "C" {
 
 namespace ytdlpp::media {
 
+namespace {
+// Largest chunk handed out by the allocating async_read()
+constexpr size_t kAllocReadChunk = 64 * 1024;
+}  // namespace
+
+class DecodeJob;
+
 // =============================================================================
 // AudioStream Implementation
 // =============================================================================
+// Decoded PCM goes through a fixed-size SPSC ring: the decoder writes straight
+// from the resampler's output and async_read() copies straight into the
+// caller's buffer. The mutex only guards a read parked on an empty ring. When
+// the ring is full the decoder parks (see DecodeJob) and the next read that
+// frees room wakes it.
+// =============================================================================
 
 struct AudioStream::Impl : std::enable_shared_from_this<AudioStream::Impl> {
 	asio::any_io_executor ex;
 	asio::strand<asio::any_io_executor> strand;
 
-	// Thread-safe state
+	SpscByteRing ring;
+	std::atomic<bool> packets{false};  // Passthrough: framed packets, not PCM
+	// Written by the decoder before `packets` is set, passthrough only
+	AudioCodecParameters codec;
+	std::atomic<bool> eof{false};
+	// Set before `eof` when the input broke off instead of ending
+	std::atomic<bool> failed{false};
+	std::atomic<bool> cancelled{false};
+
 	std::mutex mutex;
-	std::condition_variable cv;
-	std::deque<std::vector<uint8_t>> buffer_queue;
-	bool eof = false;
-	bool cancelled = false;
-	bool producer_done = false;
+	std::atomic<bool> read_pending{false};
+
+	// Decoder producing into `ring`, and whether it is parked on a full ring
+	std::shared_ptr<DecodeJob> decoder;
+	std::atomic<bool> output_parked{false};
+
+	// HttpClient read-ahead feeding the decoder, if any. Cancelling it
+	// unblocks a decoder waiting for input.
+	std::weak_ptr<StreamQueue> source;
 
 	// Pending read operation (with buffer)
 	struct PendingRead {
@@ -57,21 +90,23 @@ struct AudioStream::Impl : std::enable_shared_from_this<AudioStream::Impl> {
 	};
 	std::optional<PendingAllocRead> pending_alloc_read;
 
-	explicit Impl(asio::any_io_executor e)
-		: ex(std::move(e)), strand(asio::make_strand(ex)) {}
+	Impl(asio::any_io_executor e, size_t buffer_bytes)
+		: ex(std::move(e)), strand(asio::make_strand(ex)), ring(buffer_bytes) {}
 
 	~Impl() { cancel(); }
 
 	void cancel() {
+		cancelled.store(true);
+		if (auto q = source.lock()) q->cancel();
+		wake_decoder();
 		std::unique_lock lock(mutex);
-		cancelled = true;
-		cv.notify_all();
 
 		// Move pending reads out while holding lock
 		std::optional<PendingRead> pr = std::move(pending_read);
 		pending_read.reset();
 		std::optional<PendingAllocRead> par = std::move(pending_alloc_read);
 		pending_alloc_read.reset();
+		read_pending.store(false);
 
 		// Release lock before completing handlers
 		lock.unlock();
@@ -91,101 +126,172 @@ struct AudioStream::Impl : std::enable_shared_from_this<AudioStream::Impl> {
 		}
 	}
 
-	// Called by producer thread when data is available
-	void push_data(std::vector<uint8_t> data) {
+	void wake_decoder();
+
+	// Consumer side: wake the decoder if it parked on a full ring.
+	void notify_space() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (output_parked.exchange(false)) wake_decoder();
+	}
+
+	// Called by the decoder; never blocks. Returns how much fit.
+	size_t push_some(const uint8_t *data, size_t size) {
+		size_t n = ring.write(data, size);
+		if (n > 0) service_pending();
+		return n;
+	}
+
+	// Called by producer thread when done
+	void set_eof(bool input_failed) {
+		if (input_failed) failed.store(true);
+		eof.store(true);
+		service_pending();
+	}
+
+	// The read that finds the ring drained at the end: fails if the input
+	// broke off
+	[[nodiscard]] bool end_failed() const { return failed.load(); }
+
+	// Completes a parked read if the ring has data, or the stream ended.
+	// Whoever takes the parked read under the lock acts as the ring's
+	// consumer for it; the reader itself is idle until it completes.
+	void service_pending() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!read_pending.load()) return;
+
 		std::unique_lock lock(mutex);
-		if (cancelled) return;
+		if (!pending_read && !pending_alloc_read) return;
 
-		buffer_queue.push_back(std::move(data));
+		bool has_data = ring.readable() > 0;
+		if (!has_data && !eof.load() && !cancelled.load()) return;
 
-		// If there's a pending read, complete it
 		auto pr = std::move(pending_read);
 		pending_read.reset();
 		auto par = std::move(pending_alloc_read);
 		pending_alloc_read.reset();
+		read_pending.store(false);
+		lock.unlock();
 
-		if (pr || par) {
-			// Need to complete a pending read
+		if (cancelled.load() && !has_data) {
+			// cancel() completes reads it finds; this one raced with it
 			if (pr) {
-				auto &front = buffer_queue.front();
-				size_t to_copy = std::min(pr->size, front.size());
-				std::memcpy(pr->data, front.data(), to_copy);
-
-				if (to_copy >= front.size()) {
-					buffer_queue.pop_front();
-				} else {
-					front.erase(
-						front.begin(),
-						front.begin() + static_cast<std::ptrdiff_t>(to_copy));
-				}
-
-				lock.unlock();
 				asio::dispatch(asio::bind_executor(
-					pr->handler_ex,
-					[h = std::move(pr->handler), to_copy]() mutable {
-						h(outcome::success(to_copy));
+					pr->handler_ex, [h = std::move(pr->handler)]() mutable {
+						h(outcome::failure(asio::error::operation_aborted));
 					}));
-			} else if (par) {
-				auto result_data = std::move(buffer_queue.front());
-				buffer_queue.pop_front();
-
-				lock.unlock();
+			}
+			if (par) {
 				asio::dispatch(asio::bind_executor(
-					par->handler_ex, [h = std::move(par->handler),
-									  d = std::move(result_data)]() mutable {
-						h(outcome::success(std::move(d)));
+					par->handler_ex, [h = std::move(par->handler)]() mutable {
+						h(outcome::failure(asio::error::operation_aborted));
 					}));
 			}
+			return;
 		}
-	}
 
-	// Called by producer thread when done
-	void set_eof() {
-		std::unique_lock lock(mutex);
-		eof = true;
-		producer_done = true;
-
-		// Move out pending reads
-		auto pr = std::move(pending_read);
-		pending_read.reset();
-		auto par = std::move(pending_alloc_read);
-		pending_alloc_read.reset();
-
-		lock.unlock();
-
-		// Complete any pending read with EOF (0 bytes / empty vector)
 		if (pr) {
+			size_t n = ring.read(pr->data, pr->size);
+			notify_space();
+			bool failed = n == 0 && pr->size > 0 && end_failed();
 			asio::dispatch(asio::bind_executor(
-				pr->handler_ex, [h = std::move(pr->handler)]() mutable {
-					h(outcome::success(size_t{0}));
+				pr->handler_ex,
+				[h = std::move(pr->handler), n, failed]() mutable {
+					if (failed) return h(outcome::failure(errc::request_failed));
+					h(outcome::success(n));
 				}));
-		}
-		if (par) {
+		} else if (par) {
+			auto data = read_alloc();
+			bool failed = data.empty() && end_failed();
 			asio::dispatch(asio::bind_executor(
-				par->handler_ex, [h = std::move(par->handler)]() mutable {
-					h(outcome::success(std::vector<uint8_t>{}));
+				par->handler_ex, [h = std::move(par->handler),
+								  d = std::move(data), failed]() mutable {
+					if (failed) return h(outcome::failure(errc::request_failed));
+					h(outcome::success(std::move(d)));
 				}));
 		}
 	}
+
+	// Consumer side: up to kAllocReadChunk bytes, or one framed packet in
+	// passthrough mode (empty at EOF).
+	std::vector<uint8_t> read_alloc() {
+		size_t size = std::min(ring.readable(), kAllocReadChunk);
+		if (packets.load()) {
+			// The decoder only pushes whole packets
+			AudioPacketHeader header;
+			if (ring.peek(reinterpret_cast<uint8_t *>(&header),
+						  sizeof(header)) == sizeof(header)) {
+				size = sizeof(header) + header.size;
+			} else {
+				size = 0;
+			}
+		}
+		std::vector<uint8_t> data(size);
+		data.resize(ring.read(data.data(), data.size()));
+		notify_space();
+		return data;
+	}
+
+	// Called by the decoder: push one framed packet whole, or nothing.
+	bool push_packet(const std::vector<uint8_t> &frame) {
+		if (ring.writable() < frame.size()) return false;
+		ring.write(frame.data(), frame.size());
+		service_pending();
+		return true;
+	}
+
+	// Consumer side: park a read the ring can't satisfy yet, then re-check
+	// so a write that raced with parking isn't missed.
+	void park(std::optional<PendingRead> pr,
+			  std::optional<PendingAllocRead> par) {
+		{
+			std::lock_guard lock(mutex);
+			pending_read = std::move(pr);
+			pending_alloc_read = std::move(par);
+			read_pending.store(true);
+		}
+		service_pending();
+	}
 };
 
 AudioStream::AudioStream(std::shared_ptr<Impl> impl)
 	: m_impl(std::move(impl)) {}
 
 AudioStream::AudioStream(AudioStream &&) noexcept = default;
-AudioStream &AudioStream::operator=(AudioStream &&) noexcept = default;
-AudioStream::~AudioStream() = default;
+AudioStream &AudioStream::operator=(AudioStream &&other) noexcept {
+	if (this != &other) {
+		if (m_impl) m_impl->cancel();
+		m_impl = std::move(other.m_impl);
+	}
+	return *this;
+}
+
+// The decoder may be blocked on a full ring; dropping the stream releases it
+AudioStream::~AudioStream() {
+	if (m_impl) m_impl->cancel();
+}
 
 bool AudioStream::is_eof() const {
 	if (!m_impl) return true;
-	std::lock_guard lock(m_impl->mutex);
-	return m_impl->eof && m_impl->buffer_queue.empty();
+	return m_impl->eof.load() && m_impl->ring.readable() == 0;
+}
+
+std::error_code AudioStream::error() const {
+	if (!m_impl || !m_impl->eof.load() || !m_impl->failed.load()) return {};
+	return make_error_code(errc::request_failed);
+}
+
+bool AudioStream::is_passthrough() const {
+	return m_impl && m_impl->packets.load();
+}
+
+const AudioCodecParameters &AudioStream::codec_parameters() const {
+	static const AudioCodecParameters kNone;
+	return m_impl ? m_impl->codec : kNone;
 }
 
 bool AudioStream::is_cancelled() const {
 	if (!m_impl) return true;
-	std::lock_guard lock(m_impl->mutex);
-	return m_impl->cancelled;
+	return m_impl->cancelled.load();
 }
 
 void AudioStream::cancel() {
@@ -212,46 +318,32 @@ void AudioStream::async_read_impl(
 	auto *data_ptr = static_cast<uint8_t *>(buffer.data());
 	size_t data_size = buffer.size();
 
-	std::unique_lock lock(self->mutex);
-
-	// If data available or EOF, complete immediately
-	if (!self->buffer_queue.empty() || self->eof || self->cancelled) {
-		if (self->cancelled) {
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler)]() mutable {
-					handler(outcome::failure(asio::error::operation_aborted));
-				}));
-		} else if (self->buffer_queue.empty()) {
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler)]() mutable {
-					handler(outcome::success(size_t{0}));
-				}));
-		} else {
-			auto &front = self->buffer_queue.front();
-			size_t to_copy = std::min(data_size, front.size());
-			std::memcpy(data_ptr, front.data(), to_copy);
-
-			if (to_copy >= front.size()) {
-				self->buffer_queue.pop_front();
-			} else {
-				front.erase(
-					front.begin(),
-					front.begin() + static_cast<std::ptrdiff_t>(to_copy));
-			}
+	if (self->cancelled.load()) {
+		return asio::dispatch(asio::bind_executor(
+			handler_ex, [handler = std::move(handler)]() mutable {
+				handler(outcome::failure(asio::error::operation_aborted));
+			}));
+	}
 
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler), to_copy]() mutable {
-					handler(outcome::success(to_copy));
-				}));
-		}
-	} else {
-		// Store pending read
-		self->pending_read = Impl::PendingRead{
-			data_ptr, data_size, std::move(handler), std::move(handler_ex)};
+	// Fast path: copy straight out of the ring. EOF is only final once the
+	// ring is drained, so check it before reading.
+	bool at_eof = self->eof.load();
+	size_t n = self->ring.read(data_ptr, data_size);
+	if (n > 0 || at_eof || data_size == 0) {
+		self->notify_space();
+		bool failed = n == 0 && data_size > 0 && self->end_failed();
+		return asio::dispatch(asio::bind_executor(
+			handler_ex, [handler = std::move(handler), n, failed]() mutable {
+				if (failed) {
+					return handler(outcome::failure(errc::request_failed));
+				}
+				handler(outcome::success(n));
+			}));
 	}
+
+	self->park(Impl::PendingRead{data_ptr, data_size, std::move(handler),
+								 std::move(handler_ex)},
+			   std::nullopt);
 }
 
 void AudioStream::async_read_alloc_impl(
@@ -267,93 +359,296 @@ void AudioStream::async_read_alloc_impl(
 		});
 	}
 
-	std::unique_lock lock(self->mutex);
+	if (self->cancelled.load()) {
+		return asio::dispatch(asio::bind_executor(
+			handler_ex, [handler = std::move(handler)]() mutable {
+				handler(outcome::failure(asio::error::operation_aborted));
+			}));
+	}
 
-	if (!self->buffer_queue.empty() || self->eof || self->cancelled) {
-		if (self->cancelled) {
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler)]() mutable {
-					handler(outcome::failure(asio::error::operation_aborted));
-				}));
-		} else if (self->buffer_queue.empty()) {
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler)]() mutable {
-					handler(outcome::success(std::vector<uint8_t>{}));
-				}));
-		} else {
-			auto data = std::move(self->buffer_queue.front());
-			self->buffer_queue.pop_front();
+	bool at_eof = self->eof.load();
+	if (self->ring.readable() > 0 || at_eof) {
+		auto data = self->read_alloc();
+		bool failed = data.empty() && self->end_failed();
+		return asio::dispatch(asio::bind_executor(
+			handler_ex, [handler = std::move(handler), data = std::move(data),
+						 failed]() mutable {
+				if (failed) {
+					return handler(outcome::failure(errc::request_failed));
+				}
+				handler(outcome::success(std::move(data)));
+			}));
+	}
 
-			lock.unlock();
-			asio::dispatch(asio::bind_executor(
-				handler_ex, [handler = std::move(handler),
-							 data = std::move(data)]() mutable {
-					handler(outcome::success(std::move(data)));
-				}));
+	self->park(std::nullopt, Impl::PendingAllocRead{std::move(handler),
+													std::move(handler_ex)});
+}
+
+void AudioStream::async_read_packet_impl(
+	asio::any_completion_handler<void(Result<AudioPacket>)> handler,
+	CompletionExecutor handler_ex, asio::cancellation_slot slot) {
+	// An allocating read returns exactly one framed packet; unwrap it
+	auto unframe = [handler = std::move(handler)](
+					   Result<std::vector<uint8_t>> res) mutable {
+		if (res.has_error()) return handler(outcome::failure(res.error()));
+
+		auto &frame = res.value();
+		AudioPacket packet;
+		if (frame.size() >= sizeof(AudioPacketHeader)) {
+			AudioPacketHeader header;
+			std::memcpy(&header, frame.data(), sizeof(header));
+			packet.pts_us = header.pts_us;
+			packet.duration_us = header.duration_us;
+			packet.data.assign(frame.begin() + sizeof(header), frame.end());
 		}
-	} else {
-		self->pending_alloc_read =
-			Impl::PendingAllocRead{std::move(handler), std::move(handler_ex)};
-	}
+		handler(outcome::success(std::move(packet)));
+	};
+
+	async_read_alloc_impl(
+		asio::any_completion_handler<void(Result<std::vector<uint8_t>>)>{
+			std::move(unframe)},
+		std::move(handler_ex), slot);
 }
 
 // =============================================================================
-// AudioStreamer Implementation
+// DECODE SCHEDULER
 // =============================================================================
+// Every stream's demux/decode/resample work runs as short steps on one pool
+// shared by all streamers, sized to the cores. A step handles a bounded batch
+// of packets and then requeues itself behind the other streams (round-robin).
+// A stream whose ring is full, or whose HttpClient read-ahead has not caught
+// up, parks instead of holding a thread and is rescheduled by whatever
+// unblocks it: a consumer read, arriving bytes or cancellation.
+//
+// Streams whose URL is opened by FFmpeg itself still block inside a step
+// while FFmpeg's HTTP stack waits on the network.
+// =============================================================================
+
+namespace {
+
+// Packets or frames handled per step before yielding the thread
+constexpr int kStepBudget = 32;
+// Compressed bytes the read-ahead must hold before a step runs, so the
+// demuxer rarely blocks on the queue mid-step
+constexpr size_t kMinInputBytes = 64 * 1024;
+
+asio::thread_pool &decode_pool() {
+	static asio::thread_pool pool(
+		std::max(1U, std::thread::hardware_concurrency()));
+	return pool;
+}
 
 // Interrupt callback for FFmpeg
-static int interrupt_callback(void *ctx) {
+int interrupt_callback(void *ctx) {
 	auto *cancel_token = static_cast<std::atomic<bool> *>(ctx);
 	return cancel_token->load() ? 1 : 0;
 }
 
-struct AudioStreamer::Impl {
-	asio::any_io_executor ex;
-	asio::thread_pool work_pool{1};
-
-	explicit Impl(asio::any_io_executor e) : ex(std::move(e)) {}
-
-	~Impl() { work_pool.join(); }
-
-	// Producer function - runs in thread pool
-	static void stream_producer(
-		const std::weak_ptr<AudioStream::Impl> &weak_impl,
-		const std::string &url, AudioStreamOptions options,
-		const std::shared_ptr<std::atomic<bool>> &cancel_token) {
-		AVFormatContext *format_ctx = nullptr;
-		AVCodecContext *codec_ctx = nullptr;
-		SwrContext *swr_ctx = nullptr;
-		AVPacket *packet = nullptr;
-		AVFrame *frame = nullptr;
-
-		BOOST_SCOPE_EXIT_ALL(
-			&frame, &packet, &swr_ctx, &codec_ctx, &format_ctx) {
-			if (frame) av_frame_free(&frame);
-			if (packet) av_packet_free(&packet);
-			if (swr_ctx) swr_free(&swr_ctx);
-			if (codec_ctx) avcodec_free_context(&codec_ctx);
-			if (format_ctx) avformat_close_input(&format_ctx);
-		};
-
-		auto mark_eof = [&]() {
-			if (auto impl = weak_impl.lock()) { impl->set_eof(); }
-		};
-
-		// Allocate format context
-		format_ctx = avformat_alloc_context();
-		if (!format_ctx) {
-			spdlog::error("AudioStream: Failed to allocate format context");
-			mark_eof();
+}  // namespace
+
+class DecodeJob : public std::enable_shared_from_this<DecodeJob> {
+   public:
+	DecodeJob(std::weak_ptr<AudioStream::Impl> stream, std::string url,
+			  AudioStreamOptions options,
+			  std::shared_ptr<std::atomic<bool>> cancel_token,
+			  std::shared_ptr<StreamQueue> source)
+		: stream_(std::move(stream)),
+		  url_(std::move(url)),
+		  options_(options),
+		  cancel_token_(std::move(cancel_token)),
+		  source_(std::move(source)) {
+		if (source_) source_io_.emplace(*source_);
+	}
+
+	~DecodeJob() {
+		if (dst_data_) {
+			av_freep(&dst_data_[0]);
+			av_freep(&dst_data_);
+		}
+		if (frame_) av_frame_free(&frame_);
+		if (packet_) av_packet_free(&packet_);
+		if (swr_ctx_) swr_free(&swr_ctx_);
+		if (codec_ctx_) avcodec_free_context(&codec_ctx_);
+		if (format_ctx_) avformat_close_input(&format_ctx_);
+	}
+
+	DecodeJob(const DecodeJob &) = delete;
+	DecodeJob &operator=(const DecodeJob &) = delete;
+
+	using OpenHandler = asio::any_completion_handler<void(std::error_code)>;
+
+	// Called from the pool once the source is probed (or failed to open).
+	// Set before the first wake().
+	void on_open(OpenHandler handler) { on_open_ = std::move(handler); }
+
+	// Schedule a step unless one is queued; a wake during a step reruns it.
+	void wake() {
+		std::lock_guard lock(sched_mutex_);
+		if (running_) {
+			rerun_ = true;
 			return;
 		}
+		if (queued_ || finished_) return;
+		queued_ = true;
+		post();
+	}
 
-		format_ctx->interrupt_callback.callback = interrupt_callback;
-		format_ctx->interrupt_callback.opaque = cancel_token.get();
+   private:
+	enum class Step { more, wait_input, wait_output, done };
+
+	std::weak_ptr<AudioStream::Impl> stream_;
+	std::string url_;
+	AudioStreamOptions options_;
+	std::shared_ptr<std::atomic<bool>> cancel_token_;
+	std::shared_ptr<StreamQueue> source_;
+
+	// Declared before the format context so it outlives it
+	std::optional<QueueIo> source_io_;
+
+	AVFormatContext *format_ctx_ = nullptr;
+	AVCodecContext *codec_ctx_ = nullptr;
+	SwrContext *swr_ctx_ = nullptr;
+	AVPacket *packet_ = nullptr;
+	AVFrame *frame_ = nullptr;
+	int stream_idx_ = -1;
+	bool opened_ = false;
+	bool input_failed_ = false;	 // A read failed before the end of input
+	bool decoder_has_frames_ = false;
+	OpenHandler on_open_;
+
+	// Passthrough: demuxed packets are framed here instead of decoded
+	bool passthrough_ = false;
+	AudioCodecParameters codec_;  // Handed to the stream once opened
+	AVRational time_base_{1, 1000};
+	std::vector<uint8_t> packet_frame_;
+
+	// Resampler output; a step that fills the ring keeps the rest here
+	uint8_t **dst_data_ = nullptr;
+	int allocated_samples_ = 0;
+	size_t pending_offset_ = 0;
+	size_t pending_size_ = 0;
+
+	std::mutex sched_mutex_;
+	bool queued_ = false;
+	bool running_ = false;
+	bool rerun_ = false;
+	bool finished_ = false;
+
+	void post() {
+		asio::post(decode_pool(), [self = shared_from_this()] { self->run(); });
+	}
 
-		// Network options
+	void run() {
 		{
+			std::lock_guard lock(sched_mutex_);
+			queued_ = false;
+			running_ = true;
+			rerun_ = false;
+		}
+
+		Step step = Step::done;
+		auto stream = stream_.lock();
+		if (stream && !stream->cancelled.load() && !cancel_token_->load()) {
+			if (!input_ready()) {
+				step = Step::wait_input;
+			} else if (!opened_) {
+				opened_ = open();
+				if (opened_) {
+					if (passthrough_) stream->codec = std::move(codec_);
+					stream->packets.store(passthrough_);
+					notify_open({});
+				}
+				step = opened_ ? Step::more : Step::done;
+			} else {
+				step = decode_step(*stream);
+			}
+		}
+
+		if (step == Step::wait_output) {
+			// Park, then re-check so a read that raced with parking isn't
+			// lost; whichever side clears the flag reschedules.
+			stream->output_parked.store(true);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (stream->ring.writable() >= output_needed() &&
+				stream->output_parked.exchange(false)) {
+				step = Step::more;
+			}
+		} else if (step == Step::wait_input) {
+			std::weak_ptr<DecodeJob> weak = shared_from_this();
+			if (source_->poll_readable(kMinInputBytes, [weak] {
+					if (auto job = weak.lock()) job->wake();
+				})) {
+				step = Step::more;
+			}
+		}
+
+		if (step == Step::done) finish(stream);
+
+		std::lock_guard lock(sched_mutex_);
+		running_ = false;
+		if (finished_) return;
+		if (step == Step::more || rerun_) {
+			rerun_ = false;
+			queued_ = true;
+			post();
+		}
+	}
+
+	// The FFmpeg-fetched input is always "ready"; its reads just block.
+	bool input_ready() {
+		return !source_ || source_->poll_readable(kMinInputBytes, nullptr);
+	}
+
+	// Ring space the parked output is waiting for
+	[[nodiscard]] size_t output_needed() const {
+		return passthrough_ ? packet_frame_.size() : 1;
+	}
+
+	void notify_open(std::error_code ec) {
+		if (auto handler = std::exchange(on_open_, nullptr)) handler(ec);
+	}
+
+	void finish(const std::shared_ptr<AudioStream::Impl> &stream) {
+		{
+			std::lock_guard lock(sched_mutex_);
+			finished_ = true;
+		}
+		if (!opened_) {
+			bool cancelled =
+				cancel_token_->load() || !stream || stream->cancelled.load();
+			notify_open(cancelled
+							? make_error_code(asio::error::operation_aborted)
+							: make_error_code(errc::stream_open_failed));
+		}
+		// Stop the read-ahead download if we end before it does
+		if (source_) source_->cancel();
+		if (stream) stream->set_eof(input_failed_);
+	}
+
+	bool open() {
+		format_ctx_ = avformat_alloc_context();
+		if (!format_ctx_) {
+			spdlog::error("AudioStream: Failed to allocate format context");
+			return false;
+		}
+
+		format_ctx_->interrupt_callback.callback = interrupt_callback;
+		format_ctx_->interrupt_callback.opaque = cancel_token_.get();
+
+		if (source_io_) {
+			if (!source_io_->get()) {
+				spdlog::error("AudioStream: Failed to allocate AVIO context");
+				return false;
+			}
+			format_ctx_->pb = source_io_->get();
+			format_ctx_->flags |= AVFMT_FLAG_CUSTOM_IO;
+			if (avformat_open_input(&format_ctx_, nullptr, nullptr, nullptr) <
+				0) {
+				spdlog::error("AudioStream: Failed to open input stream");
+				return false;
+			}
+		} else {
+			// Network options
 			AVDictionary *av_options = nullptr;
 			av_dict_set(&av_options, "reconnect", "1", 0);
 			av_dict_set(&av_options, "reconnect_streamed", "1", 0);
@@ -368,163 +663,284 @@ struct AudioStreamer::Impl {
 			BOOST_SCOPE_EXIT_ALL(&av_options) { av_dict_free(&av_options); };
 
 			if (avformat_open_input(
-					&format_ctx, url.c_str(), nullptr, &av_options) < 0) {
+					&format_ctx_, url_.c_str(), nullptr, &av_options) < 0) {
 				spdlog::error("AudioStream: Failed to open input URL");
-				mark_eof();
-				return;
+				return false;
 			}
 		}
 
-		if (avformat_find_stream_info(format_ctx, nullptr) < 0) {
+		if (avformat_find_stream_info(format_ctx_, nullptr) < 0) {
 			spdlog::error("AudioStream: Failed to find stream info");
-			mark_eof();
-			return;
+			return false;
 		}
 
-		int stream_idx = av_find_best_stream(
-			format_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-		if (stream_idx < 0) {
+		stream_idx_ = av_find_best_stream(
+			format_ctx_, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+		if (stream_idx_ < 0) {
 			spdlog::error("AudioStream: No audio stream found");
-			mark_eof();
-			return;
+			return false;
+		}
+
+		AVStream *stream = format_ctx_->streams[stream_idx_];
+		if (passthrough_for(stream->codecpar->codec_id)) {
+			spdlog::debug("AudioStream: Passing {} packets through",
+						  avcodec_get_name(stream->codecpar->codec_id));
+			passthrough_ = true;
+			time_base_ = stream->time_base;
+			const AVCodecParameters *par = stream->codecpar;
+			codec_.codec = options_.output;
+			codec_.codec_id = par->codec_id;
+			codec_.sample_rate = par->sample_rate;
+			codec_.channels = par->ch_layout.nb_channels;
+			if (par->ch_layout.order == AV_CHANNEL_ORDER_NATIVE) {
+				codec_.channel_mask = par->ch_layout.u.mask;
+			}
+			codec_.initial_padding = par->initial_padding;
+			if (par->extradata && par->extradata_size > 0) {
+				codec_.extradata.assign(
+					par->extradata, par->extradata + par->extradata_size);
+			}
+			packet_ = av_packet_alloc();
+			return packet_ != nullptr;
 		}
 
-		AVStream *stream = format_ctx->streams[stream_idx];
 		const AVCodec *decoder =
 			avcodec_find_decoder(stream->codecpar->codec_id);
 		if (!decoder) {
 			spdlog::error("AudioStream: Codec not found");
-			mark_eof();
-			return;
+			return false;
 		}
 
-		codec_ctx = avcodec_alloc_context3(decoder);
-		avcodec_parameters_to_context(codec_ctx, stream->codecpar);
+		codec_ctx_ = avcodec_alloc_context3(decoder);
+		avcodec_parameters_to_context(codec_ctx_, stream->codecpar);
 
-		if (avcodec_open2(codec_ctx, decoder, nullptr) < 0) {
+		if (avcodec_open2(codec_ctx_, decoder, nullptr) < 0) {
 			spdlog::error("AudioStream: Failed to open codec");
-			mark_eof();
-			return;
+			return false;
 		}
 
 		// Setup resampler
-		int dst_rate = options.sample_rate;
-		auto dst_sample_fmt = static_cast<AVSampleFormat>(options.sample_fmt);
+		auto dst_sample_fmt = static_cast<AVSampleFormat>(options_.sample_fmt);
 
-		swr_ctx = swr_alloc();
+		swr_ctx_ = swr_alloc();
 		av_opt_set_chlayout(
-			swr_ctx, "in_chlayout", &stream->codecpar->ch_layout, 0);
+			swr_ctx_, "in_chlayout", &stream->codecpar->ch_layout, 0);
 		av_opt_set_int(
-			swr_ctx, "in_sample_rate", stream->codecpar->sample_rate, 0);
+			swr_ctx_, "in_sample_rate", stream->codecpar->sample_rate, 0);
 		av_opt_set_sample_fmt(
-			swr_ctx, "in_sample_fmt",
+			swr_ctx_, "in_sample_fmt",
 			static_cast<AVSampleFormat>(stream->codecpar->format), 0);
 
 		AVChannelLayout out_layout{};
-		av_channel_layout_default(&out_layout, options.channels);
-		av_opt_set_chlayout(swr_ctx, "out_chlayout", &out_layout, 0);
-		av_opt_set_int(swr_ctx, "out_sample_rate", dst_rate, 0);
-		av_opt_set_sample_fmt(swr_ctx, "out_sample_fmt", dst_sample_fmt, 0);
+		av_channel_layout_default(&out_layout, options_.channels);
+		av_opt_set_chlayout(swr_ctx_, "out_chlayout", &out_layout, 0);
+		av_opt_set_int(swr_ctx_, "out_sample_rate", options_.sample_rate, 0);
+		av_opt_set_sample_fmt(swr_ctx_, "out_sample_fmt", dst_sample_fmt, 0);
 
-		if (swr_init(swr_ctx) < 0) {
+		if (swr_init(swr_ctx_) < 0) {
 			spdlog::error("AudioStream: Failed to init resampler");
-			mark_eof();
-			return;
+			return false;
 		}
 
-		packet = av_packet_alloc();
-		frame = av_frame_alloc();
+		packet_ = av_packet_alloc();
+		frame_ = av_frame_alloc();
 
 		// Pre-allocate destination buffer
-		const int initial_samples = 2048;
-		uint8_t **dst_data = nullptr;
+		allocated_samples_ = 2048;
 		int dst_linesize = 0;
-		int allocated_samples = initial_samples;
-
 		av_samples_alloc_array_and_samples(
-			&dst_data, &dst_linesize, options.channels, allocated_samples,
+			&dst_data_, &dst_linesize, options_.channels, allocated_samples_,
 			dst_sample_fmt, 0);
+		return packet_ && frame_ && dst_data_;
+	}
+
+	[[nodiscard]] bool passthrough_for(AVCodecID codec) const {
+		switch (options_.output) {
+			case AudioOutput::Opus: return codec == AV_CODEC_ID_OPUS;
+			case AudioOutput::AAC: return codec == AV_CODEC_ID_AAC;
+			default: return false;
+		}
+	}
+
+	// Push what the last step could not fit; false while the ring is full.
+	bool flush_pending(AudioStream::Impl &stream) {
+		if (pending_size_ == 0) return true;
+		size_t n = stream.push_some(dst_data_[0] + pending_offset_,
+									pending_size_);
+		pending_offset_ += n;
+		pending_size_ -= n;
+		return pending_size_ == 0;
+	}
+
+	// Resample the decoded frame in frame_ and queue it for the ring.
+	void convert_frame() {
+		auto dst_sample_fmt = static_cast<AVSampleFormat>(options_.sample_fmt);
+		int dst_rate = options_.sample_rate;
+
+		// Calculate output samples
+		int max_dst_nb_samples = static_cast<int>(av_rescale_rnd(
+			swr_get_delay(swr_ctx_, codec_ctx_->sample_rate) +
+				frame_->nb_samples,
+			dst_rate, codec_ctx_->sample_rate, AV_ROUND_UP));
+
+		// Reallocate if needed
+		if (max_dst_nb_samples > allocated_samples_) {
+			av_freep(&dst_data_[0]);
+			av_freep(&dst_data_);
+			allocated_samples_ = max_dst_nb_samples;
+			int dst_linesize = 0;
+			av_samples_alloc_array_and_samples(
+				&dst_data_, &dst_linesize, options_.channels,
+				allocated_samples_, dst_sample_fmt, 0);
+		}
+
+		int nb_samples =
+			swr_convert(swr_ctx_, dst_data_, max_dst_nb_samples,
+						const_cast<const uint8_t **>(frame_->data),
+						frame_->nb_samples);
 
-		BOOST_SCOPE_EXIT_ALL(&dst_data) {
-			if (dst_data) {
-				av_freep(&dst_data[0]);
-				av_freep(&dst_data);
+		if (nb_samples > 0) {
+			int size = av_samples_get_buffer_size(
+				nullptr, options_.channels, nb_samples, dst_sample_fmt, 1);
+			pending_offset_ = 0;
+			pending_size_ = static_cast<size_t>(std::max(size, 0));
+		}
+	}
+
+	// Frame the packet in packet_ for the ring (see AudioPacketHeader).
+	void frame_packet(const AudioStream::Impl &stream) {
+		constexpr AVRational kMicros{1, 1000000};
+		AudioPacketHeader header;
+		if (packet_->pts != AV_NOPTS_VALUE) {
+			header.pts_us = av_rescale_q(packet_->pts, time_base_, kMicros);
+		}
+		if (packet_->duration > 0) {
+			header.duration_us =
+				av_rescale_q(packet_->duration, time_base_, kMicros);
+		}
+		header.size = static_cast<uint32_t>(packet_->size);
+
+		// A packet is pushed whole, so it must fit the ring
+		size_t total = sizeof(header) + header.size;
+		if (total > stream.ring.capacity()) {
+			spdlog::warn("AudioStream: Dropping {}-byte packet", header.size);
+			return;
+		}
+		packet_frame_.resize(total);
+		std::memcpy(packet_frame_.data(), &header, sizeof(header));
+		std::memcpy(packet_frame_.data() + sizeof(header), packet_->data,
+					header.size);
+	}
+
+	// A failed read ends the input as well, but the stream reports it: a
+	// broken download (the queue reads AVERROR_EXIT) or network error is not
+	// the end of the track.
+	Step end_of_input(const AudioStream::Impl &stream, int ret) {
+		bool cancelled = stream.cancelled.load() || cancel_token_->load();
+		if (ret != AVERROR_EOF && !cancelled) {
+			spdlog::error("AudioStream: Input ended early (error {})", ret);
+			input_failed_ = true;
+		}
+		return Step::done;
+	}
+
+	Step packet_step(AudioStream::Impl &stream) {
+		for (int budget = kStepBudget; budget > 0; --budget) {
+			if (!packet_frame_.empty()) {
+				if (!stream.push_packet(packet_frame_)) {
+					return Step::wait_output;
+				}
+				packet_frame_.clear();
 			}
-		};
-
-		// Decode loop
-		while (!cancel_token->load(std::memory_order_relaxed)) {
-			// Check if consumer is still alive
-			auto impl = weak_impl.lock();
-			if (!impl) break;
-
-			int ret = av_read_frame(format_ctx, packet);
-			if (ret < 0) break;
-
-			if (packet->stream_index == stream_idx) {
-				ret = avcodec_send_packet(codec_ctx, packet);
-				if (ret >= 0) {
-					while (ret >= 0 &&
-						   !cancel_token->load(std::memory_order_relaxed)) {
-						ret = avcodec_receive_frame(codec_ctx, frame);
-						if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
-						if (ret < 0) {
-							spdlog::error("AudioStream: Error during decoding");
-							break;
-						}
-
-						// Calculate output samples
-						int max_dst_nb_samples =
-							static_cast<int>(av_rescale_rnd(
-								swr_get_delay(swr_ctx, codec_ctx->sample_rate) +
-									frame->nb_samples,
-								dst_rate, codec_ctx->sample_rate, AV_ROUND_UP));
-
-						// Reallocate if needed
-						if (max_dst_nb_samples > allocated_samples) {
-							av_freep(&dst_data[0]);
-							av_freep(&dst_data);
-							allocated_samples = max_dst_nb_samples;
-							av_samples_alloc_array_and_samples(
-								&dst_data, &dst_linesize, options.channels,
-								allocated_samples, dst_sample_fmt, 0);
-						}
-
-						int nb_samples = swr_convert(
-							swr_ctx, dst_data, max_dst_nb_samples,
-							const_cast<const uint8_t **>(frame->data),
-							frame->nb_samples);
-
-						if (nb_samples > 0) {
-							int size = av_samples_get_buffer_size(
-								nullptr, options.channels, nb_samples,
-								dst_sample_fmt, 1);
-
-							std::vector<uint8_t> buffer(
-								static_cast<size_t>(size));
-							std::memcpy(buffer.data(), dst_data[0],
-										static_cast<size_t>(size));
-
-							// Push to consumer
-							if (auto i = weak_impl.lock()) {
-								i->push_data(std::move(buffer));
-							} else {
-								break;	// Consumer gone
-							}
-						}
-					}
+
+			if (!input_ready()) return Step::wait_input;
+
+			if (int ret = av_read_frame(format_ctx_, packet_); ret < 0) {
+				return end_of_input(stream, ret);
+			}
+			if (packet_->stream_index == stream_idx_) frame_packet(stream);
+			av_packet_unref(packet_);
+		}
+		return Step::more;
+	}
+
+	Step decode_step(AudioStream::Impl &stream) {
+		if (passthrough_) return packet_step(stream);
+		if (!flush_pending(stream)) return Step::wait_output;
+
+		for (int budget = kStepBudget; budget > 0; --budget) {
+			if (decoder_has_frames_) {
+				int ret = avcodec_receive_frame(codec_ctx_, frame_);
+				if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+					decoder_has_frames_ = false;
+					continue;
 				}
+				if (ret < 0) {
+					spdlog::error("AudioStream: Error during decoding");
+					decoder_has_frames_ = false;
+					continue;
+				}
+				convert_frame();
+				if (!flush_pending(stream)) return Step::wait_output;
+				continue;
 			}
 
-			av_packet_unref(packet);
+			if (!input_ready()) return Step::wait_input;
+
+			int ret = av_read_frame(format_ctx_, packet_);
+			if (ret < 0) return end_of_input(stream, ret);
+
+			if (packet_->stream_index == stream_idx_ &&
+				avcodec_send_packet(codec_ctx_, packet_) >= 0) {
+				decoder_has_frames_ = true;
+			}
+			av_packet_unref(packet_);
 		}
+		return Step::more;
+	}
+};
 
-		mark_eof();
+void AudioStream::Impl::wake_decoder() {
+	if (decoder) decoder->wake();
+}
+
+// =============================================================================
+// AudioStreamer Implementation
+// =============================================================================
+
+struct AudioStreamer::Impl {
+	asio::any_io_executor ex;
+	std::shared_ptr<net::HttpClient> http;	// Null: FFmpeg fetches the URL
+
+	// Streams opened here, watched for stats(); pruned as they go away
+	mutable std::mutex streams_mutex;
+	mutable std::vector<std::weak_ptr<AudioStream::Impl>> streams;
+	std::atomic<uint64_t> opened{0};
+
+	Impl(asio::any_io_executor e, std::shared_ptr<net::HttpClient> h)
+		: ex(std::move(e)), http(std::move(h)) {}
+
+	void track(const std::shared_ptr<AudioStream::Impl> &stream) {
+		opened.fetch_add(1, std::memory_order_relaxed);
+		std::lock_guard lock(streams_mutex);
+		prune_locked();
+		streams.push_back(stream);
+	}
+
+	void prune_locked() const {
+		streams.erase(
+			std::remove_if(streams.begin(), streams.end(),
+						   [](const auto &w) { return w.expired(); }),
+			streams.end());
 	}
 };
 
 AudioStreamer::AudioStreamer(asio::any_io_executor ex)
-	: m_impl(std::make_unique<Impl>(std::move(ex))) {}
+	: m_impl(std::make_unique<Impl>(std::move(ex), nullptr)) {}
+
+AudioStreamer::AudioStreamer(asio::any_io_executor ex,
+							 std::shared_ptr<net::HttpClient> http)
+	: m_impl(std::make_unique<Impl>(std::move(ex), std::move(http))) {}
 
 AudioStreamer::AudioStreamer(AudioStreamer &&) noexcept = default;
 AudioStreamer &AudioStreamer::operator=(AudioStreamer &&) noexcept = default;
@@ -532,12 +948,34 @@ AudioStreamer::~AudioStreamer() = default;
 
 asio::any_io_executor AudioStreamer::get_executor() const { return m_impl->ex; }
 
+AudioStreamerStats AudioStreamer::stats() const {
+	AudioStreamerStats out;
+	out.opened = m_impl->opened.load(std::memory_order_relaxed);
+	std::lock_guard lock(m_impl->streams_mutex);
+	m_impl->prune_locked();
+	for (const auto &w : m_impl->streams) {
+		auto stream = w.lock();
+		if (!stream) continue;
+		++out.open;
+		out.buffered_bytes += stream->ring.readable();
+		out.buffer_capacity += stream->ring.capacity();
+		if (stream->output_parked.load(std::memory_order_relaxed)) {
+			++out.full;
+		}
+		if (auto source = stream->source.lock()) {
+			out.prefetched_bytes += source->buffered();
+		}
+	}
+	return out;
+}
+
 void AudioStreamer::async_open_impl(
 	std::string url, AudioStreamOptions options,
 	asio::any_completion_handler<void(Result<AudioStream>)> handler,
 	CompletionExecutor handler_ex, asio::cancellation_slot slot) {
 	// Create the stream impl
-	auto stream_impl = std::make_shared<AudioStream::Impl>(m_impl->ex);
+	auto stream_impl =
+		std::make_shared<AudioStream::Impl>(m_impl->ex, options.buffer_bytes);
 	auto cancel_token = std::make_shared<std::atomic<bool>>(false);
 
 	// Bind cancellation
@@ -551,14 +989,57 @@ void AudioStreamer::async_open_impl(
 		});
 	}
 
-	// Start producer thread
-	std::weak_ptr<AudioStream::Impl> weak_impl = stream_impl;
-	asio::post(m_impl->work_pool, [weak_impl, url = std::move(url), options,
-								   cancel_token]() mutable {
-		Impl::stream_producer(weak_impl, url, options, cancel_token);
-	});
+	// Read-ahead: HttpClient downloads into a bounded queue the decoder
+	// reads through a custom AVIOContext; backpressure pauses the download
+	// once `prefetch_bytes` are buffered.
+	std::shared_ptr<StreamQueue> source;
+	if (m_impl->http) {
+		source = std::make_shared<StreamQueue>(options.prefetch_bytes);
+		stream_impl->source = source;
+		m_impl->http->async_download_file(
+			url, source, nullptr,
+			[weak = std::weak_ptr(source)](Result<void> res) {
+				// A clean end closes the queue: the decoder plays out what
+				// arrived and reports EOF. A failure cancels it (the session
+				// already did if it got as far as the sink), so the stream
+				// ends with an error instead.
+				if (res.has_error()) {
+					spdlog::error("AudioStream: Download failed: {}",
+								  res.error().message());
+					if (auto queue = weak.lock()) queue->cancel();
+				}
+			},
+			options.http_connections);
+	}
+
+	// The stream owns its decoder; the decoder only watches the stream
+	auto job = std::make_shared<DecodeJob>(
+		stream_impl, std::move(url), options, cancel_token, source);
+	stream_impl->decoder = job;
+	// stats() reads these fields without the stream's lock, so the stream is
+	// published only once they are set
+	m_impl->track(stream_impl);
+
+	// Passthrough is decided by probing the source, so report the stream
+	// once that's done. The pending handler keeps the stream alive.
+	if (options.output != AudioOutput::PCM) {
+		job->on_open([handler = std::move(handler), handler_ex,
+					  stream_impl](std::error_code ec) mutable {
+			asio::dispatch(asio::bind_executor(
+				handler_ex, [handler = std::move(handler),
+							 stream_impl = std::move(stream_impl),
+							 ec]() mutable {
+					if (ec) return handler(outcome::failure(ec));
+					handler(
+						outcome::success(AudioStream(std::move(stream_impl))));
+				}));
+		});
+		job->wake();
+		return;
+	}
+	job->wake();
 
-	// Return the stream immediately (producer runs in background)
+	// Return the stream immediately (decoding runs in the background)
 	asio::dispatch(asio::bind_executor(
 		handler_ex, [handler = std::move(handler),
 					 stream_impl = std::move(stream_impl)]() mutable {
@@ -2,8 +2,19 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/scope_exit.hpp>
+#include <chrono>
 #include <map>
+#include <thread>
+#include <ytdlpp/trace.hpp>
+
+#include "queue_io.hpp"
+#include "stream_queue.hpp"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -23,19 +34,19 @@ namespace ytdlpp::media {
 // =============================================================================
 namespace {
 constexpr size_t kIOBufferSize = 1024 * 1024;  // 1MB I/O buffer
-}  // namespace
 
-bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
-				  const std::string &output_path) {
-	// Log simulated ffmpeg command line for verbose parity
-	spdlog::debug(
-		"ffmpeg command line: ffmpeg -y -loglevel repeat+info -i \"file:{}\" "
-		"-i \"file:{}\" -c copy -map 0:v:0 -map 1:a:0 -movflags +faststart "
-		"\"file:{}\"",
-		video_path, audio_path, output_path);
-
-	AVFormatContext *video_ctx{};
-	AVFormatContext *audio_ctx{};
+// Report progress at most this often; a remux writes thousands of packets
+// per second.
+constexpr auto kProgressInterval = std::chrono::milliseconds(200);
+
+// Steps 3-6: copy the video streams of `video_ctx` and the audio streams of
+// `audio_ctx` into `output_path`, interleaving packets by dts. `total_bytes`
+// is the combined input size (0 if unknown) for progress reporting.
+bool mux_inputs(AVFormatContext *video_ctx, AVFormatContext *audio_ctx,
+				const std::string &output_path,
+				const Muxer::ProgressCallback &progress,
+				long long total_bytes) {
+	trace::Span span("mux", "mux", output_path);
 	AVFormatContext *out_ctx{};
 
 	// Map input stream index to output stream index
@@ -43,9 +54,7 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 	// Value: output_stream_index
 	std::map<std::pair<int, int>, int> stream_mapping;
 
-	BOOST_SCOPE_EXIT_ALL(&video_ctx, &audio_ctx, &out_ctx) {
-		if (video_ctx) avformat_close_input(&video_ctx);
-		if (audio_ctx) avformat_close_input(&audio_ctx);
+	BOOST_SCOPE_EXIT_ALL(&out_ctx) {
 		if (out_ctx) {
 			if (out_ctx->pb) avio_closep(&out_ctx->pb);
 			avformat_free_context(out_ctx);
@@ -54,26 +63,6 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 
 	int ret{};
 
-	// 1. Open Video File
-	if ((ret = avformat_open_input(&video_ctx, video_path.c_str(), 0, 0)) < 0) {
-		spdlog::error("Could not open input video file '{}'", video_path);
-		return false;
-	}
-	if ((ret = avformat_find_stream_info(video_ctx, 0)) < 0) {
-		spdlog::error("Failed to retrieve input video stream information");
-		return false;
-	}
-
-	// 2. Open Audio File
-	if ((ret = avformat_open_input(&audio_ctx, audio_path.c_str(), 0, 0)) < 0) {
-		spdlog::error("Could not open input audio file '{}'", audio_path);
-		return false;
-	}
-	if ((ret = avformat_find_stream_info(audio_ctx, 0)) < 0) {
-		spdlog::error("Failed to retrieve input audio stream information");
-		return false;
-	}
-
 	// 3. Output Context
 	avformat_alloc_output_context2(&out_ctx, NULL, NULL, output_path.c_str());
 	if (!out_ctx) {
@@ -149,6 +138,7 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 	}
 
 	// 4. Open Output File with optimized I/O buffer
+	trace::Span header_span("mux", "mux_header");
 	if (!(out_ctx->oformat->flags & AVFMT_NOFILE)) {
 		// Allocate I/O buffer for better throughput
 		unsigned char *io_buffer =
@@ -198,6 +188,7 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 
 	ret = avformat_write_header(out_ctx, &write_opts);
 	av_dict_free(&write_opts);
+	header_span.end();
 
 	if (ret < 0) {
 		spdlog::error("Error occurred when opening output file");
@@ -205,6 +196,7 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 	}
 
 	// 6. Packet Loop
+	trace::Span packets_span("mux", "mux_packets");
 	AVPacket *pkt_v = av_packet_alloc();
 	AVPacket *pkt_a = av_packet_alloc();
 
@@ -216,6 +208,18 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 	int ret_v = av_read_frame(video_ctx, pkt_v);
 	int ret_a = av_read_frame(audio_ctx, pkt_a);
 
+	MuxProgress prog{};
+	prog.total_bytes = total_bytes;
+	auto last_report = std::chrono::steady_clock::now();
+	auto report = [&] {
+		if (!progress) return;
+		// Input positions rather than packet sizes, so container overhead
+		// counts and a finished merge reads 100%.
+		prog.bytes = std::max<int64_t>(avio_tell(video_ctx->pb), 0) +
+					 std::max<int64_t>(avio_tell(audio_ctx->pb), 0);
+		progress(prog);
+	};
+
 	while (true) {
 		if (ret_v < 0 && ret_a < 0) {
 			break;	// Both EOF or Error
@@ -282,6 +286,7 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 				if (av_interleaved_write_frame(out_ctx, cur_pkt) < 0) {
 					spdlog::warn("Error muxing packet");
 				}
+				prog.packets++;
 			}
 
 			// Refill
@@ -291,14 +296,189 @@ bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
 			} else {
 				ret_a = av_read_frame(audio_ctx, pkt_a);
 			}
+
+			auto now = std::chrono::steady_clock::now();
+			if (now - last_report >= kProgressInterval) {
+				last_report = now;
+				report();
+			}
 		}
 	}
 
-	// Trailer
+	// A cancelled StreamQueue ends the input early; don't finalize a
+	// truncated file as if it were complete.
+	if (ret_v == AVERROR_EXIT || ret_a == AVERROR_EXIT) {
+		spdlog::error("Muxing aborted: {}", output_path);
+		return false;
+	}
+
+	packets_span.end();
+
+	// Trailer (with faststart, rewrites the file to move the index up)
+	trace::Span trailer_span("mux", "mux_trailer");
 	av_write_trailer(out_ctx);
+	trailer_span.end();
+	report();
 
 	spdlog::info("Muxing complete: {}", output_path);
 	return true;
 }
 
+// Demuxer reading from a StreamQueue (see QueueIo).
+struct QueueInput {
+	QueueIo io;
+	AVFormatContext *ctx{};
+
+	explicit QueueInput(StreamQueue &queue) : io(queue) {}
+	QueueInput(const QueueInput &) = delete;
+	QueueInput &operator=(const QueueInput &) = delete;
+
+	~QueueInput() {
+		// AVFMT_FLAG_CUSTOM_IO: closing the input leaves the AVIO to `io`
+		if (ctx) avformat_close_input(&ctx);
+	}
+
+	bool open(const char *what) {
+		if (!io.get()) return false;
+		ctx = avformat_alloc_context();
+		if (!ctx) return false;
+		ctx->pb = io.get();
+		ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+		// avformat_open_input() frees ctx on failure
+		if (avformat_open_input(&ctx, nullptr, nullptr, nullptr) < 0) {
+			spdlog::error("Could not open streamed input {}", what);
+			return false;
+		}
+		if (avformat_find_stream_info(ctx, nullptr) < 0) {
+			spdlog::error("Failed to retrieve {} stream information", what);
+			return false;
+		}
+		return true;
+	}
+};
+
+}  // namespace
+
+bool Muxer::merge(const std::string &video_path, const std::string &audio_path,
+				  const std::string &output_path,
+				  const ProgressCallback &progress) {
+	// Log simulated ffmpeg command line for verbose parity
+	spdlog::debug(
+		"ffmpeg command line: ffmpeg -y -loglevel repeat+info -i \"file:{}\" "
+		"-i \"file:{}\" -c copy -map 0:v:0 -map 1:a:0 -movflags +faststart "
+		"\"file:{}\"",
+		video_path, audio_path, output_path);
+
+	AVFormatContext *video_ctx{};
+	AVFormatContext *audio_ctx{};
+
+	BOOST_SCOPE_EXIT_ALL(&video_ctx, &audio_ctx) {
+		if (video_ctx) avformat_close_input(&video_ctx);
+		if (audio_ctx) avformat_close_input(&audio_ctx);
+	};
+
+	int ret{};
+	trace::Span open_span("mux", "mux_open_inputs");
+
+	// 1. Open Video File
+	if ((ret = avformat_open_input(&video_ctx, video_path.c_str(), 0, 0)) < 0) {
+		spdlog::error("Could not open input video file '{}'", video_path);
+		return false;
+	}
+	if ((ret = avformat_find_stream_info(video_ctx, 0)) < 0) {
+		spdlog::error("Failed to retrieve input video stream information");
+		return false;
+	}
+
+	// 2. Open Audio File
+	if ((ret = avformat_open_input(&audio_ctx, audio_path.c_str(), 0, 0)) < 0) {
+		spdlog::error("Could not open input audio file '{}'", audio_path);
+		return false;
+	}
+	if ((ret = avformat_find_stream_info(audio_ctx, 0)) < 0) {
+		spdlog::error("Failed to retrieve input audio stream information");
+		return false;
+	}
+
+	open_span.end();
+
+	long long total = std::max<int64_t>(avio_size(video_ctx->pb), 0) +
+					  std::max<int64_t>(avio_size(audio_ctx->pb), 0);
+	return mux_inputs(video_ctx, audio_ctx, output_path, progress, total);
+}
+
+bool Muxer::merge(StreamQueue &video, StreamQueue &audio,
+				  const std::string &output_path,
+				  const ProgressCallback &progress) {
+	spdlog::debug("Muxing streamed video and audio into {}", output_path);
+
+	// Probing the video input buffers the audio download until its turn;
+	// the queues' backpressure keeps that bounded.
+	trace::Span open_span("mux", "mux_open_inputs");
+	QueueInput video_in(video);
+	QueueInput audio_in(audio);
+	if (!video_in.open("video") || !audio_in.open("audio")) {
+		return false;
+	}
+	open_span.end();
+	// Sizes come from the HTTP responses; the AVIO inputs can't seek
+	long long total = std::max(video.total_size(), 0LL) +
+					  std::max(audio.total_size(), 0LL);
+	return mux_inputs(
+		video_in.ctx, audio_in.ctx, output_path, progress, total);
+}
+
+// =============================================================================
+// ASYNC MUXING
+// =============================================================================
+// Remuxing is disk-bound and can take minutes for multi-GB files, so merges
+// run on their own small pool instead of the caller's io_context. The pool is
+// bounded to a few threads: concurrent merges beyond that queue up instead of
+// thrashing the disk. Streaming merges are paced by the network rather than
+// the disk and last as long as their downloads; each gets a thread of its own
+// so file merges never queue behind them.
+// =============================================================================
+
+namespace {
+
+asio::thread_pool &mux_pool() {
+	static asio::thread_pool pool(
+		std::clamp(std::thread::hardware_concurrency() / 2, 1U, 4U));
+	return pool;
+}
+
+}  // namespace
+
+void Muxer::async_merge_impl(
+	std::function<bool(const ProgressCallback &)> job,
+	ProgressCallback progress, bool own_thread,
+	asio::any_completion_handler<void(Result<void>)> handler,
+	CompletionExecutor handler_ex) {
+	auto run = [job = std::move(job), progress = std::move(progress),
+				handler = std::move(handler),
+				handler_ex = std::move(handler_ex)]() mutable {
+		// Progress is delivered on the caller's executor, like completion
+		ProgressCallback forward;
+		if (progress) {
+			forward = [&progress, &handler_ex](const MuxProgress &p) {
+				asio::post(handler_ex, [progress, p] { progress(p); });
+			};
+		}
+		bool ok = job(forward);
+		asio::dispatch(asio::bind_executor(
+			handler_ex, [handler = std::move(handler), ok]() mutable {
+				if (ok) return handler(outcome::success());
+				handler(outcome::failure(errc::muxer_error));
+			}));
+	};
+	if (own_thread) {
+		// Owns its queues; cancelling them (or their downloads finishing)
+		// ends the merge and the thread with it
+		std::thread(std::move(run)).detach();
+		return;
+	}
+	asio::post(mux_pool(), std::move(run));
+}
+
 }  // namespace ytdlpp::media
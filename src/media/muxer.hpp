@@ -2,17 +2,113 @@
 
 #include <ytdlpp/ytdlpp_export.h>
 
+#include <boost/asio/any_completion_executor.hpp>
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <functional>
+#include <memory>
 #include <string>
+#include <ytdlpp/result.hpp>
 
 namespace ytdlpp::media {
 
+namespace asio = boost::asio;
+
+class StreamQueue;
+
+struct YTDLPP_EXPORT MuxProgress {
+	long long packets = 0;	   // Packets written to the output
+	long long bytes = 0;	   // Input bytes consumed
+	long long total_bytes = 0;	// Combined input size, 0 if unknown
+};
+
 class YTDLPP_EXPORT Muxer {
    public:
+	using CompletionExecutor = asio::any_io_executor;
+	using ProgressCallback = std::function<void(const MuxProgress &)>;
+
 	// Merges a video file and an audio file into a single output file.
 	// Returns true on success.
 	static bool merge(const std::string &video_path,
 					  const std::string &audio_path,
-					  const std::string &output_path);
+					  const std::string &output_path,
+					  const ProgressCallback &progress = {});
+
+	// Same, reading both inputs from download queues while they fill. Runs
+	// on a thread that may block; cancel a queue to abort.
+	static bool merge(StreamQueue &video, StreamQueue &audio,
+					  const std::string &output_path,
+					  const ProgressCallback &progress = {});
+
+	// Async merge of two files on the muxing thread pool. `progress` and
+	// the completion run on the handler's executor (default `ex`).
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<void>))
+				  CompletionToken>
+	static auto async_merge(asio::any_io_executor ex, std::string video_path,
+							std::string audio_path, std::string output_path,
+							ProgressCallback progress,
+							CompletionToken &&token) {
+		return initiate_merge(
+			std::move(ex),
+			[video_path = std::move(video_path),
+			 audio_path = std::move(audio_path),
+			 output_path =
+				 std::move(output_path)](const ProgressCallback &cb) {
+				return merge(video_path, audio_path, output_path, cb);
+			},
+			std::move(progress), false, std::forward<CompletionToken>(token));
+	}
+
+	// Async merge of two download queues (see StreamQueue). It lasts as long
+	// as the downloads, waiting on the network, so it gets a thread of its
+	// own instead of a muxing pool thread.
+	template <BOOST_ASIO_COMPLETION_TOKEN_FOR(void(Result<void>))
+				  CompletionToken>
+	static auto async_merge(asio::any_io_executor ex,
+							std::shared_ptr<StreamQueue> video,
+							std::shared_ptr<StreamQueue> audio,
+							std::string output_path, ProgressCallback progress,
+							CompletionToken &&token) {
+		return initiate_merge(
+			std::move(ex),
+			[video = std::move(video), audio = std::move(audio),
+			 output_path =
+				 std::move(output_path)](const ProgressCallback &cb) {
+				return merge(*video, *audio, output_path, cb);
+			},
+			std::move(progress), true, std::forward<CompletionToken>(token));
+	}
+
+   private:
+	template <typename CompletionToken>
+	static auto initiate_merge(
+		asio::any_io_executor ex,
+		std::function<bool(const ProgressCallback &)> job,
+		ProgressCallback progress, bool own_thread, CompletionToken &&token) {
+		return asio::async_initiate<CompletionToken, void(Result<void>)>(
+			[ex, job = std::move(job), progress = std::move(progress),
+			 own_thread](auto &&handler) mutable {
+				CompletionExecutor handler_ex =
+					asio::get_associated_executor(handler, ex);
+
+				auto any_handler =
+					asio::any_completion_handler<void(Result<void>)>{
+						std::forward<decltype(handler)>(handler)};
+
+				async_merge_impl(std::move(job), std::move(progress),
+								 own_thread, std::move(any_handler),
+								 std::move(handler_ex));
+			},
+			token);
+	}
+
+	static void async_merge_impl(
+		std::function<bool(const ProgressCallback &)> job,
+		ProgressCallback progress, bool own_thread,
+		asio::any_completion_handler<void(Result<void>)> handler,
+		CompletionExecutor handler_ex);
 };
 
 }  // namespace ytdlpp::media
@@ -0,0 +1,45 @@
+#include "queue_io.hpp"
+
+#include "stream_queue.hpp"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mem.h>
+}
+
+namespace ytdlpp::media {
+
+namespace {
+
+// Demuxer read size; the StreamQueue does the actual buffering
+constexpr int kReadBufferSize = 64 * 1024;
+
+int read_queue(void *opaque, uint8_t *buf, int size) {
+	int n = static_cast<StreamQueue *>(opaque)->read(buf, size);
+	if (n < 0) return AVERROR_EXIT;
+	if (n == 0) return AVERROR_EOF;
+	return n;
+}
+
+}  // namespace
+
+QueueIo::QueueIo(StreamQueue &queue) {
+	auto *buffer = static_cast<unsigned char *>(av_malloc(kReadBufferSize));
+	if (!buffer) return;
+	avio_ = avio_alloc_context(
+		buffer, kReadBufferSize, 0, &queue, read_queue, nullptr, nullptr);
+	if (!avio_) {
+		av_free(buffer);
+		return;
+	}
+	avio_->seekable = 0;
+}
+
+QueueIo::~QueueIo() {
+	if (!avio_) return;
+	// FFmpeg may have swapped the buffer; free whatever it holds now
+	av_freep(&avio_->buffer);
+	avio_context_free(&avio_);
+}
+
+}  // namespace ytdlpp::media
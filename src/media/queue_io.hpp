@@ -0,0 +1,31 @@
+#pragma once
+
+extern "C" {
+struct AVIOContext;
+}
+
+namespace ytdlpp::media {
+
+class StreamQueue;
+
+// Read-only, non-seekable AVIOContext pulling from a StreamQueue, so FFmpeg
+// demuxes bytes our HttpClient downloads. Attach it as `fmt_ctx->pb` with
+// AVFMT_FLAG_CUSTOM_IO and keep it alive until the format context is closed.
+// Reads block on the queue; cancelling the queue fails them with
+// AVERROR_EXIT.
+class QueueIo {
+   public:
+	explicit QueueIo(StreamQueue &queue);
+	~QueueIo();
+
+	QueueIo(const QueueIo &) = delete;
+	QueueIo &operator=(const QueueIo &) = delete;
+
+	// Null if allocation failed
+	[[nodiscard]] AVIOContext *get() const { return avio_; }
+
+   private:
+	AVIOContext *avio_{};
+};
+
+}  // namespace ytdlpp::media
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace ytdlpp::media {
+
+// =============================================================================
+// SPSC BYTE RING
+// =============================================================================
+// Fixed-capacity single-producer / single-consumer byte queue. One thread may
+// call write() while another calls read(); neither blocks or allocates. The
+// positions grow monotonically and are masked into the buffer, so capacity is
+// rounded up to a power of two.
+// =============================================================================
+
+class SpscByteRing {
+   public:
+	explicit SpscByteRing(size_t capacity)
+		: capacity_(round_up(capacity)),
+		  mask_(capacity_ - 1),
+		  data_(std::make_unique<uint8_t[]>(capacity_)) {}
+
+	SpscByteRing(const SpscByteRing &) = delete;
+	SpscByteRing &operator=(const SpscByteRing &) = delete;
+
+	[[nodiscard]] size_t capacity() const { return capacity_; }
+
+	// Producer: copy up to `size` bytes in; returns how many fit.
+	size_t write(const uint8_t *src, size_t size) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		size_t tail = tail_.load(std::memory_order_acquire);
+		size_t n = std::min(size, capacity_ - (head - tail));
+		copy_in(head, src, n);
+		head_.store(head + n, std::memory_order_release);
+		return n;
+	}
+
+	// Consumer: copy up to `size` bytes out; returns how many were read.
+	size_t read(uint8_t *dst, size_t size) {
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		size_t head = head_.load(std::memory_order_acquire);
+		size_t n = std::min(size, head - tail);
+		copy_out(tail, dst, n);
+		tail_.store(tail + n, std::memory_order_release);
+		return n;
+	}
+
+	// Consumer: copy up to `size` bytes out without consuming them.
+	size_t peek(uint8_t *dst, size_t size) const {
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		size_t head = head_.load(std::memory_order_acquire);
+		size_t n = std::min(size, head - tail);
+		copy_out(tail, dst, n);
+		return n;
+	}
+
+	[[nodiscard]] size_t readable() const {
+		return head_.load(std::memory_order_acquire) -
+			   tail_.load(std::memory_order_acquire);
+	}
+
+	[[nodiscard]] size_t writable() const { return capacity_ - readable(); }
+
+   private:
+	static size_t round_up(size_t v) {
+		size_t p = 1;
+		while (p < v) p <<= 1;
+		return p;
+	}
+
+	void copy_in(size_t pos, const uint8_t *src, size_t n) {
+		size_t off = pos & mask_;
+		size_t first = std::min(n, capacity_ - off);
+		std::memcpy(data_.get() + off, src, first);
+		std::memcpy(data_.get(), src + first, n - first);
+	}
+
+	void copy_out(size_t pos, uint8_t *dst, size_t n) const {
+		size_t off = pos & mask_;
+		size_t first = std::min(n, capacity_ - off);
+		std::memcpy(dst, data_.get() + off, first);
+		std::memcpy(dst + first, data_.get(), n - first);
+	}
+
+	const size_t capacity_;
+	const size_t mask_;
+	std::unique_ptr<uint8_t[]> data_;
+
+	// Separate cache lines so producer and consumer don't false-share
+	alignas(64) std::atomic<size_t> head_{0};  // Written by the producer
+	alignas(64) std::atomic<size_t> tail_{0};  // Written by the consumer
+};
+
+}  // namespace ytdlpp::media
@@ -0,0 +1,190 @@
+#include "stream_queue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ytdlpp::media {
+
+StreamQueue::StreamQueue(size_t capacity)
+	: capacity_(std::max<size_t>(capacity, 1)) {}
+
+Result<void> StreamQueue::preallocate(long long size) {
+	std::lock_guard lock(mutex_);
+	total_size_ = size;
+	return outcome::success();
+}
+
+Result<void> StreamQueue::write_at(
+	long long offset, const char *data, size_t size) {
+	std::vector<std::function<void()>> resumes;
+	{
+		std::lock_guard lock(mutex_);
+		if (cancelled_) return outcome::failure(errc::file_write_failed);
+
+		// A retried segment can overlap bytes we already hold; drop those.
+		if (offset < tail_) {
+			auto skip = static_cast<size_t>(
+				std::min<long long>(tail_ - offset, static_cast<long long>(size)));
+			offset += static_cast<long long>(skip);
+			data += skip;
+			size -= skip;
+		}
+		if (size == 0) return outcome::success();
+
+		if (offset > tail_) {
+			auto &slot = ahead_[offset];
+			if (slot.empty()) {
+				slot.assign(data, data + size);
+				ahead_bytes_ += size;
+			}
+			return outcome::success();
+		}
+
+		ready_.emplace_back(data, data + size);
+		ready_bytes_ += size;
+		tail_ += static_cast<long long>(size);
+
+		// Splice in slices the gap was holding back
+		while (!ahead_.empty() && ahead_.begin()->first <= tail_) {
+			auto node = ahead_.extract(ahead_.begin());
+			auto &chunk = node.mapped();
+			ahead_bytes_ -= chunk.size();
+			auto end = node.key() + static_cast<long long>(chunk.size());
+			if (end <= tail_) continue;
+			auto skip = static_cast<size_t>(tail_ - node.key());
+			if (skip > 0) chunk.erase(chunk.begin(), chunk.begin() + skip);
+			ready_bytes_ += chunk.size();
+			tail_ = end;
+			ready_.push_back(std::move(chunk));
+		}
+		resumes = take_ready_locked();
+		if (ready_bytes_ >= reader_min_) {
+			if (auto wake = take_reader_wake_locked()) {
+				resumes.push_back(std::move(wake));
+			}
+		}
+	}
+	cv_.notify_all();
+	for (auto &r : resumes) r();
+	return outcome::success();
+}
+
+bool StreamQueue::poll_readable(size_t min_bytes, std::function<void()> wake) {
+	std::lock_guard lock(mutex_);
+	// Writers park at capacity_, so never wait for more than that
+	min_bytes = std::min(min_bytes, capacity_);
+	if (cancelled_ || closed_ || ready_bytes_ >= min_bytes) return true;
+	if (wake) {
+		reader_wake_ = std::move(wake);
+		reader_min_ = min_bytes;
+	}
+	return false;
+}
+
+std::function<void()> StreamQueue::take_reader_wake_locked() {
+	auto wake = std::move(reader_wake_);
+	reader_wake_ = nullptr;
+	return wake;
+}
+
+bool StreamQueue::should_park_locked(long long next_offset) const {
+	if (cancelled_) return false;
+	// The connection filling the gap at the read position only waits for
+	// the reader; parking it behind slices it must precede would deadlock.
+	if (next_offset == tail_) return ready_bytes_ >= capacity_;
+	return ready_bytes_ + ahead_bytes_ >= capacity_;
+}
+
+bool StreamQueue::wants_more(
+	long long next_offset, std::function<void()> resume) {
+	std::lock_guard lock(mutex_);
+	if (!should_park_locked(next_offset)) return true;
+	waiters_.emplace_back(next_offset, std::move(resume));
+	return false;
+}
+
+std::vector<std::function<void()>> StreamQueue::take_ready_locked() {
+	std::vector<std::function<void()>> out;
+	auto it = std::remove_if(
+		waiters_.begin(), waiters_.end(), [&](Waiter &w) {
+			if (should_park_locked(w.first)) return false;
+			out.push_back(std::move(w.second));
+			return true;
+		});
+	waiters_.erase(it, waiters_.end());
+	return out;
+}
+
+void StreamQueue::abort() { cancel(); }
+
+Result<void> StreamQueue::close() {
+	std::function<void()> wake;
+	{
+		std::lock_guard lock(mutex_);
+		closed_ = true;
+		wake = take_reader_wake_locked();
+	}
+	cv_.notify_all();
+	if (wake) wake();
+	return outcome::success();
+}
+
+int StreamQueue::read(uint8_t *buf, int size) {
+	if (size <= 0) return 0;
+	std::vector<std::function<void()>> resumes;
+	int copied = 0;
+	{
+		std::unique_lock lock(mutex_);
+		cv_.wait(lock,
+				 [&] { return cancelled_ || closed_ || ready_bytes_ > 0; });
+		if (cancelled_) return -1;
+
+		while (copied < size && !ready_.empty()) {
+			auto &front = ready_.front();
+			size_t n = std::min(front.size() - front_pos_,
+								static_cast<size_t>(size - copied));
+			std::memcpy(buf + copied, front.data() + front_pos_, n);
+			copied += static_cast<int>(n);
+			front_pos_ += n;
+			ready_bytes_ -= n;
+			if (front_pos_ == front.size()) {
+				ready_.pop_front();
+				front_pos_ = 0;
+			}
+		}
+		resumes = take_ready_locked();
+	}
+	for (auto &r : resumes) r();
+	return copied;
+}
+
+void StreamQueue::cancel() {
+	std::vector<std::function<void()>> resumes;
+	{
+		std::lock_guard lock(mutex_);
+		cancelled_ = true;
+		ready_.clear();
+		ahead_.clear();
+		ready_bytes_ = ahead_bytes_ = 0;
+		for (auto &w : waiters_) resumes.push_back(std::move(w.second));
+		waiters_.clear();
+		if (auto wake = take_reader_wake_locked()) {
+			resumes.push_back(std::move(wake));
+		}
+	}
+	cv_.notify_all();
+	// Parked connections resume, hit the failing write and end the download
+	for (auto &r : resumes) r();
+}
+
+long long StreamQueue::total_size() const {
+	std::lock_guard lock(mutex_);
+	return total_size_;
+}
+
+size_t StreamQueue::buffered() const {
+	std::lock_guard lock(mutex_);
+	return ready_bytes_ + ahead_bytes_;
+}
+
+}  // namespace ytdlpp::media
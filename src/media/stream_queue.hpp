@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <ytdlpp/file_sink.hpp>
+
+namespace ytdlpp::media {
+
+// =============================================================================
+// STREAM QUEUE
+// =============================================================================
+// Bounded in-memory pipe between a download and an FFmpeg demuxer. The HTTP
+// side writes through the FileSink interface; slices that arrive ahead of the
+// read position (parallel Range segments) are held until the gap before them
+// fills. The muxer thread reads the contiguous bytes in order, blocking while
+// the queue is empty. Once `capacity` bytes are buffered, connections are
+// parked through FileSink::wants_more() until the reader drains the queue.
+// =============================================================================
+
+class StreamQueue final : public net::FileSink {
+   public:
+	explicit StreamQueue(size_t capacity);
+
+	// FileSink (download strand)
+	Result<void> preallocate(long long size) override;
+	Result<void> write_at(
+		long long offset, const char *data, size_t size) override;
+	bool wants_more(
+		long long next_offset, std::function<void()> resume) override;
+	// A failed download cancels the queue, so the reader fails instead of
+	// taking the close() that follows for the end of a short stream
+	void abort() override;
+	Result<void> close() override;
+
+	// Reader side. Blocks until data is available; returns the number of
+	// bytes copied, 0 at end of stream or -1 once cancelled.
+	int read(uint8_t *buf, int size);
+
+	// Non-blocking reader check: true if `min_bytes` are readable in order or
+	// the stream has ended. Otherwise `wake` (if set) is invoked once, from
+	// the writing thread, when that becomes true.
+	bool poll_readable(size_t min_bytes, std::function<void()> wake);
+
+	// Abort both sides: the reader fails and further writes fail the
+	// download.
+	void cancel();
+
+	/// Total stream size if the server reported it, else -1.
+	[[nodiscard]] long long total_size() const;
+
+	/// Bytes received and not yet read, including those held ahead.
+	[[nodiscard]] size_t buffered() const;
+
+   private:
+	using Waiter = std::pair<long long, std::function<void()>>;
+
+	[[nodiscard]] bool should_park_locked(long long next_offset) const;
+	std::vector<std::function<void()>> take_ready_locked();
+	std::function<void()> take_reader_wake_locked();
+
+	const size_t capacity_;
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+
+	std::deque<std::vector<char>> ready_;	  // Contiguous, in read order
+	size_t front_pos_ = 0;					  // Consumed part of ready_[0]
+	size_t ready_bytes_ = 0;				  // Unread bytes in ready_
+	std::map<long long, std::vector<char>> ahead_;	// Keyed by offset
+	size_t ahead_bytes_ = 0;
+	long long tail_ = 0;  // Offset of the first byte not yet received
+
+	std::vector<Waiter> waiters_;
+	std::function<void()> reader_wake_;
+	size_t reader_min_ = 0;
+	long long total_size_ = -1;
+	bool closed_ = false;
+	bool cancelled_ = false;
+};
+
+}  // namespace ytdlpp::media
@@ -0,0 +1,164 @@
+#include "net/bandwidth_scheduler.hpp"
+
+#include <algorithm>
+
+namespace ytdlpp::net {
+
+class BandwidthScheduler::Job {
+   public:
+	Bucket bucket;	// Guarded by the scheduler's mutex
+};
+
+void BandwidthScheduler::Bucket::set_rate(uint64_t bytes_per_second) {
+	rate = static_cast<double>(bytes_per_second);
+	tokens = rate > 0 ? std::min(tokens, capacity()) : 0;
+}
+
+// One round of the rate (at least one slice), so an idle download cannot
+// save up a burst
+double BandwidthScheduler::Bucket::capacity() const {
+	return std::max(rate * std::chrono::duration<double>(kRound).count(),
+					static_cast<double>(kMinSlice));
+}
+
+void BandwidthScheduler::Bucket::refill(Clock::time_point now) {
+	if (rate > 0) {
+		auto elapsed = std::chrono::duration<double>(now - refilled).count();
+		tokens = std::min(capacity(), tokens + rate * elapsed);
+	}
+	refilled = now;
+}
+
+void BandwidthScheduler::Bucket::charge(size_t bytes) {
+	if (rate > 0) tokens -= static_cast<double>(bytes);
+}
+
+BandwidthScheduler::Clock::duration BandwidthScheduler::Bucket::debt_time()
+	const {
+	if (!in_debt()) return Clock::duration::zero();
+	return std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(-tokens / rate));
+}
+
+BandwidthScheduler::BandwidthScheduler(asio::any_io_executor ex)
+	: timer_(std::move(ex)) {}
+
+BandwidthScheduler::~BandwidthScheduler() = default;
+
+void BandwidthScheduler::set_limits(BandwidthLimits limits) {
+	std::lock_guard lock(mutex_);
+	limits_ = limits;
+	total_.set_rate(limits.total);
+	prune_jobs_locked();
+	for (const auto &w : jobs_) {
+		if (auto job = w.lock()) job->bucket.set_rate(limits.per_download);
+	}
+	limited_.store(limits.total > 0 || limits.per_download > 0,
+				   std::memory_order_relaxed);
+	// Parked connections re-check against the new rates
+	if (!waiters_.empty()) arm_timer_locked();
+}
+
+std::shared_ptr<BandwidthScheduler::Job> BandwidthScheduler::add_job() {
+	auto job = std::make_shared<Job>();
+	std::lock_guard lock(mutex_);
+	job->bucket.set_rate(limits_.per_download);
+	prune_jobs_locked();
+	jobs_.push_back(job);
+	return job;
+}
+
+bool BandwidthScheduler::consume(const std::shared_ptr<Job> &job,
+								 size_t bytes, std::function<void()> resume) {
+	if (!limited_.load(std::memory_order_relaxed)) return true;
+
+	std::lock_guard lock(mutex_);
+	auto now = Clock::now();
+	total_.refill(now);
+	job->bucket.refill(now);
+	total_.charge(bytes);
+	job->bucket.charge(bytes);
+
+	// While others wait on the shared bucket, take a place in line
+	bool contended = total_.rate > 0 && !waiters_.empty();
+	if (!contended && !total_.in_debt() && !job->bucket.in_debt()) {
+		return true;
+	}
+	waiters_.push_back({job, std::move(resume)});
+	arm_timer_locked();
+	return false;
+}
+
+size_t BandwidthScheduler::slice_limit(int connections) const {
+	if (!limited_.load(std::memory_order_relaxed)) return 0;
+
+	std::lock_guard lock(mutex_);
+	prune_jobs_locked();
+	double share = 0;
+	if (limits_.total > 0) {
+		share = static_cast<double>(limits_.total) /
+				static_cast<double>(std::max<size_t>(1, jobs_.size()));
+	}
+	if (limits_.per_download > 0) {
+		auto own = static_cast<double>(limits_.per_download);
+		share = share > 0 ? std::min(share, own) : own;
+	}
+	if (share <= 0) return 0;
+	share /= std::max(1, connections);
+	auto slice = static_cast<size_t>(
+		share * std::chrono::duration<double>(kRound).count());
+	return std::max(slice, kMinSlice);
+}
+
+void BandwidthScheduler::prune_jobs_locked() const {
+	jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(),
+							   [](const auto &w) { return w.expired(); }),
+				jobs_.end());
+}
+
+// Wake up when the first waiter can go; a later deadline keeps the timer
+void BandwidthScheduler::arm_timer_locked() {
+	auto wait = Clock::duration::max();
+	for (const auto &w : waiters_) {
+		wait = std::min(
+			wait, std::max(total_.debt_time(), w.job->bucket.debt_time()));
+	}
+	auto deadline = Clock::now() + wait;
+	if (timer_armed_ && deadline >= timer_deadline_) return;
+
+	timer_armed_ = true;
+	timer_deadline_ = deadline;
+	timer_.expires_at(deadline);
+	timer_.async_wait(
+		[self = shared_from_this()](const boost::system::error_code &ec) {
+			// Superseded by an earlier deadline
+			if (ec == asio::error::operation_aborted) return;
+			self->on_timer();
+		});
+}
+
+void BandwidthScheduler::on_timer() {
+	std::vector<std::function<void()>> ready;
+	{
+		std::lock_guard lock(mutex_);
+		timer_armed_ = false;
+		auto now = Clock::now();
+		total_.refill(now);
+
+		// Everyone the shared bucket can afford goes this round, in order
+		std::vector<Waiter> still;
+		for (auto &w : waiters_) {
+			w.job->bucket.refill(now);
+			if (!total_.in_debt() && !w.job->bucket.in_debt()) {
+				ready.push_back(std::move(w.resume));
+			} else {
+				still.push_back(std::move(w));
+			}
+		}
+		waiters_ = std::move(still);
+		if (!waiters_.empty()) arm_timer_locked();
+	}
+	for (auto &resume : ready) resume();
+}
+
+}  // namespace ytdlpp::net
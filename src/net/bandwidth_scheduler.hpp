@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ytdlpp/http_client.hpp>
+
+namespace ytdlpp::net {
+
+// =============================================================================
+// BANDWIDTH SCHEDULER
+// =============================================================================
+// Token buckets shared by an HttpClient's downloads: one for the client
+// (BandwidthLimits::total) and one per download (per_download). Workers
+// charge each body slice after reading it. A download that has run its own
+// bucket or the client's into debt parks its connection until refills pay
+// the debt off, so the average rate holds while TCP flow control pushes
+// back on the server.
+//
+// Parked connections resume in the order they parked and go to the back of
+// the line after their next slice, so under the total limit every connection
+// gets one slice per round. slice_limit() sizes a slice to a short round of
+// the download's share split across its connections, so each download gets
+// an equal share however many connections it opened.
+// =============================================================================
+
+class BandwidthScheduler
+	: public std::enable_shared_from_this<BandwidthScheduler> {
+   public:
+	using Clock = std::chrono::steady_clock;
+
+	// A download's own bucket; it stops counting towards the fair share
+	// once dropped
+	class Job;
+
+	explicit BandwidthScheduler(asio::any_io_executor ex);
+	~BandwidthScheduler();
+
+	BandwidthScheduler(const BandwidthScheduler &) = delete;
+	BandwidthScheduler &operator=(const BandwidthScheduler &) = delete;
+
+	/// New limits apply to running downloads as well.
+	void set_limits(BandwidthLimits limits);
+
+	std::shared_ptr<Job> add_job();
+
+	/// Charge `bytes` just received by `job`. True to keep reading; false
+	/// parks the connection, and `resume` is called once it may go on.
+	bool consume(const std::shared_ptr<Job> &job, size_t bytes,
+				 std::function<void()> resume);
+
+	/// Largest read worth issuing while limited (0 = no limit): about one
+	/// kRound of the download's share, split across its `connections`.
+	[[nodiscard]] size_t slice_limit(int connections = 1) const;
+
+	static constexpr auto kRound = std::chrono::milliseconds(50);
+	static constexpr size_t kMinSlice = 16 * 1024;
+
+   private:
+	struct Bucket {
+		double rate = 0;	// Bytes per second, 0 = unlimited
+		double tokens = 0;	// Negative while in debt
+		Clock::time_point refilled = Clock::now();
+
+		void set_rate(uint64_t bytes_per_second);
+		[[nodiscard]] double capacity() const;
+		void refill(Clock::time_point now);
+		void charge(size_t bytes);
+		[[nodiscard]] bool in_debt() const { return rate > 0 && tokens < 0; }
+		// Until the debt is paid, zero if there is none
+		[[nodiscard]] Clock::duration debt_time() const;
+	};
+
+	struct Waiter {
+		std::shared_ptr<Job> job;
+		std::function<void()> resume;
+	};
+
+	void prune_jobs_locked() const;
+	void arm_timer_locked();
+	void on_timer();
+
+	asio::steady_timer timer_;
+	std::atomic<bool> limited_{false};	// Fast path while no limit is set
+
+	mutable std::mutex mutex_;
+	BandwidthLimits limits_;
+	Bucket total_;
+	mutable std::vector<std::weak_ptr<Job>> jobs_;
+	std::vector<Waiter> waiters_;  // In the order they parked
+	bool timer_armed_ = false;
+	Clock::time_point timer_deadline_;
+};
+
+}  // namespace ytdlpp::net
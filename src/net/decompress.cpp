@@ -0,0 +1,126 @@
+#include "net/decompress.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ytdlpp::net {
+
+namespace {
+
+// zlib writes into a scratch buffer of this size; only the bytes it produced
+// are appended, so reserved capacity is never zero-filled
+constexpr size_t kScratchSize = 32768;
+
+// zlib header: CM = 8 (deflate) and the 16-bit header is a multiple of 31
+bool looks_like_zlib(unsigned char b0, unsigned char b1) {
+	return (b0 & 0x0f) == 8 && ((b0 << 8) | b1) % 31 == 0;
+}
+
+bool looks_like_gzip(unsigned char b0, unsigned char b1) {
+	return b0 == 0x1f && b1 == 0x8b;
+}
+
+}  // namespace
+
+Inflater::Encoding Inflater::parse_encoding(
+	std::string_view content_encoding) {
+	if (content_encoding == "gzip" || content_encoding == "x-gzip") {
+		return Encoding::gzip;
+	}
+	if (content_encoding == "deflate") return Encoding::deflate;
+	if (!content_encoding.empty() && content_encoding != "identity") {
+		spdlog::debug("Unknown Content-Encoding: {}, passing body through",
+					  content_encoding);
+	}
+	return Encoding::identity;
+}
+
+Inflater::Inflater(Encoding encoding) : encoding_(encoding) {}
+
+Inflater::~Inflater() {
+	if (initialized_) inflateEnd(&zs_);
+}
+
+bool Inflater::init_stream(int window_bits) {
+	if (inflateInit2(&zs_, window_bits) != Z_OK) {
+		spdlog::warn("Failed to init zlib for {} decompression",
+					 window_bits < 0 ? "deflate" : "gzip");
+		return false;
+	}
+	initialized_ = true;
+	return true;
+}
+
+bool Inflater::feed(const char *data, size_t size, std::string &out) {
+	if (encoding_ == Encoding::identity) {
+		out.append(data, size);
+		return true;
+	}
+	if (done_ || size == 0) return true;
+
+	if (!initialized_) {
+		// "deflate" is sent both zlib-wrapped (RFC) and raw (some servers),
+		// gzip occasionally as "deflate" too; sniff the first two bytes.
+		header_probe_.append(data, size);
+		if (header_probe_.size() < 2) return true;
+
+		auto b0 = static_cast<unsigned char>(header_probe_[0]);
+		auto b1 = static_cast<unsigned char>(header_probe_[1]);
+		int window_bits = -MAX_WBITS;  // raw deflate
+		if (looks_like_gzip(b0, b1) || looks_like_zlib(b0, b1)) {
+			window_bits = 32 + MAX_WBITS;  // auto-detect gzip/zlib header
+		}
+		if (!init_stream(window_bits)) return false;
+
+		std::string probe = std::move(header_probe_);
+		header_probe_.clear();
+		return inflate_into(probe.data(), probe.size(), out);
+	}
+
+	return inflate_into(data, size, out);
+}
+
+bool Inflater::inflate_into(const char *data, size_t size, std::string &out) {
+	zs_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	zs_.avail_in = static_cast<uInt>(size);
+
+	if (!scratch_) scratch_ = std::make_unique<char[]>(kScratchSize);
+	while (zs_.avail_in > 0 && !done_) {
+		zs_.next_out = reinterpret_cast<Bytef *>(scratch_.get());
+		zs_.avail_out = static_cast<uInt>(kScratchSize);
+
+		int ret = inflate(&zs_, Z_NO_FLUSH);
+		// Reserved capacity from Content-Length is used before anything is
+		// reallocated
+		out.append(scratch_.get(), kScratchSize - zs_.avail_out);
+
+		if (ret == Z_STREAM_END) {
+			done_ = true;
+		} else if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+				   ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+			spdlog::warn("zlib inflate error: {}", ret);
+			return false;
+		} else if (ret == Z_BUF_ERROR && zs_.avail_out != 0) {
+			break;	// Needs more input
+		}
+	}
+	return true;
+}
+
+std::string decompress_body(const std::string &body,
+							const std::string &content_encoding) {
+	Inflater inflater(Inflater::parse_encoding(content_encoding));
+	if (inflater.encoding() == Inflater::Encoding::identity) return body;
+
+	std::string out;
+	out.reserve(body.size() * 4);  // Estimate 4x compression
+	if (!inflater.feed(body.data(), body.size(), out)) {
+		spdlog::warn("{} decompression failed, returning raw body",
+					 content_encoding);
+		return body;
+	}
+	spdlog::debug("Decompressed {}: {} -> {} bytes", content_encoding,
+				  body.size(), out.size());
+	return out;
+}
+
+}  // namespace ytdlpp::net
@@ -0,0 +1,147 @@
+#pragma once
+
+// Incremental gzip/deflate decoding for HTTP response bodies.
+//
+// `Inflater` decodes a Content-Encoding stream chunk by chunk through a small
+// scratch buffer and appends to the destination string, so a response never
+// exists as two full copies. `InflatingBody` plugs it into Beast: the body
+// reader inflates every buffer the parser hands it during async_read, and the
+// message's body() is already decoded when the read completes.
+
+#include <zlib.h>
+
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ytdlpp::net {
+
+class Inflater {
+   public:
+	enum class Encoding { identity, gzip, deflate };
+
+	// Map a Content-Encoding value; unknown encodings pass through.
+	static Encoding parse_encoding(std::string_view content_encoding);
+
+	explicit Inflater(Encoding encoding);
+	~Inflater();
+
+	Inflater(const Inflater &) = delete;
+	Inflater &operator=(const Inflater &) = delete;
+
+	// Decode `size` bytes and append the output to `out`.
+	// Returns false on corrupt input.
+	bool feed(const char *data, size_t size, std::string &out);
+
+	// True once the compressed stream signalled its end.
+	[[nodiscard]] bool done() const { return done_; }
+	[[nodiscard]] Encoding encoding() const { return encoding_; }
+
+   private:
+	bool init_stream(int window_bits);
+	bool inflate_into(const char *data, size_t size, std::string &out);
+
+	Encoding encoding_;
+	z_stream zs_{};
+	bool initialized_ = false;
+	bool done_ = false;
+	std::unique_ptr<char[]> scratch_;  // Allocated on the first inflate
+	// The first bytes decide between zlib/gzip headers and raw deflate
+	std::string header_probe_;
+};
+
+// One-shot helper for bodies that are already complete.
+// Returns the raw body when decoding fails.
+std::string decompress_body(const std::string &body,
+							const std::string &content_encoding);
+
+// Beast Body whose reader inflates as body bytes arrive.
+struct InflatingBody {
+	using value_type = std::string;
+
+	static std::uint64_t size(const value_type &body) { return body.size(); }
+
+	class reader {
+	   public:
+		// Beast builds the reader together with the parser, before the
+		// header is parsed, so Content-Encoding is looked up in init().
+		template <bool isRequest, class Fields>
+		reader(boost::beast::http::header<isRequest, Fields> &h,
+			   value_type &body)
+			: body_(body),
+			  header_(&h),
+			  encoding_of_(&encoding_of<isRequest, Fields>) {}
+
+		void init(const boost::optional<std::uint64_t> &content_length,
+				  boost::beast::error_code &ec) {
+			ec = {};
+			inflater_.emplace(
+				Inflater::parse_encoding(encoding_of_(header_)));
+			if (!content_length) return;
+			// Text responses inflate roughly 4x; cap the guess so a bogus
+			// Content-Length cannot reserve gigabytes up front.
+			constexpr std::uint64_t kMaxReserve = 16 * 1024 * 1024;
+			std::uint64_t guess =
+				inflater_->encoding() == Inflater::Encoding::identity
+					? *content_length
+					: *content_length * 4;
+			body_.reserve(
+				static_cast<size_t>(std::min(guess, kMaxReserve)));
+		}
+
+		template <class ConstBufferSequence>
+		std::size_t put(const ConstBufferSequence &buffers,
+						boost::beast::error_code &ec) {
+			std::size_t total = 0;
+			for (auto const buffer : boost::beast::buffers_range_ref(buffers)) {
+				const char *data = static_cast<const char *>(buffer.data());
+				received_ = received_ || buffer.size() > 0;
+				if (!inflater_->feed(data, buffer.size(), body_)) {
+					ec = boost::system::errc::make_error_code(
+						boost::system::errc::illegal_byte_sequence);
+					return total;
+				}
+				total += buffer.size();
+			}
+			ec = {};
+			return total;
+		}
+
+		// A compressed body that ended before its stream did is truncated
+		void finish(boost::beast::error_code &ec) {
+			ec = {};
+			if (received_ &&
+				inflater_->encoding() != Inflater::Encoding::identity &&
+				!inflater_->done()) {
+				ec = boost::beast::http::error::partial_message;
+			}
+		}
+
+	   private:
+		template <bool isRequest, class Fields>
+		static std::string_view encoding_of(const void *h) {
+			auto value = static_cast<
+				const boost::beast::http::header<isRequest, Fields> *>(h)
+				->operator[](boost::beast::http::field::content_encoding);
+			return {value.data(), value.size()};
+		}
+
+		value_type &body_;
+		const void *header_;
+		std::string_view (*encoding_of_)(const void *);
+		std::optional<Inflater> inflater_;
+		bool received_ = false;
+	};
+};
+
+}  // namespace ytdlpp::net
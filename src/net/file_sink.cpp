@@ -0,0 +1,170 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <ytdlpp/file_sink.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace ytdlpp::net {
+
+namespace {
+
+#ifdef _WIN32
+
+class NativeFileSink final : public FileSink {
+   public:
+	explicit NativeFileSink(HANDLE handle) : handle_(handle) {}
+	~NativeFileSink() override { (void)close(); }
+
+	Result<void> preallocate(long long size) override {
+		if (handle_ == INVALID_HANDLE_VALUE || size <= 0)
+			return outcome::success();
+		// Reserves the clusters without moving EOF, so a short download
+		// doesn't leave a zero-filled tail.
+		FILE_ALLOCATION_INFO info{};
+		info.AllocationSize.QuadPart = size;
+		if (!SetFileInformationByHandle(
+				handle_, FileAllocationInfo, &info, sizeof(info))) {
+			DWORD err = GetLastError();
+			if (err == ERROR_DISK_FULL)
+				return outcome::failure(errc::file_write_failed);
+			spdlog::debug("Preallocation of {} bytes failed: {}", size, err);
+		}
+		return outcome::success();
+	}
+
+	Result<void> write_at(
+		long long offset, const char *data, size_t size) override {
+		while (size > 0) {
+			// Positional write: the OVERLAPPED offset replaces the seek
+			OVERLAPPED ov{};
+			ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFLL);
+			ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD chunk = static_cast<DWORD>(
+				std::min<size_t>(size, std::numeric_limits<DWORD>::max()));
+			DWORD written = 0;
+			if (!WriteFile(handle_, data, chunk, &written, &ov) ||
+				written == 0) {
+				return outcome::failure(errc::file_write_failed);
+			}
+			data += written;
+			size -= written;
+			offset += written;
+		}
+		return outcome::success();
+	}
+
+	Result<void> close() override {
+		if (handle_ == INVALID_HANDLE_VALUE) return outcome::success();
+		bool ok = CloseHandle(handle_) != 0;
+		handle_ = INVALID_HANDLE_VALUE;
+		if (!ok) return outcome::failure(errc::file_write_failed);
+		return outcome::success();
+	}
+
+   private:
+	HANDLE handle_;
+};
+
+#else
+
+class NativeFileSink final : public FileSink {
+   public:
+	explicit NativeFileSink(int fd) : fd_(fd) {}
+	~NativeFileSink() override { (void)close(); }
+
+	Result<void> preallocate(long long size) override {
+		if (fd_ < 0 || size <= 0) return outcome::success();
+#ifdef __linux__
+		// fallocate() rather than posix_fallocate(): glibc emulates the
+		// latter by writing every block when the filesystem can't allocate.
+		// KEEP_SIZE reserves the blocks without moving EOF, like the Windows
+		// sink, so a short download doesn't leave a zero-filled tail.
+		int rc = ::fallocate(
+			fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size));
+		int err = rc == 0 ? 0 : errno;
+#else
+		// Moves EOF; close() cuts the file back to what was written
+		int err = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+#endif
+		preallocated_ = true;
+		if (err == ENOSPC) return outcome::failure(errc::file_write_failed);
+		if (err != 0) {
+			// Unsupported by the filesystem; writes still extend the file
+			spdlog::debug("Preallocation of {} bytes failed: {}", size,
+						  std::strerror(err));
+		}
+		return outcome::success();
+	}
+
+	Result<void> write_at(
+		long long offset, const char *data, size_t size) override {
+		while (size > 0) {
+			ssize_t n = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				return outcome::failure(errc::file_write_failed);
+			}
+			data += n;
+			size -= static_cast<size_t>(n);
+			offset += n;
+		}
+		end_ = std::max(end_, offset);
+		return outcome::success();
+	}
+
+	Result<void> close() override {
+		if (fd_ < 0) return outcome::success();
+		// Releases reserved blocks past the written end (and, without
+		// KEEP_SIZE, the zero tail of a download that stopped short)
+		if (preallocated_ && ::ftruncate(fd_, static_cast<off_t>(end_)) != 0) {
+			spdlog::debug("Truncating to {} bytes failed: {}", end_,
+						  std::strerror(errno));
+		}
+		int rc = ::close(fd_);
+		fd_ = -1;
+		if (rc != 0) return outcome::failure(errc::file_write_failed);
+		return outcome::success();
+	}
+
+   private:
+	int fd_;
+	bool preallocated_ = false;
+	long long end_ = 0;	 // Past the furthest byte written
+};
+
+#endif
+
+}  // namespace
+
+Result<std::shared_ptr<FileSink>> open_file_sink(const std::string &path) {
+#ifdef _WIN32
+	auto wide = std::filesystem::u8path(path).wstring();
+	HANDLE handle =
+		CreateFileW(wide.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+					CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return outcome::failure(errc::file_open_failed);
+	return std::make_shared<NativeFileSink>(handle);
+#else
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+					0644);
+	if (fd < 0) return outcome::failure(errc::file_open_failed);
+	return std::make_shared<NativeFileSink>(fd);
+#endif
+}
+
+}  // namespace ytdlpp::net
@@ -0,0 +1,376 @@
+#include "net/http2_session.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace asio = boost::asio;
+
+namespace ytdlpp::net {
+
+namespace {
+
+constexpr unsigned char kAlpnProtos[] = {2,	  'h', '2', 8,	 'h', 't',
+										 't', 'p', '/', '1', '.', '1'};
+
+nghttp2_nv make_nv(const std::string &name, const std::string &value) {
+	return {reinterpret_cast<uint8_t *>(const_cast<char *>(name.data())),
+			reinterpret_cast<uint8_t *>(const_cast<char *>(value.data())),
+			name.size(), value.size(), NGHTTP2_NV_FLAG_NONE};
+}
+
+// Connection-specific fields are forbidden in HTTP/2 (RFC 9113 8.2.2)
+bool is_connection_header(const std::string &name) {
+	return name == "host" || name == "connection" || name == "keep-alive" ||
+		   name == "proxy-connection" || name == "transfer-encoding" ||
+		   name == "upgrade";
+}
+
+}  // namespace
+
+void Http2Session::offer_alpn(Stream &stream) {
+	SSL_set_alpn_protos(stream.native_handle(), kAlpnProtos,
+						sizeof(kAlpnProtos));
+}
+
+bool Http2Session::negotiated(Stream &stream) {
+	const unsigned char *proto = nullptr;
+	unsigned int len = 0;
+	SSL_get0_alpn_selected(stream.native_handle(), &proto, &len);
+	return len == 2 && std::memcmp(proto, "h2", 2) == 0;
+}
+
+Http2Session::Http2Session(std::unique_ptr<Stream> stream,
+						   std::string authority)
+	: stream_(std::move(stream)),
+	  authority_(std::move(authority)),
+	  idle_timer_(stream_->get_executor()) {}
+
+Http2Session::~Http2Session() {
+	if (session_) nghttp2_session_del(session_);
+}
+
+bool Http2Session::start() {
+	nghttp2_session_callbacks *cbs = nullptr;
+	if (nghttp2_session_callbacks_new(&cbs) != 0) return false;
+	nghttp2_session_callbacks_set_on_header_callback(cbs, &on_header);
+	nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+		cbs, &on_data_chunk);
+	nghttp2_session_callbacks_set_on_stream_close_callback(
+		cbs, &on_stream_close);
+	nghttp2_session_callbacks_set_on_frame_recv_callback(cbs, &on_frame_recv);
+
+	int rv = nghttp2_session_client_new(&session_, cbs, this);
+	nghttp2_session_callbacks_del(cbs);
+	if (rv != 0) {
+		spdlog::warn("nghttp2 session init failed: {}", nghttp2_strerror(rv));
+		return false;
+	}
+
+	nghttp2_settings_entry iv[] = {
+		{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100},
+		{NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, 1 << 20},
+	};
+	nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, iv, std::size(iv));
+	// Widen the connection window too; responses are hundreds of KB
+	nghttp2_session_set_local_window_size(
+		session_, NGHTTP2_FLAG_NONE, 0, 4 << 20);
+
+	// The connection lives as long as it is useful, not per request
+	beast::get_lowest_layer(*stream_).expires_never();
+
+	spdlog::debug("HTTP/2 connection established to {}", authority_);
+	asio::dispatch(stream_->get_executor(), [self = shared_from_this()] {
+		self->flush();
+		self->do_read();
+	});
+	return true;
+}
+
+void Http2Session::submit(http::verb method, std::string path,
+						  std::map<std::string, std::string> headers,
+						  std::string body, Callback cb) {
+	asio::dispatch(
+		stream_->get_executor(),
+		[self = shared_from_this(), method, path = std::move(path),
+		 headers = std::move(headers), body = std::move(body),
+		 cb = std::move(cb)]() mutable {
+			self->do_submit(method, path, headers, std::move(body),
+							std::move(cb));
+		});
+}
+
+void Http2Session::do_submit(http::verb method, const std::string &path,
+							 const std::map<std::string, std::string> &headers,
+							 std::string body, Callback cb) {
+	if (closed_.load(std::memory_order_acquire)) {
+		return cb(outcome::failure(make_error_code(errc::request_failed)));
+	}
+
+	// Names and values must outlive nghttp2_submit_request (it copies them)
+	const std::string method_s(http::to_string(method));
+	const std::string scheme = "https";
+	std::vector<std::pair<std::string, std::string>> fields;
+	fields.reserve(headers.size());
+	for (const auto &[name, value] : headers) {
+		std::string lower = name;
+		std::transform(lower.begin(), lower.end(), lower.begin(),
+					   [](unsigned char c) { return std::tolower(c); });
+		if (is_connection_header(lower)) continue;
+		fields.emplace_back(std::move(lower), value);
+	}
+
+	static const std::string kMethod = ":method", kScheme = ":scheme",
+							 kAuthority = ":authority", kPath = ":path";
+	std::vector<nghttp2_nv> nva;
+	nva.reserve(fields.size() + 4);
+	nva.push_back(make_nv(kMethod, method_s));
+	nva.push_back(make_nv(kScheme, scheme));
+	nva.push_back(make_nv(kAuthority, authority_));
+	nva.push_back(make_nv(kPath, path));
+	for (const auto &[name, value] : fields) {
+		nva.push_back(make_nv(name, value));
+	}
+
+	auto state = std::make_unique<StreamState>();
+	state->cb = std::move(cb);
+	state->body_out = std::move(body);
+
+	nghttp2_data_provider provider{};
+	nghttp2_data_provider *provider_ptr = nullptr;
+	if (!state->body_out.empty()) {
+		provider.source.ptr = state.get();
+		provider.read_callback = &read_body;
+		provider_ptr = &provider;
+	}
+
+	int32_t stream_id = nghttp2_submit_request(
+		session_, nullptr, nva.data(), nva.size(), provider_ptr, state.get());
+	if (stream_id < 0) {
+		spdlog::warn("nghttp2_submit_request failed: {}",
+					 nghttp2_strerror(stream_id));
+		return state->cb(
+			outcome::failure(make_error_code(errc::request_failed)));
+	}
+
+	idle_timer_.cancel();
+	streams_.emplace(stream_id, std::move(state));
+	flush();
+}
+
+void Http2Session::do_read() {
+	stream_->async_read_some(
+		asio::buffer(read_buf_),
+		beast::bind_front_handler(&Http2Session::on_read, shared_from_this()));
+}
+
+void Http2Session::on_read(beast::error_code ec, std::size_t n) {
+	if (ec) {
+		if (ec != asio::error::operation_aborted) {
+			spdlog::debug("HTTP/2 connection to {} closed: {}", authority_,
+						  ec.message());
+		}
+		return fail_all(make_error_code(errc::request_failed));
+	}
+
+	ssize_t rv = nghttp2_session_mem_recv(session_, read_buf_.data(), n);
+	if (rv < 0) {
+		spdlog::warn("nghttp2_session_mem_recv failed: {}",
+					 nghttp2_strerror(static_cast<int>(rv)));
+		return fail_all(make_error_code(errc::request_failed));
+	}
+
+	flush();
+	if (nghttp2_session_want_read(session_) ||
+		nghttp2_session_want_write(session_)) {
+		do_read();
+	} else {
+		fail_all(make_error_code(errc::request_failed));
+	}
+}
+
+void Http2Session::flush() {
+	if (writing_ || !session_) return;
+
+	// mem_send's buffer is only valid until the next call, so copy out
+	for (;;) {
+		const uint8_t *data = nullptr;
+		ssize_t len = nghttp2_session_mem_send(session_, &data);
+		if (len < 0) {
+			spdlog::warn("nghttp2_session_mem_send failed: {}",
+						 nghttp2_strerror(static_cast<int>(len)));
+			return fail_all(make_error_code(errc::request_failed));
+		}
+		if (len == 0) break;
+		write_buf_.append(reinterpret_cast<const char *>(data),
+						  static_cast<size_t>(len));
+	}
+	if (write_buf_.empty()) return;
+
+	writing_ = true;
+	asio::async_write(
+		*stream_, asio::buffer(write_buf_),
+		beast::bind_front_handler(&Http2Session::on_write, shared_from_this()));
+}
+
+void Http2Session::on_write(beast::error_code ec, std::size_t) {
+	writing_ = false;
+	write_buf_.clear();
+	if (ec) return fail_all(make_error_code(errc::request_failed));
+	flush();
+}
+
+void Http2Session::fail_all(std::error_code ec) {
+	closed_.store(true, std::memory_order_release);
+	idle_timer_.cancel();
+	auto streams = std::move(streams_);
+	streams_.clear();
+	for (auto &[id, state] : streams) {
+		if (state->cb) state->cb(outcome::failure(ec));
+	}
+	beast::error_code ignored;
+	beast::get_lowest_layer(*stream_).socket().close(ignored);
+}
+
+void Http2Session::close() {
+	asio::dispatch(stream_->get_executor(), [self = shared_from_this()] {
+		if (self->closed_.load(std::memory_order_acquire)) return;
+		if (self->session_) {
+			nghttp2_session_terminate_session(self->session_,
+											  NGHTTP2_NO_ERROR);
+		}
+		self->fail_all(make_error_code(errc::request_failed));
+	});
+}
+
+void Http2Session::arm_idle_timer() {
+	idle_timer_.expires_after(kIdleTimeout);
+	idle_timer_.async_wait(
+		[self = shared_from_this()](beast::error_code ec) {
+			if (ec || !self->streams_.empty()) return;
+			spdlog::debug("Closing idle HTTP/2 connection to {}",
+						  self->authority_);
+			self->close();
+		});
+}
+
+int Http2Session::on_header(nghttp2_session *session,
+							const nghttp2_frame *frame, const uint8_t *name,
+							size_t namelen, const uint8_t *value,
+							size_t valuelen, uint8_t, void * /*user_data*/) {
+	if (frame->hd.type != NGHTTP2_HEADERS ||
+		frame->headers.cat != NGHTTP2_HCAT_RESPONSE) {
+		return 0;
+	}
+	auto *state = static_cast<StreamState *>(
+		nghttp2_session_get_stream_user_data(session, frame->hd.stream_id));
+	if (!state) return 0;
+
+	std::string_view n(reinterpret_cast<const char *>(name), namelen);
+	std::string_view v(reinterpret_cast<const char *>(value), valuelen);
+	if (n == ":status") {
+		state->res.status_code = std::atoi(std::string(v).c_str());
+	} else {
+		state->res.headers[std::string(n)] = std::string(v);
+	}
+	return 0;
+}
+
+int Http2Session::on_data_chunk(nghttp2_session *session, uint8_t,
+								int32_t stream_id, const uint8_t *data,
+								size_t len, void * /*user_data*/) {
+	auto *state = static_cast<StreamState *>(
+		nghttp2_session_get_stream_user_data(session, stream_id));
+	if (!state) return 0;
+	if (!state->inflater) {
+		auto &headers = state->res.headers;
+		auto enc_it = headers.find("content-encoding");
+		state->inflater.emplace(Inflater::parse_encoding(
+			enc_it != headers.end() ? enc_it->second : std::string{}));
+		auto len_it = headers.find("content-length");
+		if (len_it != headers.end()) {
+			auto len = std::strtoull(len_it->second.c_str(), nullptr, 10);
+			bool identity =
+				state->inflater->encoding() == Inflater::Encoding::identity;
+			state->res.body.reserve(std::min<unsigned long long>(
+				identity ? len : len * 4, 16 * 1024 * 1024));
+		}
+	}
+	if (!state->inflater->feed(reinterpret_cast<const char *>(data), len,
+							   state->res.body)) {
+		// Corrupt body; reset the stream, on_stream_close reports the error
+		nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream_id,
+								  NGHTTP2_INTERNAL_ERROR);
+	}
+	return 0;
+}
+
+int Http2Session::on_stream_close(nghttp2_session *, int32_t stream_id,
+								  uint32_t error_code, void *user_data) {
+	auto *self = static_cast<Http2Session *>(user_data);
+	auto it = self->streams_.find(stream_id);
+	if (it == self->streams_.end()) return 0;
+
+	auto state = std::move(it->second);
+	self->streams_.erase(it);
+
+	// A compressed body that ends before its trailer is truncated, as in
+	// InflatingBody::reader::finish
+	bool truncated = state->inflater &&
+					 state->inflater->encoding() !=
+						 Inflater::Encoding::identity &&
+					 !state->inflater->done();
+	if (error_code != NGHTTP2_NO_ERROR || state->res.status_code == 0) {
+		spdlog::debug("HTTP/2 stream {} closed with error {}", stream_id,
+					  nghttp2_http2_strerror(error_code));
+		state->cb(outcome::failure(make_error_code(errc::request_failed)));
+	} else if (truncated) {
+		spdlog::debug("HTTP/2 stream {} ended inside its compressed body",
+					  stream_id);
+		state->cb(outcome::failure(make_error_code(errc::request_failed)));
+	} else {
+		state->cb(std::move(state->res));
+	}
+
+	if (self->streams_.empty() && !self->closed_.load()) {
+		self->arm_idle_timer();
+	}
+	return 0;
+}
+
+int Http2Session::on_frame_recv(nghttp2_session *, const nghttp2_frame *frame,
+								void *user_data) {
+	if (frame->hd.type == NGHTTP2_GOAWAY) {
+		auto *self = static_cast<Http2Session *>(user_data);
+		spdlog::debug(
+			"HTTP/2 GOAWAY from {}, draining {} stream(s)", self->authority_,
+			self->streams_.size());
+		// No new streams; in-flight ones below last_stream_id still complete
+		self->closed_.store(true, std::memory_order_release);
+	}
+	return 0;
+}
+
+ssize_t Http2Session::read_body(nghttp2_session *, int32_t, uint8_t *buf,
+								size_t length, uint32_t *data_flags,
+								nghttp2_data_source *source, void *) {
+	auto *state = static_cast<StreamState *>(source->ptr);
+	size_t remaining = state->body_out.size() - state->body_off;
+	size_t n = std::min(length, remaining);
+	std::memcpy(buf, state->body_out.data() + state->body_off, n);
+	state->body_off += n;
+	if (state->body_off == state->body_out.size()) {
+		*data_flags |= NGHTTP2_DATA_FLAG_EOF;
+	}
+	return static_cast<ssize_t>(n);
+}
+
+}  // namespace ytdlpp::net
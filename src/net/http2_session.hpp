@@ -0,0 +1,109 @@
+#pragma once
+
+// HTTP/2 transport for HttpClient (built with YTDLPP_ENABLE_HTTP2).
+//
+// An Http2Session owns one TLS connection on which ALPN selected "h2" and
+// multiplexes any number of requests onto it through nghttp2. HttpClient keeps
+// one session per origin, so concurrent innertube POSTs and the watch page
+// share a single socket and handshake.
+
+#include <nghttp2/nghttp2.h>
+
+#include <atomic>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/ssl.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ytdlpp/http_client.hpp>
+
+#include "net/decompress.hpp"
+
+namespace ytdlpp::net {
+
+class Http2Session : public std::enable_shared_from_this<Http2Session> {
+   public:
+	using Stream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+	// Invoked on the connection's executor; the body is already inflated.
+	using Callback = std::function<void(Result<HttpResponse>)>;
+
+	static constexpr auto kIdleTimeout = std::chrono::seconds(30);
+
+	// Advertise "h2, http/1.1" on a stream before its handshake.
+	static void offer_alpn(Stream &stream);
+	// True if the completed handshake selected "h2".
+	[[nodiscard]] static bool negotiated(Stream &stream);
+
+	Http2Session(std::unique_ptr<Stream> stream, std::string authority);
+	~Http2Session();
+
+	Http2Session(const Http2Session &) = delete;
+	Http2Session &operator=(const Http2Session &) = delete;
+
+	// Set up nghttp2, send the preface and SETTINGS, and start reading.
+	bool start();
+
+	// Queue a request; safe to call from any thread.
+	void submit(boost::beast::http::verb method, std::string path,
+				std::map<std::string, std::string> headers, std::string body,
+				Callback cb);
+
+	// False once the peer sent GOAWAY or the connection failed.
+	[[nodiscard]] bool is_usable() const {
+		return !closed_.load(std::memory_order_acquire);
+	}
+
+	void close();
+
+   private:
+	struct StreamState {
+		Callback cb;
+		HttpResponse res{0, {}, {}};
+		std::string body_out;
+		size_t body_off = 0;
+		std::optional<Inflater> inflater;  // Created with the first DATA
+	};
+
+	void do_submit(boost::beast::http::verb method, const std::string &path,
+				   const std::map<std::string, std::string> &headers,
+				   std::string body, Callback cb);
+	void do_read();
+	void on_read(boost::beast::error_code ec, std::size_t n);
+	void flush();
+	void on_write(boost::beast::error_code ec, std::size_t);
+	void fail_all(std::error_code ec);
+	void arm_idle_timer();
+
+	static int on_header(nghttp2_session *, const nghttp2_frame *frame,
+						 const uint8_t *name, size_t namelen,
+						 const uint8_t *value, size_t valuelen, uint8_t,
+						 void *user_data);
+	static int on_data_chunk(nghttp2_session *, uint8_t, int32_t stream_id,
+							 const uint8_t *data, size_t len, void *user_data);
+	static int on_stream_close(nghttp2_session *, int32_t stream_id,
+							   uint32_t error_code, void *user_data);
+	static int on_frame_recv(nghttp2_session *, const nghttp2_frame *frame,
+							 void *user_data);
+	static ssize_t read_body(nghttp2_session *, int32_t stream_id,
+							 uint8_t *buf, size_t length, uint32_t *data_flags,
+							 nghttp2_data_source *source, void *user_data);
+
+	std::unique_ptr<Stream> stream_;
+	std::string authority_;
+	nghttp2_session *session_ = nullptr;
+	boost::asio::steady_timer idle_timer_;
+
+	std::unordered_map<int32_t, std::unique_ptr<StreamState>> streams_;
+	std::vector<uint8_t> read_buf_ = std::vector<uint8_t>(64 * 1024);
+	std::string write_buf_;
+	bool writing_ = false;
+	std::atomic<bool> closed_{false};
+};
+
+}  // namespace ytdlpp::net
@@ -1,9 +1,10 @@
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
-#include <zlib.h>
 
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/post.hpp>
 #include <boost/asio/ssl/error.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core/bind_handler.hpp>
 #include <boost/beast/core/buffers_to_string.hpp>
@@ -14,12 +15,25 @@
 #include <boost/certify/extensions.hpp>
 #include <boost/certify/https_verification.hpp>
 #include <boost/url.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <ctime>
+#include <deque>
 #include <fstream>
+#include <optional>
 #include <ytdlpp/http_client.hpp>
+#include <ytdlpp/trace.hpp>
 
+#include "net/bandwidth_scheduler.hpp"
+#include "net/decompress.hpp"
+#include "net/http_replay.hpp"
 #include "utils.hpp"
 
+#ifdef YTDLPP_ENABLE_HTTP2
+#include "net/http2_session.hpp"
+#endif
+
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace asio = boost::asio;
@@ -28,140 +42,6 @@ using tcp = asio::ip::tcp;
 
 namespace ytdlpp::net {
 
-// =============================================================================
-// GZIP/DEFLATE DECOMPRESSION
-// =============================================================================
-// Decompresses gzip or deflate encoded HTTP response bodies.
-// This reduces bandwidth usage by ~50% for text-based responses.
-// =============================================================================
-
-namespace {
-
-// Decompress gzip or deflate data
-std::optional<std::string> decompress_gzip(const std::string &compressed) {
-	if (compressed.empty()) return std::string{};
-
-	z_stream zs{};
-	// 16 + MAX_WBITS enables gzip decoding
-	if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
-		spdlog::warn("Failed to init zlib for gzip decompression");
-		return std::nullopt;
-	}
-
-	zs.next_in =
-		reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
-	zs.avail_in = static_cast<uInt>(compressed.size());
-
-	std::string decompressed;
-	decompressed.reserve(compressed.size() * 4);  // Estimate 4x compression
-
-	constexpr size_t kChunkSize = 32768;
-	char outbuffer[kChunkSize];
-
-	int ret;
-	do {
-		zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-		zs.avail_out = kChunkSize;
-
-		ret = inflate(&zs, Z_NO_FLUSH);
-
-		if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
-			inflateEnd(&zs);
-			spdlog::warn("zlib inflate error: {}", ret);
-			return std::nullopt;
-		}
-
-		size_t have = kChunkSize - zs.avail_out;
-		decompressed.append(outbuffer, have);
-	} while (ret != Z_STREAM_END);
-
-	inflateEnd(&zs);
-	return decompressed;
-}
-
-// Decompress raw deflate data (no gzip header)
-std::optional<std::string> decompress_deflate(const std::string &compressed) {
-	if (compressed.empty()) return std::string{};
-
-	z_stream zs{};
-	// -MAX_WBITS for raw deflate (no header)
-	if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
-		spdlog::warn("Failed to init zlib for deflate decompression");
-		return std::nullopt;
-	}
-
-	zs.next_in =
-		reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
-	zs.avail_in = static_cast<uInt>(compressed.size());
-
-	std::string decompressed;
-	decompressed.reserve(compressed.size() * 4);
-
-	constexpr size_t kChunkSize = 32768;
-	char outbuffer[kChunkSize];
-
-	int ret;
-	do {
-		zs.next_out = reinterpret_cast<Bytef *>(outbuffer);
-		zs.avail_out = kChunkSize;
-
-		ret = inflate(&zs, Z_NO_FLUSH);
-
-		if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
-			inflateEnd(&zs);
-			spdlog::warn("zlib deflate error: {}", ret);
-			return std::nullopt;
-		}
-
-		size_t have = kChunkSize - zs.avail_out;
-		decompressed.append(outbuffer, have);
-	} while (ret != Z_STREAM_END);
-
-	inflateEnd(&zs);
-	return decompressed;
-}
-
-// Decompress based on Content-Encoding header
-std::string decompress_body(const std::string &body,
-							const std::string &content_encoding) {
-	if (content_encoding.empty() || content_encoding == "identity") {
-		return body;
-	}
-
-	if (content_encoding == "gzip" || content_encoding == "x-gzip") {
-		if (auto result = decompress_gzip(body)) {
-			spdlog::debug("Decompressed gzip: {} -> {} bytes", body.size(),
-						  result->size());
-			return *result;
-		}
-		spdlog::warn("gzip decompression failed, returning raw body");
-		return body;
-	}
-
-	if (content_encoding == "deflate") {
-		// Try gzip first (some servers send gzip as deflate)
-		if (auto result = decompress_gzip(body)) {
-			spdlog::debug("Decompressed deflate (gzip): {} -> {} bytes",
-						  body.size(), result->size());
-			return *result;
-		}
-		// Fall back to raw deflate
-		if (auto result = decompress_deflate(body)) {
-			spdlog::debug("Decompressed deflate: {} -> {} bytes", body.size(),
-						  result->size());
-			return *result;
-		}
-		spdlog::warn("deflate decompression failed, returning raw body");
-		return body;
-	}
-
-	spdlog::debug(
-		"Unknown Content-Encoding: {}, returning raw body", content_encoding);
-	return body;
-}
-
-}  // namespace
-
 // Connection pool entry
 struct PooledConnection {
 	std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream;
@@ -192,11 +72,16 @@ class DnsCache {
 		std::lock_guard lock(mutex_);
 		auto key = host + ":" + port;
 		auto it = cache_.find(key);
-		if (it == cache_.end()) { return std::nullopt; }
+		if (it == cache_.end()) {
+			misses_.fetch_add(1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
 		if (std::chrono::steady_clock::now() > it->second.expires_at) {
 			cache_.erase(it);
+			misses_.fetch_add(1, std::memory_order_relaxed);
 			return std::nullopt;
 		}
+		hits_.fetch_add(1, std::memory_order_relaxed);
 		spdlog::debug("DNS cache hit for {}", key);
 		return it->second.results;
 	}
@@ -242,6 +127,13 @@ class DnsCache {
 		cache_.erase(host + ":" + port);
 	}
 
+	[[nodiscard]] uint64_t hits() const {
+		return hits_.load(std::memory_order_relaxed);
+	}
+	[[nodiscard]] uint64_t misses() const {
+		return misses_.load(std::memory_order_relaxed);
+	}
+
    private:
 	void evict_expired() {
 		auto now = std::chrono::steady_clock::now();
@@ -256,6 +148,8 @@ class DnsCache {
 
 	std::mutex mutex_;
 	std::unordered_map<std::string, DnsCacheEntry> cache_;
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> misses_{0};
 };
 
 // Global DNS cache (shared across all HttpClient instances)
@@ -264,6 +158,115 @@ static DnsCache &get_dns_cache() {
 	return instance;
 }
 
+// =============================================================================
+// TLS SESSION CACHE
+// =============================================================================
+// Keeps the most recent SSL_SESSION (TLS 1.2 session / TLS 1.3 ticket) per SNI
+// host so reconnects and new download segments resume with an abbreviated
+// handshake instead of a full key exchange. One cache is bound to each
+// ssl::context through its app data; OpenSSL hands us new sessions via the
+// new-session callback.
+// =============================================================================
+
+class TlsSessionCache {
+   public:
+	static constexpr size_t kMaxCacheSize = 128;
+
+	TlsSessionCache() = default;
+	TlsSessionCache(const TlsSessionCache &) = delete;
+	TlsSessionCache &operator=(const TlsSessionCache &) = delete;
+
+	~TlsSessionCache() {
+		for (auto &[host, sess] : cache_) { SSL_SESSION_free(sess); }
+	}
+
+	// Install the cache on a client context.
+	void attach(ssl::context &ctx) {
+		SSL_CTX *native = ctx.native_handle();
+		SSL_CTX_set_app_data(native, this);
+		SSL_CTX_set_session_cache_mode(
+			native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(native, &TlsSessionCache::on_new_session);
+	}
+
+	static TlsSessionCache *from(ssl::context &ctx) {
+		return static_cast<TlsSessionCache *>(
+			SSL_CTX_get_app_data(ctx.native_handle()));
+	}
+
+	// Offer the cached session for `host` on a not-yet-handshaken stream.
+	void apply(SSL *ssl, const std::string &host) {
+		std::lock_guard lock(mutex_);
+		auto it = cache_.find(host);
+		if (it == cache_.end()) return;
+		if (!SSL_SESSION_is_resumable(it->second) ||
+			is_expired(it->second)) {
+			SSL_SESSION_free(it->second);
+			cache_.erase(it);
+			return;
+		}
+		SSL_set_session(ssl, it->second);
+	}
+
+	// Count a completed handshake as resumed or full.
+	void record(SSL *ssl) {
+		if (SSL_session_reused(ssl)) {
+			hits_.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			misses_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Drop the session for a host whose handshake failed.
+	void invalidate(const std::string &host) {
+		std::lock_guard lock(mutex_);
+		auto it = cache_.find(host);
+		if (it == cache_.end()) return;
+		SSL_SESSION_free(it->second);
+		cache_.erase(it);
+	}
+
+	[[nodiscard]] TlsResumptionStats stats() const {
+		return {hits_.load(std::memory_order_relaxed),
+				misses_.load(std::memory_order_relaxed)};
+	}
+
+   private:
+	static int on_new_session(SSL *ssl, SSL_SESSION *sess) {
+		auto *self = static_cast<TlsSessionCache *>(
+			SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+		const char *host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+		if (!self || !host) return 0;
+		self->store(host, sess);
+		return 1;  // We keep the reference
+	}
+
+	static bool is_expired(const SSL_SESSION *sess) {
+		auto now = static_cast<long>(std::time(nullptr));
+		return now >= SSL_SESSION_get_time(sess) + SSL_SESSION_get_timeout(sess);
+	}
+
+	void store(const std::string &host, SSL_SESSION *sess) {
+		std::lock_guard lock(mutex_);
+		auto it = cache_.find(host);
+		if (it != cache_.end()) {
+			SSL_SESSION_free(it->second);
+			it->second = sess;
+			return;
+		}
+		if (cache_.size() >= kMaxCacheSize) {
+			SSL_SESSION_free(cache_.begin()->second);
+			cache_.erase(cache_.begin());
+		}
+		cache_.emplace(host, sess);
+	}
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, SSL_SESSION *> cache_;
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> misses_{0};
+};
+
 // Forward declaration for session cancellation interface
 class IActiveSession {
    public:
@@ -271,9 +274,87 @@ class IActiveSession {
 	virtual void cancel() = 0;
 };
 
+// =============================================================================
+// CLIENT COUNTERS
+// =============================================================================
+// Relaxed atomics behind HttpClient::stats(). Sessions hold a reference, as
+// they may finish after the client is gone. A host's counters are looked up
+// (or created) under the mutex once per session, when its host is known, and
+// never move; finishing a request only bumps atomics.
+// =============================================================================
+
+struct HttpCounters {
+	struct Transfer {
+		std::atomic<uint64_t> requests{0};
+		std::atomic<uint64_t> failures{0};
+		std::atomic<uint64_t> bytes{0};
+		std::atomic<int64_t> nanos{0};
+
+		void add(bool ok, uint64_t size, std::chrono::nanoseconds elapsed) {
+			requests.fetch_add(1, std::memory_order_relaxed);
+			if (!ok) failures.fetch_add(1, std::memory_order_relaxed);
+			bytes.fetch_add(size, std::memory_order_relaxed);
+			nanos.fetch_add(elapsed.count(), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] HttpTransferStats load() const {
+			HttpTransferStats out;
+			out.requests = requests.load(std::memory_order_relaxed);
+			out.failures = failures.load(std::memory_order_relaxed);
+			out.bytes = bytes.load(std::memory_order_relaxed);
+			out.time = std::chrono::nanoseconds(
+				nanos.load(std::memory_order_relaxed));
+			return out;
+		}
+	};
+
+	std::atomic<uint64_t> pool_hits{0};
+	std::atomic<uint64_t> pool_misses{0};
+	std::atomic<uint64_t> active_requests{0};
+	std::atomic<uint64_t> active_downloads{0};
+	Transfer total;
+
+	// Count one finished request or download to `host`
+	void record(Transfer &host, bool ok, uint64_t size,
+				std::chrono::nanoseconds elapsed) {
+		total.add(ok, size, elapsed);
+		host.add(ok, size, elapsed);
+	}
+
+	void load_hosts(std::map<std::string, HttpTransferStats> &out) {
+		std::lock_guard lock(mutex_);
+		for (const auto &[host, counters] : hosts_) {
+			out[host] = counters->load();
+		}
+	}
+
+	// Takes the mutex: resolve once per session, not per request
+	Transfer &host_counters(const std::string &host) {
+		std::lock_guard lock(mutex_);
+		auto it = hosts_.find(host);
+		if (it != hosts_.end()) return *it->second;
+		// googlevideo hosts are per cache node; keep the label set bounded
+		const std::string &key =
+			hosts_.size() < HttpClientStats::kMaxHosts ? host : kOther;
+		auto &slot = hosts_[key];
+		if (!slot) slot = std::make_unique<Transfer>();
+		return *slot;
+	}
+
+   private:
+	static inline const std::string kOther = "other";
+	std::mutex mutex_;
+	std::map<std::string, std::unique_ptr<Transfer>> hosts_;
+};
+
 struct HttpClient::Impl {
 	asio::any_io_executor ex;
 	ssl::context ssl_ctx;
+	TlsSessionCache tls_sessions;
+	std::shared_ptr<HttpCounters> counters = std::make_shared<HttpCounters>();
+	// Download rate limits (HttpClient::set_bandwidth_limits)
+	std::shared_ptr<BandwidthScheduler> bandwidth =
+		std::make_shared<BandwidthScheduler>(ex);
 
 	// Connection pool: host:port -> list of connections
 	std::mutex pool_mutex_;
@@ -286,6 +367,43 @@ struct HttpClient::Impl {
 	std::vector<std::weak_ptr<IActiveSession>> active_sessions_;
 	std::atomic<bool> shutdown_requested_{false};
 
+	// Record/replay (HttpClient::set_replay); null when off
+	std::shared_ptr<HttpReplayStore> replay;
+
+#ifdef YTDLPP_ENABLE_HTTP2
+	// One multiplexed HTTP/2 connection per origin (host:port)
+	std::mutex h2_mutex_;
+	std::unordered_map<std::string, std::shared_ptr<Http2Session>>
+		h2_sessions_;
+
+	std::shared_ptr<Http2Session> acquire_h2(const std::string &host,
+											 const std::string &port) {
+		std::lock_guard lock(h2_mutex_);
+		auto it = h2_sessions_.find(host + ":" + port);
+		if (it == h2_sessions_.end()) return nullptr;
+		if (!it->second->is_usable()) {
+			h2_sessions_.erase(it);
+			return nullptr;
+		}
+		return it->second;
+	}
+
+	// Register a fresh h2 connection. If another request raced us to the
+	// same origin, keep whichever is already usable.
+	std::shared_ptr<Http2Session> register_h2(
+		const std::string &host, const std::string &port,
+		std::shared_ptr<Http2Session> session) {
+		std::lock_guard lock(h2_mutex_);
+		auto &slot = h2_sessions_[host + ":" + port];
+		if (slot && slot->is_usable()) {
+			session->close();
+			return slot;
+		}
+		slot = std::move(session);
+		return slot;
+	}
+#endif
+
 	Impl(asio::any_io_executor e)
 		: ex(std::move(e)), ssl_ctx(ssl::context::tlsv12_client) {
 		boost::system::error_code ec;
@@ -302,6 +420,7 @@ struct HttpClient::Impl {
 		}
 
 		boost::certify::enable_native_https_server_verification(ssl_ctx);
+		tls_sessions.attach(ssl_ctx);
 	}
 
 	void register_session(std::weak_ptr<IActiveSession> session) {
@@ -338,12 +457,62 @@ struct HttpClient::Impl {
 			}
 			conn_pool_.clear();
 		}
+
+#ifdef YTDLPP_ENABLE_HTTP2
+		{
+			std::lock_guard lock(h2_mutex_);
+			for (auto &[key, session] : h2_sessions_) { session->close(); }
+			h2_sessions_.clear();
+		}
+#endif
 	}
 
 	[[nodiscard]] bool is_shutdown() const {
 		return shutdown_requested_.load(std::memory_order_acquire);
 	}
 
+	// Answer from the recordings after the configured latency and transfer
+	// time; requests that were never recorded fail.
+	void replay_request(
+		std::string_view method, const std::string &url,
+		const std::string &body,
+		asio::any_completion_handler<void(Result<HttpResponse>)> handler,
+		HttpClient::CompletionExecutor handler_ex) {
+		auto res = replay->find(method, url, body);
+		auto delay = std::chrono::nanoseconds(replay->options().latency);
+		if (res) {
+			delay += replay->transfer_time(res->body.size());
+		} else {
+			spdlog::warn("Replay: No recording of {} {}", method, url);
+		}
+
+		auto timer = std::make_shared<asio::steady_timer>(ex, delay);
+		timer->async_wait([timer, res = std::move(res),
+						   handler = std::move(handler),
+						   handler_ex](beast::error_code) mutable {
+			Result<HttpResponse> result =
+				res ? Result<HttpResponse>(std::move(*res))
+					: outcome::failure(errc::request_failed);
+			asio::dispatch(handler_ex, [handler = std::move(handler),
+										result = std::move(result)]() mutable {
+				handler(std::move(result));
+			});
+		});
+	}
+
+	// Save the response once the request completes
+	asio::any_completion_handler<void(Result<HttpResponse>)> recording(
+		std::string_view method, std::string url, std::string body,
+		asio::any_completion_handler<void(Result<HttpResponse>)> handler) {
+		return [store = replay, method = std::string(method),
+				url = std::move(url), body = std::move(body),
+				handler = std::move(handler)](
+				   Result<HttpResponse> res) mutable {
+			if (res.has_value()) store->save(method, url, body, res.value());
+			handler(std::move(res));
+		};
+	}
+
 	// Get a pooled connection or nullptr if none available
 	std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> acquire_connection(
 		const std::string &host, const std::string &port) {
@@ -359,12 +528,15 @@ struct HttpClient::Impl {
 					auto stream = std::move(conn.stream);
 					it->second.pop_back();
 					spdlog::debug("Reusing pooled connection for {}", key);
+					counters->pool_hits.fetch_add(
+						1, std::memory_order_relaxed);
 					return stream;
 				}
 				// Stale, discard
 				it->second.pop_back();
 			}
 		}
+		counters->pool_misses.fetch_add(1, std::memory_order_relaxed);
 		return nullptr;
 	}
 
@@ -372,7 +544,7 @@ struct HttpClient::Impl {
 	void release_connection(
 		const std::string &host, const std::string &port,
 		std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream) {
-		if (!stream) return;
+		if (!stream || is_shutdown()) return;
 		std::lock_guard lock(pool_mutex_);
 		std::string key = host + ":" + port;
 		auto &conns = conn_pool_[key];
@@ -435,6 +607,7 @@ struct HttpClient::Impl {
 					std::make_unique<beast::ssl_stream<beast::tcp_stream>>(
 						ex, ssl_ctx);
 				boost::certify::set_server_hostname(*stream_ptr, host);
+				tls_sessions.apply(stream_ptr->native_handle(), host);
 
 				beast::get_lowest_layer(*stream_ptr).connect(results, ec);
 				if (ec)
@@ -445,9 +618,12 @@ struct HttpClient::Impl {
 					.expires_after(std::chrono::seconds(30));
 
 				stream_ptr->handshake(ssl::stream_base::client, ec);
-				if (ec)
+				if (ec) {
+					tls_sessions.invalidate(host);
 					return outcome::failure(
 						make_error_code(errc::request_failed));
+				}
+				tls_sessions.record(stream_ptr->native_handle());
 			}
 
 			boost::system::error_code ec;
@@ -476,9 +652,9 @@ struct HttpClient::Impl {
 			if (ec)
 				return outcome::failure(make_error_code(errc::request_failed));
 
-			// Receive
+			// Receive (the body is inflated while it is read)
 			beast::flat_buffer buffer;
-			http::response<http::string_body> res;
+			http::response<InflatingBody> res;
 			http::read(stream, buffer, res, ec);
 			if (ec)
 				return outcome::failure(make_error_code(errc::request_failed));
@@ -491,17 +667,6 @@ struct HttpClient::Impl {
 				stream.shutdown(ec);
 			}
 
-			// Get Content-Encoding header
-			std::string content_encoding;
-			auto encoding_it = res.find(http::field::content_encoding);
-			if (encoding_it != res.end()) {
-				content_encoding = std::string(encoding_it->value());
-			}
-
-			// Decompress body if needed
-			std::string response_body =
-				decompress_body(res.body(), content_encoding);
-
 			// Convert headers
 			std::map<std::string, std::string> res_headers;
 			for (auto const &field : res) {
@@ -509,8 +674,8 @@ struct HttpClient::Impl {
 					std::string(field.value());
 			}
 
-			return HttpResponse{
-				static_cast<int>(res.result_int()), response_body, res_headers};
+			return HttpResponse{static_cast<int>(res.result_int()),
+								std::move(res.body()), res_headers};
 
 		} catch (const std::exception &e) {
 			spdlog::error("Request exception: {}", e.what());
@@ -520,11 +685,18 @@ struct HttpClient::Impl {
 };
 
 HttpClient::HttpClient(asio::any_io_executor ex)
-	: m_impl(std::make_unique<Impl>(std::move(ex))) {}
+	: m_impl(std::make_shared<Impl>(std::move(ex))) {}
 
-HttpClient::~HttpClient() = default;
+// Requests still in flight fail instead of outliving the pool and caches
+HttpClient::~HttpClient() { shutdown(); }
 HttpClient::HttpClient(HttpClient &&) noexcept = default;
-HttpClient &HttpClient::operator=(HttpClient &&) noexcept = default;
+HttpClient &HttpClient::operator=(HttpClient &&other) noexcept {
+	if (this != &other) {
+		shutdown();
+		m_impl = std::move(other.m_impl);
+	}
+	return *this;
+}
 
 asio::any_io_executor HttpClient::get_executor() const { return m_impl->ex; }
 
@@ -532,26 +704,77 @@ void HttpClient::shutdown() {
 	if (m_impl) { m_impl->shutdown(); }
 }
 
+TlsResumptionStats HttpClient::tls_resumption_stats() const {
+	return m_impl->tls_sessions.stats();
+}
+
+HttpClientStats HttpClient::stats() const {
+	auto &c = *m_impl->counters;
+	HttpClientStats out;
+	out.pool_hits = c.pool_hits.load(std::memory_order_relaxed);
+	out.pool_misses = c.pool_misses.load(std::memory_order_relaxed);
+	out.dns_hits = get_dns_cache().hits();
+	out.dns_misses = get_dns_cache().misses();
+	out.tls = m_impl->tls_sessions.stats();
+	out.active_requests = c.active_requests.load(std::memory_order_relaxed);
+	out.active_downloads = c.active_downloads.load(std::memory_order_relaxed);
+	out.total = c.total.load();
+	c.load_hosts(out.hosts);
+	return out;
+}
+
+void HttpClient::set_replay(HttpReplayOptions options) {
+	if (options.mode == HttpReplayOptions::Mode::off) {
+		m_impl->replay.reset();
+		return;
+	}
+	if (options.mode == HttpReplayOptions::Mode::record) {
+		spdlog::info("Recording HTTP traffic to {}", options.directory);
+	} else {
+		spdlog::info("Replaying HTTP traffic from {}", options.directory);
+	}
+	m_impl->replay = std::make_shared<HttpReplayStore>(std::move(options));
+}
+
+void HttpClient::set_bandwidth_limits(BandwidthLimits limits) {
+	m_impl->bandwidth->set_limits(limits);
+}
+
+// =============================================================================
+// ASYNC REQUEST SESSION
+// =============================================================================
+// Takes a keep-alive connection from the pool when one is available and returns
+// it afterwards, so a warm client only pays one TCP + TLS handshake per host.
+// A pooled connection may have been closed by the server while idle; in that
+// case the request is retried once on a fresh connection.
+// =============================================================================
+
 class RequestSession : public IActiveSession,
 					   public std::enable_shared_from_this<RequestSession> {
    public:
 	using CompletionExecutor = asio::any_completion_executor;
 
-	RequestSession(HttpClient::Impl *impl, const asio::any_io_executor &ex,
-				   ssl::context &ctx,
+	RequestSession(const std::shared_ptr<HttpClient::Impl> &impl,
+				   const asio::any_io_executor &ex,
 				   asio::any_completion_handler<void(Result<HttpResponse>)> cb,
 				   CompletionExecutor handler_ex)
 		: impl_(impl),
+		  counters_(impl->counters),
 		  strand_(asio::make_strand(ex)),
 		  resolver_(strand_),
-		  stream_(strand_, ctx),
 		  cb_(std::move(cb)),
-		  handler_ex_(std::move(handler_ex)) {}
+		  handler_ex_(std::move(handler_ex)) {
+		counters_->active_requests.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	~RequestSession() override {
+		counters_->active_requests.fetch_sub(1, std::memory_order_relaxed);
+	}
 
 	void cancel() override {
 		// Cancel resolver and stream operations
 		resolver_.cancel();
-		beast::get_lowest_layer(stream_).cancel();
+		if (stream_) beast::get_lowest_layer(*stream_).cancel();
 	}
 
 	void run(http::verb method, const std::string &url_str,
@@ -579,6 +802,7 @@ class RequestSession : public IActiveSession,
 		req_.target(target);
 		req_.set(http::field::host, host);
 		req_.set(http::field::user_agent, "yt-dlpp/1.0");
+		req_.set(http::field::connection, "keep-alive");
 		// Request compressed responses to save bandwidth
 		req_.set(http::field::accept_encoding, "gzip, deflate");
 		for (const auto &[key, value] : headers) { req_.set(key, value); }
@@ -587,24 +811,69 @@ class RequestSession : public IActiveSession,
 			req_.prepare_payload();
 		}
 
-		// Set SNI
-		if (!SSL_set_tlsext_host_name(stream_.native_handle(), host.c_str())) {
+		// Store host/port for pooling and DNS caching
+		host_ = host;
+		port_ = port;
+		host_stats_ = &counters_->host_counters(host_);
+		started_ = std::chrono::steady_clock::now();
+
+		auto impl = client();
+		if (!impl) {
 			return post_result(
 				outcome::failure(make_error_code(errc::request_failed)));
 		}
 
-		// Store host/port for DNS caching
-		host_ = host;
-		port_ = port;
+		if (trace::enabled()) {
+			request_span_ = trace::Span::async(
+				"net", "http_request",
+				std::string(http::to_string(method)) + " " + host +
+					std::string(u.path()));
+		}
+
+#ifdef YTDLPP_ENABLE_HTTP2
+		if (auto h2 = impl->acquire_h2(host_, port_)) {
+			counters_->pool_hits.fetch_add(1, std::memory_order_relaxed);
+			return submit_h2(std::move(h2));
+		}
+#endif
+		if (auto pooled = impl->acquire_connection(host_, port_)) {
+			stream_ = std::move(pooled);
+			reused_ = true;
+			return do_write();
+		}
+		start_connect(*impl);
+	}
+
+   private:
+	// The client, if it is still alive. Handlers may run after it is gone:
+	// they then give up instead of touching its pool and caches.
+	std::shared_ptr<HttpClient::Impl> client() const { return impl_.lock(); }
+
+	void start_connect(HttpClient::Impl &impl) {
+		stream_ = std::make_unique<beast::ssl_stream<beast::tcp_stream>>(
+			strand_, impl.ssl_ctx);
+
+		// Set SNI
+		if (!SSL_set_tlsext_host_name(
+				stream_->native_handle(), host_.c_str())) {
+			return post_result(
+				outcome::failure(make_error_code(errc::request_failed)));
+		}
+		impl.tls_sessions.apply(stream_->native_handle(), host_);
+#ifdef YTDLPP_ENABLE_HTTP2
+		Http2Session::offer_alpn(*stream_);
+#endif
 
 		// Check DNS cache first
-		auto cached = get_dns_cache().get(host, port);
+		auto cached = get_dns_cache().get(host_, port_);
 		if (cached) {
 			// Use cached results, skip DNS lookup
+			dns_cached_ = true;
 			on_resolve({}, *cached);
 		} else {
+			phase_span_ = trace::Span::async("net", "dns", host_);
 			resolver_.async_resolve(
-				host, port,
+				host_, port_,
 				beast::bind_front_handler(
 					&RequestSession::on_resolve, shared_from_this()));
 		}
@@ -616,11 +885,12 @@ class RequestSession : public IActiveSession,
 				outcome::failure(make_error_code(errc::request_failed)));
 
 		// Cache the DNS results for future requests
-		get_dns_cache().put(host_, port_, results);
+		if (!dns_cached_) get_dns_cache().put(host_, port_, results);
 
-		beast::get_lowest_layer(stream_).expires_after(
+		phase_span_ = trace::Span::async("net", "connect", host_);
+		beast::get_lowest_layer(*stream_).expires_after(
 			std::chrono::seconds(30));
-		beast::get_lowest_layer(stream_).async_connect(
+		beast::get_lowest_layer(*stream_).async_connect(
 			results, beast::bind_front_handler(
 						 &RequestSession::on_connect, shared_from_this()));
 	}
@@ -630,94 +900,191 @@ class RequestSession : public IActiveSession,
 			return post_result(
 				outcome::failure(make_error_code(errc::request_failed)));
 
-		stream_.async_handshake(
+		phase_span_ = trace::Span::async("net", "tls", host_);
+		stream_->async_handshake(
 			ssl::stream_base::client,
 			beast::bind_front_handler(
 				&RequestSession::on_handshake, shared_from_this()));
 	}
 
 	void on_handshake(beast::error_code ec) {
-		if (ec)
+		auto impl = client();
+		if (ec || !impl) {
+			if (impl) impl->tls_sessions.invalidate(host_);
 			return post_result(
 				outcome::failure(make_error_code(errc::request_failed)));
+		}
+		impl->tls_sessions.record(stream_->native_handle());
+
+#ifdef YTDLPP_ENABLE_HTTP2
+		if (Http2Session::negotiated(*stream_)) {
+			auto h2 = std::make_shared<Http2Session>(std::move(stream_), host_);
+			if (!h2->start()) {
+				return post_result(
+					outcome::failure(make_error_code(errc::request_failed)));
+			}
+			return submit_h2(impl->register_h2(host_, port_, std::move(h2)));
+		}
+#endif
+		do_write();
+	}
+
+#ifdef YTDLPP_ENABLE_HTTP2
+	void submit_h2(std::shared_ptr<Http2Session> h2) {
+		std::map<std::string, std::string> fields;
+		for (auto const &field : req_) {
+			fields[std::string(field.name_string())] =
+				std::string(field.value());
+		}
+		h2->submit(req_.method(), std::string(req_.target()),
+				   std::move(fields), std::move(req_.body()),
+				   [self = shared_from_this()](Result<HttpResponse> res) {
+					   self->post_result(std::move(res));
+				   });
+	}
+#endif
 
-		http::async_write(stream_, req_,
+	void do_write() {
+		// Time to first byte: from sending the request to the full header
+		phase_span_ = trace::Span::async(
+			"net", reused_ ? "ttfb_reused" : "ttfb", host_);
+		parser_.emplace();
+		beast::get_lowest_layer(*stream_).expires_after(
+			std::chrono::seconds(30));
+		http::async_write(*stream_, req_,
 						  beast::bind_front_handler(
 							  &RequestSession::on_write, shared_from_this()));
 	}
 
 	void on_write(beast::error_code ec, std::size_t) {
-		if (ec)
-			return post_result(
-				outcome::failure(make_error_code(errc::request_failed)));
+		if (ec) return retry_or_fail(ec);
+
+		http::async_read_header(
+			*stream_, buf_, *parser_,
+			beast::bind_front_handler(
+				&RequestSession::on_read_header, shared_from_this()));
+	}
 
-		http::async_read(stream_, buf_, res_,
+	void on_read_header(beast::error_code ec, std::size_t) {
+		if (ec) return retry_or_fail(ec);
+
+		phase_span_ = trace::Span::async("net", "body", host_);
+		http::async_read(*stream_, buf_, *parser_,
 						 beast::bind_front_handler(
 							 &RequestSession::on_read, shared_from_this()));
 	}
 
 	void on_read(beast::error_code ec, std::size_t) {
-		if (ec)
-			return post_result(
-				outcome::failure(make_error_code(errc::request_failed)));
+		if (ec) return retry_or_fail(ec);
+		if (phase_span_.active()) {
+			phase_span_.set_detail(fmt::format(
+				"{} ({} bytes)", host_, parser_->get().body().size()));
+		}
+		phase_span_.end();
+
+		auto impl = client();
+		if (impl && parser_->get().keep_alive() && !impl->is_shutdown()) {
+			// Park the connection for the next request to this host
+			beast::get_lowest_layer(*stream_).expires_never();
+			impl->release_connection(host_, port_, std::move(stream_));
+			return finish();
+		}
 
 		// Graceful close - set short timeout
-		beast::get_lowest_layer(stream_).expires_after(std::chrono::seconds(2));
-		stream_.async_shutdown(beast::bind_front_handler(
+		beast::get_lowest_layer(*stream_).expires_after(
+			std::chrono::seconds(2));
+		stream_->async_shutdown(beast::bind_front_handler(
 			&RequestSession::on_shutdown, shared_from_this()));
 	}
 
 	void on_shutdown(beast::error_code /*ec*/) {
 		// Ignore shutdown errors (eof, timeout, etc) since we have the body
+		finish();
+	}
 
-		// Get Content-Encoding header and decompress if needed
-		std::string content_encoding;
-		auto encoding_it = res_.find(http::field::content_encoding);
-		if (encoding_it != res_.end()) {
-			content_encoding = std::string(encoding_it->value());
+	// A pooled connection the server already closed fails on first use; that
+	// is expected, so retry once on a fresh connection.
+	void retry_or_fail(beast::error_code ec) {
+		auto impl = client();
+		if (impl && reused_ && !impl->is_shutdown() &&
+			ec != asio::error::operation_aborted) {
+			spdlog::debug(
+				"Pooled connection to {} failed ({}), reconnecting", host_,
+				ec.message());
+			reused_ = false;
+			stream_.reset();
+			buf_.clear();
+			parser_.reset();
+			return start_connect(*impl);
 		}
-		std::string response_body =
-			decompress_body(res_.body(), content_encoding);
+		post_result(outcome::failure(make_error_code(errc::request_failed)));
+	}
 
+	void finish() {
 		// Convert headers
+		auto &res = parser_->get();
 		std::map<std::string, std::string> res_headers;
-		for (auto const &field : res_) {
+		for (auto const &field : res) {
 			res_headers[std::string(field.name_string())] =
 				std::string(field.value());
 		}
 
-		post_result(HttpResponse{
-			static_cast<int>(res_.result_int()), response_body, res_headers});
+		post_result(HttpResponse{static_cast<int>(res.result_int()),
+								 std::move(res.body()), res_headers});
 	}
 
 	void post_result(Result<HttpResponse> res) {
+		phase_span_.end();
+		request_span_.end();
+		// URL errors fail before a host is known
+		if (host_stats_) {
+			counters_->record(
+				*host_stats_, res.has_value(),
+				res.has_value() ? res.value().body.size() : 0,
+				std::chrono::steady_clock::now() - started_);
+		}
 		asio::dispatch(
 			handler_ex_, [cb = std::move(cb_), res = std::move(res)]() mutable {
 				cb(std::move(res));
 			});
 	}
 
-   private:
-	HttpClient::Impl *impl_;
+	// Not owned: the client may be destroyed with requests in flight
+	std::weak_ptr<HttpClient::Impl> impl_;
+	std::shared_ptr<HttpCounters> counters_;
 	asio::strand<asio::any_io_executor> strand_;
 	tcp::resolver resolver_;
-	beast::ssl_stream<beast::tcp_stream> stream_;
+	// Owned while in flight; handed back to the pool on keep-alive
+	std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream_;
 	asio::any_completion_handler<void(Result<HttpResponse>)> cb_;
 	CompletionExecutor handler_ex_;
 	beast::flat_buffer buf_;
 	http::request<http::string_body> req_;
-	http::response<http::string_body> res_;
-	std::string host_;	// For DNS caching
-	std::string port_;	// For DNS caching
+	// Inflated incrementally as body bytes arrive; one per attempt
+	std::optional<http::response_parser<InflatingBody>> parser_;
+	std::string host_;	// For pooling and DNS caching
+	std::string port_;	// For pooling and DNS caching
+	HttpCounters::Transfer *host_stats_ = nullptr;
+	bool reused_ = false;
+	bool dns_cached_ = false;
+	std::chrono::steady_clock::time_point started_;
+	trace::Span request_span_;	// Whole request, until the result posts
+	trace::Span phase_span_;	// dns, connect, tls, ttfb, body
 };
 
 void HttpClient::async_get_impl(
 	std::string url, std::map<std::string, std::string> headers,
 	asio::any_completion_handler<void(Result<HttpResponse>)> handler,
 	CompletionExecutor handler_ex) {
+	if (auto &replay = m_impl->replay) {
+		if (replay->replaying()) {
+			return m_impl->replay_request(
+				"GET", url, "", std::move(handler), std::move(handler_ex));
+		}
+		handler = m_impl->recording("GET", url, "", std::move(handler));
+	}
 	auto session = std::make_shared<RequestSession>(
-		m_impl.get(), m_impl->ex, m_impl->ssl_ctx, std::move(handler),
-		std::move(handler_ex));
+		m_impl, m_impl->ex, std::move(handler), std::move(handler_ex));
 	m_impl->register_session(session);
 	session->run(http::verb::get, url, "", headers);
 }
@@ -727,13 +1094,164 @@ void HttpClient::async_post_impl(
 	std::map<std::string, std::string> headers,
 	asio::any_completion_handler<void(Result<HttpResponse>)> handler,
 	CompletionExecutor handler_ex) {
+	if (auto &replay = m_impl->replay) {
+		if (replay->replaying()) {
+			return m_impl->replay_request(
+				"POST", url, body, std::move(handler), std::move(handler_ex));
+		}
+		handler = m_impl->recording("POST", url, body, std::move(handler));
+	}
 	auto session = std::make_shared<RequestSession>(
-		m_impl.get(), m_impl->ex, m_impl->ssl_ctx, std::move(handler),
-		std::move(handler_ex));
+		m_impl, m_impl->ex, std::move(handler), std::move(handler_ex));
 	m_impl->register_session(session);
 	session->run(http::verb::post, url, body, headers);
 }
 
+class AsyncDownloadSession;
+
+// =============================================================================
+// SEGMENTED DOWNLOADS
+// =============================================================================
+// googlevideo throttles bandwidth per connection, so large streams are split
+// into Range segments that several DownloadWorkers fetch concurrently. Each
+// worker owns one keep-alive connection; the AsyncDownloadSession hands out
+// segments, writes every body slice at its file offset and requeues the
+// unfinished tail of a segment when a connection breaks.
+//
+// Segments are cut from the rest of the file as workers ask for them, sized
+// by a TransferSizer from the throughput measured so far, and get smaller
+// towards the end so the connections finish together.
+// =============================================================================
+
+struct DownloadSegment {
+	long long begin = 0;
+	long long end = -1;	 // Inclusive, -1 = until EOF (server ignored Range)
+	int attempts = 0;
+	bool probe = false;	 // First request, learns the total size
+};
+
+// Chunk and read sizes from the download's measured per-connection
+// throughput and round trip time. A chunk should take about kSegmentTime and
+// at least kRttsPerSegment round trips, so the request latency between
+// chunks stays small next to the transfer; a read about kReadTime. The
+// initial sizes apply until the first segment completes.
+class TransferSizer {
+   public:
+	static constexpr long long kInitialChunk = 2 * 1024 * 1024;	 // 2MB
+	static constexpr long long kMinChunk = 256 * 1024;
+	static constexpr long long kMaxChunk = 16 * 1024 * 1024;
+	static constexpr size_t kInitialRead = 256 * 1024;	// 256KB
+	static constexpr size_t kMinRead = 32 * 1024;
+	static constexpr size_t kMaxRead = 1024 * 1024;
+	static constexpr auto kSegmentTime = std::chrono::seconds(1);
+	static constexpr auto kReadTime = std::chrono::milliseconds(25);
+	static constexpr int kRttsPerSegment = 16;
+
+	// A finished segment: `bytes` of body in `transfer`, `rtt` from sending
+	// the request to its response header
+	void add_sample(long long bytes, std::chrono::nanoseconds transfer,
+					std::chrono::nanoseconds rtt) {
+		double secs = std::chrono::duration<double>(transfer).count();
+		if (bytes <= 0 || secs <= 0) return;
+		double rate = static_cast<double>(bytes) / secs;
+		double rtt_secs = std::chrono::duration<double>(rtt).count();
+		if (!measured_) {
+			throughput_ = rate;
+			rtt_ = rtt_secs;
+			measured_ = true;
+			return;
+		}
+		throughput_ += kWeight * (rate - throughput_);
+		rtt_ += kWeight * (rtt_secs - rtt_);
+	}
+
+	// Next chunk with `remaining` bytes unassigned (-1 = unknown), shared by
+	// `connections`
+	[[nodiscard]] long long chunk_size(long long remaining,
+									   int connections) const {
+		long long size = kInitialChunk;
+		if (measured_) {
+			double secs = std::max(
+				std::chrono::duration<double>(kSegmentTime).count(),
+				kRttsPerSegment * rtt_);
+			size = std::clamp(static_cast<long long>(throughput_ * secs),
+							  kMinChunk, kMaxChunk);
+		}
+		if (remaining < 0) return size;
+		long long share = (remaining + connections - 1) / connections;
+		return std::min(size, std::max(kMinChunk, share));
+	}
+
+	[[nodiscard]] size_t read_size() const {
+		if (!measured_) return kInitialRead;
+		auto size = static_cast<size_t>(
+			throughput_ * std::chrono::duration<double>(kReadTime).count());
+		return std::clamp(size, kMinRead, kMaxRead);
+	}
+
+   private:
+	static constexpr double kWeight = 0.3;	// Of the newest sample
+
+	bool measured_ = false;
+	double throughput_ = 0;	 // Bytes per second and connection
+	double rtt_ = 0;		 // Seconds
+};
+
+class DownloadWorker : public std::enable_shared_from_this<DownloadWorker> {
+   public:
+	DownloadWorker(std::shared_ptr<AsyncDownloadSession> session,
+				   asio::strand<asio::any_io_executor> strand,
+				   ssl::context &ctx)
+		: session_(std::move(session)),
+		  strand_(std::move(strand)),
+		  ctx_(ctx) {}
+
+	void start(DownloadSegment segment);
+
+	[[nodiscard]] const DownloadSegment &segment() const { return segment_; }
+	[[nodiscard]] long long received() const { return received_; }
+	// When the current segment's request went out and its header came in
+	[[nodiscard]] std::chrono::steady_clock::time_point sent_at() const {
+		return sent_at_;
+	}
+	[[nodiscard]] std::chrono::steady_clock::time_point header_at() const {
+		return header_at_;
+	}
+
+   private:
+	std::shared_ptr<AsyncDownloadSession> session_;
+	asio::strand<asio::any_io_executor> strand_;
+	ssl::context &ctx_;
+	std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream_;
+	std::unique_ptr<tcp::resolver> resolver_;
+
+	http::request<http::empty_body> req_;
+	std::optional<http::response_parser<http::buffer_body>> parser_;
+	beast::flat_buffer buffer_;
+	std::vector<char> buf_;  // Grows to the largest read issued
+	size_t read_size_ = 0;
+
+	DownloadSegment segment_;
+	long long received_ = 0;
+	std::chrono::steady_clock::time_point sent_at_, header_at_;
+	bool reusable_ = false;
+	bool dns_cached_ = false;
+	trace::Span phase_span_;	 // dns, connect, tls, ttfb
+	trace::Span segment_span_;	 // Request to last body byte
+
+	void start_connect();
+	void on_resolve(beast::error_code ec, tcp::resolver::results_type results);
+	void on_connect(beast::error_code ec, tcp::endpoint);
+	void on_handshake(beast::error_code ec);
+	void do_write();
+	void on_write(beast::error_code ec, std::size_t);
+	void on_read_header(beast::error_code ec, std::size_t);
+	void read_body();
+	void on_read_body(beast::error_code ec, std::size_t);
+	void continue_body();
+	void fail(beast::error_code ec, const char *what);
+};
+
 class AsyncDownloadSession
 	: public std::enable_shared_from_this<AsyncDownloadSession> {
    public:
@@ -743,358 +1261,768 @@ class AsyncDownloadSession
 	// BUFFER SIZE CONSTANTS (Optimized for low-memory devices like Raspberry
 	// Pi)
 	// ==========================================================================
-	// kChunkSize: Size of HTTP Range request chunks. Smaller = less memory,
-	//             but more HTTP requests. 2MB is a good balance.
-	// kReadBufferSize: Size of the read buffer for body data. 256KB provides
-	//                  good throughput while being memory-efficient.
+	// Range chunks and body reads are sized by a TransferSizer: 2MB and
+	// 256KB to start, then from the measured throughput, so a connection's
+	// read buffer stays within TransferSizer::kMaxRead (1MB).
+	// kMaxSegmentRetries: Fresh-connection retries of a single segment
+	//                     before the whole download fails.
+	// kMaxConnections: Upper bound for the requested connection count.
 	// ==========================================================================
-	static constexpr long long kChunkSize = 2 * 1024 * 1024;  // 2MB
-	static constexpr size_t kReadBufferSize = 256 * 1024;	  // 256KB
+	static constexpr int kMaxSegmentRetries = 3;
+	static constexpr int kMaxConnections = 16;
 
-	AsyncDownloadSession(const asio::any_io_executor &ex, ssl::context &ctx,
+	AsyncDownloadSession(const asio::any_io_executor &ex,
+						 std::shared_ptr<HttpClient::Impl> client,
 						 asio::any_completion_handler<void(Result<void>)> cb,
 						 CompletionExecutor handler_ex,
-						 std::function<void(long long, long long)> progress_cb)
+						 std::function<void(long long, long long)> progress_cb,
+						 int connections, std::shared_ptr<FileSink> sink,
+						 std::shared_ptr<HttpCounters> counters,
+						 std::shared_ptr<BandwidthScheduler> scheduler)
 		: strand_(asio::make_strand(ex)),
-		  ctx_(ctx),
+		  client_(std::move(client)),
+		  ctx_(client_->ssl_ctx),
 		  cb_(std::move(cb)),
 		  handler_ex_(std::move(handler_ex)),
-		  progress_cb_(std::move(progress_cb)) {}
+		  progress_cb_(std::move(progress_cb)),
+		  max_connections_(std::clamp(connections, 1, kMaxConnections)),
+		  sink_(std::move(sink)),
+		  counters_(std::move(counters)),
+		  scheduler_(std::move(scheduler)),
+		  job_(scheduler_->add_job()) {
+		counters_->active_downloads.fetch_add(1, std::memory_order_relaxed);
+	}
 
-	void run(const std::string &url_str, const std::string &output_path) {
-		outfile_.open(output_path, std::ios::binary | std::ios::out);
-		if (!outfile_.is_open()) {
-			return post_result(outcome::failure(errc::file_open_failed));
-		}
+	~AsyncDownloadSession() {
+		counters_->active_downloads.fetch_sub(1, std::memory_order_relaxed);
+	}
 
+	void run(const std::string &url_str) {
 		auto u_res = boost::urls::parse_uri(url_str);
 		if (u_res.has_error())
 			return post_result(outcome::failure(errc::invalid_url));
-		url_ = u_res.value();
+		boost::urls::url_view url = u_res.value();
 
 		// Defaults
-		host_ = url_.host();
-		port_ = url_.port();
-		path_ = url_.path();
-		if (url_.has_query()) {
+		host_ = url.host();
+		port_ = url.port();
+		path_ = url.path();
+		if (url.has_query()) {
 			path_ += "?";
-			path_ += url_.query();
+			path_ += url.query();
 		}
 		if (path_.empty()) path_ = "/";
-		if (port_.empty()) port_ = (url_.scheme() == "https") ? "443" : "80";
+		if (port_.empty()) port_ = (url.scheme() == "https") ? "443" : "80";
+		host_stats_ = &counters_->host_counters(host_);
+		started_ = std::chrono::steady_clock::now();
+		if (trace::enabled()) {
+			span_ = trace::Span::async(
+				"net", "download", host_ + std::string(url.path()));
+		}
 
-		// Start with HEAD request
-		head_phase_ = true;
-		start_resolve();
+		// The first chunk doubles as the size probe (no separate HEAD round
+		// trip); the remaining segments are queued once Content-Range arrives.
+		asio::dispatch(strand_, [self = shared_from_this()] {
+			DownloadSegment probe;
+			probe.end = TransferSizer::kInitialChunk - 1;
+			probe.probe = true;
+			self->spawn_worker(probe);
+		});
 	}
 
-   private:
-	asio::strand<asio::any_io_executor> strand_;
-	ssl::context &ctx_;
-	std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream_;
-	std::unique_ptr<tcp::resolver> resolver_;
-
-	asio::any_completion_handler<void(Result<void>)> cb_;
-	CompletionExecutor handler_ex_;
-	std::function<void(long long, long long)> progress_cb_;
+	[[nodiscard]] const std::string &host() const { return host_; }
+	[[nodiscard]] const std::string &port() const { return port_; }
+	[[nodiscard]] const std::string &path() const { return path_; }
+	[[nodiscard]] bool is_done() const { return done_; }
+	// Unknown total size: chunks are fetched one after another until a
+	// short one (or a 416 past the end) marks EOF
+	[[nodiscard]] bool is_sequential() const {
+		return total_size_ <= 0 && !full_body_;
+	}
 
-	std::ofstream outfile_;
-	boost::urls::url_view url_;
-	std::string host_, port_, path_;
+	// Called by the probe worker once its response header is in. Returns the
+	// segment the worker should keep reading, or nullopt to abort.
+	std::optional<DownloadSegment> on_probe_header(
+		const http::response_parser<http::buffer_body>::value_type &res,
+		DownloadSegment segment) {
+		int status = res.result_int();
 
-	http::request<http::empty_body> req_;
-	std::optional<http::response_parser<http::buffer_body>> parser_;
-	std::optional<http::response_parser<http::empty_body>> head_parser_;
+		if (status == 200) {
+			// Server ignored Range, we are getting the full file on this
+			// connection; nothing to parallelise.
+			full_body_ = true;
+			segment.end = -1;
+			auto cl_it = res.find(http::field::content_length);
+			if (cl_it != res.end()) {
+				auto len_opt = utils::to_long(std::string_view(
+					cl_it->value().data(), cl_it->value().size()));
+				if (len_opt) total_size_ = len_opt.value();
+			}
+			if (!preallocate()) return std::nullopt;
+			return segment;
+		}
 
-	beast::flat_buffer buffer_;
-	// Read buffer - sized according to kReadBufferSize constant
-	std::vector<char> buf_{std::vector<char>(kReadBufferSize)};
+		if (status != 206) {
+			spdlog::warn("Async Download failed status: {}", status);
+			fail(make_error_code(errc::http_error));
+			return std::nullopt;
+		}
 
-	long long total_size_ = -1;
-	long long current_offset_ = 0;
-	bool head_phase_ = false;
+		// Parse "bytes start-end/total"
+		auto cr_it = res.find(http::field::content_range);
+		if (cr_it != res.end()) {
+			std::string_view cr = cr_it->value();
+			auto slash_pos = cr.find('/');
+			if (slash_pos != std::string_view::npos) {
+				auto len_opt = utils::to_long(cr.substr(slash_pos + 1));
+				if (len_opt) total_size_ = len_opt.value();
+			}
+		}
 
-	void start_next_chunk(bool reuse = false) {
-		if (total_size_ > 0 && current_offset_ >= total_size_) {
-			return on_finish(beast::error_code{});
+		if (total_size_ > 0) {
+			if (!preallocate()) return std::nullopt;
+			segment.end = std::min(segment.end, total_size_ - 1);
+			next_offset_ = segment.end + 1;
+
+			long long remaining = total_size_ - next_offset_;
+			int extra = static_cast<int>(std::min<long long>(
+				max_connections_ - 1,
+				(remaining + TransferSizer::kInitialChunk - 1) /
+					TransferSizer::kInitialChunk));
+			if (extra > 0) {
+				spdlog::debug("Downloading {} bytes with {} connections",
+							  total_size_, extra + 1);
+			}
+			for (int i = 0; i < extra; ++i) {
+				auto seg = cut_segment();
+				if (!seg) break;
+				spawn_worker(*seg);
+			}
 		}
+		// Unknown total ("bytes 0-x/*"): continue sequentially, one chunk
+		// after another, until a short chunk marks the end.
+		return segment;
+	}
 
-		if (reuse && stream_) {
-			// Reuse existing connection
-			head_phase_ = false;
-			parser_.emplace();
-			parser_->body_limit(boost::none);
-			do_write();
-		} else {
-			head_phase_ = false;
-			start_resolve();
+	// Called for every body slice; writes it at its file offset straight
+	// from the worker's read buffer.
+	bool write_at(long long offset, const char *data, size_t size) {
+		if (done_) return false;
+		auto res = sink_->write_at(offset, data, size);
+		if (res.has_error()) {
+			fail(res.error());
+			return false;
 		}
+		bytes_done_ += static_cast<long long>(size);
+		if (progress_cb_)
+			progress_cb_(bytes_done_, total_size_ > 0 ? total_size_ : 0);
+		return true;
 	}
 
-	void start_resolve() {
-		// Re-create stream and resolver for fresh connection
-		stream_ = std::make_unique<beast::ssl_stream<beast::tcp_stream>>(
-			strand_, ctx_);
-		resolver_ = std::make_unique<tcp::resolver>(strand_);
+	bool wants_more(long long next_offset, std::function<void()> resume) {
+		return done_ || sink_->wants_more(next_offset, std::move(resume));
+	}
 
-		if (!head_phase_) {
-			parser_.emplace();
-			parser_->body_limit(boost::none);
-		} else {
-			head_parser_.emplace();
-			head_parser_->skip(true);
+	// Charge a body slice against the bandwidth limits; false parks the
+	// connection until `resume`
+	bool throttle(size_t bytes, std::function<void()> resume) {
+		return done_ || scheduler_->consume(job_, bytes, std::move(resume));
+	}
+
+	// Next body read, no more than one scheduler round of this connection's
+	// part of the download's share while limited
+	[[nodiscard]] size_t read_size() const {
+		size_t size = sizer_.read_size();
+		if (size_t slice = scheduler_->slice_limit(active_workers_)) {
+			size = std::min(size, slice);
 		}
+		return size;
+	}
 
-		buffer_.clear();
+	// The worker finished its segment; hand it the next one or retire it.
+	std::optional<DownloadSegment> on_segment_complete(
+		const DownloadWorker &worker) {
+		if (done_) return std::nullopt;
 
-		if (!SSL_set_tlsext_host_name(
-				stream_->native_handle(), host_.c_str())) {
-			return post_result(
-				outcome::failure(make_error_code(errc::request_failed)));
+		if (worker.received() > 0) {
+			auto now = std::chrono::steady_clock::now();
+			sizer_.add_sample(worker.received(), now - worker.header_at(),
+							  worker.header_at() - worker.sent_at());
 		}
 
-		// Check DNS cache first
-		auto cached = get_dns_cache().get(host_, port_);
-		if (cached) {
-			// Use cached results, skip DNS lookup
-			on_resolve({}, *cached);
-		} else {
-			resolver_->async_resolve(
-				host_, port_,
-				beast::bind_front_handler(
-					&AsyncDownloadSession::on_resolve, shared_from_this()));
+		const auto &seg = worker.segment();
+		if (is_sequential()) {
+			long long requested = seg.end - seg.begin + 1;
+			if (worker.received() == requested) {
+				DownloadSegment next;
+				next.begin = seg.end + 1;
+				next.end = next.begin + sizer_.chunk_size(-1, 1) - 1;
+				pending_.push_back(next);
+			}
 		}
+		return next_segment();
 	}
 
-	void on_resolve(beast::error_code ec, tcp::resolver::results_type results) {
-		if (ec) return fail(ec, "resolve");
+	// The worker's connection broke mid-segment. Requeue what is left of the
+	// segment; the worker retries it on a fresh connection.
+	std::optional<DownloadSegment> on_segment_failed(
+		const DownloadWorker &worker, beast::error_code ec, const char *what) {
+		if (done_) return std::nullopt;
+
+		DownloadSegment rest = worker.segment();
+		rest.begin += worker.received();
+		rest.probe = false;
+		if (rest.end >= 0 && rest.begin > rest.end) {
+			// Body was complete, only the connection teardown failed
+			return next_segment();
+		}
+		if (++rest.attempts > kMaxSegmentRetries || full_body_) {
+			spdlog::error(
+				"AsyncDownloadSession error in {}: {}", what, ec.message());
+			fail(make_error_code(errc::request_failed));
+			return std::nullopt;
+		}
 
-		// Cache the DNS results for future requests
-		get_dns_cache().put(host_, port_, results);
+		spdlog::warn("Segment {}-{} failed in {} ({}), retry {}/{}",
+					 rest.begin, rest.end, what, ec.message(), rest.attempts,
+					 kMaxSegmentRetries);
+		if (worker.segment().probe && total_size_ <= 0) {
+			// Nothing learned yet, the retry is still the probe.
+			rest.probe = true;
+		}
+		pending_.push_front(rest);
+		return next_segment();
+	}
 
-		beast::get_lowest_layer(*stream_).expires_after(
-			std::chrono::seconds(30));
-		beast::get_lowest_layer(*stream_).async_connect(
-			results,
-			beast::bind_front_handler(
-				&AsyncDownloadSession::on_connect, shared_from_this()));
+	void fail(std::error_code ec) {
+		if (done_) return;
+		done_ = true;
+		pending_.clear();
+		sink_->abort();
+		(void)sink_->close();
+		post_result(outcome::failure(ec));
 	}
 
-	void on_connect(beast::error_code ec, tcp::endpoint) {
-		if (ec) return fail(ec, "connect");
+   private:
+	asio::strand<asio::any_io_executor> strand_;
+	// Workers connect (and resume TLS sessions) with the client's context
+	// until the download ends, even if the client is destroyed first
+	std::shared_ptr<HttpClient::Impl> client_;
+	ssl::context &ctx_;
+
+	asio::any_completion_handler<void(Result<void>)> cb_;
+	CompletionExecutor handler_ex_;
+	std::function<void(long long, long long)> progress_cb_;
+	int max_connections_;
 
-		stream_->async_handshake(
-			ssl::stream_base::client,
-			beast::bind_front_handler(
-				&AsyncDownloadSession::on_handshake, shared_from_this()));
+	std::shared_ptr<FileSink> sink_;
+	std::shared_ptr<HttpCounters> counters_;
+	std::shared_ptr<BandwidthScheduler> scheduler_;
+	std::shared_ptr<BandwidthScheduler::Job> job_;
+	std::string host_, port_, path_;
+	HttpCounters::Transfer *host_stats_ = nullptr;
+	std::chrono::steady_clock::time_point started_;
+
+	TransferSizer sizer_;
+	// Retried tails and the sequential chunks of an unknown size; the rest
+	// of a known size is cut from next_offset_ on demand
+	std::deque<DownloadSegment> pending_;
+	long long next_offset_ = 0;
+	int active_workers_ = 0;
+	long long total_size_ = -1;
+	long long bytes_done_ = 0;
+	bool full_body_ = false;
+	bool done_ = false;
+	trace::Span span_;	// Whole download, until the result posts
+
+	// Reserve the final size in one go so parallel segments don't leave the
+	// file fragmented. A full disk fails the download before any body.
+	bool preallocate() {
+		trace::Span span("disk", "preallocate");
+		auto res = sink_->preallocate(total_size_);
+		if (res.has_error()) {
+			spdlog::error("Failed to allocate {} bytes for download: {}",
+						  total_size_, res.error().message());
+			fail(res.error());
+			return false;
+		}
+		return true;
 	}
 
-	void on_handshake(beast::error_code ec) {
-		if (ec) return fail(ec, "handshake");
-		do_write();
+	void spawn_worker(DownloadSegment segment) {
+		++active_workers_;
+		std::make_shared<DownloadWorker>(
+			shared_from_this(), strand_, ctx_)
+			->start(segment);
 	}
 
-	void do_write() {
-		// Prepare Request
-		req_ = {};
-		req_.version(11);
-		req_.target(path_);
-		req_.set(http::field::host, host_);
-		req_.set(http::field::user_agent, "yt-dlpp/1.0");
-		req_.set(http::field::accept, "*/*");
+	std::optional<DownloadSegment> cut_segment() {
+		if (full_body_ || total_size_ <= 0 || next_offset_ >= total_size_) {
+			return std::nullopt;
+		}
+		DownloadSegment seg;
+		seg.begin = next_offset_;
+		long long size =
+			sizer_.chunk_size(total_size_ - next_offset_, max_connections_);
+		seg.end = std::min(next_offset_ + size, total_size_) - 1;
+		next_offset_ = seg.end + 1;
+		return seg;
+	}
 
-		if (head_phase_) {
-			req_.method(http::verb::head);
-		} else {
-			req_.method(http::verb::get);
-			if (total_size_ > 0 || current_offset_ == 0) {
-				// Calculate range
-				long long end = -1;
-				if (total_size_ > 0) {
-					end = std::min(
-						current_offset_ + kChunkSize - 1, total_size_ - 1);
-				} else {
-					// Try probing with first chunk
-					end = kChunkSize - 1;
-				}
+	std::optional<DownloadSegment> next_segment() {
+		if (!pending_.empty()) {
+			auto seg = pending_.front();
+			pending_.pop_front();
+			return seg;
+		}
+		if (auto seg = cut_segment()) return seg;
+		// This worker retires
+		if (--active_workers_ == 0) on_finish();
+		return std::nullopt;
+	}
 
-				std::string range_val =
-					"bytes=" + std::to_string(current_offset_) + "-" +
-					std::to_string(end);
-				req_.set(http::field::range, range_val);
-			}
+	void on_finish() {
+		if (done_) return;
+		done_ = true;
+		trace::Span close_span("disk", "close");
+		auto res = sink_->close();
+		close_span.end();
+		if (res.has_error()) return post_result(outcome::failure(res.error()));
+		post_result(outcome::success());
+	}
+
+	void post_result(Result<void> res) {
+		if (span_.active()) {
+			span_.set_detail(fmt::format(
+				"{}{} ({} bytes)", host_, path_.substr(0, path_.find('?')),
+				bytes_done_));
+		}
+		span_.end();
+		if (host_stats_) {
+			counters_->record(*host_stats_, res.has_value(),
+							  static_cast<uint64_t>(bytes_done_),
+							  std::chrono::steady_clock::now() - started_);
 		}
+		asio::dispatch(
+			handler_ex_, [cb = std::move(cb_), res]() mutable { cb(res); });
+	}
+};
+
+void DownloadWorker::start(DownloadSegment segment) {
+	segment_ = segment;
+	received_ = 0;
+	parser_.emplace();
+	parser_->body_limit(boost::none);
+
+	if (reusable_ && stream_) {
+		// Reuse existing keep-alive connection
+		do_write();
+	} else {
+		start_connect();
+	}
+}
+
+void DownloadWorker::start_connect() {
+	// Re-create stream and resolver for fresh connection
+	stream_ =
+		std::make_unique<beast::ssl_stream<beast::tcp_stream>>(strand_, ctx_);
+	resolver_ = std::make_unique<tcp::resolver>(strand_);
+	buffer_.clear();
+
+	if (!SSL_set_tlsext_host_name(
+			stream_->native_handle(), session_->host().c_str())) {
+		return session_->fail(make_error_code(errc::request_failed));
+	}
+	if (auto *tls = TlsSessionCache::from(ctx_)) {
+		tls->apply(stream_->native_handle(), session_->host());
+	}
 
-		http::async_write(
-			*stream_, req_,
+	// Check DNS cache first
+	auto cached = get_dns_cache().get(session_->host(), session_->port());
+	dns_cached_ = cached.has_value();
+	if (cached) {
+		// Use cached results, skip DNS lookup
+		on_resolve({}, *cached);
+	} else {
+		phase_span_ = trace::Span::async("net", "dns", session_->host());
+		resolver_->async_resolve(
+			session_->host(), session_->port(),
 			beast::bind_front_handler(
-				&AsyncDownloadSession::on_write, shared_from_this()));
+				&DownloadWorker::on_resolve, shared_from_this()));
 	}
+}
 
-	void on_write(beast::error_code ec, std::size_t) {
-		if (ec) return fail(ec, "write");
+void DownloadWorker::on_resolve(beast::error_code ec,
+								tcp::resolver::results_type results) {
+	if (ec) return fail(ec, "resolve");
 
-		if (head_phase_) {
-			http::async_read(
-				*stream_, buffer_, *head_parser_,
-				beast::bind_front_handler(
-					&AsyncDownloadSession::on_head_read, shared_from_this()));
-		} else {
-			http::async_read_header(
-				*stream_, buffer_, *parser_,
-				beast::bind_front_handler(
-					&AsyncDownloadSession::on_read_header, shared_from_this()));
-		}
+	// Cache the DNS results for future requests
+	if (!dns_cached_) {
+		get_dns_cache().put(session_->host(), session_->port(), results);
 	}
 
-	void on_head_read(beast::error_code ec, std::size_t) {
-		// Even if head fails, we proceed to download and hope for the best
-		if (!ec) {
-			int status = head_parser_->get().result_int();
-			if (status == 200) {
-				auto cl_it =
-					head_parser_->get().find(http::field::content_length);
-				if (cl_it != head_parser_->get().end()) {
-					auto len_opt = utils::to_long(std::string_view(
-						cl_it->value().data(), cl_it->value().size()));
-					if (len_opt) total_size_ = len_opt.value();
-				}
-			}
-		} else {
-			spdlog::warn("HEAD request failed: {}", ec.message());
-		}
+	phase_span_ = trace::Span::async("net", "connect", session_->host());
+	beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
+	beast::get_lowest_layer(*stream_).async_connect(
+		results, beast::bind_front_handler(
+					 &DownloadWorker::on_connect, shared_from_this()));
+}
 
-		// Check for keep-alive to reuse connection
-		bool keep_alive = head_parser_->get().keep_alive();
+void DownloadWorker::on_connect(beast::error_code ec, tcp::endpoint) {
+	if (ec) return fail(ec, "connect");
 
-		if (keep_alive) {
-			// Reuse for download
-			start_next_chunk(true);
-		} else {
-			// Shutdown head connection and start download fresh
-			stream_->async_shutdown(beast::bind_front_handler(
-				&AsyncDownloadSession::on_shutdown, shared_from_this()));
-		}
+	phase_span_ = trace::Span::async("net", "tls", session_->host());
+	stream_->async_handshake(
+		ssl::stream_base::client,
+		beast::bind_front_handler(
+			&DownloadWorker::on_handshake, shared_from_this()));
+}
+
+void DownloadWorker::on_handshake(beast::error_code ec) {
+	auto *tls = TlsSessionCache::from(ctx_);
+	if (ec) {
+		if (tls) tls->invalidate(session_->host());
+		return fail(ec, "handshake");
 	}
+	if (tls) tls->record(stream_->native_handle());
+	do_write();
+}
 
-	void on_read_header(beast::error_code ec, std::size_t /*unused*/) {
-		if (ec) return fail(ec, "read_header");
+void DownloadWorker::do_write() {
+	// Prepare Request
+	req_ = {};
+	req_.version(11);
+	req_.method(http::verb::get);
+	req_.target(session_->path());
+	req_.set(http::field::host, session_->host());
+	req_.set(http::field::user_agent, "yt-dlpp/1.0");
+	req_.set(http::field::accept, "*/*");
+	req_.set(http::field::range, "bytes=" + std::to_string(segment_.begin) +
+									 "-" + std::to_string(segment_.end));
+	sent_at_ = std::chrono::steady_clock::now();
+
+	if (trace::enabled()) {
+		auto range = fmt::format("{}-{}", segment_.begin, segment_.end);
+		segment_span_ = trace::Span::async("net", "segment", range);
+		phase_span_ = trace::Span::async(
+			"net", reusable_ ? "ttfb_reused" : "ttfb", range);
+	}
 
-		int status = parser_->get().result_int();
+	beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
+	http::async_write(*stream_, req_,
+					  beast::bind_front_handler(
+						  &DownloadWorker::on_write, shared_from_this()));
+}
 
-		if (status == 200) {
-			// Server ignored Range, we are getting full file
-			current_offset_ = 0;
-			outfile_.seekp(0);
-			// Total size might be in Content-Length
-			auto cl_it = parser_->get().find(http::field::content_length);
-			if (cl_it != parser_->get().end()) {
-				auto len_opt = utils::to_long(std::string_view(
-					cl_it->value().data(), cl_it->value().size()));
-				if (len_opt) total_size_ = len_opt.value();
-			} else {
-				total_size_ = -1;  // Unknown
-			}
-		} else if (status == 206) {
-			// Partial Content
-			auto cr_it = parser_->get().find(http::field::content_range);
-			if (cr_it != parser_->get().end()) {
-				// Parse "bytes start-end/total"
-				std::string_view cr = cr_it->value();
-				auto slash_pos = cr.find('/');
-				if (slash_pos != std::string_view::npos) {
-					std::string_view total_sv = cr.substr(slash_pos + 1);
-					auto len_opt = utils::to_long(total_sv);
-					if (len_opt) total_size_ = len_opt.value();
-				}
-			}
-		} else {
-			spdlog::warn("Async Download failed status: {}", status);
-			return post_result(outcome::failure(errc::request_failed));
-		}
+void DownloadWorker::on_write(beast::error_code ec, std::size_t) {
+	if (ec) return fail(ec, "write");
+
+	http::async_read_header(
+		*stream_, buffer_, *parser_,
+		beast::bind_front_handler(
+			&DownloadWorker::on_read_header, shared_from_this()));
+}
 
-		read_body();
+void DownloadWorker::on_read_header(beast::error_code ec, std::size_t) {
+	if (ec) return fail(ec, "read_header");
+	header_at_ = std::chrono::steady_clock::now();
+	phase_span_.end();
+	if (session_->is_done()) return;
+
+	if (segment_.probe) {
+		auto seg = session_->on_probe_header(parser_->get(), segment_);
+		if (!seg) return;
+		segment_ = *seg;
+	} else if (parser_->get().result_int() == 416 &&
+			   session_->is_sequential()) {
+		// The previous chunk ended exactly at EOF. The 416 body is not
+		// read, so the connection is not reused.
+		segment_span_.end();
+		reusable_ = false;
+		stream_.reset();
+		auto next = session_->on_segment_complete(*this);
+		if (next) start(*next);
+		return;
+	} else if (parser_->get().result_int() != 206) {
+		// A 200 here would restart the body from offset 0
+		spdlog::warn("Segment {}-{} got status {}", segment_.begin,
+					 segment_.end, parser_->get().result_int());
+		return session_->fail(make_error_code(errc::http_error));
 	}
 
-	void read_body() {
-		if (parser_->is_done()) { return on_chunk_finish(); }
+	read_body();
+}
 
-		beast::get_lowest_layer(*stream_).expires_after(
-			std::chrono::seconds(30));
+void DownloadWorker::read_body() {
+	if (parser_->is_done()) {
+		segment_span_.end();
+		reusable_ = parser_->get().keep_alive();
+		auto next = session_->on_segment_complete(*this);
+		if (next) return start(*next);
+		return;
+	}
 
-		parser_->get().body().data = buf_.data();
-		parser_->get().body().size = buf_.size();
+	beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
 
-		http::async_read(
-			*stream_, buffer_, *parser_,
-			beast::bind_front_handler(
-				&AsyncDownloadSession::on_read_body, shared_from_this()));
+	read_size_ = session_->read_size();
+	if (buf_.size() < read_size_) buf_.resize(read_size_);
+	parser_->get().body().data = buf_.data();
+	parser_->get().body().size = read_size_;
+
+	http::async_read(*stream_, buffer_, *parser_,
+					 beast::bind_front_handler(
+						 &DownloadWorker::on_read_body, shared_from_this()));
+}
+
+void DownloadWorker::on_read_body(beast::error_code ec, std::size_t) {
+	if (ec == http::error::need_buffer) ec = {};
+	if (ec) return fail(ec, "read_body");
+
+	size_t bytes_read = read_size_ - parser_->get().body().size;
+	if (bytes_read == 0) return read_body();
+
+	if (!session_->write_at(
+			segment_.begin + received_, buf_.data(), bytes_read)) {
+		return;
 	}
+	received_ += static_cast<long long>(bytes_read);
+
+	// Over a bandwidth limit the scheduler parks this connection until a
+	// later round; charged first so a parked slice still counts.
+	auto unthrottle = [self = shared_from_this()] {
+		asio::post(self->strand_, [self] { self->continue_body(); });
+	};
+	if (!session_->throttle(bytes_read, unthrottle)) return;
+	continue_body();
+}
 
-	void on_read_body(beast::error_code ec, std::size_t) {
-		if (ec == http::error::need_buffer) ec = {};
-		if (ec) return fail(ec, "read_body");
+void DownloadWorker::continue_body() {
+	// A streaming sink whose consumer is behind parks this connection;
+	// TCP flow control then throttles the server.
+	auto resume = [self = shared_from_this()] {
+		asio::post(self->strand_, [self] { self->read_body(); });
+	};
+	if (!session_->wants_more(segment_.begin + received_, resume)) return;
+	read_body();
+}
 
-		size_t bytes_read = buf_.size() - parser_->get().body().size;
-		if (bytes_read > 0) {
-			outfile_.write(buf_.data(), bytes_read);
-			current_offset_ += bytes_read;
-			if (progress_cb_)
-				progress_cb_(
-					current_offset_, total_size_ > 0 ? total_size_ : 0);
-		}
+void DownloadWorker::fail(beast::error_code ec, const char *what) {
+	phase_span_.end();
+	segment_span_.end();
+	reusable_ = false;
+	stream_.reset();
+	auto retry = session_->on_segment_failed(*this, ec, what);
+	if (retry) start(*retry);
+}
+
+// =============================================================================
+// REPLAYED DOWNLOADS
+// =============================================================================
+// Plays a recorded download back through the same shape of transfer as
+// AsyncDownloadSession: segments over up to `connections` lanes, each
+// delayed by the replay latency and delivered in read-sized slices at the
+// replay bandwidth, so the effect of chunk and buffer sizes on throughput
+// shows without a network. A TransferSizer sizes both from the replayed
+// segments, as it does live. The client's bandwidth limits do not apply
+// (HttpReplayOptions::bandwidth paces replay instead).
+// =============================================================================
+
+class ReplayDownloadSession
+	: public std::enable_shared_from_this<ReplayDownloadSession> {
+   public:
+	using CompletionExecutor = HttpClient::CompletionExecutor;
 
-		read_body();
+	ReplayDownloadSession(const asio::any_io_executor &ex,
+						  std::shared_ptr<HttpReplayStore> store,
+						  asio::any_completion_handler<void(Result<void>)> cb,
+						  CompletionExecutor handler_ex,
+						  std::function<void(long long, long long)> progress_cb,
+						  int connections, std::shared_ptr<FileSink> sink)
+		: strand_(asio::make_strand(ex)),
+		  store_(std::move(store)),
+		  cb_(std::move(cb)),
+		  handler_ex_(std::move(handler_ex)),
+		  progress_cb_(std::move(progress_cb)),
+		  connections_(std::clamp(
+			  connections, 1, AsyncDownloadSession::kMaxConnections)),
+		  sink_(std::move(sink)) {}
+
+	void run(const std::string &url) {
+		asio::dispatch(strand_, [self = shared_from_this(), url] {
+			self->start(url);
+		});
 	}
 
-	void on_chunk_finish() {
-		// Check Keep-Alive
-		bool keep_alive = parser_->get().keep_alive();
-		if (keep_alive && (total_size_ <= 0 || current_offset_ < total_size_)) {
-			// Reuse connection
-			return start_next_chunk(true);
+   private:
+	struct Lane {
+		explicit Lane(asio::strand<asio::any_io_executor> &strand)
+			: timer(strand) {}
+		asio::steady_timer timer;
+		std::vector<char> buf;	// Grows to the largest slice delivered
+		long long begin = 0;	// Start of the current segment
+		long long pos = 0;		// Next offset to deliver
+		long long end = 0;		// Exclusive end of the current segment
+		// When the segment was claimed and its first bytes were due
+		std::chrono::steady_clock::time_point sent_at, header_at;
+	};
+
+	void start(const std::string &url) {
+		auto media = store_->find_media(url);
+		if (!media) {
+			spdlog::warn("Replay: No recording of download {}", url);
+			return finish(make_error_code(errc::request_failed));
+		}
+		total_ = media->size;
+		if (!media->body.empty()) {
+			body_.open(media->body, std::ios::binary);
+		}
+		if (auto res = sink_->preallocate(total_); res.has_error()) {
+			return finish(res.error());
+		}
+		if (total_ == 0) return finish({});
+
+		int lanes = static_cast<int>(std::min<long long>(
+			connections_, (total_ + TransferSizer::kInitialChunk - 1) /
+							  TransferSizer::kInitialChunk));
+		for (int i = 0; i < lanes; ++i) {
+			lanes_.push_back(std::make_unique<Lane>(strand_));
+			next_segment(*lanes_.back());
 		}
+	}
 
-		// Graceful shutdown of this connection
-		stream_->async_shutdown(beast::bind_front_handler(
-			&AsyncDownloadSession::on_shutdown, shared_from_this()));
+	// Claim the next chunk; its first bytes arrive after the latency.
+	// Lanes without work left just stop.
+	void next_segment(Lane &lane) {
+		if (done_ || next_offset_ >= total_) return;
+		long long size = sizer_.chunk_size(total_ - next_offset_, connections_);
+		lane.begin = lane.pos = next_offset_;
+		lane.end = std::min(next_offset_ + size, total_);
+		next_offset_ = lane.end;
+		lane.sent_at = std::chrono::steady_clock::now();
+		wait(lane, store_->options().latency, [this, &lane] {
+			lane.header_at = std::chrono::steady_clock::now();
+			slice(lane);
+		});
 	}
 
-	void on_shutdown(beast::error_code /*unused*/) {
-		if (head_phase_) {
-			head_phase_ = false;
-			start_resolve();
-		} else {
-			start_next_chunk(false);
+	// Deliver one read-buffer slice, paced at the replay bandwidth
+	void slice(Lane &lane) {
+		if (done_) return;
+		if (lane.pos >= lane.end) {
+			sizer_.add_sample(lane.end - lane.begin,
+							  std::chrono::steady_clock::now() - lane.header_at,
+							  lane.header_at - lane.sent_at);
+			return next_segment(lane);
 		}
-	}
 
-	void on_finish(beast::error_code) {
-		outfile_.close();
-		post_result(outcome::success());
+		size_t size = static_cast<size_t>(std::min<long long>(
+			static_cast<long long>(sizer_.read_size()), lane.end - lane.pos));
+		if (lane.buf.size() < size) lane.buf.resize(size);
+		wait(lane, store_->transfer_time(size), [this, &lane, size] {
+			if (done_) return;
+			if (body_.is_open()) {
+				body_.seekg(lane.pos);
+				body_.read(lane.buf.data(), static_cast<std::streamsize>(size));
+				if (!body_) return finish(make_error_code(errc::request_failed));
+			}
+			if (auto res = sink_->write_at(lane.pos, lane.buf.data(), size);
+				res.has_error()) {
+				return finish(res.error());
+			}
+			lane.pos += static_cast<long long>(size);
+			delivered_ += static_cast<long long>(size);
+			if (progress_cb_) progress_cb_(delivered_, total_);
+			if (delivered_ >= total_) return finish({});
+
+			auto resume = [self = shared_from_this(), &lane] {
+				asio::post(self->strand_, [self, &lane] { self->slice(lane); });
+			};
+			if (sink_->wants_more(lane.pos, resume)) slice(lane);
+		});
 	}
 
-	void fail(beast::error_code ec, const char *what) {
-		spdlog::error(
-			"AsyncDownloadSession error in {}: {}", what, ec.message());
-		outfile_.close();
-		post_result(outcome::failure(make_error_code(errc::request_failed)));
+	// Posted even without a delay, so slices don't recurse
+	template <typename Fn>
+	void wait(Lane &lane, std::chrono::nanoseconds delay, Fn fn) {
+		if (delay.count() <= 0) {
+			asio::post(strand_, [self = shared_from_this(),
+								 fn = std::move(fn)]() mutable { fn(); });
+			return;
+		}
+		lane.timer.expires_after(delay);
+		lane.timer.async_wait(
+			[self = shared_from_this(), fn = std::move(fn)](
+				beast::error_code ec) mutable {
+				if (!ec) fn();
+			});
 	}
 
-	void post_result(Result<void> res) {
-		asio::dispatch(
-			handler_ex_, [cb = std::move(cb_), res]() mutable { cb(res); });
+	void finish(std::error_code ec) {
+		if (done_) return;
+		done_ = true;
+		if (ec) sink_->abort();
+		auto closed = sink_->close();
+		if (!ec && closed.has_error()) ec = closed.error();
+		Result<void> res = ec ? Result<void>(outcome::failure(ec))
+							  : Result<void>(outcome::success());
+		asio::dispatch(handler_ex_,
+					   [cb = std::move(cb_), res]() mutable { cb(res); });
 	}
+
+	asio::strand<asio::any_io_executor> strand_;
+	std::shared_ptr<HttpReplayStore> store_;
+	asio::any_completion_handler<void(Result<void>)> cb_;
+	CompletionExecutor handler_ex_;
+	std::function<void(long long, long long)> progress_cb_;
+	int connections_;
+	std::shared_ptr<FileSink> sink_;
+
+	std::ifstream body_;  // Recorded bytes; zeros are sent without one
+	TransferSizer sizer_;
+	std::vector<std::unique_ptr<Lane>> lanes_;
+	long long total_ = 0;
+	long long next_offset_ = 0;
+	long long delivered_ = 0;
+	bool done_ = false;
 };
 
 void HttpClient::async_download_file_impl(
 	std::string url, std::string output_path, ProgressCallback progress_cb,
+	int connections, asio::any_completion_handler<void(Result<void>)> handler,
+	CompletionExecutor handler_ex) {
+	auto sink = open_file_sink(output_path);
+	if (sink.has_error()) {
+		asio::dispatch(handler_ex, [handler = std::move(handler),
+									ec = sink.error()]() mutable {
+			handler(outcome::failure(ec));
+		});
+		return;
+	}
+	async_download_sink_impl(std::move(url), std::move(sink).value(),
+							 std::move(progress_cb), connections,
+							 std::move(handler), std::move(handler_ex));
+}
+
+void HttpClient::async_download_sink_impl(
+	std::string url, std::shared_ptr<FileSink> sink,
+	ProgressCallback progress_cb, int connections,
 	asio::any_completion_handler<void(Result<void>)> handler,
 	CompletionExecutor handler_ex) {
+	if (auto &replay = m_impl->replay) {
+		if (replay->replaying()) {
+			std::make_shared<ReplayDownloadSession>(
+				m_impl->ex, replay, std::move(handler), std::move(handler_ex),
+				std::move(progress_cb), connections, std::move(sink))
+				->run(url);
+			return;
+		}
+		sink = replay->record_media(url, std::move(sink));
+	}
 	std::make_shared<AsyncDownloadSession>(
-		m_impl->ex, m_impl->ssl_ctx, std::move(handler), std::move(handler_ex),
-		std::move(progress_cb))
-		->run(url, output_path);
+		m_impl->ex, m_impl, std::move(handler), std::move(handler_ex),
+		std::move(progress_cb), connections, std::move(sink), m_impl->counters,
+		m_impl->bandwidth)
+		->run(url);
 }
 
 }  // namespace ytdlpp::net
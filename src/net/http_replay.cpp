@@ -0,0 +1,248 @@
+#include "net/http_replay.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <nlohmann/json.hpp>
+
+namespace ytdlpp::net {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+// FNV-1a over method, URL and body; 64 bits name entries uniquely enough
+// for one recording session
+std::string entry_key(std::string_view method, std::string_view url,
+					  std::string_view body) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto mix = [&hash](std::string_view part) {
+		for (unsigned char c : part) {
+			hash ^= c;
+			hash *= 0x100000001b3ULL;
+		}
+		hash ^= 0xff;  // Separator, so ("ab", "c") != ("a", "bc")
+		hash *= 0x100000001b3ULL;
+	};
+	mix(method);
+	mix(url);
+	mix(body);
+	return fmt::format("{:016x}", hash);
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+					  [](unsigned char x, unsigned char y) {
+						  return std::tolower(x) == std::tolower(y);
+					  });
+}
+
+std::optional<std::string> read_file(const fs::path &path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return std::nullopt;
+	return std::string((std::istreambuf_iterator<char>(file)),
+					   std::istreambuf_iterator<char>());
+}
+
+bool write_file(const fs::path &path, std::string_view data) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+	file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(file);
+}
+
+}  // namespace
+
+// Forwards to the download's real sink; on close, records the size and
+// (optionally) the bytes it saw.
+class RecordingSink : public FileSink {
+   public:
+	RecordingSink(HttpReplayStore &store, std::string url,
+				  std::shared_ptr<FileSink> sink,
+				  std::shared_ptr<FileSink> copy)
+		: store_(store),
+		  url_(std::move(url)),
+		  sink_(std::move(sink)),
+		  copy_(std::move(copy)) {}
+
+	Result<void> preallocate(long long size) override {
+		size_ = size;
+		if (copy_ && copy_->preallocate(size).has_error()) drop_copy();
+		return sink_->preallocate(size);
+	}
+
+	Result<void> write_at(
+		long long offset, const char *data, size_t size) override {
+		end_ = std::max(end_, offset + static_cast<long long>(size));
+		if (copy_ && copy_->write_at(offset, data, size).has_error()) {
+			drop_copy();
+		}
+		return sink_->write_at(offset, data, size);
+	}
+
+	bool wants_more(long long next_offset,
+					std::function<void()> resume) override {
+		return sink_->wants_more(next_offset, std::move(resume));
+	}
+
+	void abort() override {
+		failed_ = true;
+		sink_->abort();
+	}
+
+	// Only a download that got every byte is recorded: a failed one still
+	// closes cleanly, and its preallocated size would replay as complete
+	Result<void> close() override {
+		auto res = sink_->close();
+		if (copy_) (void)copy_->close();
+		bool complete = !failed_ && (size_ <= 0 || end_ == size_);
+		if (res.has_value() && complete && !closed_) {
+			store_.save_media(url_, size_ > 0 ? size_ : end_);
+		} else if (!closed_ && !complete) {
+			spdlog::debug("Record: download {} incomplete, not saved", url_);
+		}
+		closed_ = true;
+		return res;
+	}
+
+   private:
+	void drop_copy() {
+		spdlog::warn("Record: Cannot save the body of {}", url_);
+		(void)copy_->close();
+		copy_.reset();
+	}
+
+	HttpReplayStore &store_;
+	std::string url_;
+	std::shared_ptr<FileSink> sink_;
+	std::shared_ptr<FileSink> copy_;
+	long long size_ = -1;
+	long long end_ = 0;
+	bool failed_ = false;
+	bool closed_ = false;
+};
+
+HttpReplayStore::HttpReplayStore(HttpReplayOptions options)
+	: options_(std::move(options)), dir_(options_.directory) {
+	if (recording()) {
+		std::error_code ec;
+		fs::create_directories(dir_, ec);
+		if (ec) {
+			spdlog::error("Record: Cannot create {}: {}", dir_.string(),
+						  ec.message());
+		}
+	}
+}
+
+fs::path HttpReplayStore::path_for(std::string_view key,
+								   const char *suffix) const {
+	return dir_ / (std::string(key) + suffix);
+}
+
+std::optional<HttpResponse> HttpReplayStore::find(
+	std::string_view method, const std::string &url,
+	const std::string &body) const {
+	auto key = entry_key(method, url, body);
+	auto meta_text = read_file(path_for(key, ".json"));
+	if (!meta_text) return std::nullopt;
+	auto meta = json::parse(*meta_text, nullptr, false);
+	if (meta.is_discarded() || !meta.is_object()) return std::nullopt;
+
+	HttpResponse res;
+	res.status_code = meta.value("status", 0);
+	res.body = read_file(path_for(key, ".body")).value_or("");
+	if (auto it = meta.find("headers"); it != meta.end() && it->is_object()) {
+		for (const auto &[name, value] : it->items()) {
+			if (!value.is_string()) continue;
+			res.headers[name] = value.get<std::string>();
+		}
+	}
+	return res;
+}
+
+void HttpReplayStore::save(std::string_view method, const std::string &url,
+						   const std::string &body,
+						   const HttpResponse &response) {
+	json headers = json::object();
+	for (const auto &[name, value] : response.headers) {
+		if (iequals(name, "content-encoding") ||
+			iequals(name, "content-length")) {
+			continue;
+		}
+		headers[name] = value;
+	}
+	json meta = {{"method", method},
+				 {"url", url},
+				 {"status", response.status_code},
+				 {"headers", std::move(headers)},
+				 {"size", response.body.size()}};
+
+	auto key = entry_key(method, url, body);
+	std::lock_guard lock(mutex_);
+	if (!write_file(path_for(key, ".body"), response.body) ||
+		!write_file(path_for(key, ".json"), meta.dump(1, '\t'))) {
+		spdlog::warn("Record: Cannot save {} {}", method, url);
+		return;
+	}
+	spdlog::debug("Record: {} {} -> {}", method, url, key);
+}
+
+std::optional<HttpReplayStore::Media> HttpReplayStore::find_media(
+	const std::string &url) const {
+	auto key = entry_key("GET", url, "");
+	auto meta_text = read_file(path_for(key, ".json"));
+	if (!meta_text) return std::nullopt;
+	auto meta = json::parse(*meta_text, nullptr, false);
+	if (meta.is_discarded() || !meta.is_object()) return std::nullopt;
+
+	Media media;
+	media.size = meta.value("size", 0LL);
+	auto body = path_for(key, ".body");
+	std::error_code ec;
+	if (fs::exists(body, ec) &&
+		static_cast<long long>(fs::file_size(body, ec)) == media.size) {
+		media.body = std::move(body);
+	}
+	return media;
+}
+
+std::shared_ptr<FileSink> HttpReplayStore::record_media(
+	const std::string &url, std::shared_ptr<FileSink> sink) {
+	std::shared_ptr<FileSink> copy;
+	if (options_.record_media) {
+		auto body = path_for(entry_key("GET", url, ""), ".body");
+		auto opened = open_file_sink(body.string());
+		if (opened.has_value()) copy = std::move(opened).value();
+	}
+	return std::make_shared<RecordingSink>(
+		*this, url, std::move(sink), std::move(copy));
+}
+
+void HttpReplayStore::save_media(const std::string &url, long long size) {
+	json meta = {{"method", "GET"},
+				 {"url", url},
+				 {"status", 200},
+				 {"headers", json::object()},
+				 {"size", size}};
+	auto key = entry_key("GET", url, "");
+	std::lock_guard lock(mutex_);
+	if (!write_file(path_for(key, ".json"), meta.dump(1, '\t'))) {
+		spdlog::warn("Record: Cannot save download {}", url);
+		return;
+	}
+	spdlog::debug("Record: download {} ({} bytes) -> {}", url, size, key);
+}
+
+std::chrono::nanoseconds HttpReplayStore::transfer_time(size_t bytes) const {
+	if (options_.bandwidth == 0) return {};
+	return std::chrono::nanoseconds(static_cast<int64_t>(
+		static_cast<double>(bytes) * 1e9 /
+		static_cast<double>(options_.bandwidth)));
+}
+
+}  // namespace ytdlpp::net
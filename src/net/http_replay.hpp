@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <ytdlpp/http_client.hpp>
+
+namespace ytdlpp::net {
+
+// =============================================================================
+// HTTP RECORDINGS
+// =============================================================================
+// One entry per request, named by a hash of method, URL and body:
+//   <key>.json  {"method", "url", "status", "headers", "size"}
+//   <key>.body  response body as the caller saw it (already inflated), or
+//               the downloaded bytes when media bodies are recorded
+// Content-Encoding and Content-Length are dropped from recorded headers since
+// the stored body is decoded.
+// =============================================================================
+
+class HttpReplayStore {
+   public:
+	explicit HttpReplayStore(HttpReplayOptions options);
+
+	[[nodiscard]] const HttpReplayOptions &options() const { return options_; }
+	[[nodiscard]] bool replaying() const {
+		return options_.mode == HttpReplayOptions::Mode::replay;
+	}
+	[[nodiscard]] bool recording() const {
+		return options_.mode == HttpReplayOptions::Mode::record;
+	}
+
+	/// Recorded response to the request, or nullopt if it never was.
+	[[nodiscard]] std::optional<HttpResponse> find(
+		std::string_view method, const std::string &url,
+		const std::string &body) const;
+
+	void save(std::string_view method, const std::string &url,
+			  const std::string &body, const HttpResponse &response);
+
+	struct Media {
+		long long size = 0;
+		// Recorded bytes; empty when only the size was recorded
+		std::filesystem::path body;
+	};
+
+	/// Recorded download of `url`, or nullopt if it never was.
+	[[nodiscard]] std::optional<Media> find_media(const std::string &url) const;
+
+	/// Sink forwarding to `sink` that records the download of `url` when it
+	/// closes (with its bytes if options().record_media).
+	std::shared_ptr<FileSink> record_media(const std::string &url,
+										   std::shared_ptr<FileSink> sink);
+
+	/// Replay delay of a response or segment of `bytes` bytes, on top of
+	/// options().latency.
+	[[nodiscard]] std::chrono::nanoseconds transfer_time(size_t bytes) const;
+
+   private:
+	friend class RecordingSink;
+
+	void save_media(const std::string &url, long long size);
+
+	[[nodiscard]] std::filesystem::path path_for(std::string_view key,
+												 const char *suffix) const;
+
+	HttpReplayOptions options_;
+	std::filesystem::path dir_;
+	std::mutex mutex_;	// Serializes writes of recordings
+};
+
+}  // namespace ytdlpp::net
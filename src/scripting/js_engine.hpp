@@ -1,14 +1,34 @@
 #pragma once
 
 #include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 #include <ytdlpp/result.hpp>
 
+#include "../shared_bytes.hpp"
+
 namespace ytdlpp::scripting {
 
+/// Outcome of compiling a script against a V8 code cache.
+struct CodeCacheResult {
+	bool consumed = false;	// The supplied cache was accepted
+	bool rejected = false;	// The supplied cache was stale (V8/flags/source)
+	// Fresh cache data, produced whenever no cache was consumed
+	std::vector<uint8_t> produced;
+};
+
+/// Work done on an engine's worker thread, see JsEngine::stats().
+struct JsEngineStats {
+	uint64_t tasks = 0;		   // Tasks that ran
+	uint64_t queue_depth = 0;  // Posted to the worker, not started yet
+	std::chrono::nanoseconds wait_time{0};	// Summed time spent queued
+	std::chrono::nanoseconds run_time{0};	// Summed time spent running
+};
+
 class JsEngine {
    public:
 	explicit JsEngine(boost::asio::any_io_executor ex);
@@ -18,6 +38,13 @@ class JsEngine {
 	/// worker thread.
 	void shutdown();
 
+	/// True if the isolate was created from the embedded startup snapshot, in
+	/// which case the EJS solver bundle is already loaded.
+	[[nodiscard]] bool booted_from_snapshot() const;
+
+	/// Task counters (relaxed; readable from any thread).
+	[[nodiscard]] JsEngineStats stats() const;
+
 	// Async evaluators
 	template <typename CompletionToken>
 	auto async_evaluate(std::string code, CompletionToken &&token) {
@@ -53,6 +80,22 @@ class JsEngine {
 			token, std::move(func_name), std::move(args));
 	}
 
+	/// Compile and run `code`, consuming `cached_data` if it is non-empty and
+	/// still valid, and producing a new code cache otherwise. V8 reads the
+	/// cache in place; `cached_data.owner` keeps it alive until then.
+	template <typename CompletionToken>
+	auto async_evaluate_cached(std::string code, SharedBytes cached_data,
+							   CompletionToken &&token) {
+		return boost::asio::async_initiate<CompletionToken,
+										   void(Result<CodeCacheResult>)>(
+			[this](auto handler, std::string code, SharedBytes cached_data) {
+				async_evaluate_cached_impl(std::move(code),
+										   std::move(cached_data),
+										   std::move(handler));
+			},
+			token, std::move(code), std::move(cached_data));
+	}
+
 	// Keep synchronous versions for non-critical paths or fallback
 	Result<void> evaluate(const std::string &code);
 	Result<std::string> call_function(const std::string &func_name,
@@ -71,6 +114,11 @@ class JsEngine {
 		std::string code,
 		boost::asio::any_completion_handler<void(Result<std::string>)> handler);
 
+	void async_evaluate_cached_impl(
+		std::string code, SharedBytes cached_data,
+		boost::asio::any_completion_handler<void(Result<CodeCacheResult>)>
+			handler);
+
 	void async_call_function_impl(
 		std::string func_name, std::vector<std::string> args,
 		boost::asio::any_completion_handler<void(Result<std::string>)> handler);
@@ -0,0 +1,99 @@
+#include "js_engine_pool.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace ytdlpp::scripting {
+
+JsEnginePool::Lease &JsEnginePool::Lease::operator=(Lease &&other) noexcept {
+	if (this != &other) {
+		release();
+		slot_ = std::move(other.slot_);
+	}
+	return *this;
+}
+
+void JsEnginePool::Lease::release() {
+	if (!slot_) return;
+	slot_->leases.fetch_sub(1, std::memory_order_acq_rel);
+	slot_.reset();
+}
+
+JsEnginePool::JsEnginePool(boost::asio::any_io_executor ex,
+						   size_t max_isolates)
+	: ex_(std::move(ex)), max_isolates_(std::max<size_t>(1, max_isolates)) {}
+
+JsEnginePool::~JsEnginePool() { shutdown(); }
+
+std::shared_ptr<JsEnginePool::Slot> JsEnginePool::add_slot_locked() {
+	auto slot = std::make_shared<Slot>();
+	slot->engine = std::make_shared<JsEngine>(ex_);
+	slots_.push_back(slot);
+	spdlog::debug("JsEnginePool: started isolate {}/{}", slots_.size(),
+				  max_isolates_);
+	return slot;
+}
+
+JsEnginePool::Lease JsEnginePool::acquire(const std::string &player_id) {
+	std::lock_guard lock(mutex_);
+
+	auto load = [](const std::shared_ptr<Slot> &s) {
+		return s->leases.load(std::memory_order_acquire);
+	};
+
+	std::shared_ptr<Slot> affine;	// Least busy slot holding this player
+	std::shared_ptr<Slot> idle;		// Idle slot, preferring a blank one
+	std::shared_ptr<Slot> lightest;
+	for (const auto &s : slots_) {
+		if (!player_id.empty() && s->player_id == player_id &&
+			(!affine || load(s) < load(affine))) {
+			affine = s;
+		}
+		if (load(s) == 0 && (!idle || s->player_id.empty())) idle = s;
+		if (!lightest || load(s) < load(lightest)) lightest = s;
+	}
+
+	// Growing the pool is preferred over evicting another idle player
+	std::shared_ptr<Slot> chosen;
+	if (affine && load(affine) == 0) {
+		chosen = affine;
+	} else if (idle && idle->player_id.empty()) {
+		chosen = idle;
+	} else if (slots_.size() < max_isolates_) {
+		chosen = add_slot_locked();
+	} else if (idle) {
+		chosen = idle;
+	} else if (affine) {
+		chosen = affine;
+	} else {
+		chosen = lightest;
+	}
+
+	// The extraction loads its player here, so later lookups can follow it
+	if (!player_id.empty()) chosen->player_id = player_id;
+	chosen->leases.fetch_add(1, std::memory_order_acq_rel);
+	return Lease(chosen);
+}
+
+JsEnginePoolStats JsEnginePool::stats() {
+	std::lock_guard lock(mutex_);
+	JsEnginePoolStats out;
+	out.isolates = slots_.size();
+	for (const auto &s : slots_) {
+		if (s->leases.load(std::memory_order_relaxed) > 0) ++out.busy;
+		auto engine = s->engine->stats();
+		out.tasks.tasks += engine.tasks;
+		out.tasks.queue_depth += engine.queue_depth;
+		out.tasks.wait_time += engine.wait_time;
+		out.tasks.run_time += engine.run_time;
+	}
+	return out;
+}
+
+void JsEnginePool::shutdown() {
+	std::lock_guard lock(mutex_);
+	for (auto &s : slots_) { s->engine->shutdown(); }
+}
+
+}  // namespace ytdlpp::scripting
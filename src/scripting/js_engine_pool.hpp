@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "js_engine.hpp"
+
+namespace ytdlpp::scripting {
+
+// =============================================================================
+// JS ENGINE POOL
+// =============================================================================
+// A set of JsEngine instances, each with its own isolate and worker thread, so
+// concurrent extractions don't queue behind one core. Work is routed by player
+// id: an isolate that already holds a player's preprocessed solver is preferred
+// while it is idle, and isolates are created on demand up to the pool size.
+// =============================================================================
+
+/// Snapshot of JsEnginePool::stats(): isolates started so far, how many are
+/// leased to an extraction, and their task counters summed.
+struct JsEnginePoolStats {
+	size_t isolates = 0;
+	size_t busy = 0;
+	JsEngineStats tasks;
+};
+
+class JsEnginePool {
+	struct Slot {
+		std::shared_ptr<JsEngine> engine;
+		std::string player_id;	// Player last routed here (guarded by mutex_)
+		std::atomic<size_t> leases{0};
+	};
+
+   public:
+	// Keeps an engine assigned to one extraction; released on destruction.
+	class Lease {
+	   public:
+		Lease() = default;
+		Lease(Lease &&other) noexcept = default;
+		Lease &operator=(Lease &&other) noexcept;
+		~Lease() { release(); }
+
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+
+		[[nodiscard]] JsEngine &engine() const { return *slot_->engine; }
+		explicit operator bool() const { return slot_ != nullptr; }
+
+		void release();
+
+	   private:
+		friend class JsEnginePool;
+		explicit Lease(std::shared_ptr<Slot> slot) : slot_(std::move(slot)) {}
+
+		std::shared_ptr<Slot> slot_;
+	};
+
+	JsEnginePool(boost::asio::any_io_executor ex, size_t max_isolates);
+	~JsEnginePool();
+
+	JsEnginePool(const JsEnginePool &) = delete;
+	JsEnginePool &operator=(const JsEnginePool &) = delete;
+
+	// Pick an engine for an extraction using `player_id` (may be empty).
+	Lease acquire(const std::string &player_id);
+
+	// Shut down every isolate; later leases get failing engines.
+	void shutdown();
+
+	[[nodiscard]] size_t capacity() const { return max_isolates_; }
+
+	[[nodiscard]] JsEnginePoolStats stats();
+
+   private:
+	std::shared_ptr<Slot> add_slot_locked();
+
+	boost::asio::any_io_executor ex_;
+	size_t max_isolates_;
+	std::mutex mutex_;
+	std::vector<std::shared_ptr<Slot>> slots_;
+};
+
+}  // namespace ytdlpp::scripting
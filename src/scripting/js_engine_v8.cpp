@@ -10,6 +10,10 @@
 
 #include "js_engine.hpp"
 
+#ifdef YTDLPP_V8_SNAPSHOT
+#include "js_snapshot.hpp"
+#endif
+
 namespace ytdlpp::scripting {
 
 struct JsEngine::Impl {
@@ -24,6 +28,44 @@ struct JsEngine::Impl {
 		boost::asio::io_context::executor_type>>
 		work_guard;
 	std::atomic<bool> shutdown_flag{false};
+	// Context comes from the embedded snapshot (EJS bundle preloaded)
+	const bool from_snapshot = snapshot_available();
+
+	// Task counters behind stats()
+	using Clock = std::chrono::steady_clock;
+	std::atomic<uint64_t> tasks{0};
+	std::atomic<uint64_t> queued{0};
+	std::atomic<int64_t> wait_ns{0};
+	std::atomic<int64_t> run_ns{0};
+
+	Clock::time_point task_posted() {
+		queued.fetch_add(1, std::memory_order_relaxed);
+		return Clock::now();
+	}
+
+	Clock::time_point task_started(Clock::time_point posted) {
+		auto now = Clock::now();
+		queued.fetch_sub(1, std::memory_order_relaxed);
+		wait_ns.fetch_add(
+			std::chrono::nanoseconds(now - posted).count(),
+			std::memory_order_relaxed);
+		return now;
+	}
+
+	void task_finished(Clock::time_point started) {
+		run_ns.fetch_add(
+			std::chrono::nanoseconds(Clock::now() - started).count(),
+			std::memory_order_relaxed);
+		tasks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static bool snapshot_available() {
+#ifdef YTDLPP_V8_SNAPSHOT
+		return !detail::get_v8_snapshot().empty();
+#else
+		return false;
+#endif
+	}
 
 	Impl() {
 		work_guard = std::make_unique<boost::asio::executor_work_guard<
@@ -64,6 +106,14 @@ struct JsEngine::Impl {
 
 		create_params.array_buffer_allocator =
 			v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+#ifdef YTDLPP_V8_SNAPSHOT
+		// Must outlive every isolate created from it
+		static const v8::StartupData snapshot = [] {
+			auto blob = detail::get_v8_snapshot();
+			return v8::StartupData{blob.data(), static_cast<int>(blob.size())};
+		}();
+		if (from_snapshot) create_params.snapshot_blob = &snapshot;
+#endif
 		isolate = v8::Isolate::New(create_params);
 
 		v8::Isolate::Scope isolate_scope(isolate);
@@ -76,6 +126,9 @@ struct JsEngine::Impl {
 		}
 
 		context.Reset(isolate, ctx);
+		if (create_params.snapshot_blob) {
+			spdlog::debug("JsEngine: Booted from startup snapshot");
+		}
 	}
 
 	void CleanupV8OnThread() {
@@ -96,8 +149,11 @@ struct JsEngine::Impl {
 		auto future = promise.get_future();
 
 		boost::asio::post(ioc, [this, p = std::move(promise),
-								f = std::forward<Func>(func)]() mutable {
+								f = std::forward<Func>(func),
+								posted = task_posted()]() mutable {
+			auto started = task_started(posted);
 			if (!isolate) {
+				task_finished(started);
 				if constexpr (std::is_void_v<ResultType>)
 					p.set_value();
 				else
@@ -114,11 +170,17 @@ struct JsEngine::Impl {
 			try {
 				if constexpr (std::is_void_v<ResultType>) {
 					f(isolate, ctx);
+					task_finished(started);
 					p.set_value();
 				} else {
-					p.set_value(f(isolate, ctx));
+					auto res = f(isolate, ctx);
+					task_finished(started);
+					p.set_value(std::move(res));
 				}
-			} catch (...) { p.set_exception(std::current_exception()); }
+			} catch (...) {
+				task_finished(started);
+				p.set_exception(std::current_exception());
+			}
 		});
 
 		return future.get();
@@ -128,8 +190,11 @@ struct JsEngine::Impl {
 	template <typename Func, typename Handler>
 	void RunOnWorkerAsync(Func &&func, Handler &&handler) {
 		boost::asio::post(ioc, [this, f = std::forward<Func>(func),
-								h = std::forward<Handler>(handler)]() mutable {
+								h = std::forward<Handler>(handler),
+								posted = task_posted()]() mutable {
+			auto started = task_started(posted);
 			if (!isolate) {
+				task_finished(started);
 				h(outcome::failure(
 					std::make_error_code(std::errc::state_not_recoverable)));
 				return;
@@ -142,8 +207,10 @@ struct JsEngine::Impl {
 
 			try {
 				auto res = f(isolate, ctx);
+				task_finished(started);
 				h(res);
 			} catch (...) {
+				task_finished(started);
 				using ResType = std::invoke_result_t<Func, v8::Isolate *,
 													 v8::Local<v8::Context>>;
 				h(ResType(outcome::failure(
@@ -162,6 +229,19 @@ void JsEngine::shutdown() {
 	if (impl_) { impl_->shutdown(); }
 }
 
+bool JsEngine::booted_from_snapshot() const { return impl_->from_snapshot; }
+
+JsEngineStats JsEngine::stats() const {
+	JsEngineStats out;
+	out.tasks = impl_->tasks.load(std::memory_order_relaxed);
+	out.queue_depth = impl_->queued.load(std::memory_order_relaxed);
+	out.wait_time = std::chrono::nanoseconds(
+		impl_->wait_ns.load(std::memory_order_relaxed));
+	out.run_time = std::chrono::nanoseconds(
+		impl_->run_ns.load(std::memory_order_relaxed));
+	return out;
+}
+
 Result<void> JsEngine::evaluate(const std::string &code) {
 	auto task = [&](v8::Isolate *isolate,
 					v8::Local<v8::Context> context) -> Result<void> {
@@ -344,6 +424,75 @@ void JsEngine::async_evaluate_and_get_impl(
 	impl_->RunOnWorkerAsync(std::move(task), std::move(handler));
 }
 
+void JsEngine::async_evaluate_cached_impl(
+	std::string code, SharedBytes cached_data,
+	boost::asio::any_completion_handler<void(Result<CodeCacheResult>)>
+		handler) {
+	auto task = [code = std::move(code), cached_data = std::move(cached_data)](
+					v8::Isolate *isolate,
+					v8::Local<v8::Context> context) -> Result<CodeCacheResult> {
+		v8::Local<v8::String> source_str;
+		if (!v8::String::NewFromUtf8(isolate, code.data(),
+									 v8::NewStringType::kNormal,
+									 static_cast<int>(code.size()))
+				 .ToLocal(&source_str)) {
+			return std::make_error_code(std::errc::invalid_argument);
+		}
+
+		// Source takes ownership of the CachedData; the bytes stay ours
+		// (possibly a mapped cache file), held by cached_data.owner
+		v8::ScriptCompiler::CachedData *cache = nullptr;
+		if (!cached_data.empty()) {
+			cache = new v8::ScriptCompiler::CachedData(
+				cached_data.data, static_cast<int>(cached_data.size),
+				v8::ScriptCompiler::CachedData::BufferNotOwned);
+		}
+		v8::ScriptCompiler::Source source(source_str, cache);
+		auto options = cache ? v8::ScriptCompiler::kConsumeCodeCache
+							 : v8::ScriptCompiler::kNoCompileOptions;
+
+		v8::Local<v8::Script> script;
+		v8::TryCatch try_catch(isolate);
+		if (!v8::ScriptCompiler::Compile(context, &source, options)
+				 .ToLocal(&script)) {
+			if (try_catch.HasCaught()) {
+				v8::String::Utf8Value error(isolate, try_catch.Exception());
+				spdlog::error("JsEngine: Compile Error (cached): {}",
+							  *error ? *error : "Unknown");
+			}
+			return std::make_error_code(std::errc::invalid_argument);
+		}
+
+		CodeCacheResult out;
+		if (cache) {
+			out.rejected = source.GetCachedData()->rejected;
+			out.consumed = !out.rejected;
+		}
+
+		v8::Local<v8::Value> result;
+		if (!script->Run(context).ToLocal(&result)) {
+			if (try_catch.HasCaught()) {
+				v8::String::Utf8Value error(isolate, try_catch.Exception());
+				spdlog::error("JsEngine: Runtime Error (cached): {}",
+							  *error ? *error : "Unknown");
+			}
+			return std::make_error_code(std::errc::invalid_argument);
+		}
+
+		// Created after running so eagerly used functions are included
+		if (!out.consumed) {
+			std::unique_ptr<v8::ScriptCompiler::CachedData> fresh(
+				v8::ScriptCompiler::CreateCodeCache(
+					script->GetUnboundScript()));
+			if (fresh && fresh->length > 0) {
+				out.produced.assign(fresh->data, fresh->data + fresh->length);
+			}
+		}
+		return out;
+	};
+	impl_->RunOnWorkerAsync(std::move(task), std::move(handler));
+}
+
 void JsEngine::async_call_function_impl(
 	std::string func_name, std::vector<std::string> args,
 	boost::asio::any_completion_handler<void(Result<std::string>)> handler) {
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string_view>
+
+namespace ytdlpp::detail {
+
+// V8 startup snapshot with the EJS solver bundle already evaluated. The
+// definition is generated at build time by ytdlpp-snapshot-gen and only exists
+// when the library is built with YTDLPP_V8_SNAPSHOT.
+std::string_view get_v8_snapshot();
+
+}  // namespace ytdlpp::detail
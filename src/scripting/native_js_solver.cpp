@@ -4,12 +4,11 @@
 
 #include <boost/regex.hpp>
 #include <cstring>
-#include <fstream>
-#include <iostream>
 #include <nlohmann/json.hpp>
-#include <sstream>
 #include <vector>
+#include <ytdlpp/trace.hpp>
 
+#include "../youtube/player_script.hpp"
 #include "js_engine.hpp"
 
 using json = nlohmann::json;
@@ -26,7 +25,118 @@ bool NativeJsSolver::init() {
 // --- Static Helpers for Dynamic Resolution ---
 namespace {
 
-std::string find_sig_function_impl(const std::string &code, const json &obf) {
+// Minimal browser environment the player's top-level statements expect
+constexpr const char *kBrowserStubs = R"(
+        var _dummyFunc = function(){ return _dummyProxy; };
+        var _dummyHandler = {
+            get: function(t,p) {
+                if (p === Symbol.toPrimitive || p === 'toString') return function(){return "";};
+                if (p === 'length') return 0;
+                return _dummyProxy;
+            },
+            set: function(){ return true; },
+            apply: function(){ return _dummyProxy; },
+            construct: function(){ return _dummyProxy; }
+        };
+        var _dummyProxy = new Proxy(_dummyFunc, _dummyHandler);
+
+		var _realDoc = {
+			createElement: function() {
+                return { innerHTML: '', style: {}, appendChild: function(){}, setAttribute: function(){} };
+            },
+			write: function() {},
+			cookie: '',
+            getElementById: function(){ return _dummyProxy; },
+            getElementsByTagName: function(){ return []; },
+            body: _dummyProxy,
+            head: _dummyProxy,
+            documentElement: { style: {} }
+		};
+        var document = new Proxy(_realDoc, {
+            get: function(t,p) { if(p in t) return t[p]; return _dummyProxy; },
+            set: function(t,p,v) { t[p]=v; return true; }
+        });
+
+		var _realWindow = {
+            location: { hostname: 'www.youtube.com', protocol: 'https:', href: 'https://www.youtube.com/' },
+            document: document,
+            navigator: { userAgent: 'Mozilla/5.0' },
+            Intl: {
+                NumberFormat: function() {
+                    var f = function(n){ return ""+n; };
+                    return { format: f };
+                },
+                DateTimeFormat: function() { return { format: function(d){ return d.toString(); } }; }
+            },
+            history: { pushState: function(){}, replaceState: function(){} },
+            screen: { width: 1280, height: 720 },
+            localStorage: { getItem: function(){ return null; }, setItem: function(){} },
+            sessionStorage: { getItem: function(){ return null; }, setItem: function(){} },
+            Error: Error,
+            TypeError: TypeError,
+            XMLHttpRequest: function(){
+                 return {
+                     open: function(){},
+                     send: function(){},
+                     setRequestHeader: function(){},
+                     abort: function(){}
+                 };
+            }
+        };
+
+        // Static method required by some polyfills
+        _realWindow.Intl.NumberFormat.supportedLocalesOf = function(){ return []; };
+
+        var window = new Proxy(_realWindow, {
+             get: function(t,p) { if(p in t) return t[p]; return _dummyProxy; },
+             set: function(t,p,v) { t[p]=v; return true; }
+        });
+
+		var location = window.location;
+		var navigator = window.navigator;
+        var localStorage = window.localStorage;
+        var sessionStorage = window.sessionStorage;
+        var history = window.history;
+        var screen = window.screen;
+        var Intl = window.Intl;
+
+		var g = window;
+		var _yt_player = window;
+
+        // Expose critical globals
+        globalThis.window = window;
+        globalThis.document = document;
+        globalThis.location = window.location;
+        globalThis.navigator = window.navigator;
+        globalThis.XMLHttpRequest = _realWindow.XMLHttpRequest;
+        globalThis.Intl = window.Intl;
+	)";
+
+// Bump when the cached discovery format or the discovery logic changes
+constexpr int kNativeCacheVersion = 2;
+
+// Statements that would run player logic instead of defining functions
+bool is_skipped_statement(const std::string &stmt) {
+	// Always keep 'for' loops as they likely contain definitions
+	if (stmt.rfind("for", 0) == 0) return false;
+	for (const char *kw : {"try", "if", "return", "throw", "while", "do",
+						   "switch", "break", "continue"}) {
+		if (stmt.rfind(kw, 0) == 0) return true;
+	}
+	return false;
+}
+
+// "(?:a|b|c)"
+std::string alternation(const std::vector<std::string> &parts) {
+	std::string out = "(?:";
+	for (size_t i = 0; i < parts.size(); ++i) {
+		out += parts[i] + (i < parts.size() - 1 ? "|" : "");
+	}
+	return out + ")";
+}
+
+// set_part + `\(\s*` + key_part + `\s*,\s*([\w$]+)` + tail
+std::string sig_pattern(const json &obf, const std::string &tail) {
 	std::string arr = obf.value("name", "");
 	int set_idx = obf.value("setIdx", -1);
 	int sig_idx = obf.value("sigIdx", -1);
@@ -53,36 +163,58 @@ std::string find_sig_function_impl(const std::string &code, const json &obf) {
 				arr + "\\[" + std::to_string(sig_cipher_idx) + "\\]");
 	}
 
-	std::string set_part = "(?:";
-	for (size_t i = 0; i < set_accessors.size(); ++i) {
-		set_part +=
-			set_accessors[i] + (i < set_accessors.size() - 1 ? "|" : "");
+	return alternation(set_accessors) + "\\(\\s*" +
+		   alternation(key_patterns) + "\\s*,\\s*([\\w$]+)" + tail;
+}
+
+std::string n_pattern(const json &obf) {
+	std::string arr = obf.value("name", "");
+	int get_idx = obf.value("getIdx", -1);
+	int n_idx = obf.value("nIdx", -1);
+
+	std::vector<std::string> get_accessors;
+	get_accessors.push_back("\\.get");
+	get_accessors.push_back("\\[[\"']get[\"']\\]");
+	if (!arr.empty() && get_idx >= 0) {
+		get_accessors.push_back(
+			"\\[" + arr + "\\[" + std::to_string(get_idx) + "\\]\\]");
 	}
-	set_part += ")";
 
-	std::string key_part = "(?:";
-	for (size_t i = 0; i < key_patterns.size(); ++i) {
-		key_part += key_patterns[i] + (i < key_patterns.size() - 1 ? "|" : "");
+	std::vector<std::string> key_patterns = {R"(["']n["'])"};
+	if (!arr.empty() && n_idx >= 0) {
+		key_patterns.push_back(arr + "\\[" + std::to_string(n_idx) + "\\]");
 	}
-	key_part += ")";
 
-	// Regex: set_part + `\(\s*` + key_part + `\s*,\s*([\w$]+)\)`
-	std::string re_str =
-		set_part + "\\(\\s*" + key_part + "\\s*,\\s*([\\w$]+)\\)";
+	return "\\b([\\w$]+)\\s*=\\s*[\\w$]+" + alternation(get_accessors) +
+		   "\\(\\s*" + alternation(key_patterns) +
+		   "\\)(?:[\\s\\S]*?)\\1\\s*=\\s*([\\w$]+)(?:\\[(\\d+)\\])?\\(\\1\\)";
+}
+
+// Search for `pattern`. `plain` is the same pattern built without an
+// obfuscation array and compiled once; only patterns that differ from it
+// (array-specific accessors) are compiled per call.
+bool search(const std::string &code, const std::string &pattern,
+			const boost::regex &plain, boost::smatch &m) {
+	if (pattern == plain.str()) return boost::regex_search(code, m, plain);
+	return boost::regex_search(code, m, boost::regex(pattern));
+}
+
+std::string find_sig_function_impl(const std::string &code, const json &obf) {
+	static const boost::regex plain_re(sig_pattern(json::object(), "\\)"));
+	static const boost::regex plain_re_call(
+		sig_pattern(json::object(), "\\("));
+
 	try {
-		boost::regex re(re_str);
 		boost::smatch m;
-		if (boost::regex_search(code, m, re)) return m[1];
+		if (search(code, sig_pattern(obf, "\\)"), plain_re, m)) return m[1];
 	} catch (const std::exception &e) {
 		spdlog::error("[native-solver] Regex error (sig): {}", e.what());
 	}
 
-	std::string re_str_call =
-		set_part + "\\(\\s*" + key_part + "\\s*,\\s*([\\w$]+)\\(";
 	try {
-		boost::regex re(re_str_call);
 		boost::smatch m;
-		if (boost::regex_search(code, m, re)) return m[1];
+		if (search(code, sig_pattern(obf, "\\("), plain_re_call, m))
+			return m[1];
 	} catch (...) {}
 
 	static const boost::regex re3(
@@ -94,43 +226,11 @@ std::string find_sig_function_impl(const std::string &code, const json &obf) {
 }
 
 std::string find_n_function_impl(const std::string &code, const json &obf) {
-	std::string arr = obf.value("name", "");
-	int get_idx = obf.value("getIdx", -1);
-	int n_idx = obf.value("nIdx", -1);
-
-	std::vector<std::string> get_accessors;
-	get_accessors.push_back("\\.get");
-	get_accessors.push_back("\\[[\"']get[\"']\\]");
-	if (!arr.empty() && get_idx >= 0) {
-		get_accessors.push_back(
-			"\\[" + arr + "\\[" + std::to_string(get_idx) + "\\]\\]");
-	}
-
-	std::vector<std::string> key_patterns = {R"(["']n["'])"};
-	if (!arr.empty() && n_idx >= 0) {
-		key_patterns.push_back(arr + "\\[" + std::to_string(n_idx) + "\\]");
-	}
+	static const boost::regex plain_re(n_pattern(json::object()));
 
-	std::string get_part = "(?:";
-	for (size_t i = 0; i < get_accessors.size(); ++i) {
-		get_part +=
-			get_accessors[i] + (i < get_accessors.size() - 1 ? "|" : "");
-	}
-	get_part += ")";
-
-	std::string key_part = "(?:";
-	for (size_t i = 0; i < key_patterns.size(); ++i) {
-		key_part += key_patterns[i] + (i < key_patterns.size() - 1 ? "|" : "");
-	}
-	key_part += ")";
-
-	std::string re_str =
-		"\\b([\\w$]+)\\s*=\\s*[\\w$]+" + get_part + "\\(\\s*" + key_part +
-		"\\)(?:[\\s\\S]*?)\\1\\s*=\\s*([\\w$]+)(?:\\[(\\d+)\\])?\\(\\1\\)";
 	try {
-		boost::regex re(re_str);
 		boost::smatch m;
-		if (boost::regex_search(code, m, re)) {
+		if (search(code, n_pattern(obf), plain_re, m)) {
 			if (m[3].matched) {
 				return std::string(m[2]) + "[" + std::string(m[3]) + "]";
 			}
@@ -150,7 +250,8 @@ std::string find_n_function_impl(const std::string &code, const json &obf) {
 
 }  // namespace
 
-bool NativeJsSolver::load_player(const std::string &player_code) {
+bool NativeJsSolver::load_player(const std::string &player_code,
+								 const std::string &player_id) {
 	ready_ = false;
 
 	if (player_code.empty()) {
@@ -158,10 +259,18 @@ bool NativeJsSolver::load_player(const std::string &player_code) {
 		return false;
 	}
 
+	trace::Span span("js", "native_load_player", player_id);
+	if (!player_id.empty() && load_cached_player(player_code, player_id)) {
+		if (span.active()) span.set_detail(player_id + " (cached)");
+		ready_ = true;
+		return true;
+	}
+
 	spdlog::debug("[native-solver] Processing player script ({} bytes)...",
 				  player_code.size());
 
-	std::string body = extract_iife_body(player_code);
+	size_t body_offset = 0;
+	std::string body = extract_iife_body(player_code, &body_offset);
 	if (body.empty()) {
 		spdlog::error("[native-solver] Failed to extract IIFE body");
 		return false;
@@ -177,135 +286,27 @@ bool NativeJsSolver::load_player(const std::string &player_code) {
 	spdlog::debug("[native-solver] Filtered code processing ({} bytes)",
 				  filtered_code.size());
 
-	{
-		std::ofstream out("f:/dev/C++/yt-dlpp/debug_filtered.js");
-		out << filtered_code;
-	}
-
 	// 4. Load browser stubs with Proxy
-	const std::string stubs = R"(
-        var _dummyFunc = function(){ return _dummyProxy; };
-        var _dummyHandler = {
-            get: function(t,p) {
-                if (p === Symbol.toPrimitive || p === 'toString') return function(){return "";};
-                if (p === 'length') return 0;
-                return _dummyProxy;
-            },
-            set: function(){ return true; },
-            apply: function(){ return _dummyProxy; },
-            construct: function(){ return _dummyProxy; }
-        };
-        var _dummyProxy = new Proxy(_dummyFunc, _dummyHandler);
-
-		var _realDoc = {
-			createElement: function() {
-                return { innerHTML: '', style: {}, appendChild: function(){}, setAttribute: function(){} };
-            },
-			write: function() {},
-			cookie: '',
-            getElementById: function(){ return _dummyProxy; },
-            getElementsByTagName: function(){ return []; },
-            body: _dummyProxy,
-            head: _dummyProxy,
-            documentElement: { style: {} }
-		};
-        var document = new Proxy(_realDoc, {
-            get: function(t,p) { if(p in t) return t[p]; return _dummyProxy; },
-            set: function(t,p,v) { t[p]=v; return true; }
-        });
-
-		var _realWindow = {
-            location: { hostname: 'www.youtube.com', protocol: 'https:', href: 'https://www.youtube.com/' },
-            document: document,
-            navigator: { userAgent: 'Mozilla/5.0' },
-            Intl: {
-                NumberFormat: function() {
-                    var f = function(n){ return ""+n; };
-                    return { format: f };
-                },
-                DateTimeFormat: function() { return { format: function(d){ return d.toString(); } }; }
-            },
-            history: { pushState: function(){}, replaceState: function(){} },
-            screen: { width: 1280, height: 720 },
-            localStorage: { getItem: function(){ return null; }, setItem: function(){} },
-            sessionStorage: { getItem: function(){ return null; }, setItem: function(){} },
-            Error: Error,
-            TypeError: TypeError,
-            XMLHttpRequest: function(){
-                 return {
-                     open: function(){},
-                     send: function(){},
-                     setRequestHeader: function(){},
-                     abort: function(){}
-                 };
-            }
-        };
-
-        // Static method required by some polyfills
-        _realWindow.Intl.NumberFormat.supportedLocalesOf = function(){ return []; };
+	(void)js_->evaluate(kBrowserStubs);
 
-        var window = new Proxy(_realWindow, {
-             get: function(t,p) { if(p in t) return t[p]; return _dummyProxy; },
-             set: function(t,p,v) { t[p]=v; return true; }
-        });
-
-		var location = window.location;
-		var navigator = window.navigator;
-        var localStorage = window.localStorage;
-        var sessionStorage = window.sessionStorage;
-        var history = window.history;
-        var screen = window.screen;
-        var Intl = window.Intl;
-
-		var g = window;
-		var _yt_player = window;
-
-        // Expose critical globals
-        globalThis.window = window;
-        globalThis.document = document;
-        globalThis.location = window.location;
-        globalThis.navigator = window.navigator;
-        globalThis.XMLHttpRequest = _realWindow.XMLHttpRequest;
-        globalThis.Intl = window.Intl;
-	)";
-	(void)js_->evaluate(stubs);
-
-	// 5. Load safe code iteratively
+	// 5. Load safe code iteratively. The statements split the body without
+	// gaps, so the cache records each one as [offset, length] in the player
+	// source instead of a second copy of it.
 	int success_count = 0;
 	int fail_count = 0;
+	json loaded = json::array();
+	size_t offset = body_offset;
 	for (const auto &stmt : statements) {
-		bool keep = true;
-
-		if (stmt.rfind("try", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("if", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("return", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("throw", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("while", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("do", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("switch", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("break", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("continue", 0) == 0)
-			keep = false;
-
-		// Always keep 'for' loops as they likely contain definitions
-		if (stmt.rfind("for", 0) == 0) keep = true;
-
-		if (keep) {
-			auto res = js_->evaluate(stmt);
-			if (res.has_error()) {
-				fail_count++;
-			} else {
-				success_count++;
-			}
+		size_t stmt_offset = offset;
+		offset += stmt.size();
+		if (is_skipped_statement(stmt)) continue;
+		auto res = js_->evaluate(stmt);
+		if (res.has_error()) {
+			fail_count++;
+		} else {
+			success_count++;
 		}
+		loaded.push_back({stmt_offset, stmt.size()});
 	}
 	spdlog::info("[native-solver] Executed statements: {} success, {} failed",
 				 success_count, fail_count);
@@ -367,15 +368,79 @@ bool NativeJsSolver::load_player(const std::string &player_code) {
 				 sig_func_name, n_func_name);
 
 	// 8. Store function names
+	install_function_names(sig_func_name, n_func_name);
+
+	if (!player_id.empty()) {
+		json cached = {{"version", kNativeCacheVersion},
+					   {"source_size", player_code.size()},
+					   {"sig", sig_func_name},
+					   {"n", n_func_name},
+					   {"obfuscation", obf_data},
+					   {"statements", std::move(loaded)}};
+		youtube::PlayerScript::cache_native(player_id, cached.dump());
+	}
+
+	ready_ = true;
+	return true;
+}
+
+bool NativeJsSolver::load_cached_player(const std::string &player_code,
+										const std::string &player_id) {
+	auto text = youtube::PlayerScript::get_cached_native(player_id);
+	if (!text) return false;
+
+	auto cached = json::parse(*text, nullptr, false);
+	if (cached.is_discarded() || !cached.is_object() ||
+		cached.value("version", 0) != kNativeCacheVersion ||
+		cached.value("source_size", size_t{0}) != player_code.size() ||
+		!cached.contains("statements") || !cached["statements"].is_array()) {
+		spdlog::debug("[native-solver] Ignoring stale cache for {}", player_id);
+		return false;
+	}
+
+	std::string sig_func_name = cached.value("sig", "");
+	std::string n_func_name = cached.value("n", "");
+	if (sig_func_name.empty() && n_func_name.empty()) return false;
+
+	// [offset, length] ranges of the player source
+	std::vector<std::pair<size_t, size_t>> ranges;
+	ranges.reserve(cached["statements"].size());
+	for (const auto &range : cached["statements"]) {
+		if (!range.is_array() || range.size() != 2 ||
+			!range[0].is_number_unsigned() || !range[1].is_number_unsigned()) {
+			return false;
+		}
+		auto offset = range[0].get<size_t>();
+		auto length = range[1].get<size_t>();
+		if (offset > player_code.size() ||
+			length > player_code.size() - offset) {
+			return false;
+		}
+		ranges.emplace_back(offset, length);
+	}
+
+	// Same statements, same order as the discovery run, so the engine ends
+	// up in the same state without splitting or searching the player again
+	(void)js_->evaluate(kBrowserStubs);
+	for (const auto &[offset, length] : ranges) {
+		(void)js_->evaluate(player_code.substr(offset, length));
+	}
+	install_function_names(sig_func_name, n_func_name);
+
+	spdlog::info(
+		"[native-solver] Using cached functions for {}: sig='{}', n='{}'",
+		player_id, sig_func_name, n_func_name);
+	return true;
+}
+
+void NativeJsSolver::install_function_names(const std::string &sig_func_name,
+											const std::string &n_func_name) {
 	std::string store_names =
 		"globalThis._native_sig_func_name = '" + sig_func_name +
 		"';\n"
 		"globalThis._native_n_func_name = '" +
 		n_func_name + "';";
 	(void)js_->evaluate(store_names);
-
-	ready_ = true;
-	return true;
 }
 
 std::string NativeJsSolver::solve_sig(const std::string &encrypted_sig) const {
@@ -412,7 +477,63 @@ std::string NativeJsSolver::solve_n(const std::string &n_param) const {
 	return n_param;
 }
 
-std::string NativeJsSolver::extract_iife_body(const std::string &player_code) {
+ChallengeResults NativeJsSolver::solve_batch(
+	const std::vector<std::string> &sigs,
+	const std::vector<std::string> &ns) const {
+	ChallengeResults results;
+	for (const auto &s : sigs) results.sig.emplace(s, s);
+	for (const auto &n : ns) results.n.emplace(n, n);
+	if (!ready_ || (sigs.empty() && ns.empty())) return results;
+
+	trace::Span span("js", "native_solve");
+	auto to_js = [](const std::vector<std::string> &list) {
+		return json(list).dump(-1, ' ', false, json::error_handler_t::replace);
+	};
+
+	// Each challenge is solved independently so one failure does not
+	// discard the rest; null entries keep their input.
+	std::string code = R"(
+		(function() {
+			function run(name, list) {
+				var fn = name ? globalThis[name] : null;
+				return list.map(function(x) {
+					if (!fn) return null;
+					try { return fn(x); } catch (e) { return null; }
+				});
+			}
+			return JSON.stringify({
+				sig: run(globalThis._native_sig_func_name, )" +
+					   to_js(sigs) + R"(),
+				n: run(globalThis._native_n_func_name, )" +
+					   to_js(ns) + R"()
+			});
+		})()
+	)";
+	auto res = js_->evaluate_and_get(code);
+	if (!res.has_value()) return results;
+
+	try {
+		auto output = json::parse(res.value());
+		auto apply = [](const json &solved,
+						const std::vector<std::string> &inputs,
+						std::unordered_map<std::string, std::string> &target) {
+			for (size_t i = 0; i < inputs.size() && i < solved.size(); ++i) {
+				if (solved[i].is_string() &&
+					!solved[i].get_ref<const std::string &>().empty()) {
+					target[inputs[i]] = solved[i].get<std::string>();
+				}
+			}
+		};
+		apply(output["sig"], sigs, results.sig);
+		apply(output["n"], ns, results.n);
+	} catch (const std::exception &e) {
+		spdlog::debug("[native-solver] Batch solve JSON error: {}", e.what());
+	}
+	return results;
+}
+
+std::string NativeJsSolver::extract_iife_body(const std::string &player_code,
+											 size_t *body_offset) {
 	static const boost::regex re(R"(\((function\s*\(.+?\)\s*\{))");
 	boost::smatch m;
 	if (boost::regex_search(player_code, m, re)) {
@@ -465,9 +586,9 @@ std::string NativeJsSolver::extract_iife_body(const std::string &player_code) {
 			} else if (c == '}' && !in_quote && !in_regex) {
 				depth--;
 				if (found_start && depth == 0) {
-					return player_code.substr(
-						player_code.find('{', start_pos) + 1,
-						i - player_code.find('{', start_pos) - 1);
+					size_t begin = player_code.find('{', start_pos) + 1;
+					if (body_offset) *body_offset = begin;
+					return player_code.substr(begin, i - begin);
 				}
 			}
 		}
@@ -546,29 +667,7 @@ std::string NativeJsSolver::filter_statements(
 	const std::vector<std::string> &statements) {
 	std::string result;
 	for (const auto &stmt : statements) {
-		bool keep = true;
-		if (stmt.rfind("try", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("if", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("return", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("throw", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("while", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("do", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("switch", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("break", 0) == 0)
-			keep = false;
-		else if (stmt.rfind("continue", 0) == 0)
-			keep = false;
-
-		if (stmt.rfind("for", 0) == 0) keep = true;
-
-		if (keep) result += stmt + "\n";
+		if (!is_skipped_statement(stmt)) result += stmt + "\n";
 	}
 	return result;
 }
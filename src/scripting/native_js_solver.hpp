@@ -3,6 +3,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include <ytdlpp/ejs_solver.hpp>
 
 namespace ytdlpp::scripting {
 class JsEngine;
@@ -34,8 +35,11 @@ class NativeJsSolver {
 
 	/**
 	 * Parse the player script and extract decipher functions.
+	 * With a player_id, discovery results are cached per player (see
+	 * PlayerScript::cache_native) and reused on later loads.
 	 */
-	bool load_player(const std::string &player_code);
+	bool load_player(const std::string &player_code,
+					 const std::string &player_id = "");
 
 	/**
 	 * Solve a signature challenge.
@@ -47,6 +51,12 @@ class NativeJsSolver {
 	 */
 	std::string solve_n(const std::string &n_param) const;
 
+	/**
+	 * Solve all challenges of a video in one evaluation.
+	 */
+	ChallengeResults solve_batch(const std::vector<std::string> &sigs,
+								 const std::vector<std::string> &ns) const;
+
 	/**
 	 * Check if the solver is ready.
 	 */
@@ -66,11 +76,22 @@ class NativeJsSolver {
 	// Parse the jsc() result and extract function names
 	bool parse_jsc_result(const std::string &json_result);
 
+	// Replay cached discovery results for player_id, whose source is
+	// `player_code`; false if none usable
+	bool load_cached_player(const std::string &player_code,
+							const std::string &player_id);
+
+	// Publish the discovered function names to the JS environment
+	void install_function_names(const std::string &sig_func_name,
+								const std::string &n_func_name);
+
 	// Escape a string for safe embedding in JS code
 	static std::string js_escape(const std::string &str);
 
 	// --- Native C++ Parsing Helpers (Robust Fallback) ---
-	std::string extract_iife_body(const std::string &player_code);
+	// `body_offset`, if given, receives where the body starts in the player
+	std::string extract_iife_body(const std::string &player_code,
+								  size_t *body_offset = nullptr);
 	std::vector<std::string> split_toplevel_statements(const std::string &code);
 	std::string filter_statements(const std::vector<std::string> &statements);
 	std::string find_n_function(const std::string &code);
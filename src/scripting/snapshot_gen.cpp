@@ -0,0 +1,116 @@
+// Build-time tool: boots V8, evaluates the EJS solver bundle and serializes the
+// resulting heap as a startup snapshot. The blob is written out as a C++
+// source defining ytdlpp::detail::get_v8_snapshot(), which is compiled into
+// yt-dlpp-lib when YTDLPP_V8_SNAPSHOT is enabled.
+//
+// Usage: ytdlpp-snapshot-gen <output.cpp>
+
+#include <libplatform/libplatform.h>
+#include <v8.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <ytdlpp/ejs_bundle.hpp>
+
+namespace {
+
+bool run_bundle(v8::Isolate *isolate, v8::Local<v8::Context> context) {
+	auto bundle = ytdlpp::detail::get_ejs_bundle();
+	// Same guard EjsSolver uses, so a snapshot-booted isolate reports the
+	// solver as loaded.
+	std::string code = "if (!globalThis._ytdlpp_ejs_loaded) { " +
+					   std::string(bundle) +
+					   "; globalThis._ytdlpp_ejs_loaded = true; }";
+
+	v8::TryCatch try_catch(isolate);
+	v8::Local<v8::String> source;
+	v8::Local<v8::Script> script;
+	v8::Local<v8::Value> result;
+	if (!v8::String::NewFromUtf8(isolate, code.c_str(),
+								 v8::NewStringType::kNormal,
+								 static_cast<int>(code.size()))
+			 .ToLocal(&source) ||
+		!v8::Script::Compile(context, source).ToLocal(&script) ||
+		!script->Run(context).ToLocal(&result)) {
+		if (try_catch.HasCaught()) {
+			v8::String::Utf8Value error(isolate, try_catch.Exception());
+			std::fprintf(stderr, "snapshot-gen: bundle failed: %s\n",
+						 *error ? *error : "Unknown");
+		}
+		return false;
+	}
+	return true;
+}
+
+bool write_source(const std::string &path, const v8::StartupData &blob) {
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+
+	out << "// Auto-generated by ytdlpp-snapshot-gen. Do not edit.\n"
+		   "#include \"scripting/js_snapshot.hpp\"\n\n"
+		   "namespace ytdlpp::detail {\n\n"
+		   "namespace {\n"
+		   "alignas(16) const unsigned char kSnapshotData[] = {\n";
+	char hex[8];
+	for (int i = 0; i < blob.raw_size; ++i) {
+		std::snprintf(hex, sizeof(hex), "0x%02x,",
+					  static_cast<unsigned char>(blob.data[i]));
+		out << (i % 16 == 0 ? "    " : "") << hex
+			<< (i % 16 == 15 ? "\n" : "");
+	}
+	out << "\n};\n"
+		   "}  // namespace\n\n"
+		   "std::string_view get_v8_snapshot() {\n"
+		   "    return std::string_view(\n"
+		   "        reinterpret_cast<const char *>(kSnapshotData), "
+		<< blob.raw_size
+		<< ");\n"
+		   "}\n\n"
+		   "}  // namespace ytdlpp::detail\n";
+	return static_cast<bool>(out);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		std::fprintf(stderr, "usage: %s <output.cpp>\n", argv[0]);
+		return 2;
+	}
+
+	std::unique_ptr<v8::Platform> platform = v8::platform::NewDefaultPlatform();
+	v8::V8::InitializePlatform(platform.get());
+	v8::V8::Initialize();
+
+	v8::StartupData blob{nullptr, 0};
+	{
+		v8::SnapshotCreator creator;
+		v8::Isolate *isolate = creator.GetIsolate();
+		{
+			v8::HandleScope handle_scope(isolate);
+			v8::Local<v8::Context> context = v8::Context::New(isolate);
+			v8::Context::Scope context_scope(context);
+			if (!run_bundle(isolate, context)) return 1;
+			creator.SetDefaultContext(context);
+		}
+		// Keep compiled functions so the first jsc() call skips lazy compile
+		blob = creator.CreateBlob(
+			v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+	}
+
+	if (blob.data == nullptr || blob.raw_size <= 0) {
+		std::fprintf(stderr, "snapshot-gen: failed to create snapshot\n");
+		return 1;
+	}
+
+	bool ok = write_source(argv[1], blob);
+	std::printf("snapshot-gen: %d byte snapshot -> %s\n", blob.raw_size,
+				argv[1]);
+	delete[] blob.data;
+
+	v8::V8::Dispose();
+	v8::V8::DisposePlatform();
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,444 @@
+#include "server/extract_server.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <deque>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <ytdlpp/extractor.hpp>
+
+#include "server/metrics.hpp"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace ytdlpp::server {
+
+using tcp = asio::ip::tcp;
+
+namespace {
+
+// Request bodies are a URL in a small JSON object
+constexpr size_t kMaxRequestBody = 64 * 1024;
+
+using Request = http::request<http::string_body>;
+using Response = http::response<http::string_body>;
+
+Response text_response(http::status status, std::string body,
+					   const char *content_type, unsigned version,
+					   bool keep_alive) {
+	Response res{status, version};
+	res.set(http::field::server, "yt-dlpp");
+	res.set(http::field::content_type, content_type);
+	res.keep_alive(keep_alive);
+	res.body() = std::move(body);
+	res.prepare_payload();
+	return res;
+}
+
+Response json_response(http::status status, const nlohmann::json &body,
+					   unsigned version, bool keep_alive) {
+	return text_response(
+		status, body.dump(), "application/json", version, keep_alive);
+}
+
+Response error_response(http::status status, std::string_view message,
+						unsigned version, bool keep_alive) {
+	return json_response(
+		status, {{"error", std::string(message)}}, version, keep_alive);
+}
+
+}  // namespace
+
+// =============================================================================
+// Server state
+// =============================================================================
+// Everything runs on the server's executor, which must not run handlers
+// concurrently (a single-threaded io_context, as in the CLI, or a strand).
+
+struct ExtractServer::Impl : std::enable_shared_from_this<ExtractServer::Impl> {
+	asio::any_io_executor ex;
+	youtube::Extractor &extractor;
+	ServerOptions options;
+	tcp::acceptor acceptor;
+	asio::steady_timer drain_timer;
+
+	std::unordered_set<Session *> sessions;
+	bool draining = false;
+	std::function<void()> on_drained;
+	uint64_t requests = 0;	// Read so far, for /metrics
+
+	Impl(asio::any_io_executor e, youtube::Extractor &x, ServerOptions opts)
+		: ex(std::move(e)),
+		  extractor(x),
+		  options(std::move(opts)),
+		  acceptor(ex),
+		  drain_timer(ex) {}
+
+	void do_accept();
+	[[nodiscard]] std::string metrics() const;
+	void begin_drain(std::function<void()> cb);
+	void remove(Session *session);
+	void check_drained();
+};
+
+// =============================================================================
+// Session
+// =============================================================================
+// One keep-alive connection. Reads run ahead of the writes by up to
+// max_pipelined requests; each request gets a slot in `queue_` when it is
+// read, and the writer sends the head slot once its extraction has filled it.
+
+class Session : public std::enable_shared_from_this<Session> {
+   public:
+	Session(std::shared_ptr<ExtractServer::Impl> server, tcp::socket socket)
+		: server_(std::move(server)),
+		  socket_(std::move(socket)),
+		  idle_timer_(server_->ex) {
+		server_->sessions.insert(this);
+	}
+
+	~Session() { server_->remove(this); }
+
+	Session(const Session &) = delete;
+	Session &operator=(const Session &) = delete;
+
+	void start() { do_read(); }
+
+	// Stop reading; close now if idle, else after the queued responses.
+	// A read in flight is ended by shutting down the receive side, which
+	// leaves the queued responses free to go out.
+	void drain() {
+		read_closed_ = true;
+		if (queue_.empty() && !writing_) return close();
+		if (reading_) {
+			beast::error_code ec;
+			socket_.shutdown(tcp::socket::shutdown_receive, ec);
+		}
+	}
+
+	void close() {
+		beast::error_code ec;
+		socket_.shutdown(tcp::socket::shutdown_both, ec);
+		socket_.close(ec);
+		idle_timer_.cancel();
+	}
+
+   private:
+	struct Slot {
+		std::optional<Response> response;
+	};
+
+	void do_read() {
+		if (read_closed_ || reading_) return;
+		// Resumed by on_write() once the backlog shrinks
+		if (queue_.size() >= server_->options.max_pipelined) return;
+
+		parser_.emplace();
+		parser_->body_limit(kMaxRequestBody);
+		// Only an idle connection times out; queued work keeps it open
+		if (queue_.empty() && !writing_) arm_idle_timer();
+
+		reading_ = true;
+		http::async_read(socket_, buffer_, *parser_,
+						 [self = shared_from_this()](
+							 beast::error_code ec, size_t /*bytes*/) {
+							 self->on_read(ec);
+						 });
+	}
+
+	void on_read(beast::error_code ec) {
+		reading_ = false;
+		if (ec) {
+			// end_of_stream, or closed by drain() or the idle timer: answer
+			// what was already asked, then close
+			if (ec != http::error::end_of_stream &&
+				ec != asio::error::operation_aborted) {
+				spdlog::debug("Server: Read failed: {}", ec.message());
+			}
+			read_closed_ = true;
+			if (queue_.empty() && !writing_) close();
+			return;
+		}
+
+		// Read while draining (e.g. already buffered): not answered, the
+		// client retries it elsewhere once the connection closes
+		if (read_closed_) {
+			if (queue_.empty() && !writing_) close();
+			return;
+		}
+
+		idle_timer_.cancel();
+		Request req = parser_->release();
+		if (!req.keep_alive()) read_closed_ = true;
+
+		auto slot = std::make_shared<Slot>();
+		queue_.push_back(slot);
+		handle(std::move(req), slot);
+		do_read();
+	}
+
+	void handle(Request req, const std::shared_ptr<Slot> &slot) {
+		unsigned version = req.version();
+		bool keep_alive = req.keep_alive();
+
+		auto finish = [self = shared_from_this(), slot](Response res) {
+			slot->response = std::move(res);
+			self->do_write();
+		};
+
+		++server_->requests;
+		auto target = std::string_view(req.target().data(),
+									   req.target().size());
+		if (target == "/metrics") {
+			if (req.method() != http::verb::get) {
+				return finish(error_response(http::status::method_not_allowed,
+											 "Use GET", version, keep_alive));
+			}
+			return finish(text_response(http::status::ok, server_->metrics(),
+										MetricsWriter::kContentType, version,
+										keep_alive));
+		}
+		if (target == "/health") {
+			if (req.method() != http::verb::get) {
+				return finish(error_response(http::status::method_not_allowed,
+											 "Use GET", version, keep_alive));
+			}
+			return finish(json_response(http::status::ok, {{"status", "ok"}},
+										version, keep_alive));
+		}
+		if (target != "/extract") {
+			return finish(error_response(http::status::not_found,
+										 "Unknown path", version, keep_alive));
+		}
+		if (req.method() != http::verb::post) {
+			return finish(error_response(http::status::method_not_allowed,
+										 "Use POST", version, keep_alive));
+		}
+
+		auto body = nlohmann::json::parse(req.body(), nullptr, false);
+		if (body.is_discarded() || !body.is_object() ||
+			!body.contains("url") || !body["url"].is_string()) {
+			return finish(error_response(
+				http::status::bad_request,
+				"Expected a JSON object with a \"url\" string", version,
+				keep_alive));
+		}
+		auto url = body["url"].get<std::string>();
+
+		auto &extractor = server_->extractor;
+		if (auto search = youtube::parse_search_url(url)) {
+			return extractor.async_search(
+				*search, [finish = std::move(finish), version,
+						  keep_alive](Result<std::vector<SearchResult>> res) {
+					if (res.has_error()) {
+						return finish(error_response(
+							http::status::bad_gateway, res.error().message(),
+							version, keep_alive));
+					}
+					auto j = nlohmann::json::array();
+					for (const auto &r : res.value()) {
+						nlohmann::json item;
+						youtube::to_json(item, r);
+						j.push_back(std::move(item));
+					}
+					finish(json_response(
+						http::status::ok, j, version, keep_alive));
+				});
+		}
+
+		extractor.async_process(
+			url, [finish = std::move(finish), version,
+				  keep_alive](Result<VideoInfo> res) {
+				if (res.has_error()) {
+					return finish(error_response(http::status::bad_gateway,
+												 res.error().message(),
+												 version, keep_alive));
+				}
+				nlohmann::json j;
+				youtube::to_json(j, res.value());
+				finish(json_response(http::status::ok, j, version, keep_alive));
+			});
+	}
+
+	void do_write() {
+		if (writing_ || queue_.empty() || !queue_.front()->response) return;
+
+		auto &res = *queue_.front()->response;
+		// The last response before closing tells the client so
+		if (read_closed_ && queue_.size() == 1) res.keep_alive(false);
+
+		writing_ = true;
+		http::async_write(socket_, res,
+						  [self = shared_from_this()](
+							  beast::error_code ec, size_t /*bytes*/) {
+							  self->on_write(ec);
+						  });
+	}
+
+	void on_write(beast::error_code ec) {
+		writing_ = false;
+		if (ec) {
+			spdlog::debug("Server: Write failed: {}", ec.message());
+			read_closed_ = true;
+			queue_.clear();
+			close();
+			return;
+		}
+
+		bool keep_alive = queue_.front()->response->keep_alive();
+		queue_.pop_front();
+		if (!keep_alive) read_closed_ = true;
+
+		if (queue_.empty() && read_closed_) return close();
+		if (queue_.empty() && reading_) arm_idle_timer();
+		do_write();
+		do_read();
+	}
+
+	void arm_idle_timer() {
+		idle_timer_.expires_after(server_->options.idle_timeout);
+		idle_timer_.async_wait([weak = weak_from_this()](beast::error_code ec) {
+			if (ec) return;
+			if (auto self = weak.lock()) self->close();
+		});
+	}
+
+	std::shared_ptr<ExtractServer::Impl> server_;
+	tcp::socket socket_;
+	asio::steady_timer idle_timer_;
+	beast::flat_buffer buffer_;
+	std::optional<http::request_parser<http::string_body>> parser_;
+
+	std::deque<std::shared_ptr<Slot>> queue_;  // In request order
+	bool reading_ = false;
+	bool writing_ = false;
+	bool read_closed_ = false;
+};
+
+// =============================================================================
+// ExtractServer::Impl
+// =============================================================================
+
+void ExtractServer::Impl::do_accept() {
+	acceptor.async_accept([self = shared_from_this()](
+							  beast::error_code ec, tcp::socket socket) {
+		if (self->draining || !self->acceptor.is_open()) return;
+		if (ec) {
+			spdlog::warn("Server: Accept failed: {}", ec.message());
+		} else {
+			std::make_shared<Session>(self, std::move(socket))->start();
+		}
+		self->do_accept();
+	});
+}
+
+void ExtractServer::Impl::begin_drain(std::function<void()> cb) {
+	if (draining) return;
+	draining = true;
+	on_drained = std::move(cb);
+
+	beast::error_code ec;
+	acceptor.close(ec);
+
+	spdlog::info("Server: Draining {} connection(s)", sessions.size());
+	for (auto *s : sessions) s->drain();
+
+	drain_timer.expires_after(options.drain_timeout);
+	drain_timer.async_wait([self = shared_from_this()](beast::error_code ec) {
+		if (ec || self->sessions.empty()) return;
+		spdlog::warn("Server: Drain timed out, closing {} connection(s)",
+					 self->sessions.size());
+		std::vector<Session *> left(self->sessions.begin(),
+									self->sessions.end());
+		for (auto *s : left) s->close();
+		// A session waiting on an extraction has no socket operation to
+		// abort and stays until the extraction returns; don't wait for it
+		if (self->on_drained) {
+			asio::post(self->ex, std::exchange(self->on_drained, nullptr));
+		}
+	});
+	check_drained();
+}
+
+std::string ExtractServer::Impl::metrics() const {
+	MetricsWriter out;
+	out.counter("ytdlpp_server_requests_total", "HTTP requests read",
+				static_cast<double>(requests));
+	out.gauge("ytdlpp_server_connections", "Open client connections",
+			  static_cast<double>(sessions.size()));
+	write_metrics(out, extractor.stats());
+	if (options.extra_metrics) options.extra_metrics(out);
+	return out.str();
+}
+
+void ExtractServer::Impl::remove(Session *session) {
+	sessions.erase(session);
+	check_drained();
+}
+
+void ExtractServer::Impl::check_drained() {
+	if (!draining || !sessions.empty() || !on_drained) return;
+	drain_timer.cancel();
+	asio::post(ex, std::exchange(on_drained, nullptr));
+}
+
+// =============================================================================
+// ExtractServer
+// =============================================================================
+
+ExtractServer::ExtractServer(asio::any_io_executor ex,
+							 youtube::Extractor &extractor,
+							 ServerOptions options)
+	: m_impl(std::make_shared<Impl>(
+		  std::move(ex), extractor, std::move(options))) {}
+
+ExtractServer::~ExtractServer() {
+	beast::error_code ec;
+	m_impl->acceptor.close(ec);
+}
+
+Result<void> ExtractServer::start() {
+	beast::error_code ec;
+	auto address = asio::ip::make_address(m_impl->options.address, ec);
+	if (ec) {
+		spdlog::error("Server: Invalid address: {}", m_impl->options.address);
+		return outcome::failure(errc::invalid_url);
+	}
+
+	auto &acceptor = m_impl->acceptor;
+	tcp::endpoint endpoint{address, m_impl->options.port};
+	acceptor.open(endpoint.protocol(), ec);
+	if (!ec) acceptor.set_option(asio::socket_base::reuse_address(true), ec);
+	if (!ec) acceptor.bind(endpoint, ec);
+	if (!ec) acceptor.listen(asio::socket_base::max_listen_connections, ec);
+	if (!ec) {
+		m_impl->do_accept();
+		return outcome::success();
+	}
+
+	spdlog::error("Server: Cannot listen on {}:{}: {}",
+				  m_impl->options.address, m_impl->options.port, ec.message());
+	return outcome::failure(errc::request_failed);
+}
+
+unsigned short ExtractServer::port() const {
+	beast::error_code ec;
+	auto endpoint = m_impl->acceptor.local_endpoint(ec);
+	return ec ? 0 : endpoint.port();
+}
+
+void ExtractServer::drain(std::function<void()> on_drained) {
+	m_impl->begin_drain(std::move(on_drained));
+}
+
+}  // namespace ytdlpp::server
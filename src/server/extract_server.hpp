@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <ytdlpp/result.hpp>
+
+namespace ytdlpp::youtube {
+class Extractor;
+}
+
+namespace ytdlpp::server {
+
+namespace asio = boost::asio;
+
+class Session;
+class MetricsWriter;
+
+struct ServerOptions {
+	// Loopback only: the daemon has no authentication
+	std::string address = "127.0.0.1";
+	unsigned short port = 8765;	 // 0 picks a free port (see port())
+	// Requests read ahead of their responses on one connection
+	size_t max_pipelined = 16;
+	// Idle keep-alive connections are closed after this long
+	std::chrono::seconds idle_timeout{60};
+	// drain() force-closes connections still busy after this long
+	std::chrono::seconds drain_timeout{30};
+	// Appended to GET /metrics after the server's and the extractor's own
+	// metrics, e.g. the HttpClient's (see metrics.hpp); runs on the
+	// server's executor
+	std::function<void(MetricsWriter &)> extra_metrics;
+};
+
+// =============================================================================
+// EXTRACT SERVER
+// =============================================================================
+// Long-running HTTP/1.1 front end to a warm Extractor, so callers skip V8
+// startup, player loading and TLS setup on every job.
+//
+//   POST /extract  {"url": "..."} -> to_json(VideoInfo), as --dump-json;
+//                  a ytsearch URL returns an array of to_json(SearchResult)
+//   GET  /health   -> {"status": "ok"}
+//   GET  /metrics  -> Prometheus text: requests, connections, extractor
+//                  and cache counters, V8 queue, plus extra_metrics
+//
+// Failures return {"error": "..."} with 400 (bad request), 404, 405 or 502
+// (extraction failed). Connections are keep-alive and pipelined: requests
+// are read and extracted concurrently, and the responses are written back in
+// request order.
+// =============================================================================
+
+class ExtractServer {
+   public:
+	ExtractServer(asio::any_io_executor ex, youtube::Extractor &extractor,
+				  ServerOptions options = {});
+	~ExtractServer();
+
+	ExtractServer(const ExtractServer &) = delete;
+	ExtractServer &operator=(const ExtractServer &) = delete;
+
+	/// Bind, listen and start accepting connections.
+	Result<void> start();
+
+	/// Port actually bound (after start()).
+	[[nodiscard]] unsigned short port() const;
+
+	/// Graceful shutdown: stop accepting, close idle connections, and close
+	/// the others once every request they already sent has been answered.
+	/// `on_drained` runs on the executor once no connection is left.
+	void drain(std::function<void()> on_drained);
+
+   private:
+	friend class Session;
+
+	struct Impl;
+	std::shared_ptr<Impl> m_impl;
+};
+
+}  // namespace ytdlpp::server
@@ -0,0 +1,173 @@
+#include "server/metrics.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <iterator>
+#include <ytdlpp/extractor.hpp>
+#include <ytdlpp/http_client.hpp>
+
+namespace ytdlpp::server {
+
+namespace {
+
+double seconds(std::chrono::nanoseconds d) {
+	return std::chrono::duration<double>(d).count();
+}
+
+}  // namespace
+
+void MetricsWriter::family(std::string_view name, const char *type,
+						   std::string_view help) {
+	fmt::format_to(std::back_inserter(out_), "# HELP {} {}\n# TYPE {} {}\n",
+				   name, help, name, type);
+}
+
+void MetricsWriter::sample(std::string_view name, double value,
+						   Labels labels) {
+	out_ += name;
+	if (labels.size() > 0) {
+		char sep = '{';
+		for (const auto &[key, label] : labels) {
+			out_ += sep;
+			out_ += key;
+			out_ += "=\"";
+			write_label_value(label);
+			out_ += '"';
+			sep = ',';
+		}
+		out_ += '}';
+	}
+	fmt::format_to(std::back_inserter(out_), " {}\n", value);
+}
+
+void MetricsWriter::counter(std::string_view name, std::string_view help,
+							double value) {
+	family(name, "counter", help);
+	sample(name, value);
+}
+
+void MetricsWriter::gauge(std::string_view name, std::string_view help,
+						  double value) {
+	family(name, "gauge", help);
+	sample(name, value);
+}
+
+void MetricsWriter::write_label_value(std::string_view value) {
+	for (char c : value) {
+		switch (c) {
+			case '\\': out_ += "\\\\"; break;
+			case '"': out_ += "\\\""; break;
+			case '\n': out_ += "\\n"; break;
+			default: out_ += c;
+		}
+	}
+}
+
+void write_metrics(MetricsWriter &out, const youtube::ExtractorStats &s) {
+	out.counter("ytdlpp_extractions_total", "Extraction sessions started",
+				static_cast<double>(s.extractions));
+	out.counter("ytdlpp_extraction_failures_total",
+				"Extraction sessions that failed",
+				static_cast<double>(s.failures));
+	out.gauge("ytdlpp_extractions_active", "Extraction sessions running",
+			  static_cast<double>(s.active));
+	out.counter("ytdlpp_extractions_coalesced_total",
+				"Requests that joined an extraction in flight",
+				static_cast<double>(s.coalesced));
+
+	out.family("ytdlpp_info_cache_lookups_total", "counter",
+			   "Extraction result cache lookups");
+	out.sample("ytdlpp_info_cache_lookups_total",
+			   static_cast<double>(s.info_cache_hits), {{"result", "hit"}});
+	out.sample("ytdlpp_info_cache_lookups_total",
+			   static_cast<double>(s.info_cache_misses), {{"result", "miss"}});
+
+	out.family("ytdlpp_player_cache_lookups_total", "counter",
+			   "Player script, bytecode and solver cache lookups");
+	out.sample("ytdlpp_player_cache_lookups_total",
+			   static_cast<double>(s.player_cache_memory_hits),
+			   {{"result", "memory"}});
+	out.sample("ytdlpp_player_cache_lookups_total",
+			   static_cast<double>(s.player_cache_disk_hits),
+			   {{"result", "disk"}});
+	out.sample("ytdlpp_player_cache_lookups_total",
+			   static_cast<double>(s.player_cache_misses),
+			   {{"result", "miss"}});
+
+	out.gauge("ytdlpp_js_isolates", "V8 isolates started",
+			  static_cast<double>(s.js_isolates));
+	out.gauge("ytdlpp_js_isolates_busy", "V8 isolates leased to extractions",
+			  static_cast<double>(s.js_isolates_busy));
+	out.gauge("ytdlpp_js_queue_depth", "Tasks waiting for a V8 worker",
+			  static_cast<double>(s.js_queue_depth));
+	out.counter("ytdlpp_js_tasks_total", "Tasks run on V8 workers",
+				static_cast<double>(s.js_tasks));
+	out.counter("ytdlpp_js_task_wait_seconds_total",
+				"Time V8 tasks spent queued", seconds(s.js_wait_time));
+	out.counter("ytdlpp_js_task_run_seconds_total",
+				"Time V8 tasks spent running", seconds(s.js_run_time));
+}
+
+void write_metrics(MetricsWriter &out, const net::HttpClientStats &s) {
+	out.family("ytdlpp_http_pool_requests_total", "counter",
+			   "Requests by whether a pooled connection was reused");
+	out.sample("ytdlpp_http_pool_requests_total",
+			   static_cast<double>(s.pool_hits), {{"result", "hit"}});
+	out.sample("ytdlpp_http_pool_requests_total",
+			   static_cast<double>(s.pool_misses), {{"result", "miss"}});
+
+	out.family("ytdlpp_dns_cache_lookups_total", "counter",
+			   "DNS cache lookups (process-wide)");
+	out.sample("ytdlpp_dns_cache_lookups_total",
+			   static_cast<double>(s.dns_hits), {{"result", "hit"}});
+	out.sample("ytdlpp_dns_cache_lookups_total",
+			   static_cast<double>(s.dns_misses), {{"result", "miss"}});
+
+	out.family("ytdlpp_tls_handshakes_total", "counter",
+			   "TLS handshakes by whether a cached session resumed");
+	out.sample("ytdlpp_tls_handshakes_total",
+			   static_cast<double>(s.tls.hits), {{"resumed", "true"}});
+	out.sample("ytdlpp_tls_handshakes_total",
+			   static_cast<double>(s.tls.misses), {{"resumed", "false"}});
+
+	out.family("ytdlpp_http_active", "gauge",
+			   "Requests and downloads in flight");
+	out.sample("ytdlpp_http_active", static_cast<double>(s.active_requests),
+			   {{"kind", "request"}});
+	out.sample("ytdlpp_http_active", static_cast<double>(s.active_downloads),
+			   {{"kind", "download"}});
+
+	out.family("ytdlpp_http_transfers_total", "counter",
+			   "Requests and downloads completed, by host");
+	for (const auto &[host, t] : s.hosts) {
+		out.sample("ytdlpp_http_transfers_total",
+				   static_cast<double>(t.requests), {{"host", host}});
+	}
+	out.family("ytdlpp_http_transfer_failures_total", "counter",
+			   "Requests and downloads that failed, by host");
+	for (const auto &[host, t] : s.hosts) {
+		out.sample("ytdlpp_http_transfer_failures_total",
+				   static_cast<double>(t.failures), {{"host", host}});
+	}
+	out.family("ytdlpp_http_received_bytes_total", "counter",
+			   "Body bytes received, by host");
+	for (const auto &[host, t] : s.hosts) {
+		out.sample("ytdlpp_http_received_bytes_total",
+				   static_cast<double>(t.bytes), {{"host", host}});
+	}
+	out.family("ytdlpp_http_transfer_seconds_total", "counter",
+			   "Time spent on requests and downloads, by host");
+	for (const auto &[host, t] : s.hosts) {
+		out.sample("ytdlpp_http_transfer_seconds_total", seconds(t.time),
+				   {{"host", host}});
+	}
+	out.family("ytdlpp_http_throughput_bytes_per_second", "gauge",
+			   "Mean receive rate since start, by host");
+	for (const auto &[host, t] : s.hosts) {
+		out.sample("ytdlpp_http_throughput_bytes_per_second",
+				   t.throughput(), {{"host", host}});
+	}
+}
+
+}  // namespace ytdlpp::server
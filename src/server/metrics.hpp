@@ -0,0 +1,52 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ytdlpp::net {
+struct HttpClientStats;
+}
+
+namespace ytdlpp::youtube {
+struct ExtractorStats;
+}
+
+namespace ytdlpp::server {
+
+// =============================================================================
+// METRICS
+// =============================================================================
+// Builds a GET /metrics body in the Prometheus text exposition format
+// (version 0.0.4). A family is declared once with its type and help text,
+// followed by its samples; totals are counters, the rest gauges.
+// =============================================================================
+
+class MetricsWriter {
+   public:
+	using Labels = std::initializer_list<std::pair<std::string_view,
+												   std::string_view>>;
+
+	static constexpr const char *kContentType = "text/plain; version=0.0.4";
+
+	void family(std::string_view name, const char *type,
+				std::string_view help);
+	void sample(std::string_view name, double value, Labels labels = {});
+
+	/// Family with a single, unlabelled sample.
+	void counter(std::string_view name, std::string_view help, double value);
+	void gauge(std::string_view name, std::string_view help, double value);
+
+	[[nodiscard]] const std::string &str() const { return out_; }
+
+   private:
+	void write_label_value(std::string_view value);
+
+	std::string out_;
+};
+
+void write_metrics(MetricsWriter &out, const youtube::ExtractorStats &stats);
+void write_metrics(MetricsWriter &out, const net::HttpClientStats &stats);
+
+}  // namespace ytdlpp::server
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ytdlpp {
+
+// =============================================================================
+// SHARED BYTES
+// =============================================================================
+// Read-only byte range kept alive by `owner` (a mapped cache file, a vector),
+// so cached data can be passed down to V8 without copying it.
+// =============================================================================
+
+struct SharedBytes {
+	std::shared_ptr<const void> owner;
+	const uint8_t *data = nullptr;
+	size_t size = 0;
+
+	[[nodiscard]] bool empty() const { return size == 0; }
+
+	static SharedBytes from_vector(std::vector<uint8_t> bytes) {
+		auto owned = std::make_shared<const std::vector<uint8_t>>(
+			std::move(bytes));
+		return {owned, owned->data(), owned->size()};
+	}
+};
+
+}  // namespace ytdlpp
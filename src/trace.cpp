@@ -0,0 +1,149 @@
+#include <fmt/format.h>
+
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+#include <ytdlpp/trace.hpp>
+
+namespace ytdlpp::trace {
+
+namespace {
+
+struct Registry {
+	std::mutex mutex;
+	std::shared_ptr<const Sink> sink;
+};
+
+Registry &registry() {
+	// Leaked so spans ending during static destruction find it
+	static auto *r = new Registry();
+	return *r;
+}
+
+}  // namespace
+
+namespace detail {
+
+std::atomic<bool> g_enabled{false};
+
+void emit(Event &&event) {
+	std::shared_ptr<const Sink> sink;
+	{
+		auto &r = registry();
+		std::lock_guard lock(r.mutex);
+		sink = r.sink;
+	}
+	// Uninstalled while the span was open
+	if (sink) (*sink)(event);
+}
+
+uint64_t next_async_id() {
+	static std::atomic<uint64_t> next{1};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+void set_sink(Sink sink) {
+	auto &r = registry();
+	std::lock_guard lock(r.mutex);
+	if (sink) {
+		r.sink = std::make_shared<const Sink>(std::move(sink));
+	} else {
+		r.sink.reset();
+	}
+	detail::g_enabled.store(r.sink != nullptr, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// CHROME TRACE RECORDER
+// =============================================================================
+
+struct ChromeTraceRecorder::State {
+	const Clock::time_point epoch = Clock::now();
+	mutable std::mutex mutex;
+	std::vector<Event> events;
+	bool installed = false;
+};
+
+ChromeTraceRecorder::ChromeTraceRecorder()
+	: state_(std::make_shared<State>()) {}
+
+ChromeTraceRecorder::~ChromeTraceRecorder() {
+	if (state_->installed) set_sink(nullptr);
+}
+
+void ChromeTraceRecorder::install() {
+	state_->installed = true;
+	set_sink([state = state_](const Event &event) {
+		std::lock_guard lock(state->mutex);
+		state->events.push_back(event);
+	});
+}
+
+std::vector<Event> ChromeTraceRecorder::events() const {
+	std::lock_guard lock(state_->mutex);
+	return state_->events;
+}
+
+Result<void> ChromeTraceRecorder::write(const std::string &path) const {
+	auto events = this->events();
+	auto micros = [epoch = state_->epoch](Clock::time_point t) {
+		if (t < epoch) return 0.0;
+		return std::chrono::duration<double, std::micro>(t - epoch).count();
+	};
+
+	nlohmann::json out = nlohmann::json::array();
+	std::unordered_map<std::thread::id, int> tids;
+	for (const auto &event : events) {
+		auto [it, added] =
+			tids.emplace(event.thread, static_cast<int>(tids.size()) + 1);
+		if (added) {
+			out.push_back(
+				{{"name", "thread_name"},
+				 {"ph", "M"},
+				 {"pid", 1},
+				 {"tid", it->second},
+				 {"args", {{"name", fmt::format("thread {}", it->second)}}}});
+		}
+
+		nlohmann::json entry = {{"name", event.name},
+								{"cat", event.category},
+								{"ts", micros(event.begin)},
+								{"pid", 1},
+								{"tid", it->second}};
+		if (!event.detail.empty()) {
+			entry["args"] = {{"detail", event.detail}};
+		}
+		if (!event.async) {
+			entry["ph"] = "X";
+			entry["dur"] = micros(event.end) - micros(event.begin);
+			out.push_back(std::move(entry));
+			continue;
+		}
+		// Nestable async pair, so overlapping requests get their own rows
+		auto id = fmt::format("{:#x}", event.id);
+		entry["ph"] = "b";
+		entry["id"] = id;
+		nlohmann::json tail = {{"name", event.name},
+							   {"cat", event.category},
+							   {"ph", "e"},
+							   {"id", id},
+							   {"ts", micros(event.end)},
+							   {"pid", 1},
+							   {"tid", it->second}};
+		out.push_back(std::move(entry));
+		out.push_back(std::move(tail));
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return outcome::failure(errc::file_open_failed);
+	file << nlohmann::json{{"traceEvents", std::move(out)},
+						   {"displayTimeUnit", "ms"}}
+				.dump();
+	if (!file) return outcome::failure(errc::file_write_failed);
+	return outcome::success();
+}
+
+}  // namespace ytdlpp::trace
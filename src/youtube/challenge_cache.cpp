@@ -0,0 +1,146 @@
+#include "challenge_cache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/post.hpp>
+#include <nlohmann/json.hpp>
+
+#include "player_script.hpp"
+
+namespace ytdlpp::youtube {
+
+namespace {
+
+const char *kind_name(ChallengeKind kind) {
+	return kind == ChallengeKind::sig ? "sig" : "n";
+}
+
+}  // namespace
+
+SolvedChallengeCache &SolvedChallengeCache::instance() {
+	static SolvedChallengeCache cache;
+	return cache;
+}
+
+SolvedChallengeCache::~SolvedChallengeCache() {
+	// Without stop(), join() waits for the queue to run dry
+	writer_.join();
+}
+
+std::string SolvedChallengeCache::make_key(const std::string &player_id,
+										   ChallengeKind kind,
+										   const std::string &challenge) {
+	std::string key;
+	key.reserve(player_id.size() + challenge.size() + 4);
+	key += player_id;
+	key += '\0';
+	key += kind_name(kind);
+	key += '\0';
+	key += challenge;
+	return key;
+}
+
+std::optional<std::string> SolvedChallengeCache::get(
+	const std::string &player_id, ChallengeKind kind,
+	const std::string &challenge) {
+	std::lock_guard lock(mutex_);
+	auto it = index_.find(make_key(player_id, kind, challenge));
+	if (it == index_.end()) return std::nullopt;
+	lru_.splice(lru_.begin(), lru_, it->second);
+	return it->second->solved;
+}
+
+void SolvedChallengeCache::put(const std::string &player_id,
+							   ChallengeKind kind, const std::string &challenge,
+							   const std::string &solved) {
+	std::lock_guard lock(mutex_);
+	put_locked(player_id, kind, challenge, solved);
+}
+
+void SolvedChallengeCache::put_locked(const std::string &player_id,
+									  ChallengeKind kind,
+									  const std::string &challenge,
+									  const std::string &solved) {
+	std::string key = make_key(player_id, kind, challenge);
+	auto it = index_.find(key);
+	if (it != index_.end()) {
+		it->second->solved = solved;
+		lru_.splice(lru_.begin(), lru_, it->second);
+		return;
+	}
+
+	if (lru_.size() >= kMaxEntries) {
+		index_.erase(lru_.back().key);
+		lru_.pop_back();
+	}
+	lru_.push_front({key, player_id, kind, challenge, solved});
+	index_.emplace(std::move(key), lru_.begin());
+}
+
+void SolvedChallengeCache::load(const std::string &player_id) {
+	if (player_id.empty()) return;
+	{
+		std::lock_guard lock(mutex_);
+		if (!loaded_players_.insert(player_id).second) return;
+	}
+
+	auto bytes = PlayerScript::get_cached_solved(player_id);
+	if (!bytes) return;
+
+	try {
+		auto data = nlohmann::json::parse(bytes->data,
+										  bytes->data + bytes->size);
+		std::lock_guard lock(mutex_);
+		size_t count = 0;
+		for (auto kind : {ChallengeKind::sig, ChallengeKind::n}) {
+			auto it = data.find(kind_name(kind));
+			if (it == data.end() || !it->is_object()) continue;
+			for (const auto &[challenge, solved] : it->items()) {
+				if (!solved.is_string()) continue;
+				put_locked(
+					player_id, kind, challenge, solved.get<std::string>());
+				count++;
+			}
+		}
+		spdlog::debug(
+			"Loaded {} solved challenges for player {}", count, player_id);
+	} catch (const std::exception &e) {
+		spdlog::debug("Ignoring corrupt solved challenge cache for {}: {}",
+					  player_id, e.what());
+	}
+}
+
+void SolvedChallengeCache::persist(const std::string &player_id) {
+	if (player_id.empty()) return;
+	{
+		std::lock_guard lock(mutex_);
+		if (!queued_writes_.insert(player_id).second) return;
+	}
+	boost::asio::post(writer_, [this, player_id] { write(player_id); });
+}
+
+void SolvedChallengeCache::write(const std::string &player_id) {
+	nlohmann::json data = {{"sig", nlohmann::json::object()},
+						   {"n", nlohmann::json::object()}};
+	{
+		std::lock_guard lock(mutex_);
+		// Solves from here on queue the next write
+		queued_writes_.erase(player_id);
+		for (const auto &e : lru_) {
+			if (e.player_id != player_id) continue;
+			data[kind_name(e.kind)][e.challenge] = e.solved;
+		}
+	}
+	// Published under a unique temporary name, then renamed, so processes
+	// sharing the directory don't write over each other
+	PlayerScript::cache_solved(player_id, data.dump());
+}
+
+void SolvedChallengeCache::clear() {
+	std::lock_guard lock(mutex_);
+	lru_.clear();
+	index_.clear();
+	loaded_players_.clear();
+}
+
+}  // namespace ytdlpp::youtube
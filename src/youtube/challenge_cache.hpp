@@ -0,0 +1,79 @@
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ytdlpp::youtube {
+
+// =============================================================================
+// SOLVED CHALLENGE CACHE
+// =============================================================================
+// A solved sig or n value depends only on the player version and the
+// challenge, so results are shared across videos and extractions. Entries live
+// in a process-wide LRU and are persisted per player as <player_id>.solved.json
+// in the player cache store, next to the cached .js/.jsc files. Writes run on
+// a background thread, off the extraction path.
+// =============================================================================
+
+enum class ChallengeKind { sig, n };
+
+class SolvedChallengeCache {
+   public:
+	static constexpr size_t kMaxEntries = 16384;
+
+	static SolvedChallengeCache &instance();
+
+	SolvedChallengeCache() = default;
+	// Finishes the queued writes
+	~SolvedChallengeCache();
+
+	SolvedChallengeCache(const SolvedChallengeCache &) = delete;
+	SolvedChallengeCache &operator=(const SolvedChallengeCache &) = delete;
+
+	[[nodiscard]] std::optional<std::string> get(const std::string &player_id,
+												 ChallengeKind kind,
+												 const std::string &challenge);
+
+	void put(const std::string &player_id, ChallengeKind kind,
+			 const std::string &challenge, const std::string &solved);
+
+	// Read <player_id>.solved.json into memory (once per player).
+	void load(const std::string &player_id);
+
+	// Write the cached entries of a player to disk, in the background. Calls
+	// while a write for the player is still queued share it.
+	void persist(const std::string &player_id);
+
+	void clear();
+
+   private:
+	struct Entry {
+		std::string key;
+		std::string player_id;
+		ChallengeKind kind;
+		std::string challenge;
+		std::string solved;
+	};
+
+	static std::string make_key(const std::string &player_id,
+								ChallengeKind kind,
+								const std::string &challenge);
+	void put_locked(const std::string &player_id, ChallengeKind kind,
+					const std::string &challenge, const std::string &solved);
+	void write(const std::string &player_id);  // On writer_
+
+	std::mutex mutex_;
+	std::list<Entry> lru_;	// Most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+	std::unordered_set<std::string> loaded_players_;
+	std::unordered_set<std::string> queued_writes_;
+
+	boost::asio::thread_pool writer_{1};
+};
+
+}  // namespace ytdlpp::youtube
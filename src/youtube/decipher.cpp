@@ -2,9 +2,11 @@
 
 #include <spdlog/spdlog.h>
 
+#include <unordered_set>
 #include <ytdlpp/ejs_solver.hpp>
 
 #include "../scripting/native_js_solver.hpp"
+#include "challenge_cache.hpp"
 
 namespace ytdlpp::youtube {
 
@@ -73,6 +75,9 @@ void SigDecipherer::async_load_functions_impl(
 	spdlog::debug("Async loading decipher functions ({} bytes, id: {})...",
 				  code.size(), player_id);
 
+	player_id_ = player_id;
+	SolvedChallengeCache::instance().load(player_id_);
+
 	ejs_solver_->async_load_player(
 		code,
 		[this, code, handler = std::move(handler)](bool success) mutable {
@@ -91,7 +96,7 @@ void SigDecipherer::async_load_functions_impl(
 				// Assuming it's fast enough for regex or we should post?
 				// Regex on 1MB file is debatable.
 				// But let's keep it simple for now.
-				if (native_solver_->load_player(code)) {
+				if (native_solver_->load_player(code, player_id_)) {
 					spdlog::info("[jsc:native] Native solver ready");
 					use_ejs_ = false;
 					handler(true);
@@ -107,9 +112,22 @@ void SigDecipherer::async_load_functions_impl(
 void SigDecipherer::async_decipher_signature_impl(
 	std::string sig,
 	boost::asio::any_completion_handler<void(std::string)> handler) {
+	auto &cache = SolvedChallengeCache::instance();
+	if (!player_id_.empty()) {
+		if (auto hit = cache.get(player_id_, ChallengeKind::sig, sig)) {
+			handler(std::move(*hit));
+			return;
+		}
+	}
+
 	if (use_ejs_) {
 		ejs_solver_->async_solve_sig(
-			sig, [handler = std::move(handler)](std::string res) mutable {
+			sig, [this, sig, handler = std::move(handler)](
+					 std::string res) mutable {
+				if (!player_id_.empty() && res != sig) {
+					SolvedChallengeCache::instance().put(
+						player_id_, ChallengeKind::sig, sig, res);
+				}
 				handler(std::move(res));
 			});
 	} else if (native_solver_->is_ready()) {
@@ -123,9 +141,22 @@ void SigDecipherer::async_decipher_signature_impl(
 void SigDecipherer::async_transform_n_impl(
 	std::string n,
 	boost::asio::any_completion_handler<void(std::string)> handler) {
+	auto &cache = SolvedChallengeCache::instance();
+	if (!player_id_.empty()) {
+		if (auto hit = cache.get(player_id_, ChallengeKind::n, n)) {
+			handler(std::move(*hit));
+			return;
+		}
+	}
+
 	if (use_ejs_) {
 		ejs_solver_->async_solve_n(
-			n, [handler = std::move(handler)](std::string res) mutable {
+			n, [this, n, handler = std::move(handler)](
+				   std::string res) mutable {
+				if (!player_id_.empty() && res != n) {
+					SolvedChallengeCache::instance().put(
+						player_id_, ChallengeKind::n, n, res);
+				}
 				handler(std::move(res));
 			});
 	} else if (native_solver_->is_ready()) {
@@ -135,4 +166,98 @@ void SigDecipherer::async_transform_n_impl(
 	}
 }
 
+namespace {
+
+// Drop empty and repeated challenges, keeping first-seen order
+std::vector<std::string> unique_challenges(std::vector<std::string> in) {
+	std::unordered_set<std::string> seen;
+	std::vector<std::string> out;
+	out.reserve(in.size());
+	for (auto &c : in) {
+		if (c.empty() || !seen.insert(c).second) continue;
+		out.push_back(std::move(c));
+	}
+	return out;
+}
+
+using SolvedMap = std::unordered_map<std::string, std::string>;
+
+// Move cached results into `out` and return the challenges still unsolved
+std::vector<std::string> take_cached(const std::string &player_id,
+									 ChallengeKind kind,
+									 std::vector<std::string> challenges,
+									 SolvedMap &out) {
+	if (player_id.empty()) return challenges;
+	auto &cache = SolvedChallengeCache::instance();
+	std::vector<std::string> misses;
+	for (auto &c : challenges) {
+		if (auto hit = cache.get(player_id, kind, c)) {
+			out.emplace(c, std::move(*hit));
+		} else {
+			misses.push_back(std::move(c));
+		}
+	}
+	return misses;
+}
+
+void store_solved(const std::string &player_id, ChallengeKind kind,
+				  const SolvedMap &solved, size_t &stored) {
+	auto &cache = SolvedChallengeCache::instance();
+	for (const auto &[challenge, result] : solved) {
+		// Unsolvable challenges map to themselves; don't remember those
+		if (result == challenge) continue;
+		cache.put(player_id, kind, challenge, result);
+		stored++;
+	}
+}
+
+}  // namespace
+
+void SigDecipherer::async_solve_batch_impl(
+	std::vector<std::string> sigs, std::vector<std::string> ns,
+	boost::asio::any_completion_handler<void(ChallengeResults)> handler) {
+	size_t requested = sigs.size() + ns.size();
+	ChallengeResults cached;
+	sigs = take_cached(player_id_, ChallengeKind::sig,
+					   unique_challenges(std::move(sigs)), cached.sig);
+	ns = take_cached(player_id_, ChallengeKind::n,
+					 unique_challenges(std::move(ns)), cached.n);
+	spdlog::debug(
+		"Solving {} challenges ({} sig, {} n) out of {}, {} cached",
+		sigs.size() + ns.size(), sigs.size(), ns.size(), requested,
+		cached.sig.size() + cached.n.size());
+
+	if (sigs.empty() && ns.empty()) {
+		handler(std::move(cached));
+		return;
+	}
+
+	// Merge fresh results with the cache hits and remember them
+	auto complete = [this, cached = std::move(cached),
+					 handler = std::move(handler)](
+						ChallengeResults res) mutable {
+		if (!player_id_.empty()) {
+			size_t stored = 0;
+			store_solved(player_id_, ChallengeKind::sig, res.sig, stored);
+			store_solved(player_id_, ChallengeKind::n, res.n, stored);
+			if (stored > 0) SolvedChallengeCache::instance().persist(player_id_);
+		}
+		res.sig.merge(cached.sig);
+		res.n.merge(cached.n);
+		handler(std::move(res));
+	};
+
+	if (use_ejs_) {
+		ejs_solver_->async_solve_batch(
+			std::move(sigs), std::move(ns), std::move(complete));
+	} else if (native_solver_->is_ready()) {
+		complete(native_solver_->solve_batch(sigs, ns));
+	} else {
+		ChallengeResults res;
+		for (auto &s : sigs) res.sig.emplace(s, s);
+		for (auto &n : ns) res.n.emplace(n, n);
+		complete(std::move(res));
+	}
+}
+
 }  // namespace ytdlpp::youtube
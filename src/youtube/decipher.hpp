@@ -2,13 +2,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include <ytdlpp/ejs_solver.hpp>
 
 #include "../scripting/js_engine.hpp"
 
 // Forward declaration
 namespace ytdlpp {
 class NativeJsSolver;
-class EjsSolver;
 }  // namespace ytdlpp
 
 namespace ytdlpp::youtube {
@@ -65,11 +66,30 @@ class SigDecipherer {
 			token, std::move(n));
 	}
 
+	// Solve every sig and n challenge of a video at once. Inputs may contain
+	// duplicates; each unique challenge is solved once, in a single JS call,
+	// and challenges already solved for this player skip JS entirely.
+	template <typename CompletionToken>
+	auto async_solve_batch(std::vector<std::string> sigs,
+						   std::vector<std::string> ns,
+						   CompletionToken &&token) {
+		return boost::asio::async_initiate<CompletionToken,
+										   void(ChallengeResults)>(
+			[this](auto handler, std::vector<std::string> sigs,
+				   std::vector<std::string> ns) {
+				async_solve_batch_impl(
+					std::move(sigs), std::move(ns), std::move(handler));
+			},
+			token, std::move(sigs), std::move(ns));
+	}
+
    private:
 	scripting::JsEngine &js_;
 	std::unique_ptr<NativeJsSolver> native_solver_;
 	std::unique_ptr<EjsSolver> ejs_solver_;
 	bool use_ejs_{false};
+	// Player version of the loaded functions; keys the solved-value cache
+	std::string player_id_;
 
 	// Async impls
 	void async_load_functions_impl(
@@ -82,6 +102,9 @@ class SigDecipherer {
 	void async_transform_n_impl(
 		std::string n,
 		boost::asio::any_completion_handler<void(std::string)> handler);
+	void async_solve_batch_impl(
+		std::vector<std::string> sigs, std::vector<std::string> ns,
+		boost::asio::any_completion_handler<void(ChallengeResults)> handler);
 };
 
 }  // namespace ytdlpp::youtube
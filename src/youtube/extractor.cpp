@@ -1,17 +1,24 @@
 #include <spdlog/spdlog.h>
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/regex.hpp>
 #include <boost/url.hpp>
 #include <fstream>
 #include <mutex>
 #include <set>
+#include <unordered_map>
+#include <ytdlpp/downloader.hpp>
 #include <ytdlpp/ejs_solver.hpp>
 #include <ytdlpp/extractor.hpp>
+#include <ytdlpp/http_client.hpp>
+#include <ytdlpp/trace.hpp>
 
 #include "decipher.hpp"
+#include "info_cache.hpp"
 #include "innertube.hpp"
 #include "player_script.hpp"
-#include "scripting/js_engine.hpp"
+#include "scripting/js_engine_pool.hpp"
+#include "search_results.hpp"
 #include "utils.hpp"
 
 namespace ytdlpp::youtube {
@@ -42,34 +49,41 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 	using CompletionExecutor = Extractor::CompletionExecutor;
 
 	std::shared_ptr<net::HttpClient> http;
-	std::shared_ptr<scripting::JsEngine> js;
+	std::shared_ptr<scripting::JsEnginePool> js_pool;
 	std::string url;
 	InfoHandler handler;
 	CompletionExecutor handler_ex;
+	ExtractorOptions options;
 	std::string video_id;
 
 	PlayerScript player_script;
-	SigDecipherer decipherer;
+	// Bound once the player id is known, so the pool can route by it
+	scripting::JsEnginePool::Lease js_lease;
+	std::unique_ptr<SigDecipherer> decipherer;
 	std::vector<std::pair<std::string, nlohmann::json>> responses;
 	std::atomic<bool> cancelled{false};
 	VideoInfo collected_info;  // Store info being built
+	trace::Span span;		   // start() until complete()
 
 	static const std::vector<InnertubeContext> &get_clients();
 
 	AsyncSession(std::shared_ptr<net::HttpClient> h,
-				 std::shared_ptr<scripting::JsEngine> j, std::string u,
-				 InfoHandler handler, CompletionExecutor handler_ex)
+				 std::shared_ptr<scripting::JsEnginePool> j, std::string u,
+				 InfoHandler handler, CompletionExecutor handler_ex,
+				 ExtractorOptions options)
 		: http(std::move(h)),
-		  js(std::move(j)),
+		  js_pool(std::move(j)),
 		  url(std::move(u)),
 		  handler(std::move(handler)),
 		  handler_ex(std::move(handler_ex)),
+		  options(std::move(options)),
 		  player_script(*http),
-		  decipherer(*js) {}
+		  client_deadline_(http->get_executor()) {}
 
 	void cancel() { cancelled = true; }
 
 	void complete(Result<VideoInfo> result) {
+		span.end();
 		asio::dispatch(handler_ex, [h = std::move(handler),
 									result = std::move(result)]() mutable {
 			h(std::move(result));
@@ -85,6 +99,7 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 		}
 
 		spdlog::info("{}: Downloading webpage", video_id);
+		span = trace::Span::async("extract", "extract", video_id);
 
 		auto self = shared_from_this();
 		player_script.async_fetch(
@@ -111,9 +126,15 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 			if (boost::regex_search(player_url, match, re)) {
 				if (match.size() > 1) { player_id = match.str(1); }
 			}
-			self->decipherer.async_load_functions(
+			self->js_lease = self->js_pool->acquire(player_id);
+			self->decipherer =
+				std::make_unique<SigDecipherer>(self->js_lease.engine());
+			self->decipherer->async_load_functions(
 				*content,
-				[self](bool success) {
+				[self, span = trace::Span::async(
+						   "js", "load_solver", player_id)](
+					bool success) mutable {
+					span.end();
 					if (self->cancelled) return;
 					if (!success) {
 						spdlog::debug(
@@ -226,7 +247,8 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 		VideoFormat fmt{};
 		fmt.itag = fmt_json.value("itag", 0);
 		fmt.url = fmt_json.value("url", "");
-		fmt.mime_type = fmt_json.value("mimeType", "");
+		std::string mime_type = fmt_json.value("mimeType", "");
+		fmt.mime_type = mime_type;
 		fmt.width = fmt_json.value("width", 0);
 		fmt.height = fmt_json.value("height", 0);
 		fmt.fps = fmt_json.value("fps", 0);
@@ -258,12 +280,9 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 				fmt.itag, id, display_name, is_default);
 
 			// Extract language code from audioTrack.id
+			std::string language;
 			if (!id.empty()) {
-				size_t dot = id.find('.');
-				if (dot != std::string::npos)
-					fmt.language = id.substr(0, dot);
-				else
-					fmt.language = id;
+				language = id.substr(0, id.find('.'));
 
 				// Use full audioTrack.id as format_id suffix (handles
 				// multi-lang)
@@ -283,7 +302,7 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 						   [](unsigned char c) { return std::tolower(c); });
 
 			if (dn_lower.find("descriptive") != std::string::npos) {
-				if (!fmt.language.empty()) fmt.language += "-desc";
+				if (!language.empty()) language += "-desc";
 				fmt.language_preference = -10;
 			} else if (dn_lower.find("original") != std::string::npos) {
 				fmt.language_preference = 10;
@@ -292,6 +311,7 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 			} else {
 				fmt.language_preference = -1;
 			}
+			fmt.language = language;
 		}
 
 		// Build final format_id: itag or itag-suffix
@@ -301,9 +321,9 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 			fmt.format_id = std::to_string(fmt.itag) + "-" + format_id_suffix;
 		}
 
-		if (!fmt.mime_type.empty()) {
-			auto semi = fmt.mime_type.find(';');
-			std::string type_part = fmt.mime_type.substr(0, semi);
+		if (!mime_type.empty()) {
+			auto semi = mime_type.find(';');
+			std::string type_part = mime_type.substr(0, semi);
 
 			auto slash = type_part.find('/');
 			if (slash != std::string::npos) {
@@ -317,13 +337,12 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 					fmt.ext = sub_type;
 			}
 
-			auto codecs_pos = fmt.mime_type.find("codecs=\"");
+			auto codecs_pos = mime_type.find("codecs=\"");
 			if (codecs_pos != std::string::npos) {
 				auto start = codecs_pos + 8;
-				auto end = fmt.mime_type.find('\"', start);
+				auto end = mime_type.find('\"', start);
 				if (end != std::string::npos) {
-					std::string codecs =
-						fmt.mime_type.substr(start, end - start);
+					std::string codecs = mime_type.substr(start, end - start);
 					auto comma = codecs.find(',');
 					if (comma != std::string::npos) {
 						fmt.vcodec = codecs.substr(0, comma);
@@ -346,33 +365,27 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 		return fmt;
 	}
 
-	void async_process_url_n(const std::string &url_raw,
-							 std::function<void(std::string)> cb) {
-		boost::system::result<boost::urls::url> r =
+	// Value of the `n` query parameter, empty if absent
+	static std::string find_n_param(const std::string &url_raw) {
+		boost::system::result<boost::urls::url_view> r =
 			boost::urls::parse_uri(url_raw);
-		if (r.has_value()) {
-			boost::urls::url url_obj = *r;
-			std::string n_val;
-			for (auto p : url_obj.params()) {
-				if (p.key == "n") {
-					n_val = p.value;
-					break;
-				}
-			}
-			if (!n_val.empty()) {
-				decipherer.async_transform_n(
-					n_val, [this, url_obj, cb](std::string new_n) mutable {
-						boost::urls::params_ref params = url_obj.params();
-						auto it = params.find("n");
-						if (it != params.end())
-							params.replace(it, {"n", new_n});
-						cb(std::string(
-							url_obj.buffer().data(), url_obj.buffer().size()));
-					});
-				return;
-			}
+		if (!r.has_value()) return "";
+		for (auto p : r->params()) {
+			if (p.key == "n") return p.value;
 		}
-		cb(url_raw);
+		return "";
+	}
+
+	static std::string replace_n_param(const std::string &url_raw,
+									   const std::string &new_n) {
+		boost::system::result<boost::urls::url> r =
+			boost::urls::parse_uri(url_raw);
+		if (!r.has_value()) return url_raw;
+		boost::urls::url url_obj = *r;
+		boost::urls::params_ref params = url_obj.params();
+		auto it = params.find("n");
+		if (it != params.end()) params.replace(it, {"n", new_n});
+		return std::string(url_obj.buffer().data(), url_obj.buffer().size());
 	}
 
 	void extract_web_tokens(const std::string &html) {
@@ -417,6 +430,13 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 		const auto &clients = get_clients();
 		pending_clients_ = clients.size();
 
+		if (options.client_timeout.count() > 0) {
+			client_deadline_.expires_after(options.client_timeout);
+			client_deadline_.async_wait([self](boost::system::error_code ec) {
+				if (!ec) self->on_client_deadline();
+			});
+		}
+
 		for (const auto &client : clients) {
 			// Create friendly names for logging (matches yt-dlp output)
 			std::string friendly_name = client.client_name;
@@ -445,8 +465,11 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 				[self, name = client.client_name](Result<nlohmann::json> res) {
 					if (self->cancelled) return;
 
+					bool done = false;
 					{
 						std::lock_guard lock(self->response_mutex_);
+						// Finished early; this straggler is ignored
+						if (self->clients_done_) return;
 						if (res.has_value()) {
 							auto &json = res.value();
 							if (json.contains("playabilityStatus") &&
@@ -461,10 +484,12 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 							}
 						}
 						self->pending_clients_--;
+						done = self->pending_clients_ == 0 ||
+							   self->can_finish_early_locked();
+						if (done) self->clients_done_ = true;
 					}
 
-					// Check if all clients have responded
-					if (self->pending_clients_ == 0) { self->finish(); }
+					if (done) self->finish_clients();
 				});
 		}
 	}
@@ -472,6 +497,65 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 	// Mutex for thread-safe response collection
 	std::mutex response_mutex_;
 	std::atomic<size_t> pending_clients_{0};
+	bool clients_done_ = false;		 // finish() started; ignore the rest
+	bool deadline_passed_ = false;	 // Take the first usable response
+	asio::steady_timer client_deadline_;
+
+	// Whether the responses collected so far are enough to stop waiting
+	bool can_finish_early_locked() {
+		if (responses.empty()) return false;
+		if (deadline_passed_) return true;
+		if (options.complete_when_selectable.empty()) return false;
+
+		// Only the metadata select_streams() looks at; URLs and challenges
+		// are dealt with in finish()
+		VideoInfo partial;
+		for (const auto &[client_name, resp] : responses) {
+			if (!resp.contains("streamingData")) continue;
+			const auto &sd = resp["streamingData"];
+			for (const char *key : {"formats", "adaptiveFormats"}) {
+				if (!sd.contains(key)) continue;
+				for (const auto &f : sd[key]) {
+					partial.formats.push_back(parse_format_metadata(f));
+				}
+			}
+		}
+		// Quiet: this runs on every client response
+		const auto &selector = options.complete_when_selectable;
+		auto streams =
+			Downloader::select_streams(partial, selector, std::nullopt, false);
+		// Every side the download will use must be there already, or a
+		// merge would go ahead without its audio or video. Only
+		// "bestaudio" picks a single side.
+		if (selector == "bestaudio") return streams.audio != nullptr;
+		return streams.video && streams.audio;
+	}
+
+	void on_client_deadline() {
+		if (cancelled) return;
+		bool done = false;
+		{
+			std::lock_guard lock(response_mutex_);
+			if (clients_done_) return;
+			deadline_passed_ = true;
+			done = can_finish_early_locked();
+			if (done) clients_done_ = true;
+		}
+		if (done) {
+			spdlog::debug("{}: Client deadline passed, {} still pending",
+						  video_id, pending_clients_.load());
+			finish_clients();
+		}
+	}
+
+	void finish_clients() {
+		client_deadline_.cancel();
+		if (pending_clients_ > 0) {
+			spdlog::debug("{}: Finishing without {} slower client(s)",
+						  video_id, pending_clients_.load());
+		}
+		finish();
+	}
 
 	void async_get_info_with_client(
 		const std::string &vid, const InnertubeContext &client,
@@ -500,24 +584,27 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 
 		http->async_post(
 			api_url, payload.dump(),
-			[client_name = client.client_name,
-			 cb = std::move(callback)](Result<net::HttpResponse> res_result) {
+			[client_name = client.client_name, cb = std::move(callback),
+			 span = trace::Span::async(
+				 "extract", "player_api", client.client_name)](
+				Result<net::HttpResponse> res_result) mutable {
+				span.end();
 				if (res_result.has_error()) {
 					cb(outcome::failure(res_result.error()));
 					return;
 				}
 
-				auto r = res_result.value();
+				const auto &r = res_result.value();
 				if (r.status_code != 200) {
 					cb(outcome::failure(errc::request_failed));
 					return;
 				}
 
-				auto json = nlohmann::json::parse(r.body, nullptr, false);
+				auto json = Innertube::parse_player_response(r.body);
 				if (json.is_discarded()) {
 					cb(outcome::failure(errc::json_parse_error));
 				} else {
-					cb(json);
+					cb(std::move(json));
 				}
 			},
 			headers);
@@ -626,12 +713,20 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 		}
 	}
 
-	void async_process_fmt(const nlohmann::json &fmt_json,
-						   std::function<void(std::optional<VideoFormat>)> cb) {
-		VideoFormat fmt = parse_format_metadata(fmt_json);
+	// A format whose URL still carries unsolved challenges
+	struct PendingFormat {
+		VideoFormat fmt;
+		std::string url_raw;
+		std::string s;	 // Encrypted signature, if any
+		std::string sp;	 // Query key for the solved signature
+		std::string n;	 // Throttling parameter, if any
+	};
+
+	std::optional<PendingFormat> prepare_format(const nlohmann::json &fmt_json) {
+		PendingFormat pending{parse_format_metadata(fmt_json), "", "", "", ""};
 
 		// Check signatureCipher
-		if (fmt.url.empty() && fmt_json.contains("signatureCipher")) {
+		if (pending.fmt.url.empty() && fmt_json.contains("signatureCipher")) {
 			std::string cipher = fmt_json["signatureCipher"];
 			std::string s, sp, url_raw;
 
@@ -660,37 +755,40 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 			}
 
 			if (!url_raw.empty() && !s.empty()) {
-				decipherer.async_decipher_signature(
-					s, [this, url_raw, sp, fmt, cb](std::string sig) mutable {
-						std::string final_url_raw = url_raw;
-						if (final_url_raw.find('?') == std::string::npos)
-							final_url_raw += "?";
-						else
-							final_url_raw += "&";
-						final_url_raw += (sp.empty() ? "sig" : sp) + "=" + sig;
-
-						async_process_url_n(
-							final_url_raw,
-							[fmt, cb](std::string final_url) mutable {
-								fmt.url = final_url;
-								cb(fmt);
-							});
-					});
-				return;
+				pending.url_raw = std::move(url_raw);
+				pending.s = std::move(s);
+				pending.sp = std::move(sp);
 			}
 		}
 
-		if (!fmt.url.empty()) {
-			async_process_url_n(
-				fmt.url, [fmt, cb](std::string final_url) mutable {
-					fmt.url = final_url;
-					cb(fmt);
-				});
-			return;
-		}
+		if (pending.url_raw.empty()) pending.url_raw = pending.fmt.url;
 
 		// Skip if no URL found
-		cb(std::nullopt);
+		if (pending.url_raw.empty()) return std::nullopt;
+
+		pending.n = find_n_param(pending.url_raw);
+		return pending;
+	}
+
+	static VideoFormat apply_challenges(PendingFormat &pending,
+										const ChallengeResults &solved) {
+		std::string final_url = std::move(pending.url_raw);
+		if (!pending.s.empty()) {
+			auto it = solved.sig.find(pending.s);
+			const std::string &sig =
+				it != solved.sig.end() ? it->second : pending.s;
+			final_url += final_url.find('?') == std::string::npos ? "?" : "&";
+			final_url += (pending.sp.empty() ? "sig" : pending.sp) + "=" + sig;
+		}
+		if (!pending.n.empty()) {
+			auto it = solved.n.find(pending.n);
+			if (it != solved.n.end() && it->second != pending.n) {
+				final_url = replace_n_param(final_url, it->second);
+			}
+		}
+
+		pending.fmt.url = std::move(final_url);
+		return std::move(pending.fmt);
 	}
 
 	void finish() {
@@ -733,26 +831,50 @@ struct AsyncSession : public std::enable_shared_from_this<AsyncSession> {
 
 		if (all_format_jsons.empty()) { return finalize_formats(); }
 
-		auto pending =
-			std::make_shared<std::atomic<size_t>>(all_format_jsons.size());
-		auto mut = std::make_shared<std::mutex>();
-		auto self = shared_from_this();
-
+		// Gather every challenge first so the whole video is solved in one
+		// JS round trip; most formats share the same n value.
+		auto pending = std::make_shared<std::vector<PendingFormat>>();
+		pending->reserve(all_format_jsons.size());
+		std::vector<std::string> sigs;
+		std::vector<std::string> ns;
 		for (const auto &f : all_format_jsons) {
-			async_process_fmt(
-				f, [self, pending, mut](std::optional<VideoFormat> fmt) {
-					if (fmt) {
-						std::lock_guard lock(*mut);
-						self->collected_info.formats.push_back(*fmt);
-					}
-					// Check if done
-					size_t remaining = pending->fetch_sub(1);
-					if (remaining == 1) {
-						asio::dispatch(self->handler_ex,
-									   [self]() { self->finalize_formats(); });
-					}
-				});
+			auto p = prepare_format(f);
+			if (!p) continue;
+			if (!p->s.empty()) sigs.push_back(p->s);
+			if (!p->n.empty()) ns.push_back(p->n);
+			pending->push_back(std::move(*p));
+		}
+
+		auto self = shared_from_this();
+		trace::Span solve_span;
+		if (trace::enabled()) {
+			solve_span = trace::Span::async(
+				"js", "solve_challenges",
+				fmt::format("{} sig, {} n", sigs.size(), ns.size()));
 		}
+		auto on_solved = [self, pending, span = std::move(solve_span)](
+							 ChallengeResults solved) mutable {
+			span.end();
+			asio::dispatch(self->handler_ex, [self, pending,
+											  solved = std::move(
+												  solved)]() mutable {
+				// Solving was the last JS work; free the isolate for others
+				self->js_lease.release();
+				if (self->cancelled) return;
+				trace::Span span("extract", "apply_challenges");
+				auto &formats = self->collected_info.formats;
+				formats.reserve(formats.size() + pending->size());
+				for (auto &p : *pending) {
+					formats.push_back(apply_challenges(p, solved));
+				}
+				self->finalize_formats();
+			});
+		};
+
+		// Without a player script the URLs are used as-is
+		if (!decipherer) return on_solved({});
+		decipherer->async_solve_batch(
+			std::move(sigs), std::move(ns), std::move(on_solved));
 	}
 
 	void finalize_formats() {
@@ -785,16 +907,74 @@ const std::vector<InnertubeContext> &AsyncSession::get_clients() {
 	return _clients;
 }
 
+// Cached results and in-flight extractions by video id. Shared with the
+// session completions, which may run after the Extractor is gone.
+struct InfoRequests {
+	struct Waiter {
+		InfoHandler handler;
+		Extractor::CompletionExecutor handler_ex;
+	};
+
+	std::unique_ptr<VideoInfoCache> cache;
+	std::mutex mutex;
+	std::unordered_map<std::string, std::vector<Waiter>> inflight;
+
+	// Counters behind Extractor::stats()
+	std::atomic<uint64_t> extractions{0};
+	std::atomic<uint64_t> failures{0};
+	std::atomic<uint64_t> active{0};
+	std::atomic<uint64_t> cache_hits{0};
+	std::atomic<uint64_t> cache_misses{0};
+	std::atomic<uint64_t> coalesced{0};
+
+	// Complete every request waiting on `video_id`
+	void finish(const std::string &video_id, Result<VideoInfo> result) {
+		if (cache && result.has_value()) cache->put(video_id, result.value());
+
+		std::vector<Waiter> waiters;
+		{
+			std::lock_guard lock(mutex);
+			auto it = inflight.find(video_id);
+			if (it == inflight.end()) return;
+			waiters = std::move(it->second);
+			inflight.erase(it);
+		}
+		if (waiters.size() > 1) {
+			spdlog::debug("{}: Extraction shared by {} requests", video_id,
+						  waiters.size());
+		}
+		for (size_t i = 0; i < waiters.size(); ++i) {
+			auto &w = waiters[i];
+			// The last waiter takes the result, the others get copies
+			Result<VideoInfo> r =
+				i + 1 == waiters.size() ? std::move(result) : result;
+			asio::dispatch(w.handler_ex, [h = std::move(w.handler),
+										  r = std::move(r)]() mutable {
+				h(std::move(r));
+			});
+		}
+	}
+};
+
 // Extractor Impl
 struct Extractor::Impl {
 	asio::any_io_executor ex;
 	std::shared_ptr<net::HttpClient> http;
-	std::shared_ptr<scripting::JsEngine> js;
+	std::shared_ptr<scripting::JsEnginePool> js_pool;
 	std::vector<std::weak_ptr<AsyncSession>> sessions;
-
-	Impl(std::shared_ptr<net::HttpClient> h, asio::any_io_executor ex)
-		: ex(std::move(ex)), http(std::move(h)) {
-		js = std::make_shared<scripting::JsEngine>(this->ex);
+	ExtractorOptions options;
+	std::shared_ptr<InfoRequests> requests = std::make_shared<InfoRequests>();
+
+	Impl(std::shared_ptr<net::HttpClient> h, asio::any_io_executor ex,
+		 const ExtractorOptions &options)
+		: ex(std::move(ex)), http(std::move(h)), options(options) {
+		js_pool = std::make_shared<scripting::JsEnginePool>(
+			this->ex, options.js_isolates);
+		if (options.info_cache_entries > 0 || !options.info_cache_dir.empty()) {
+			requests->cache = std::make_unique<VideoInfoCache>(
+				options.info_cache_entries, options.info_cache_margin,
+				options.info_cache_dir);
+		}
 	}
 
 	~Impl() { shutdown(); }
@@ -808,8 +988,8 @@ struct Extractor::Impl {
 		}
 		sessions.clear();
 
-		// Shutdown the JS engine (this terminates V8)
-		if (js) { js->shutdown(); }
+		// Shutdown the JS engines (this terminates V8)
+		if (js_pool) { js_pool->shutdown(); }
 	}
 
 	std::atomic<bool> shutdown_flag{false};
@@ -825,9 +1005,61 @@ struct Extractor::Impl {
 			return;
 		}
 
+		// Invalid URLs go straight to a session, which reports the error
+		auto video_id = extract_video_id(url);
+		if (video_id.empty()) {
+			return start_session(
+				std::move(url), std::move(handler), std::move(handler_ex));
+		}
+
+		if (requests->cache) {
+			if (auto hit = requests->cache->get(video_id)) {
+				requests->cache_hits.fetch_add(1, std::memory_order_relaxed);
+				spdlog::info("{}: Using cached extraction", video_id);
+				asio::dispatch(handler_ex, [handler = std::move(handler),
+											info = std::move(*hit)]() mutable {
+					handler(outcome::success(std::move(info)));
+				});
+				return;
+			}
+			requests->cache_misses.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		{
+			std::lock_guard lock(requests->mutex);
+			auto [it, inserted] = requests->inflight.try_emplace(video_id);
+			it->second.push_back({std::move(handler), std::move(handler_ex)});
+			if (!inserted) {
+				requests->coalesced.fetch_add(1, std::memory_order_relaxed);
+				spdlog::debug("{}: Joining in-flight extraction", video_id);
+				return;
+			}
+		}
+
+		start_session(
+			std::move(url),
+			[requests = requests, video_id](Result<VideoInfo> result) {
+				requests->finish(video_id, std::move(result));
+			},
+			ex);
+	}
+
+	void start_session(std::string url, InfoHandler handler,
+					   CompletionExecutor handler_ex) {
+		requests->extractions.fetch_add(1, std::memory_order_relaxed);
+		requests->active.fetch_add(1, std::memory_order_relaxed);
+		InfoHandler counted = [requests = requests,
+							   handler = std::move(handler)](
+								  Result<VideoInfo> result) mutable {
+			requests->active.fetch_sub(1, std::memory_order_relaxed);
+			if (result.has_error()) {
+				requests->failures.fetch_add(1, std::memory_order_relaxed);
+			}
+			handler(std::move(result));
+		};
 		auto session = std::make_shared<AsyncSession>(
-			http, js, std::move(url), std::move(handler),
-			std::move(handler_ex));
+			http, js_pool, std::move(url), std::move(counted),
+			std::move(handler_ex), options);
 		sessions.push_back(session);
 
 		sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
@@ -841,8 +1073,9 @@ struct Extractor::Impl {
 };
 
 Extractor::Extractor(std::shared_ptr<net::HttpClient> http,
-					 asio::any_io_executor ex)
-	: m_impl(std::make_unique<Impl>(std::move(http), std::move(ex))) {}
+					 asio::any_io_executor ex, ExtractorOptions options)
+	: m_impl(
+		  std::make_unique<Impl>(std::move(http), std::move(ex), options)) {}
 
 Extractor::~Extractor() = default;
 Extractor::Extractor(Extractor &&) noexcept = default;
@@ -854,6 +1087,31 @@ void Extractor::shutdown() {
 	if (m_impl) { m_impl->shutdown(); }
 }
 
+ExtractorStats Extractor::stats() const {
+	const auto &r = *m_impl->requests;
+	ExtractorStats out;
+	out.extractions = r.extractions.load(std::memory_order_relaxed);
+	out.failures = r.failures.load(std::memory_order_relaxed);
+	out.active = r.active.load(std::memory_order_relaxed);
+	out.info_cache_hits = r.cache_hits.load(std::memory_order_relaxed);
+	out.info_cache_misses = r.cache_misses.load(std::memory_order_relaxed);
+	out.coalesced = r.coalesced.load(std::memory_order_relaxed);
+
+	auto player = PlayerScript::cache_stats();
+	out.player_cache_memory_hits = player.memory_hits;
+	out.player_cache_disk_hits = player.disk_hits;
+	out.player_cache_misses = player.misses;
+
+	auto js = m_impl->js_pool->stats();
+	out.js_isolates = js.isolates;
+	out.js_isolates_busy = js.busy;
+	out.js_tasks = js.tasks.tasks;
+	out.js_queue_depth = js.tasks.queue_depth;
+	out.js_wait_time = js.tasks.wait_time;
+	out.js_run_time = js.tasks.run_time;
+	return out;
+}
+
 void Extractor::async_process_impl(
 	std::string url,
 	asio::any_completion_handler<void(Result<VideoInfo>)> handler,
@@ -916,8 +1174,7 @@ static std::string seconds_to_duration_string(long long seconds) {
 	return result;
 }
 
-// Extract search results from Innertube response
-static std::vector<SearchResult> extract_search_results(
+std::vector<SearchResult> extract_search_results(
 	const nlohmann::json &response, int max_results) {
 	std::vector<SearchResult> results;
 
@@ -1189,9 +1446,9 @@ void to_json(nlohmann::json &j, const VideoFormat &f) {
 		 f.format_id.empty() ? std::to_string(f.itag) : f.format_id},
 		{"url", f.url},
 		{"filesize", f.content_length},
-		{"vcodec", f.vcodec},
-		{"acodec", f.acodec},
-		{"ext", f.ext},
+		{"vcodec", f.vcodec.str()},
+		{"acodec", f.acodec.str()},
+		{"ext", f.ext.str()},
 		{"fps", f.fps},
 		{"asr", f.audio_sample_rate},
 		{"audio_channels", f.audio_channels},
@@ -1208,7 +1465,7 @@ void to_json(nlohmann::json &j, const VideoFormat &f) {
 		j["height"] = nullptr;
 
 	// Language fields for yt-dlp parity
-	if (!f.language.empty()) j["language"] = f.language;
+	if (!f.language.empty()) j["language"] = f.language.str();
 	j["language_preference"] = f.language_preference;
 
 	// Derived bitrates
@@ -1281,36 +1538,50 @@ std::string Extractor::warmup() {
 	spdlog::info("Extracting player from cache dir: {}", cache_dir.string());
 	if (!fs::exists(cache_dir)) { return ""; }
 
+	// <id>.js is the raw player, <id>.prep.js its preprocessed form; either
+	// one identifies a player we can bring up
+	constexpr std::string_view kPrepSuffix = ".prep";
 	std::string latest_id;
 	fs::file_time_type latest_time;
-	fs::path latest_path;
 
 	for (const auto &entry : fs::directory_iterator(cache_dir)) {
-		if (entry.is_regular_file() && entry.path().extension() == ".js") {
-			if (latest_path.empty() || entry.last_write_time() > latest_time) {
-				latest_time = entry.last_write_time();
-				latest_path = entry.path();
-			}
+		if (!entry.is_regular_file() || entry.path().extension() != ".js") {
+			continue;
+		}
+		std::string id = entry.path().stem().string();
+		if (id.size() > kPrepSuffix.size() &&
+			id.compare(id.size() - kPrepSuffix.size(), kPrepSuffix.size(),
+					   kPrepSuffix) == 0) {
+			id.resize(id.size() - kPrepSuffix.size());
+		}
+		if (latest_id.empty() || entry.last_write_time() > latest_time) {
+			latest_time = entry.last_write_time();
+			latest_id = std::move(id);
 		}
 	}
 
-	if (latest_path.empty()) { return ""; }
+	if (latest_id.empty()) { return ""; }
 
-	latest_id = latest_path.stem().string();
-
-	// Read content
-	std::ifstream file(latest_path, std::ios::binary);
-	if (!file) { return ""; }
-	std::string content((std::istreambuf_iterator<char>(file)),
-						std::istreambuf_iterator<char>());
+	// The raw script is only needed when there is nothing preprocessed;
+	// otherwise the solver installs straight from .prep.js and .jsc
+	std::string content;
+	if (!PlayerScript::get_cached_preprocessed(latest_id)) {
+		std::ifstream file(cache_dir / (latest_id + ".js"), std::ios::binary);
+		if (!file) { return ""; }
+		content.assign((std::istreambuf_iterator<char>(file)),
+					   std::istreambuf_iterator<char>());
+	}
 
 	spdlog::info("Pre-loading cached player {}...", latest_id);
 
-	// Create transient solver and keep it alive via lambda capture
-	auto solver = std::make_shared<EjsSolver>(*m_impl->js);
+	// Create transient solver and keep it (and its isolate) alive via lambda
+	// capture; the pool remembers which isolate now holds this player.
+	auto lease = std::make_shared<scripting::JsEnginePool::Lease>(
+		m_impl->js_pool->acquire(latest_id));
+	auto solver = std::make_shared<EjsSolver>(lease->engine());
 	solver->async_load_player(
-		content,
-		[solver, id = latest_id](bool success) {
+		std::move(content),
+		[solver, lease, id = latest_id](bool success) {
 			if (success) {
 				spdlog::info("Pre-loaded player {} successfully.", id);
 			} else {
@@ -0,0 +1,358 @@
+#include "info_cache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <cctype>
+#include <nlohmann/json.hpp>
+
+#include "player_cache_store.hpp"
+
+namespace ytdlpp::youtube {
+
+using json = nlohmann::json;
+
+namespace {
+
+int64_t unix_now() {
+	return std::chrono::duration_cast<std::chrono::seconds>(
+			   std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+// Value of the `expire` query parameter, if any
+std::optional<int64_t> url_expiry(const std::string &url) {
+	static constexpr std::string_view key = "expire=";
+	for (size_t pos = url.find(key); pos != std::string::npos;
+		 pos = url.find(key, pos + 1)) {
+		if (pos == 0 || (url[pos - 1] != '?' && url[pos - 1] != '&')) {
+			continue;
+		}
+		int64_t value = 0;
+		size_t i = pos + key.size();
+		size_t start = i;
+		while (i < url.size() &&
+			   std::isdigit(static_cast<unsigned char>(url[i]))) {
+			value = value * 10 + (url[i] - '0');
+			++i;
+		}
+		if (i > start) return value;
+	}
+	return std::nullopt;
+}
+
+// Cache serialization: lossless (unlike to_json, which follows yt-dlp's
+// output format), and only ever read back by this file
+
+template <typename T>
+void read(const json &j, const char *key, T &out) {
+	auto it = j.find(key);
+	if (it != j.end() && !it->is_null()) it->get_to(out);
+}
+
+void read(const json &j, const char *key, InternedString &out) {
+	std::string s;
+	read(j, key, s);
+	out = s;
+}
+
+json format_to_json(const VideoFormat &f) {
+	return {{"itag", f.itag},
+			{"format_id", f.format_id},
+			{"url", f.url},
+			{"mime_type", f.mime_type.str()},
+			{"ext", f.ext.str()},
+			{"vcodec", f.vcodec.str()},
+			{"acodec", f.acodec.str()},
+			{"width", f.width},
+			{"height", f.height},
+			{"fps", f.fps},
+			{"audio_sample_rate", f.audio_sample_rate},
+			{"audio_channels", f.audio_channels},
+			{"tbr", f.tbr},
+			{"abr", f.abr},
+			{"vbr", f.vbr},
+			{"content_length", f.content_length},
+			{"language", f.language.str()},
+			{"language_preference", f.language_preference},
+			{"format_note", f.format_note.str()},
+			{"container", f.container.str()},
+			{"protocol", static_cast<int>(f.protocol)},
+			{"dynamic_range", static_cast<int>(f.dynamic_range)},
+			{"aspect_ratio", f.aspect_ratio},
+			{"has_drm", f.has_drm},
+			{"filesize_approx", f.filesize_approx}};
+}
+
+VideoFormat format_from_json(const json &j) {
+	VideoFormat f;
+	int protocol = 0;
+	int dynamic_range = 0;
+	read(j, "itag", f.itag);
+	read(j, "format_id", f.format_id);
+	read(j, "url", f.url);
+	read(j, "mime_type", f.mime_type);
+	read(j, "ext", f.ext);
+	read(j, "vcodec", f.vcodec);
+	read(j, "acodec", f.acodec);
+	read(j, "width", f.width);
+	read(j, "height", f.height);
+	read(j, "fps", f.fps);
+	read(j, "audio_sample_rate", f.audio_sample_rate);
+	read(j, "audio_channels", f.audio_channels);
+	read(j, "tbr", f.tbr);
+	read(j, "abr", f.abr);
+	read(j, "vbr", f.vbr);
+	read(j, "content_length", f.content_length);
+	read(j, "language", f.language);
+	read(j, "language_preference", f.language_preference);
+	read(j, "format_note", f.format_note);
+	read(j, "container", f.container);
+	read(j, "protocol", protocol);
+	read(j, "dynamic_range", dynamic_range);
+	read(j, "aspect_ratio", f.aspect_ratio);
+	read(j, "has_drm", f.has_drm);
+	read(j, "filesize_approx", f.filesize_approx);
+	f.protocol = static_cast<Protocol>(protocol);
+	f.dynamic_range = static_cast<DynamicRange>(dynamic_range);
+	return f;
+}
+
+json info_to_json(const VideoInfo &i) {
+	json formats = json::array();
+	for (const auto &f : i.formats) formats.push_back(format_to_json(f));
+	json thumbnails = json::array();
+	for (const auto &t : i.thumbnails) {
+		thumbnails.push_back(
+			{{"url", t.url}, {"width", t.width}, {"height", t.height},
+			 {"id", t.id}});
+	}
+	json chapters = json::array();
+	for (const auto &c : i.chapters) {
+		chapters.push_back({{"start_time", c.start_time},
+							{"end_time", c.end_time},
+							{"title", c.title}});
+	}
+	return {{"id", i.id},
+			{"title", i.title},
+			{"fulltitle", i.fulltitle},
+			{"description", i.description},
+			{"uploader", i.uploader},
+			{"uploader_id", i.uploader_id},
+			{"uploader_url", i.uploader_url},
+			{"upload_date", i.upload_date},
+			{"duration", i.duration},
+			{"duration_string", i.duration_string},
+			{"view_count", i.view_count},
+			{"like_count", i.like_count},
+			{"comment_count", i.comment_count},
+			{"webpage_url", i.webpage_url},
+			{"thumbnail", i.thumbnail},
+			{"thumbnails", std::move(thumbnails)},
+			{"formats", std::move(formats)},
+			{"channel", i.channel},
+			{"channel_id", i.channel_id},
+			{"channel_url", i.channel_url},
+			{"channel_follower_count", i.channel_follower_count},
+			{"channel_is_verified", i.channel_is_verified},
+			{"categories", i.categories},
+			{"tags", i.tags},
+			{"chapters", std::move(chapters)},
+			{"age_limit", i.age_limit},
+			{"availability", i.availability},
+			{"live_status", i.live_status},
+			{"playable_in_embed", i.playable_in_embed},
+			{"is_live", i.is_live},
+			{"was_live", i.was_live},
+			{"timestamp", i.timestamp},
+			{"release_date", i.release_date},
+			{"ext", i.ext},
+			{"format", i.format},
+			{"format_id", i.format_id},
+			{"resolution", i.resolution},
+			{"extractor", i.extractor},
+			{"extractor_key", i.extractor_key},
+			{"_type", i._type}};
+}
+
+VideoInfo info_from_json(const json &j) {
+	VideoInfo i;
+	read(j, "id", i.id);
+	read(j, "title", i.title);
+	read(j, "fulltitle", i.fulltitle);
+	read(j, "description", i.description);
+	read(j, "uploader", i.uploader);
+	read(j, "uploader_id", i.uploader_id);
+	read(j, "uploader_url", i.uploader_url);
+	read(j, "upload_date", i.upload_date);
+	read(j, "duration", i.duration);
+	read(j, "duration_string", i.duration_string);
+	read(j, "view_count", i.view_count);
+	read(j, "like_count", i.like_count);
+	read(j, "comment_count", i.comment_count);
+	read(j, "webpage_url", i.webpage_url);
+	read(j, "thumbnail", i.thumbnail);
+	for (const auto &t : j.value("thumbnails", json::array())) {
+		Thumbnail thumb;
+		read(t, "url", thumb.url);
+		read(t, "width", thumb.width);
+		read(t, "height", thumb.height);
+		read(t, "id", thumb.id);
+		i.thumbnails.push_back(std::move(thumb));
+	}
+	for (const auto &f : j.value("formats", json::array())) {
+		i.formats.push_back(format_from_json(f));
+	}
+	read(j, "channel", i.channel);
+	read(j, "channel_id", i.channel_id);
+	read(j, "channel_url", i.channel_url);
+	read(j, "channel_follower_count", i.channel_follower_count);
+	read(j, "channel_is_verified", i.channel_is_verified);
+	read(j, "categories", i.categories);
+	read(j, "tags", i.tags);
+	for (const auto &c : j.value("chapters", json::array())) {
+		Chapter chapter;
+		read(c, "start_time", chapter.start_time);
+		read(c, "end_time", chapter.end_time);
+		read(c, "title", chapter.title);
+		i.chapters.push_back(std::move(chapter));
+	}
+	read(j, "age_limit", i.age_limit);
+	read(j, "availability", i.availability);
+	read(j, "live_status", i.live_status);
+	read(j, "playable_in_embed", i.playable_in_embed);
+	read(j, "is_live", i.is_live);
+	read(j, "was_live", i.was_live);
+	read(j, "timestamp", i.timestamp);
+	read(j, "release_date", i.release_date);
+	read(j, "ext", i.ext);
+	read(j, "format", i.format);
+	read(j, "format_id", i.format_id);
+	read(j, "resolution", i.resolution);
+	read(j, "extractor", i.extractor);
+	read(j, "extractor_key", i.extractor_key);
+	read(j, "_type", i._type);
+	return i;
+}
+
+std::string file_for(const std::string &video_id) {
+	return video_id + ".info.json";
+}
+
+}  // namespace
+
+VideoInfoCache::VideoInfoCache(size_t capacity, std::chrono::seconds margin,
+							   const std::filesystem::path &dir)
+	: capacity_(capacity), margin_(margin) {
+	if (!dir.empty()) store_ = std::make_unique<PlayerCacheStore>(dir);
+}
+
+VideoInfoCache::~VideoInfoCache() {
+	// Without stop(), join() waits for the queue to run dry
+	writer_.join();
+}
+
+std::optional<int64_t> VideoInfoCache::expiry_for(const VideoInfo &info) const {
+	std::optional<int64_t> earliest;
+	for (const auto &f : info.formats) {
+		if (auto e = url_expiry(f.url)) {
+			earliest = earliest ? std::min(*earliest, *e) : *e;
+		}
+	}
+	if (!earliest) return std::nullopt;
+	int64_t expires = *earliest - margin_.count();
+	if (expires <= unix_now()) return std::nullopt;
+	return expires;
+}
+
+std::optional<VideoInfo> VideoInfoCache::get(const std::string &video_id) {
+	int64_t now = unix_now();
+	{
+		std::lock_guard lock(mutex_);
+		auto it = index_.find(video_id);
+		if (it != index_.end()) {
+			if (it->second->expires > now) {
+				lru_.splice(lru_.begin(), lru_, it->second);
+				spdlog::debug("{}: Using cached video info", video_id);
+				return *it->second->info;
+			}
+			lru_.erase(it->second);
+			index_.erase(it);
+		}
+	}
+	if (!store_) return std::nullopt;
+
+	auto bytes = store_->get(file_for(video_id));
+	if (!bytes) return std::nullopt;
+	auto j =
+		json::parse(bytes->data, bytes->data + bytes->size, nullptr, false);
+	bytes.reset();	// Unmapped, so it can be removed (Windows)
+	if (j.is_discarded() || !j.contains("info")) return std::nullopt;
+	// A missing or malformed expiry counts as expired (json::value would
+	// throw on a non-integer)
+	int64_t expires = 0;
+	if (auto it = j.find("expires");
+		it != j.end() && it->is_number_integer()) {
+		expires = it->get<int64_t>();
+	}
+	if (expires <= now) {
+		// Its URLs are dead; don't leave it for the age eviction
+		spdlog::debug("{}: Removing expired video info from disk", video_id);
+		boost::asio::post(writer_, [this, video_id] {
+			store_->remove(file_for(video_id));
+		});
+		return std::nullopt;
+	}
+
+	Entry entry{video_id, nullptr, expires};
+	try {
+		entry.info =
+			std::make_shared<const VideoInfo>(info_from_json(j["info"]));
+	} catch (const json::exception &e) {
+		spdlog::debug("{}: Ignoring unreadable cached info: {}", video_id,
+					  e.what());
+		return std::nullopt;
+	}
+	spdlog::debug("{}: Using video info from disk cache", video_id);
+
+	VideoInfo info = *entry.info;
+	std::lock_guard lock(mutex_);
+	insert_locked(std::move(entry));
+	return info;
+}
+
+void VideoInfoCache::put(const std::string &video_id, const VideoInfo &info) {
+	auto expires = expiry_for(info);
+	if (!expires) return;
+
+	Entry entry{video_id, std::make_shared<const VideoInfo>(info), *expires};
+	if (store_) {
+		boost::asio::post(writer_, [this, video_id, info = entry.info,
+									expires = *expires] {
+			auto text =
+				json{{"expires", expires}, {"info", info_to_json(*info)}}
+					.dump();
+			store_->put(file_for(video_id), text.data(), text.size());
+		});
+	}
+
+	std::lock_guard lock(mutex_);
+	insert_locked(std::move(entry));
+}
+
+void VideoInfoCache::insert_locked(Entry entry) {
+	if (capacity_ == 0) return;
+	if (auto it = index_.find(entry.video_id); it != index_.end()) {
+		lru_.erase(it->second);
+		index_.erase(it);
+	}
+	lru_.push_front(std::move(entry));
+	index_[lru_.front().video_id] = lru_.begin();
+	while (lru_.size() > capacity_) {
+		index_.erase(lru_.back().video_id);
+		lru_.pop_back();
+	}
+}
+
+}  // namespace ytdlpp::youtube
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <ytdlpp/types.hpp>
+
+namespace ytdlpp::youtube {
+
+class PlayerCacheStore;
+
+// =============================================================================
+// VIDEO INFO CACHE
+// =============================================================================
+// Extraction results keyed by video id. A result is only as good as its
+// stream URLs, so an entry expires at the earliest `expire` parameter among
+// its formats minus a safety margin; results without one are not cached.
+// Entries live in an LRU of `capacity` videos and, with a directory, also as
+// <video_id>.info.json in a PlayerCacheStore shared with other processes.
+// Disk writes and removals run on a background thread, off the extraction
+// path; an entry found expired on disk is removed.
+// =============================================================================
+
+class VideoInfoCache {
+   public:
+	VideoInfoCache(size_t capacity, std::chrono::seconds margin,
+				   const std::filesystem::path &dir = {});
+
+	// Finishes the queued disk writes
+	~VideoInfoCache();
+
+	VideoInfoCache(const VideoInfoCache &) = delete;
+	VideoInfoCache &operator=(const VideoInfoCache &) = delete;
+
+	[[nodiscard]] std::optional<VideoInfo> get(const std::string &video_id);
+
+	void put(const std::string &video_id, const VideoInfo &info);
+
+	/// Unix time the entry for `info` would expire at, or nullopt if its
+	/// formats carry no expiry (or it is already within the margin).
+	[[nodiscard]] std::optional<int64_t> expiry_for(
+		const VideoInfo &info) const;
+
+   private:
+	struct Entry {
+		std::string video_id;
+		std::shared_ptr<const VideoInfo> info;
+		int64_t expires = 0;
+	};
+
+	void insert_locked(Entry entry);
+
+	const size_t capacity_;
+	const std::chrono::seconds margin_;
+	std::unique_ptr<PlayerCacheStore> store_;
+
+	std::mutex mutex_;
+	std::list<Entry> lru_;	// Most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+	boost::asio::thread_pool writer_{1};  // For store_, if set
+};
+
+}  // namespace ytdlpp::youtube
@@ -1,7 +1,30 @@
 #include "innertube.hpp"
 
+#include <algorithm>
+#include <array>
+
 namespace ytdlpp::youtube {
 
+namespace {
+
+// Top-level /player sections the extractor reads
+constexpr std::array<std::string_view, 4> kPlayerSections = {
+	"playabilityStatus", "streamingData", "videoDetails", "microformat"};
+
+// Fields of microformat.playerMicroformatRenderer the extractor reads; the
+// rest includes availableCountries, a ~250-entry array
+constexpr std::array<std::string_view, 5> kMicroformatFields = {
+	"uploadDate", "isPlayableInEmbed", "category", "isFamilySafe",
+	"isUnlisted"};
+
+template <size_t N>
+bool is_one_of(const std::string &key,
+			   const std::array<std::string_view, N> &keys) {
+	return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+}  // namespace
+
 // Client priority: android_sdkless (no POT) > tv > web_safari (HLS) > web
 
 // ANDROID client - standard Android app
@@ -156,4 +179,26 @@ std::map<std::string, std::string> Innertube::get_headers(
 			{"Origin", "https://www.youtube.com"}};
 }
 
+nlohmann::json Innertube::parse_player_response(std::string_view body) {
+	using event_t = nlohmann::json::parse_event_t;
+
+	// Returning false for a key drops it and its value; the parser then only
+	// scans that subtree without building it.
+	std::string section;  // Top-level key being parsed
+	auto keep = [&section](int depth, event_t event, nlohmann::json &parsed) {
+		if (event != event_t::key) return true;
+		const auto &key = parsed.get_ref<const std::string &>();
+		if (depth == 1) {
+			section = key;
+			return is_one_of(key, kPlayerSections);
+		}
+		if (depth == 3 && section == "microformat") {
+			return is_one_of(key, kMicroformatFields);
+		}
+		return true;
+	};
+
+	return nlohmann::json::parse(body.begin(), body.end(), keep, false);
+}
+
 }  // namespace ytdlpp::youtube
@@ -3,6 +3,7 @@
 #include <map>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 
 namespace ytdlpp::youtube {
 
@@ -46,6 +47,11 @@ class Innertube {
 	// Helper to get headers
 	static std::map<std::string, std::string> get_headers(
 		const InnertubeContext &client);
+
+	// Parse a /player response, building only the parts the extractor
+	// reads; captions, storyboards, tracking and ads are skipped by the
+	// parser instead of being materialized. Discarded value if malformed.
+	static nlohmann::json parse_player_response(std::string_view body);
 };
 
 }  // namespace ytdlpp::youtube
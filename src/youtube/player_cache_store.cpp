@@ -0,0 +1,304 @@
+#include "player_cache_store.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/scope_exit.hpp>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <shared_mutex>
+#include <vector>
+
+namespace ytdlpp::youtube {
+
+namespace fs = std::filesystem;
+namespace bip = boost::interprocess;
+
+namespace {
+
+constexpr const char *kIndexFile = "index.json";
+constexpr const char *kLockFile = ".lock";
+
+int64_t unix_now() {
+	return std::chrono::duration_cast<std::chrono::seconds>(
+			   std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+// "<name>.tmp.<random>": unique across processes writing the same entry
+fs::path temp_path_for(const fs::path &target) {
+	thread_local std::mt19937_64 rng{std::random_device{}()};
+	return target.string() + ".tmp." + std::to_string(rng());
+}
+
+bool write_file(const fs::path &path, const void *data, size_t size) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+	file.write(static_cast<const char *>(data),
+			   static_cast<std::streamsize>(size));
+	file.close();
+	return !file.fail();
+}
+
+// Write to a temporary file, then rename over `path`
+bool publish(const fs::path &path, const void *data, size_t size) {
+	auto tmp = temp_path_for(path);
+	std::error_code ec;
+	if (!write_file(tmp, data, size)) {
+		fs::remove(tmp, ec);
+		return false;
+	}
+	fs::rename(tmp, path, ec);
+	if (ec) {
+		spdlog::debug("Cache: Cannot publish {}: {}", path.string(),
+					  ec.message());
+		fs::remove(tmp, ec);
+		return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+struct PlayerCacheStore::Impl {
+	fs::path dir;
+	PlayerCacheOptions options;
+
+	// In-process readers/writers; the file lock below covers other processes
+	mutable std::shared_mutex mutex;
+
+	// The file lock is process-wide (fcntl on POSIX), so the first reader in
+	// takes it shared and the last one out releases it
+	mutable std::mutex file_lock_mutex;
+	mutable std::optional<bip::file_lock> file_lock;
+	mutable int shared_holders = 0;
+
+	struct Entry {
+		uint64_t size = 0;
+		int64_t written = 0;
+	};
+	using Index = std::vector<std::pair<std::string, Entry>>;
+
+	Impl(fs::path d, PlayerCacheOptions opts)
+		: dir(std::move(d)), options(opts) {}
+
+	// Created on first use; without it only in-process locking applies
+	bip::file_lock *lock_file() const {
+		if (file_lock) return &*file_lock;
+		std::error_code ec;
+		fs::create_directories(dir, ec);
+		auto path = dir / kLockFile;
+		{ std::ofstream touch(path, std::ios::app); }
+		try {
+			file_lock.emplace(path.string().c_str());
+		} catch (const bip::interprocess_exception &e) {
+			spdlog::debug("Cache: No cross-process lock on {}: {}",
+						  path.string(), e.what());
+			return nullptr;
+		}
+		return &*file_lock;
+	}
+
+	void lock_shared() const {
+		std::lock_guard guard(file_lock_mutex);
+		if (shared_holders++ > 0) return;
+		if (auto *lock = lock_file()) lock->lock_sharable();
+	}
+
+	void unlock_shared() const {
+		std::lock_guard guard(file_lock_mutex);
+		if (--shared_holders > 0) return;
+		if (file_lock) file_lock->unlock_sharable();
+	}
+
+	// Caller holds `mutex` exclusively, so no reader holds the file lock
+	void lock_exclusive() const {
+		std::lock_guard guard(file_lock_mutex);
+		if (auto *lock = lock_file()) lock->lock();
+	}
+
+	void unlock_exclusive() const {
+		std::lock_guard guard(file_lock_mutex);
+		if (file_lock) file_lock->unlock();
+	}
+
+	[[nodiscard]] Index read_index() const {
+		Index index;
+		std::ifstream file(dir / kIndexFile, std::ios::binary);
+		if (!file) return index;
+		std::string text((std::istreambuf_iterator<char>(file)),
+						 std::istreambuf_iterator<char>());
+		auto j = nlohmann::json::parse(text, nullptr, false);
+		if (j.is_discarded() || !j.contains("entries") ||
+			!j["entries"].is_object()) {
+			return index;
+		}
+		for (const auto &[name, e] : j["entries"].items()) {
+			if (!e.is_object()) continue;
+			index.emplace_back(name, Entry{e.value("size", uint64_t{0}),
+										   e.value("written", int64_t{0})});
+		}
+		return index;
+	}
+
+	void write_index(const Index &index) const {
+		nlohmann::json entries = nlohmann::json::object();
+		for (const auto &[name, e] : index) {
+			entries[name] = {{"size", e.size}, {"written", e.written}};
+		}
+		auto text = nlohmann::json{{"entries", std::move(entries)}}.dump();
+		publish(dir / kIndexFile, text.data(), text.size());
+	}
+
+	// Drop expired entries, then the oldest until under max_bytes. The entry
+	// named `keep` (just written) stays.
+	void evict(Index &index, const std::string &keep) const {
+		auto remove_entry = [this](const std::string &name) {
+			std::error_code ec;
+			fs::remove(dir / name, ec);
+			// Still mapped elsewhere on Windows: keep it for a later pass
+			return !ec || !fs::exists(dir / name, ec);
+		};
+
+		int64_t cutoff =
+			unix_now() -
+			std::chrono::duration_cast<std::chrono::seconds>(options.max_age)
+				.count();
+		uint64_t total = 0;
+		Index kept;
+		for (auto &entry : index) {
+			if (entry.first != keep && entry.second.written < cutoff &&
+				remove_entry(entry.first)) {
+				spdlog::debug("Cache: Evicted expired {}", entry.first);
+				continue;
+			}
+			total += entry.second.size;
+			kept.push_back(std::move(entry));
+		}
+
+		std::sort(kept.begin(), kept.end(), [](const auto &a, const auto &b) {
+			return a.second.written < b.second.written;
+		});
+		Index result;
+		for (auto &entry : kept) {
+			if (total > options.max_bytes && entry.first != keep &&
+				remove_entry(entry.first)) {
+				spdlog::debug("Cache: Evicted {} ({} bytes)", entry.first,
+							  entry.second.size);
+				total -= entry.second.size;
+				continue;
+			}
+			result.push_back(std::move(entry));
+		}
+		index = std::move(result);
+	}
+};
+
+PlayerCacheStore::PlayerCacheStore(fs::path dir, PlayerCacheOptions options)
+	: impl_(std::make_unique<Impl>(std::move(dir), options)) {}
+
+PlayerCacheStore::~PlayerCacheStore() = default;
+
+const fs::path &PlayerCacheStore::directory() const { return impl_->dir; }
+
+std::optional<SharedBytes> PlayerCacheStore::get(
+	const std::string &name) const {
+	std::shared_lock lock(impl_->mutex);
+	impl_->lock_shared();
+	BOOST_SCOPE_EXIT_ALL(&) { impl_->unlock_shared(); };
+
+	auto path = impl_->dir / name;
+	std::error_code ec;
+	auto size = fs::file_size(path, ec);
+	if (ec || size == 0) return std::nullopt;
+
+	try {
+		// The region stays valid after the file_mapping is destroyed
+		bip::file_mapping file(path.string().c_str(), bip::read_only);
+		auto region =
+			std::make_shared<bip::mapped_region>(file, bip::read_only);
+		const auto *data = static_cast<const uint8_t *>(region->get_address());
+		size_t length = region->get_size();
+		return SharedBytes{std::move(region), data, length};
+	} catch (const bip::interprocess_exception &e) {
+		spdlog::debug("Cache: Cannot map {}: {}", path.string(), e.what());
+		return std::nullopt;
+	}
+}
+
+bool PlayerCacheStore::put(const std::string &name, const void *data,
+						   size_t size) {
+	std::error_code ec;
+	fs::create_directories(impl_->dir, ec);
+
+	// Written outside the lock; only the rename and index update need it
+	auto path = impl_->dir / name;
+	auto tmp = temp_path_for(path);
+	if (!write_file(tmp, data, size)) {
+		fs::remove(tmp, ec);
+		spdlog::debug("Cache: Cannot write {}", path.string());
+		return false;
+	}
+
+	std::unique_lock lock(impl_->mutex);
+	impl_->lock_exclusive();
+	BOOST_SCOPE_EXIT_ALL(&) { impl_->unlock_exclusive(); };
+
+	fs::rename(tmp, path, ec);
+	if (ec) {
+		spdlog::debug("Cache: Cannot publish {}: {}", path.string(),
+					  ec.message());
+		fs::remove(tmp, ec);
+		return false;
+	}
+
+	auto index = impl_->read_index();
+	auto it = std::find_if(index.begin(), index.end(),
+						   [&](const auto &e) { return e.first == name; });
+	Impl::Entry entry{size, unix_now()};
+	if (it != index.end()) {
+		it->second = entry;
+	} else {
+		index.emplace_back(name, entry);
+	}
+	impl_->evict(index, name);
+	impl_->write_index(index);
+	return true;
+}
+
+void PlayerCacheStore::remove(const std::string &name) {
+	std::unique_lock lock(impl_->mutex);
+	impl_->lock_exclusive();
+	BOOST_SCOPE_EXIT_ALL(&) { impl_->unlock_exclusive(); };
+
+	std::error_code ec;
+	fs::remove(impl_->dir / name, ec);
+	auto index = impl_->read_index();
+	auto it = std::find_if(index.begin(), index.end(),
+						   [&](const auto &e) { return e.first == name; });
+	if (it == index.end()) return;
+	index.erase(it);
+	impl_->write_index(index);
+}
+
+void PlayerCacheStore::clear() {
+	std::unique_lock lock(impl_->mutex);
+	impl_->lock_exclusive();
+	BOOST_SCOPE_EXIT_ALL(&) { impl_->unlock_exclusive(); };
+
+	std::error_code ec;
+	for (const auto &item : fs::directory_iterator(impl_->dir, ec)) {
+		// Other processes may hold the lock file open
+		if (item.path().filename() == kLockFile) continue;
+		std::error_code remove_ec;
+		fs::remove_all(item.path(), remove_ec);
+	}
+}
+
+}  // namespace ytdlpp::youtube
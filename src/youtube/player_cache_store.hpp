@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "../shared_bytes.hpp"
+
+namespace ytdlpp::youtube {
+
+struct PlayerCacheOptions {
+	// Oldest entries are evicted once the indexed files exceed this
+	uint64_t max_bytes = 512ULL * 1024 * 1024;
+	// Entries written longer ago than this are evicted
+	std::chrono::hours max_age{24 * 14};
+};
+
+// =============================================================================
+// PLAYER CACHE STORE
+// =============================================================================
+// On-disk cache shared by every process on the host that uses the same
+// directory. Entries are published atomically (written to a temporary file,
+// then renamed), so readers never see partial files. Reads map the file
+// read-only and hand out the mapping itself. `index.json` records the size
+// and write time of each entry for size/age eviction.
+//
+// Lookups take a shared lock (in-process and on `.lock` across processes),
+// so concurrent readers don't serialize; publishing, eviction and clear()
+// take it exclusively.
+// =============================================================================
+
+class PlayerCacheStore {
+   public:
+	explicit PlayerCacheStore(std::filesystem::path dir,
+							  PlayerCacheOptions options = {});
+	~PlayerCacheStore();
+
+	PlayerCacheStore(const PlayerCacheStore &) = delete;
+	PlayerCacheStore &operator=(const PlayerCacheStore &) = delete;
+
+	[[nodiscard]] const std::filesystem::path &directory() const;
+
+	/// Read-only mapping of entry `name`, or nullopt if it is missing,
+	/// empty or unreadable.
+	[[nodiscard]] std::optional<SharedBytes> get(const std::string &name) const;
+
+	/// Publish `size` bytes as entry `name`, replacing any previous version,
+	/// then evict per the options. False if the entry could not be written.
+	bool put(const std::string &name, const void *data, size_t size);
+
+	/// Delete entry `name` and drop it from the index.
+	void remove(const std::string &name);
+
+	/// Remove every file in the directory.
+	void clear();
+
+   private:
+	struct Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace ytdlpp::youtube
@@ -3,9 +3,12 @@
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
-#include <fstream>
+#include <atomic>
 #include <regex>
 #include <string>
+#include <ytdlpp/trace.hpp>
+
+#include "challenge_cache.hpp"
 
 namespace ytdlpp::youtube {
 
@@ -107,131 +110,183 @@ std::optional<std::string> extract_player_id_fast(const std::string &url) {
 	return url.substr(id_start, id_end - id_start);
 }
 
+// Player cache lookups, see PlayerScript::cache_stats()
+std::atomic<uint64_t> g_memory_hits{0};
+std::atomic<uint64_t> g_disk_hits{0};
+std::atomic<uint64_t> g_misses{0};
+
+void count(std::atomic<uint64_t> &counter) {
+	counter.fetch_add(1, std::memory_order_relaxed);
+}
+
 }  // namespace
 
 // Static member definitions
 std::unordered_map<std::string, CachedPlayerData> PlayerScript::cache_;
-std::mutex PlayerScript::cache_mutex_;
+std::shared_mutex PlayerScript::cache_mutex_;
 fs::path PlayerScript::cache_dir_ = fs::temp_directory_path() / "ytdlpp_cache";
+std::unique_ptr<PlayerCacheStore> PlayerScript::store_ =
+	std::make_unique<PlayerCacheStore>(PlayerScript::cache_dir_);
 
 PlayerScript::PlayerScript(net::HttpClient &http) : http_(http) {}
 
 void PlayerScript::set_cache_directory(const fs::path &dir) {
-	std::lock_guard lock(cache_mutex_);
+	std::unique_lock lock(cache_mutex_);
 	cache_dir_ = dir;
+	store_ = std::make_unique<PlayerCacheStore>(cache_dir_);
 	std::error_code ec;
 	fs::create_directories(cache_dir_, ec);
 }
 
 std::filesystem::path PlayerScript::get_cache_directory() {
-	std::lock_guard lock(cache_mutex_);
+	std::shared_lock lock(cache_mutex_);
 	return cache_dir_;
 }
 
 void PlayerScript::clear_cache() {
-	std::lock_guard lock(cache_mutex_);
+	std::unique_lock lock(cache_mutex_);
 	cache_.clear();
-	std::error_code ec;
-	if (fs::exists(cache_dir_)) { fs::remove_all(cache_dir_, ec); }
+	SolvedChallengeCache::instance().clear();
+	store_->clear();
 }
 
-// Bytecode stored alongside .js files with .jsc extension (~10x faster loading)
+PlayerCacheStats PlayerScript::cache_stats() {
+	return {g_memory_hits.load(std::memory_order_relaxed),
+			g_disk_hits.load(std::memory_order_relaxed),
+			g_misses.load(std::memory_order_relaxed)};
+}
 
-std::optional<std::vector<uint8_t>> PlayerScript::get_cached_bytecode(
-	const std::string &player_id) {
-	std::lock_guard lock(cache_mutex_);
+// Entries live in the shared PlayerCacheStore as <player_id><suffix>:
+//   .js (player), .jsc (V8 code cache, ~10x faster loading),
+//   .prep.js (EJS-preprocessed player), .native.json (native discovery),
+//   .solved.json (solved challenges)
 
-	// Check in-memory cache
-	auto it = cache_.find(player_id);
-	if (it != cache_.end() && it->second.bytecode) {
-		spdlog::debug("Bytecode for {} found in memory cache", player_id);
-		return it->second.bytecode;
+std::optional<SharedBytes> PlayerScript::read_disk(const std::string &file) {
+	std::shared_lock lock(cache_mutex_);
+	return store_->get(file);
+}
+
+void PlayerScript::write_disk(const std::string &file, const void *data,
+							  size_t size) {
+	std::shared_lock lock(cache_mutex_);
+	if (store_->put(file, data, size)) {
+		spdlog::debug("{} saved to disk cache ({} bytes)", file, size);
 	}
+}
 
-	// Check disk cache
-	auto cache_file = cache_dir_ / (player_id + ".jsc");
-	if (fs::exists(cache_file)) {
-		std::ifstream file(cache_file, std::ios::binary);
-		if (file) {
-			std::vector<uint8_t> bytecode(
-				(std::istreambuf_iterator<char>(file)),
-				std::istreambuf_iterator<char>());
-			// Store in memory cache
-			cache_[player_id].bytecode = bytecode;
-			spdlog::debug("Bytecode for {} loaded from disk ({} bytes)",
-						  player_id, bytecode.size());
-			return bytecode;
+std::optional<std::string> PlayerScript::load_text(
+	const std::string &player_id, std::string CachedPlayerData::*field,
+	const char *suffix) {
+	{
+		std::shared_lock lock(cache_mutex_);
+		auto it = cache_.find(player_id);
+		if (it != cache_.end() && !(it->second.*field).empty()) {
+			spdlog::debug("{}{} found in memory cache", player_id, suffix);
+			count(g_memory_hits);
+			return it->second.*field;
 		}
 	}
 
-	return std::nullopt;
+	auto bytes = read_disk(player_id + suffix);
+	if (!bytes) {
+		count(g_misses);
+		return std::nullopt;
+	}
+	std::string content(reinterpret_cast<const char *>(bytes->data),
+						bytes->size);
+	spdlog::debug("{}{} loaded from disk cache", player_id, suffix);
+	count(g_disk_hits);
+
+	std::unique_lock lock(cache_mutex_);
+	cache_[player_id].*field = content;
+	return content;
+}
+
+void PlayerScript::store_text(const std::string &player_id,
+							  std::string CachedPlayerData::*field,
+							  const char *suffix, const std::string &content) {
+	{
+		std::unique_lock lock(cache_mutex_);
+		cache_[player_id].*field = content;
+	}
+	write_disk(player_id + suffix, content.data(), content.size());
+}
+
+std::optional<SharedBytes> PlayerScript::get_cached_bytecode(
+	const std::string &player_id) {
+	{
+		std::shared_lock lock(cache_mutex_);
+		auto it = cache_.find(player_id);
+		if (it != cache_.end() && !it->second.bytecode.empty()) {
+			spdlog::debug("Bytecode for {} found in memory cache", player_id);
+			count(g_memory_hits);
+			return it->second.bytecode;
+		}
+	}
+
+	// Mapped, not read: the same pages back every process's cache
+	auto bytes = read_disk(player_id + ".jsc");
+	if (!bytes) {
+		count(g_misses);
+		return std::nullopt;
+	}
+	spdlog::debug("Bytecode for {} mapped from disk cache ({} bytes)",
+				  player_id, bytes->size);
+	count(g_disk_hits);
+
+	std::unique_lock lock(cache_mutex_);
+	cache_[player_id].bytecode = *bytes;
+	return bytes;
 }
 
 void PlayerScript::cache_bytecode(const std::string &player_id,
 								  const std::vector<uint8_t> &bytecode) {
-	std::lock_guard lock(cache_mutex_);
+	write_disk(player_id + ".jsc", bytecode.data(), bytecode.size());
+	// Later lookups map the published file instead of keeping a copy
+	std::unique_lock lock(cache_mutex_);
+	if (auto it = cache_.find(player_id); it != cache_.end()) {
+		it->second.bytecode = {};
+	}
+}
 
-	// Store in memory
-	cache_[player_id].bytecode = bytecode;
+std::optional<std::string> PlayerScript::get_cached_preprocessed(
+	const std::string &player_id) {
+	return load_text(player_id, &CachedPlayerData::preprocessed, ".prep.js");
+}
 
-	// Store on disk
-	std::error_code ec;
-	fs::create_directories(cache_dir_, ec);
-	auto cache_file = cache_dir_ / (player_id + ".jsc");
-	std::ofstream file(cache_file, std::ios::binary);
-	if (file) {
-		file.write(reinterpret_cast<const char *>(bytecode.data()),
-				   static_cast<std::streamsize>(bytecode.size()));
-		spdlog::debug("Bytecode for {} saved to disk ({} bytes)", player_id,
-					  bytecode.size());
-	}
+void PlayerScript::cache_preprocessed(const std::string &player_id,
+									  const std::string &code) {
+	store_text(player_id, &CachedPlayerData::preprocessed, ".prep.js", code);
 }
 
-std::optional<std::string> PlayerScript::get_cached_script(
+std::optional<std::string> PlayerScript::get_cached_native(
 	const std::string &player_id) {
-	std::lock_guard lock(cache_mutex_);
+	return load_text(player_id, &CachedPlayerData::native, ".native.json");
+}
 
-	// Check in-memory cache first
-	auto it = cache_.find(player_id);
-	if (it != cache_.end() && !it->second.script.empty()) {
-		spdlog::debug("Player script {} found in memory cache", player_id);
-		return it->second.script;
-	}
+void PlayerScript::cache_native(const std::string &player_id,
+								const std::string &json) {
+	store_text(player_id, &CachedPlayerData::native, ".native.json", json);
+}
 
-	// Check disk cache
-	auto cache_file = cache_dir_ / (player_id + ".js");
-	if (fs::exists(cache_file)) {
-		std::ifstream file(cache_file, std::ios::binary);
-		if (file) {
-			std::string content((std::istreambuf_iterator<char>(file)),
-								std::istreambuf_iterator<char>());
-			// Also store in memory for faster subsequent access
-			cache_[player_id].script = content;
-			spdlog::debug("Player script {} loaded from disk cache", player_id);
-			return content;
-		}
-	}
+std::optional<SharedBytes> PlayerScript::get_cached_solved(
+	const std::string &player_id) {
+	return read_disk(player_id + ".solved.json");
+}
 
-	return std::nullopt;
+void PlayerScript::cache_solved(const std::string &player_id,
+								const std::string &json) {
+	write_disk(player_id + ".solved.json", json.data(), json.size());
+}
+
+std::optional<std::string> PlayerScript::get_cached_script(
+	const std::string &player_id) {
+	return load_text(player_id, &CachedPlayerData::script, ".js");
 }
 
 void PlayerScript::cache_script(const std::string &player_id,
 								const std::string &content) {
-	std::lock_guard lock(cache_mutex_);
-
-	// Store in memory
-	cache_[player_id].script = content;
-
-	// Store on disk
-	std::error_code ec;
-	fs::create_directories(cache_dir_, ec);
-	auto cache_file = cache_dir_ / (player_id + ".js");
-	std::ofstream file(cache_file, std::ios::binary);
-	if (file) {
-		file.write(
-			content.data(), static_cast<std::streamsize>(content.size()));
-		spdlog::debug("Player script {} saved to disk cache", player_id);
-	}
+	store_text(player_id, &CachedPlayerData::script, ".js", content);
 }
 
 std::optional<std::string> PlayerScript::extract_player_url_from_webpage(
@@ -290,9 +345,10 @@ void PlayerScript::async_fetch(const std::string &video_id, ScriptCallback cb,
 
 	http_.async_get(
 		url,
-		[this, video_id, cb = std::move(cb),
-		 on_webpage = std::move(on_webpage)](
+		[this, video_id, cb = std::move(cb), on_webpage = std::move(on_webpage),
+		 span = trace::Span::async("extract", "watch_page", video_id)](
 			Result<net::HttpResponse> res_result) mutable {
+			span.end();
 			if (res_result.has_error()) {
 				spdlog::error("Failed to fetch video page: {}",
 							  res_result.error().message());
@@ -305,6 +361,7 @@ void PlayerScript::async_fetch(const std::string &video_id, ScriptCallback cb,
 				return cb(std::nullopt);
 			}
 
+			trace::Span parse_span("extract", "parse_webpage", video_id);
 			if (on_webpage) { on_webpage(res.body); }
 
 			auto extracted_url = extract_player_url_from_webpage(res.body);
@@ -330,6 +387,8 @@ void PlayerScript::async_fetch(const std::string &video_id, ScriptCallback cb,
 				} catch (...) {}
 			}
 
+			parse_span.end();
+
 			// Check cache before downloading
 			auto cached = get_cached_script(player_id);
 			if (cached) {
@@ -349,8 +408,11 @@ void PlayerScript::async_fetch(const std::string &video_id, ScriptCallback cb,
 
 			http_.async_get(
 				player_url_,
-				[this, player_id, cb = std::move(cb)](
+				[this, player_id, cb = std::move(cb),
+				 span = trace::Span::async(
+					 "extract", "player_download", player_id)](
 					Result<net::HttpResponse> script_res_result) mutable {
+					span.end();
 					if (script_res_result.has_error()) {
 						spdlog::error("Failed to download player script: {}",
 									  script_res_result.error().message());
@@ -1,14 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
-#include <mutex>
+#include <memory>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "../../include/ytdlpp/http_client.hpp"
+#include "../shared_bytes.hpp"
+#include "player_cache_store.hpp"
 
 namespace ytdlpp::youtube {
 
@@ -17,12 +21,23 @@ namespace ytdlpp::youtube {
 // =============================================================================
 // Stores both raw JavaScript and pre-compiled bytecode for optimal performance.
 // On first load, JS is parsed normally. On subsequent loads, bytecode is used
-// which is ~10x faster than re-parsing the ~1MB player script.
+// which is ~10x faster than re-parsing the ~1MB player script. The disk side
+// is a PlayerCacheStore, shared by every process using the cache directory.
 // =============================================================================
 
 struct CachedPlayerData {
 	std::string script;							   // Raw JavaScript source
-	std::optional<std::vector<uint8_t>> bytecode;  // Pre-compiled bytecode
+	SharedBytes bytecode;						   // Mapped V8 code cache
+	std::string preprocessed;					   // EJS-preprocessed player
+	std::string native;							   // Native solver discovery
+};
+
+/// Lookups of the player cache, over scripts, bytecode, preprocessed
+/// players and native discovery alike (see PlayerScript::cache_stats()).
+struct PlayerCacheStats {
+	uint64_t memory_hits = 0;
+	uint64_t disk_hits = 0;
+	uint64_t misses = 0;
 };
 
 class PlayerScript {
@@ -41,30 +56,67 @@ class PlayerScript {
 
 	std::string get_captured_player_url() const { return player_url_; }
 
+	// base.js URL referenced by a watch page
+	static std::optional<std::string> extract_player_url_from_webpage(
+		const std::string &webpage);
+
 	// Cache control
 	static void set_cache_directory(const std::filesystem::path &dir);
 	static std::filesystem::path get_cache_directory();
 	static void clear_cache();
+	// Process-wide lookup counters; not reset by clear_cache()
+	static PlayerCacheStats cache_stats();
 
-	// Get cached bytecode for a player (used by SigDecipherer)
-	static std::optional<std::vector<uint8_t>> get_cached_bytecode(
+	// Get cached bytecode for a player, mapped from disk (used by EjsSolver)
+	static std::optional<SharedBytes> get_cached_bytecode(
 		const std::string &player_id);
 
 	// Store bytecode after successful compilation (used by SigDecipherer)
 	static void cache_bytecode(const std::string &player_id,
 							   const std::vector<uint8_t> &bytecode);
 
+	// EJS-preprocessed player (<player_id>.prep.js); lets a known player skip
+	// the jsc() preprocessing pass entirely (used by EjsSolver)
+	static std::optional<std::string> get_cached_preprocessed(
+		const std::string &player_id);
+	static void cache_preprocessed(const std::string &player_id,
+								   const std::string &code);
+
+	// NativeJsSolver discovery results (<player_id>.native.json): function
+	// names and the source ranges of the statements that loaded, so a known
+	// player skips the IIFE split, filtering and regex search (used by
+	// NativeJsSolver)
+	static std::optional<std::string> get_cached_native(
+		const std::string &player_id);
+	static void cache_native(const std::string &player_id,
+							 const std::string &json);
+
+	// Solved sig/n challenges (<player_id>.solved.json), read and written by
+	// SolvedChallengeCache; disk only, it keeps its own memory LRU
+	static std::optional<SharedBytes> get_cached_solved(
+		const std::string &player_id);
+	static void cache_solved(const std::string &player_id,
+							 const std::string &json);
+
    private:
 	ytdlpp::net::HttpClient &http_;
 	std::string player_url_;
 
-	std::optional<std::string> extract_player_url_from_webpage(
-		const std::string &webpage);
-
 	// In-memory cache (player_id -> cached data)
 	static std::unordered_map<std::string, CachedPlayerData> cache_;
-	static std::mutex cache_mutex_;
+	static std::shared_mutex cache_mutex_;
 	static std::filesystem::path cache_dir_;
+	static std::unique_ptr<PlayerCacheStore> store_;
+
+	static std::optional<SharedBytes> read_disk(const std::string &file);
+	static void write_disk(const std::string &file, const void *data,
+						   size_t size);
+	static std::optional<std::string> load_text(
+		const std::string &player_id, std::string CachedPlayerData::*field,
+		const char *suffix);
+	static void store_text(const std::string &player_id,
+						   std::string CachedPlayerData::*field,
+						   const char *suffix, const std::string &content);
 
 	std::optional<std::string> get_cached_script(const std::string &player_id);
 	void cache_script(const std::string &player_id, const std::string &content);
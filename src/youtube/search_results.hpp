@@ -0,0 +1,13 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <vector>
+#include <ytdlpp/types.hpp>
+
+namespace ytdlpp::youtube {
+
+// Video entries of an Innertube /search response, at most max_results
+std::vector<SearchResult> extract_search_results(
+	const nlohmann::json &response, int max_results);
+
+}  // namespace ytdlpp::youtube